@@ -37,7 +37,18 @@ maquettes.path  =  $$OUT_PWD/dist/data/Maquettes
 maquettes.files =  $$PWD/data/Maquettes/*
 INSTALLS    += maquettes
 
-#Install the file containing the infos about tracks
+#Generate the compile-time track catalogue from infosVoies.txt
+CATALOGUE_VOIES = $$PWD/data/infosVoies.txt
+cataloguevoies.input = CATALOGUE_VOIES
+cataloguevoies.output = $$OUT_PWD/generated/cataloguevoies_gen.h
+cataloguevoies.commands = cmake -DENTREE=${QMAKE_FILE_IN} -DSORTIE=${QMAKE_FILE_OUT} -P $$PWD/tools/gencatalogue.cmake
+cataloguevoies.depends = $$PWD/tools/gencatalogue.cmake
+cataloguevoies.CONFIG += no_link target_predeps
+QMAKE_EXTRA_COMPILERS += cataloguevoies
+INCLUDEPATH += $$OUT_PWD/generated
+
+#Install the file containing the infos about tracks (read by genmaquette, the
+#simulator uses the compiled catalogue)
 infos.path  =  $$OUT_PWD/dist/data
 infos.files =  $$PWD/data/infosVoies.txt
 INSTALLS    += infos
@@ -96,7 +107,18 @@ SOURCES += \
     $$PWD/src/maquettemanager.cpp \
     $$PWD/src/voieaiguillageenroule.cpp \
     $$PWD/src/voieaiguillagetriple.cpp \
-    $$PWD/src/ctrain_handler.cpp
+    $$PWD/src/ctrain_handler.cpp \
+    $$PWD/src/locostore.cpp \
+    $$PWD/src/chargeurmaquette.cpp \
+    $$PWD/src/statistiquessim.cpp \
+    $$PWD/src/simbatch.cpp \
+    $$PWD/src/metriques.cpp \
+    $$PWD/src/panneaumetriques.cpp \
+    $$PWD/src/observateurscontact.cpp \
+    $$PWD/src/graphevoies.cpp \
+    $$PWD/src/cataloguevoies.cpp \
+    $$PWD/src/validateurmaquette.cpp \
+    $$PWD/src/fenetreoccupation.cpp
 
 HEADERS += \
     $$PWD/src/mainwindow.h \
@@ -119,6 +141,18 @@ HEADERS += \
     $$PWD/src/maquettemanager.h \
     $$PWD/src/voieaiguillageenroule.h \
     $$PWD/src/voieaiguillagetriple.h \
-    $$PWD/src/ctrain_handler.h
+    $$PWD/src/ctrain_handler.h \
+    $$PWD/src/simsnapshot.h \
+    $$PWD/src/locostore.h \
+    $$PWD/src/chargeurmaquette.h \
+    $$PWD/src/statistiquessim.h \
+    $$PWD/src/simbatch.h \
+    $$PWD/src/metriques.h \
+    $$PWD/src/panneaumetriques.h \
+    $$PWD/src/observateurscontact.h \
+    $$PWD/src/graphevoies.h \
+    $$PWD/src/cataloguevoies.h \
+    $$PWD/src/validateurmaquette.h \
+    $$PWD/src/fenetreoccupation.h
 
 OTHER_FILES += $$PWD/data/infosVoies.txt
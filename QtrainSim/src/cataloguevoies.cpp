@@ -0,0 +1,103 @@
+#include <QDebug>
+#include <QFile>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+#include "cataloguevoies.h"
+
+// Define a compatibility symbol due to "QString::SkipEmptyParts" being
+// deprecated in newer versions of Qt
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+#define SkipEmptyParts      Qt::SkipEmptyParts
+#else
+#define SkipEmptyParts      QString::SkipEmptyParts
+#endif
+
+/** vérifie qu'aucune référence n'apparait deux fois dans le catalogue compilé.
+  */
+static constexpr bool referencesUniques()
+{
+    for(const DescriptionVoie& d : CATALOGUE_VOIES)
+    {
+        if(CatalogueVoies::descriptionCompilee(d.reference) != &d)
+            return false;
+    }
+    return true;
+}
+
+static_assert(referencesUniques(), "infosVoies.txt contient deux fois la meme reference");
+
+/** retourne le type de voie correspondant à un nom de infosVoies.txt.
+  * \param nom le nom du type.
+  * \param type reçoit le type.
+  * \return vrai si le nom est connu.
+  */
+static bool typeDepuisNom(const QString &nom, TypeVoie &type)
+{
+    for(int code = 1; code <= NB_TYPES_VOIES; code++)
+    {
+        if(nom == NOMS_TYPES_VOIES[code])
+        {
+            type = static_cast<TypeVoie>(code);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CatalogueVoies::chargerSurcharge(const QString &fichier)
+{
+    QFile fichierInfosVoies(fichier);
+    if(!fichierInfosVoies.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Erreur de lecture de fichier : impossible d'ouvrir" << fichier;
+        return false;
+    }
+
+    QTextStream lecture(&fichierInfosVoies);
+    QString ligne = lecture.readLine();
+
+    while(!ligne.isNull() && !ligne.startsWith("EOF"))
+    {
+        QStringList ligneDecoupee = ligne.split(QRegExp("\\s+"), SkipEmptyParts);
+
+        if(!ligneDecoupee.isEmpty())
+        {
+            DescriptionVoie description{0, TypeVoie::Droite, {0.0, 0.0, 0.0}};
+            bool valide = ligneDecoupee.length() >= 3 && ligneDecoupee.length() <= 5;
+
+            if(valide)
+                description.reference = ligneDecoupee.at(0).toInt(&valide);
+            if(valide)
+                valide = typeDepuisNom(ligneDecoupee.at(1), description.type);
+            for(int i = 2; valide && i < ligneDecoupee.length(); i++)
+                description.parametres[i - 2] = ligneDecoupee.at(i).toDouble(&valide);
+
+            if(!valide)
+            {
+                qDebug() << "Erreur de lecture de fichier :" << fichier << ": description de voie invalide :" << ligne;
+                return false;
+            }
+
+            surcharges.insert(description.reference, description);
+        }
+
+        ligne = lecture.readLine();
+    }
+
+    return true;
+}
+
+const DescriptionVoie* CatalogueVoies::description(int reference) const
+{
+    QHash<int, DescriptionVoie>::const_iterator it = surcharges.constFind(reference);
+    if(it != surcharges.constEnd())
+        return &it.value();
+    return descriptionCompilee(reference);
+}
+
+int CatalogueVoies::getNbreSurcharges() const
+{
+    return surcharges.size();
+}
@@ -0,0 +1,91 @@
+#ifndef CATALOGUEVOIES_H
+#define CATALOGUEVOIES_H
+
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+
+/** Types de voies gérés par le simulateur. Les valeurs sont les codes utilisés
+  * historiquement par le chargeur de maquettes.
+  */
+enum class TypeVoie : int
+{
+    Droite = 1,
+    Courbe,
+    Aiguillage,
+    Croisement,
+    TraverseeJonction,
+    Buttoir,
+    AiguillageEnroule,
+    AiguillageTriple
+};
+
+//! nombre de types de voies, codes de 1 a NB_TYPES_VOIES.
+constexpr int NB_TYPES_VOIES = 8;
+
+//! noms des types de voies dans infosVoies.txt, indexés par leur code.
+constexpr const char* NOMS_TYPES_VOIES[NB_TYPES_VOIES + 1] = {
+    "", "droite", "courbe", "aiguillage", "croisement", "traversee-jonction",
+    "buttoir", "aiguillageEnroule", "aiguillageTriple"
+};
+
+/** Description d'une référence de voie du catalogue.
+  */
+struct DescriptionVoie
+{
+    //! référence de la voie (numéro Märklin).
+    int reference;
+    TypeVoie type;
+    //! paramètres géométriques, dans l'ordre de infosVoies.txt. Les paramètres
+    //! absents valent 0.
+    qreal parametres[3];
+};
+
+// CATALOGUE_VOIES, généré à la compilation à partir de data/infosVoies.txt.
+#include "cataloguevoies_gen.h"
+
+/** Catalogue des références de voies. Les références de infosVoies.txt sont compilées
+  * dans le programme ; un fichier de même format peut, optionnellement, ajouter des
+  * références ou en remplacer.
+  */
+class CatalogueVoies
+{
+public:
+    /** recherche une référence dans le catalogue compilé.
+      * \param reference la référence de la voie.
+      * \return la description de la voie, nullptr si la référence est inconnue.
+      */
+    static constexpr const DescriptionVoie* descriptionCompilee(int reference)
+    {
+        for(const DescriptionVoie& description : CATALOGUE_VOIES)
+        {
+            if(description.reference == reference)
+                return &description;
+        }
+        return nullptr;
+    }
+
+    /** lit un fichier de description de voies, au format de infosVoies.txt, dont les
+      * références s'ajoutent à celles du catalogue compilé ou les remplacent.
+      * \param fichier le chemin du fichier.
+      * \return vrai si le fichier a pu être lu entièrement.
+      */
+    bool chargerSurcharge(const QString &fichier);
+
+    /** recherche une référence, d'abord parmi les surcharges puis dans le catalogue
+      * compilé.
+      * \param reference la référence de la voie.
+      * \return la description de la voie, nullptr si la référence est inconnue.
+      */
+    const DescriptionVoie* description(int reference) const;
+
+    /** retourne le nombre de références lues dans le fichier de surcharge.
+      * \return le nombre de surcharges.
+      */
+    int getNbreSurcharges() const;
+
+private:
+    QHash<int, DescriptionVoie> surcharges;
+};
+
+#endif // CATALOGUEVOIES_H
@@ -0,0 +1,390 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtGlobal>
+
+#include "chargeurmaquette.h"
+#include "voieaiguillage.h"
+#include "voieaiguillageenroule.h"
+#include "voieaiguillagetriple.h"
+#include "voiebuttoir.h"
+#include "voiecourbe.h"
+#include "voiecroisement.h"
+#include "voiedroite.h"
+#include "voietraverseejonction.h"
+#include "contact.h"
+
+// Define a compatibility symbol due to "QString::SkipEmptyParts" being
+// deprecated in newer versions of Qt
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+#define SkipEmptyParts      Qt::SkipEmptyParts
+#else
+#define SkipEmptyParts      QString::SkipEmptyParts
+#endif
+
+/* Fabriques des voies, specialisees par type a la compilation. Chacune indique la
+ * classe construite, l'ordre dans lequel les identifiants des voies voisines sont lus
+ * dans le fichier de maquette et si une direction (gauche/droite) les suit.
+ */
+template<TypeVoie T> struct FabriqueVoie;
+
+template<> struct FabriqueVoie<TypeVoie::Droite>
+{
+    using Classe = VoieDroite;
+    static constexpr int ORDRE_LIENS[] = {0, 1};
+    static constexpr bool DIRECTION = false;
+    static Voie* creer(const DescriptionVoie &d, qreal)
+    {
+        return new VoieDroite(d.parametres[0]);
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::Courbe>
+{
+    using Classe = VoieCourbe;
+    static constexpr int ORDRE_LIENS[] = {0, 1};
+    static constexpr bool DIRECTION = true;
+    static Voie* creer(const DescriptionVoie &d, qreal direction)
+    {
+        return new VoieCourbe(d.parametres[0], d.parametres[1], int(direction));
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::Aiguillage>
+{
+    using Classe = VoieAiguillage;
+    static constexpr int ORDRE_LIENS[] = {0, 1, 2};
+    static constexpr bool DIRECTION = true;
+    static Voie* creer(const DescriptionVoie &d, qreal direction)
+    {
+        return new VoieAiguillage(d.parametres[0], d.parametres[1], d.parametres[2], direction);
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::Croisement>
+{
+    using Classe = VoieCroisement;
+    static constexpr int ORDRE_LIENS[] = {0, 1, 2, 3};
+    static constexpr bool DIRECTION = false;
+    static Voie* creer(const DescriptionVoie &d, qreal)
+    {
+        return new VoieCroisement(d.parametres[0], d.parametres[1]);
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::TraverseeJonction>
+{
+    using Classe = VoieTraverseeJonction;
+    static constexpr int ORDRE_LIENS[] = {0, 1, 2, 3};
+    static constexpr bool DIRECTION = false;
+    static Voie* creer(const DescriptionVoie &d, qreal)
+    {
+        return new VoieTraverseeJonction(d.parametres[0], d.parametres[1], d.parametres[2]);
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::Buttoir>
+{
+    using Classe = VoieButtoir;
+    static constexpr int ORDRE_LIENS[] = {0};
+    static constexpr bool DIRECTION = false;
+    static Voie* creer(const DescriptionVoie &d, qreal)
+    {
+        return new VoieButtoir(d.parametres[0]);
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::AiguillageEnroule>
+{
+    using Classe = VoieAiguillageEnroule;
+    //ordre inversé, pour la cohérence du code...
+    static constexpr int ORDRE_LIENS[] = {0, 2, 1};
+    static constexpr bool DIRECTION = true;
+    static Voie* creer(const DescriptionVoie &d, qreal direction)
+    {
+        return new VoieAiguillageEnroule(d.parametres[0], d.parametres[1], d.parametres[2], direction);
+    }
+};
+
+template<> struct FabriqueVoie<TypeVoie::AiguillageTriple>
+{
+    using Classe = VoieAiguillageTriple;
+    static constexpr int ORDRE_LIENS[] = {0, 1, 2, 3};
+    static constexpr bool DIRECTION = false;
+    static Voie* creer(const DescriptionVoie &d, qreal)
+    {
+        return new VoieAiguillageTriple(d.parametres[0], d.parametres[1], d.parametres[2]);
+    }
+};
+
+/** construit une voie d'un type donné à partir de sa ligne dans le fichier de maquette.
+  * \param d la description de la référence de la voie.
+  * \param champs la ligne découpée : identifiant, référence, voisines, direction.
+  * \param liens reçoit les identifiants des voies voisines, dans l'ordre des liaisons.
+  * \return la voie créée.
+  */
+template<TypeVoie T>
+static Voie* creerVoie(const DescriptionVoie &d, const QStringList &champs, QList<int>* liens)
+{
+    using Fabrique = FabriqueVoie<T>;
+    constexpr int nbLiens = int(sizeof(Fabrique::ORDRE_LIENS) / sizeof(Fabrique::ORDRE_LIENS[0]));
+
+    for(int i = 0; i < nbLiens; i++)
+        liens->append(champs.at(2 + Fabrique::ORDRE_LIENS[i]).toInt());
+
+    // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
+    // NE CHANGER SOUS AUCUN PRETEXTE.
+    qreal direction = 1.0;
+    if(Fabrique::DIRECTION)
+    {
+        QString nom = champs.value(2 + nbLiens).toLower();
+        if(nom == "droite")
+            direction = -1.0;
+        else if(nom != "gauche") //en cas d'erreur dans le fichier...
+            qDebug() << "Erreur de lecture de fichier : fichier non standard (direction de voie). ";
+    }
+
+    return Fabrique::creer(d, direction);
+}
+
+/** construit une voie à partir de sa ligne dans le fichier de maquette, avec la
+  * fabrique correspondant à son type.
+  */
+static Voie* creerVoie(const DescriptionVoie &d, const QStringList &champs, QList<int>* liens)
+{
+    switch(d.type)
+    {
+    case TypeVoie::Droite:
+        return creerVoie<TypeVoie::Droite>(d, champs, liens);
+    case TypeVoie::Courbe:
+        return creerVoie<TypeVoie::Courbe>(d, champs, liens);
+    case TypeVoie::Aiguillage:
+        return creerVoie<TypeVoie::Aiguillage>(d, champs, liens);
+    case TypeVoie::Croisement:
+        return creerVoie<TypeVoie::Croisement>(d, champs, liens);
+    case TypeVoie::TraverseeJonction:
+        return creerVoie<TypeVoie::TraverseeJonction>(d, champs, liens);
+    case TypeVoie::Buttoir:
+        return creerVoie<TypeVoie::Buttoir>(d, champs, liens);
+    case TypeVoie::AiguillageEnroule:
+        return creerVoie<TypeVoie::AiguillageEnroule>(d, champs, liens);
+    case TypeVoie::AiguillageTriple:
+        return creerVoie<TypeVoie::AiguillageTriple>(d, champs, liens);
+    }
+    return nullptr;
+}
+
+ChargeurMaquette::ChargeurMaquette()
+{
+    // Les references de infosVoies.txt sont compilees dans le programme. Un fichier de
+    // description supplementaire, s'il existe, les complete ou les remplace.
+    infosVoiesChargees = true;
+
+    QString fichierSurcharge = getFichierInfosVoies();
+    if(QFile::exists(fichierSurcharge))
+    {
+        infosVoiesChargees = catalogue.chargerSurcharge(fichierSurcharge);
+        if(infosVoiesChargees)
+            qDebug() << catalogue.getNbreSurcharges() << "references de voies lues dans" << fichierSurcharge;
+    }
+}
+
+bool ChargeurMaquette::estValide() const
+{
+    return infosVoiesChargees;
+}
+
+QString ChargeurMaquette::getFichierInfosVoies() const
+{
+    return DATADIR+"/infosVoiesPerso.txt";
+}
+
+bool ChargeurMaquette::charger(QString filename, SimView *simView)
+{
+    simView->viderMaquette();
+
+    // stockage temporaire des voies, avec les identifiants des voies a lier.
+    QMap <Voie*, QList<int>*> voiesALier;
+    // stockage temporaire des voies, indexees par identifiants.
+    QMap <int, Voie*> IDVoies;
+
+    QStringList listeTemporaire;
+    int IDvoie;
+
+    QFile fichier(filename);
+
+    if(!fichier.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "Erreur de lecture de fichier : impossible d'ouvrir" << filename;
+        return false;
+    }
+
+    QTextStream lecture(&fichier);
+    QString ligne;
+    bool premiereInfoValide;
+    int limite;
+
+    //avance rapide pour passer une eventuelle introduction.
+
+    ligne = lecture.readLine();
+
+    listeTemporaire = ligne.split(" ", SkipEmptyParts);
+
+    limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
+
+    while((listeTemporaire.length() != 1) && !premiereInfoValide)
+    {
+        if(lecture.atEnd())
+            qDebug() << "Erreur de lecture de fichier : fichier non standard. (nombre de voies mal indique)";
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", SkipEmptyParts);
+
+        limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
+
+    }
+
+    // lecture des informations relatives aux voies, creation des voies.
+
+    // nombre de voies par type, indexe par le code du type (1 a 8).
+    int nbVoiesParType[NB_TYPES_VOIES + 1] = {};
+
+    for(int i =0; i < limite; i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", SkipEmptyParts);
+
+        IDvoie = listeTemporaire.at(0).toInt();
+
+        //recuperation des infos de la voie en traitement.
+        const DescriptionVoie* description = catalogue.description(listeTemporaire.at(1).toInt());
+
+        if(description == nullptr)
+        {
+            qDebug() << "Erreur de lecture de fichier : reference de voie inconnue" << listeTemporaire.at(1);
+            libererLiens(voiesALier);
+            // les voies deja lues ont ete confiees a la vue : la maquette partielle est videe.
+            simView->viderMaquette();
+            return false;
+        }
+
+        //Creation et insertion de la voie dans les stockages temporaires.
+        QList<int>* liens = new QList<int>();
+        Voie* voie = creerVoie(*description, listeTemporaire, liens);
+        voie->setIdVoie(IDvoie);
+        IDVoies.insert(IDvoie, voie);
+        voiesALier.insert(voie, liens);
+        simView->addVoie(voie, IDvoie);
+
+        nbVoiesParType[int(description->type)]++;
+    }
+    //finalisation de la creation des voies.
+
+    for(int i = 1; i <= IDVoies.size(); i++)
+    {
+        for(int j = 0; j < voiesALier[IDVoies[i]]->length(); j++)
+        {
+            IDVoies[i]->lier(IDVoies[voiesALier[IDVoies[i]]->at(j)], j);
+        }
+    }
+
+    //debut de la lecture des contacts.
+
+    limite = lecture.readLine().toInt();
+
+    Contact* c;
+
+    for(int i=0; i < limite;i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", SkipEmptyParts);
+
+        //creation des contacts.
+        c = new Contact(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt());
+
+        IDVoies[listeTemporaire.at(1).toInt()]->setContact(c);
+        simView->addContact(c, listeTemporaire.at(0).toInt());
+    }
+
+    //debut de la lecture des aiguillages.
+
+    limite = lecture.readLine().toInt();
+
+    for(int i=0; i < limite;i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", SkipEmptyParts);
+
+        VoieVariable *v=dynamic_cast<VoieVariable *>(IDVoies[listeTemporaire.at(1).toInt()]);
+
+        simView->addVoieVariable(v, listeTemporaire.at(0).toInt());
+
+        v->setNumVoieVariable(listeTemporaire.at(0).toInt());
+
+    }
+
+    //indication de la premiere voie a poser.
+
+    Voie * premiereVoie = IDVoies[lecture.readLine().toInt()];
+
+    simView->setPremiereVoie(premiereVoie);
+
+    simView->construireMaquette();
+
+    simView->genererSegments();
+
+    afficherEmpreinteMemoire(filename, nbVoiesParType);
+
+    // On détruit la map qui contient des pointeurs sur des QList
+    libererLiens(voiesALier);
+
+    return true;
+}
+
+void ChargeurMaquette::libererLiens(QMap<Voie*, QList<int>*> &voiesALier)
+{
+    QMapIterator<Voie*, QList<int>*> it(voiesALier);
+    while (it.hasNext()) {
+        it.next();
+        delete it.value();
+    }
+    voiesALier.clear();
+}
+
+void ChargeurMaquette::afficherEmpreinteMemoire(const QString &filename, const int nbVoiesParType[])
+{
+    // taille des objets de chaque type de voie, dans l'ordre des codes de type.
+    static const size_t tailles[NB_TYPES_VOIES + 1] = {
+        0,
+        sizeof(FabriqueVoie<TypeVoie::Droite>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::Courbe>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::Aiguillage>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::Croisement>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::TraverseeJonction>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::Buttoir>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::AiguillageEnroule>::Classe),
+        sizeof(FabriqueVoie<TypeVoie::AiguillageTriple>::Classe)
+    };
+
+    int nbVoies = 0;
+    size_t total = 0;
+    QStringList details;
+
+    for(int type = 1; type <= NB_TYPES_VOIES; type++)
+    {
+        if(nbVoiesParType[type] == 0)
+            continue;
+        size_t taille = tailles[type] * size_t(nbVoiesParType[type]);
+        nbVoies += nbVoiesParType[type];
+        total += taille;
+        details << QString("%1: %2 x %3 o").arg(NOMS_TYPES_VOIES[type]).arg(nbVoiesParType[type]).arg(tailles[type]);
+    }
+
+    qDebug().noquote() << QString("Maquette %1 : %2 voies, %3 octets (%4)")
+                          .arg(QFileInfo(filename).fileName()).arg(nbVoies).arg(total)
+                          .arg(details.join(", "));
+}
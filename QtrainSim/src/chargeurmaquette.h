@@ -0,0 +1,57 @@
+#ifndef CHARGEURMAQUETTE_H
+#define CHARGEURMAQUETTE_H
+
+#include <QMap>
+#include <QList>
+#include <QString>
+
+#include "cataloguevoies.h"
+#include "simview.h"
+
+/** Construit les maquettes dans un SimView, à partir du catalogue des types de voies
+  * compilé depuis infosVoies.txt. N'utilise aucune boîte de dialogue : peut servir sans fenêtre
+  * principale, par exemple pour une simulation sans affichage.
+  */
+class ChargeurMaquette
+{
+public:
+    /** Constructeur de classe. Lit le fichier optionnel de description de voies
+      * supplémentaires, s'il existe.
+      */
+    ChargeurMaquette();
+
+    /** indique si le fichier optionnel de description de voies, s'il existe, a pu être lu.
+      * \return vrai si les maquettes peuvent être chargées.
+      */
+    bool estValide() const;
+
+    /** retourne le chemin du fichier optionnel de description de voies, au format de
+      * infosVoies.txt, qui complète ou remplace le catalogue compilé.
+      * \return le chemin de infosVoiesPerso.txt.
+      */
+    QString getFichierInfosVoies() const;
+
+    /** Charge et construit la maquette décrite dans le fichier filename.
+      * \param filename le fichier de la maquette à charger.
+      * \param simView la vue dans laquelle la maquette est construite.
+      * \return vrai si le fichier a pu être lu.
+      */
+    bool charger(QString filename, SimView* simView);
+
+private:
+    /** affiche la taille occupée par les objets voies d'une maquette chargée.
+      * \param filename le fichier de la maquette.
+      * \param nbVoiesParType le nombre de voies de chaque type, indexé par le code du type.
+      */
+    static void afficherEmpreinteMemoire(const QString &filename, const int nbVoiesParType[]);
+
+    /** détruit les listes des voies voisines construites pendant le chargement.
+      * \param voiesALier les listes, par voie.
+      */
+    static void libererLiens(QMap<Voie*, QList<int>*> &voiesALier);
+
+    CatalogueVoies catalogue;
+    bool infosVoiesChargees;
+};
+
+#endif // CHARGEURMAQUETTE_H
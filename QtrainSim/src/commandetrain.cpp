@@ -1,15 +1,28 @@
 
 #include <iostream>
 #include <QApplication>
+#include <QDataStream>
+#include <QFile>
 #include <QThread>
 
 #include "commandetrain.h"
 #include "mainwindow.h"
+#include "simbatch.h"
+#include "locostore.h"
+#include "metriques.h"
+#include "observateurscontact.h"
+
+//! identifie les fichiers écrits par sauvegarder_etat().
+#define FICHIER_ETAT_MAGIQUE 0x51545346
 
 
 
 static MainWindow *mainwindow;
 static SimView* simView;
+//! fenêtre principale ou simulation sans affichage, qui charge les maquettes.
+static QObject* hote;
+static QSemaphore* semWaitMaquette;
+static QSemaphore* maquetteFinie;
 
 
 
@@ -21,6 +34,8 @@ CommandeTrain::CommandeTrain()
     mutex = new QMutex();
     VarCond = new QWaitCondition();
     waitingOn=false;
+    prochainAbonnement = 1;
+    attentesAnnulees = false;
 }
 
 CommandeTrain* CommandeTrain::getInstance()
@@ -35,6 +50,9 @@ void CommandeTrain::init_maquette(void)
     mainwindow->show();
 
     simView = mainwindow->getSimView();
+    hote = mainwindow;
+    semWaitMaquette = &mainwindow->semWaitMaquette;
+    maquetteFinie = &mainwindow->maquetteFinie;
 
     CONNECT(this, SIGNAL(setLoco(int,int,int,int)), simView, SLOT(setLoco(int,int,int,int)));
     CONNECT(this, SIGNAL(askLoco(int,int)), simView, SLOT(askLoco(int,int)));
@@ -42,12 +60,53 @@ void CommandeTrain::init_maquette(void)
     CONNECT(this, SIGNAL(reverseLoco(int)), simView, SLOT(reverseLoco(int)));
     CONNECT(this, SIGNAL(setVitesseProgressiveLoco(int,int)), simView, SLOT(setVitesseProgressiveLoco(int,int)));
     CONNECT(this, SIGNAL(setVoieVariable(int,int)), simView, SLOT(setVoieVariable(int,int)));
+    CONNECT(this, SIGNAL(setAlimentation(bool)), simView, SLOT(setAlimentation(bool)));
+    CONNECT(this, SIGNAL(programmerArret(int,int)), simView, SLOT(programmerArret(int,int)));
+    CONNECT(this, SIGNAL(annulerArret(int)), simView, SLOT(annulerArret(int)));
+    CONNECT(this, SIGNAL(setBlocMobile(int,bool)), simView, SLOT(setBlocMobile(int,bool)));
+    CONNECT(this, SIGNAL(leverArretUrgence()), simView, SLOT(leverArretUrgence()));
+    CONNECT(this, SIGNAL(setPauseLoco(int,bool)), simView, SLOT(setPauseLoco(int,bool)));
+    CONNECT(simView, SIGNAL(pauseLoco(int,bool)), this, SLOT(notifierPause(int,bool)));
+    CONNECT(simView, SIGNAL(alerteCollision(int,int,int,qreal)), this, SLOT(notifierAlerteCollision(int,int,int,qreal)));
+    CONNECT(simView, SIGNAL(maquetteAVider()), this, SLOT(oublierAbonnements()));
     CONNECT(this, SIGNAL(addLoco(int)),mainwindow,SLOT(addLoco(int)));
     CONNECT(this, SIGNAL(selectMaquette(QString)),mainwindow,SLOT(selectionMaquette(QString)));
     CONNECT(this, SIGNAL(afficheMessage(QString)),mainwindow,SLOT(afficherMessage(QString)));
     CONNECT(this, SIGNAL(afficheMessageLoco(int,QString)),mainwindow,SLOT(afficherMessageLoco(int,QString)));
 
-    QTimer::singleShot(10, this, SLOT(timerTrigger()));
+    CONNECT(qApp, SIGNAL(aboutToQuit()), this, SLOT(arreterProgramme()));
+
+    QTimer::singleShot(0, this, SLOT(timerTrigger()));
+}
+
+void CommandeTrain::init_batch(SimBatch *batch)
+{
+    simView = batch->getSimView();
+    hote = batch;
+    semWaitMaquette = &batch->semWaitMaquette;
+    maquetteFinie = &batch->maquetteFinie;
+
+    CONNECT(this, SIGNAL(setLoco(int,int,int,int)), simView, SLOT(setLoco(int,int,int,int)));
+    CONNECT(this, SIGNAL(askLoco(int,int)), simView, SLOT(askLoco(int,int)));
+    CONNECT(this, SIGNAL(setVitesseLoco(int,int)), simView, SLOT(setVitesseLoco(int,int)));
+    CONNECT(this, SIGNAL(reverseLoco(int)), simView, SLOT(reverseLoco(int)));
+    CONNECT(this, SIGNAL(setVitesseProgressiveLoco(int,int)), simView, SLOT(setVitesseProgressiveLoco(int,int)));
+    CONNECT(this, SIGNAL(setVoieVariable(int,int)), simView, SLOT(setVoieVariable(int,int)));
+    CONNECT(this, SIGNAL(setAlimentation(bool)), simView, SLOT(setAlimentation(bool)));
+    CONNECT(this, SIGNAL(programmerArret(int,int)), simView, SLOT(programmerArret(int,int)));
+    CONNECT(this, SIGNAL(annulerArret(int)), simView, SLOT(annulerArret(int)));
+    CONNECT(this, SIGNAL(setBlocMobile(int,bool)), simView, SLOT(setBlocMobile(int,bool)));
+    CONNECT(this, SIGNAL(leverArretUrgence()), simView, SLOT(leverArretUrgence()));
+    CONNECT(this, SIGNAL(setPauseLoco(int,bool)), simView, SLOT(setPauseLoco(int,bool)));
+    CONNECT(simView, SIGNAL(pauseLoco(int,bool)), this, SLOT(notifierPause(int,bool)));
+    CONNECT(simView, SIGNAL(alerteCollision(int,int,int,qreal)), this, SLOT(notifierAlerteCollision(int,int,int,qreal)));
+    CONNECT(simView, SIGNAL(maquetteAVider()), this, SLOT(oublierAbonnements()));
+    CONNECT(this, SIGNAL(addLoco(int)), batch, SLOT(addLoco(int)));
+    CONNECT(this, SIGNAL(selectMaquette(QString)), batch, SLOT(selectionMaquette(QString)));
+    CONNECT(this, SIGNAL(afficheMessage(QString)), batch, SLOT(afficherMessage(QString)));
+    CONNECT(this, SIGNAL(afficheMessageLoco(int,QString)), batch, SLOT(afficherMessageLoco(int,QString)));
+
+    QTimer::singleShot(0, this, SLOT(timerTrigger()));
 }
 
 
@@ -84,12 +143,29 @@ static UserThread *userThread = nullptr;
 CommandeTrain::~CommandeTrain()
 {
     if (userThread != nullptr) {
-        userThread->terminate();
-        userThread->wait();
+        // Le programme client a normalement été arrêté par arreterProgramme.
+        if (!userThread->isFinished()) {
+            userThread->terminate();
+            userThread->wait();
+        }
         delete userThread;
     }
 }
 
+void CommandeTrain::arreterProgramme()
+{
+    mutexAttentes.lock();
+    QList<std::function<void()> > fonctions = fonctionsArret;
+    mutexAttentes.unlock();
+
+    foreach(const std::function<void()> &fonction, fonctions)
+        fonction();
+    annuler_attentes();
+
+    if (userThread != nullptr)
+        userThread->wait(DELAI_ARRET_PROGRAMME_MS);
+}
+
 void CommandeTrain::timerTrigger()
 {
 
@@ -104,19 +180,31 @@ void CommandeTrain::timerTrigger()
 
 void CommandeTrain::mettre_maquette_hors_service(void)
 {
-
+    emit setAlimentation(false);
 }
 
 void CommandeTrain::mettre_maquette_en_service(void)
 {
-
+    emit setAlimentation(true);
 }
 
 void CommandeTrain::ajouter_loco(int no_loco)
 {
+    if (!verifierNumeroLoco(no_loco))
+        return;
     emit addLoco(no_loco);
 }
 
+bool CommandeTrain::verifierNumeroLoco(int no_loco)
+{
+    if (LocoStore::numeroValide(no_loco))
+        return true;
+
+    emit afficheMessage(QString("Erreur : le numéro de loco %1 n'est pas valide, il doit être compris entre 0 et %2.")
+                        .arg(no_loco).arg(MAX_LOCOS));
+    return false;
+}
+
 void CommandeTrain::diriger_aiguillage(int no_aiguillage, int direction, int /*temps_alim*/)
 {
     emit setVoieVariable(no_aiguillage, direction);
@@ -124,13 +212,168 @@ void CommandeTrain::diriger_aiguillage(int no_aiguillage, int direction, int /*t
 
 void CommandeTrain::attendre_contact(int no_contact)
 {
-    Contact *c=simView->getContact(no_contact);
-    if (c == nullptr)
+    attendre_contacts(QList<int>() << no_contact);
+}
+
+void CommandeTrain::attendre_contact_loco(int no_contact, int no_loco)
+{
+    attendre_contacts(QList<int>() << no_contact, no_loco);
+}
+
+int CommandeTrain::attendre_contacts(const QList<int> &contacts, int no_loco)
+{
+    AttenteContacts attente(no_loco);
+    QList<Contact*> observes;
+
+    foreach(int no_contact, contacts)
     {
-        QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
+        Contact *c = simView->getContact(no_contact);
+        if (c == nullptr)
+        {
+            QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
+        }
+        else if (!observes.contains(c))
+        {
+            c->abonner(&attente, true);
+            observes.append(c);
+        }
     }
+
+    if (observes.isEmpty())
+        return -1;
+
+    mutexAttentes.lock();
+    if (attentesAnnulees)
+        attente.annuler();
+    attentes.append(&attente);
+    mutexAttentes.unlock();
+
+    qint64 debut = Metriques::maintenant();
+    int no_contact = attente.attendre();
+    foreach(Contact *c, observes)
+        c->desabonner(&attente);
+
+    mutexAttentes.lock();
+    attentes.removeOne(&attente);
+    mutexAttentes.unlock();
+
+    if (no_contact >= 0)
+        Metriques::getInstance()->attenteContact(no_contact, Metriques::maintenant() - debut);
+    return no_contact;
+}
+
+void CommandeTrain::annuler_attentes()
+{
+    mutexAttentes.lock();
+    attentesAnnulees = true;
+    foreach(AttenteContacts *attente, attentes)
+        attente->annuler();
+    mutexAttentes.unlock();
+}
+
+void CommandeTrain::retablir_attentes()
+{
+    mutexAttentes.lock();
+    attentesAnnulees = false;
+    mutexAttentes.unlock();
+}
+
+void CommandeTrain::sur_arret_programme(std::function<void()> fonction)
+{
+    mutexAttentes.lock();
+    fonctionsArret.append(fonction);
+    mutexAttentes.unlock();
+}
+
+void CommandeTrain::mettre_loco_en_pause(int no_loco, bool en_pause)
+{
+    emit setPauseLoco(no_loco, en_pause);
+}
+
+bool CommandeTrain::loco_en_pause(int no_loco)
+{
+    QMutexLocker locker(&mutexPause);
+    return locosEnPause.contains(no_loco);
+}
+
+void CommandeTrain::sur_pause_loco(std::function<void(int, bool)> fonction)
+{
+    mutexPause.lock();
+    fonctionsPause.append(fonction);
+    mutexPause.unlock();
+}
+
+void CommandeTrain::notifierPause(int numLoco, bool enPause)
+{
+    mutexPause.lock();
+    if (enPause)
+        locosEnPause.insert(numLoco);
     else
-        c->attendContact();
+        locosEnPause.remove(numLoco);
+    QList<std::function<void(int, bool)> > fonctions = fonctionsPause;
+    mutexPause.unlock();
+
+    foreach(const std::function<void(int, bool)> &fonction, fonctions)
+        fonction(numLoco, enPause);
+}
+
+void CommandeTrain::sur_alerte_collision(std::function<void(int, int, int, qreal)> fonction)
+{
+    mutexAlertes.lock();
+    fonctionsAlerte.append(fonction);
+    mutexAlertes.unlock();
+}
+
+void CommandeTrain::notifierAlerteCollision(int numLoco, int numAutreLoco, int niveau, qreal tempsAvantCollision)
+{
+    mutexAlertes.lock();
+    QList<std::function<void(int, int, int, qreal)> > fonctions = fonctionsAlerte;
+    mutexAlertes.unlock();
+
+    foreach(const std::function<void(int, int, int, qreal)> &fonction, fonctions)
+        fonction(numLoco, numAutreLoco, niveau, tempsAvantCollision);
+}
+
+int CommandeTrain::abonner_contact(int no_contact, std::function<void(int, int)> rappel)
+{
+    Contact *c = simView->getContact(no_contact);
+    if (c == nullptr)
+        return -1;
+
+    AbonnementContact *abonnement = new AbonnementContact(rappel);
+    mutexAbonnements.lock();
+    int numero = prochainAbonnement++;
+    abonnements.insert(numero, qMakePair(c, abonnement));
+    mutexAbonnements.unlock();
+
+    c->abonner(abonnement);
+    return numero;
+}
+
+void CommandeTrain::desabonner_contact(int abonnement)
+{
+    mutexAbonnements.lock();
+    QPair<Contact*, AbonnementContact*> a = abonnements.take(abonnement);
+    mutexAbonnements.unlock();
+
+    if (a.first == nullptr)
+        return;
+    a.first->desabonner(a.second);
+    delete a.second;
+}
+
+void CommandeTrain::oublierAbonnements()
+{
+    mutexAbonnements.lock();
+    QMap<int, QPair<Contact*, AbonnementContact*> > anciens = abonnements;
+    abonnements.clear();
+    mutexAbonnements.unlock();
+
+    foreach(const QPair<Contact*, AbonnementContact*> &a, anciens)
+    {
+        a.first->desabonner(a.second);
+        delete a.second;
+    }
 }
 
 void CommandeTrain::arreter_loco(int no_loco)
@@ -165,15 +408,117 @@ void CommandeTrain::demander_loco(int contact_a, int contact_b, int */*no_loco*/
 
 void CommandeTrain::assigner_loco(int contact_a,int contact_b,int no_loco,int vitesse)
 {
+    if (!verifierNumeroLoco(no_loco))
+        return;
     emit addLoco(no_loco);
     emit setLoco(contact_a, contact_b, no_loco, vitesse);
 }
 
+double CommandeTrain::distance_jusqu_au_contact(int no_loco, int no_contact)
+{
+    qreal distance = -1.0;
+    QMetaObject::invokeMethod(simView, "distanceJusquAuContact", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(qreal, distance), Q_ARG(int, no_loco), Q_ARG(int, no_contact));
+    return distance;
+}
+
+double CommandeTrain::temps_jusqu_au_contact(int no_loco, int no_contact)
+{
+    qreal temps = -1.0;
+    QMetaObject::invokeMethod(simView, "tempsJusquAuContact", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(qreal, temps), Q_ARG(int, no_loco), Q_ARG(int, no_contact));
+    return temps;
+}
+
+void CommandeTrain::programmer_arret_loco(int no_loco, int no_contact)
+{
+    emit programmerArret(no_loco, no_contact);
+}
+
+void CommandeTrain::annuler_arret_loco(int no_loco)
+{
+    emit annulerArret(no_loco);
+}
+
+void CommandeTrain::mettre_bloc_mobile_loco(int no_loco, bool actif)
+{
+    emit setBlocMobile(no_loco, actif);
+}
+
+void CommandeTrain::arret_urgence()
+{
+    simView->demanderArretUrgence(Metriques::maintenant());
+}
+
+void CommandeTrain::lever_arret_urgence()
+{
+    emit leverArretUrgence();
+}
+
+void CommandeTrain::suspendre_simulation(bool suspendue)
+{
+    QMetaObject::invokeMethod(simView, "setSuspendue", Qt::BlockingQueuedConnection,
+                              Q_ARG(bool, suspendue));
+}
+
+bool CommandeTrain::sauvegarder_etat(const QString &fichier, const QByteArray &donnees)
+{
+    QByteArray etat;
+    QMetaObject::invokeMethod(simView, "sauvegarderEtat", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(QByteArray, etat));
+
+    QFile f(fichier);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream flux(&f);
+    flux << quint32(FICHIER_ETAT_MAGIQUE) << etat << donnees;
+    return flux.status() == QDataStream::Ok;
+}
+
+bool CommandeTrain::restaurer_etat(const QString &fichier, QByteArray &donnees)
+{
+    QFile f(fichier);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream flux(&f);
+    quint32 magique;
+    QByteArray etat;
+    flux >> magique >> etat >> donnees;
+    if (flux.status() != QDataStream::Ok || magique != FICHIER_ETAT_MAGIQUE)
+        return false;
+
+    bool restaure = false;
+    QMetaObject::invokeMethod(simView, "restaurerEtat", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, restaure), Q_ARG(QByteArray, etat));
+    return restaure;
+}
+
+void CommandeTrain::precharger_maquette(QString maquette, bool demarrer)
+{
+    maquettePrechargee = maquette;
+
+    // Mis en file après le lancement du programme client par timerTrigger : le
+    // chargement se fait pendant que le programme client construit ses threads.
+    QMetaObject::invokeMethod(hote, "selectionMaquette", Qt::QueuedConnection,
+                              Q_ARG(QString, maquette));
+    if (demarrer && hote == mainwindow)
+        QMetaObject::invokeMethod(mainwindow, "demarrerSimulation", Qt::QueuedConnection);
+}
+
 void CommandeTrain::selection_maquette(QString maquette)
 {
+    if (!maquettePrechargee.isNull()) {
+        semWaitMaquette->acquire();
+        maquetteFinie->acquire();
+        bool memeMaquette = maquettePrechargee == maquette;
+        maquettePrechargee = QString();
+        if (memeMaquette)
+            return;
+    }
+
     emit selectMaquette(maquette);
-    mainwindow->semWaitMaquette.acquire();
-    mainwindow->maquetteFinie.acquire();
+    semWaitMaquette->acquire();
+    maquetteFinie->acquire();
 }
 
 void CommandeTrain::afficher_message(const char *message)
@@ -3,11 +3,22 @@
 
 #include <QObject>
 #include <QString>
+#include <QList>
+#include <QMap>
 #include <QMutex>
+#include <QPair>
+#include <QSet>
 #include <QWaitCondition>
 
+#include <functional>
+
 #include "general.h"
 
+class SimBatch;
+class Contact;
+class AbonnementContact;
+class AttenteContacts;
+
 /**
   Toutes les methodes de cette classe doivent être reentrantes!!!!!!!
   */
@@ -41,6 +52,13 @@ public:
      */
     void init_maquette(void);
 
+    /**
+     * Initialise la communication avec un simulateur sans fenetre principale.
+     * Remplace init_maquette pour une simulation sans affichage.
+     * \param batch L'hote de la simulation.
+     */
+    void init_batch(SimBatch *batch);
+
     /**
      * Met fin a la simulation. A appeler en fin de programme client
      */
@@ -56,7 +74,8 @@ public:
      * Remarque : n'a pas d'effet sur la maquette reelle.
      * Remarque bis : Cette méthode est appelée automatiquement lors de l'appel de
      *                assigner_loco(...);
-     * \param no_loco Numéro de la locomotive.
+     * \param no_loco Numéro de la locomotive, entre 0 et MAX_LOCOS. Un numéro hors
+     *                de ces bornes est signalé et ignoré.
      */
     void ajouter_loco(int no_loco);
 
@@ -72,10 +91,100 @@ public:
     /**
      * Méthode bloquante, permettant d'attendre l'activation du contact voulu.
      * Remarque : le contact peut être activé par n'importe quelle locomotive.
+     * Remarque bis : retourne sans activation si les attentes sont annulées.
      * \param no_contact  Numéro du contact dont on attend l'activation.
      */
     void attendre_contact(int no_contact);
 
+    /**
+     * Méthode bloquante, permettant d'attendre qu'une loco donnée active un contact.
+     * Les activations du contact par d'autres locos sont ignorées.
+     * \param no_contact  Numéro du contact dont on attend l'activation.
+     * \param no_loco     Numéro de la loco attendue.
+     */
+    void attendre_contact_loco(int no_contact, int no_loco);
+
+    /**
+     * Méthode bloquante, permettant d'attendre l'activation de l'un de plusieurs contacts.
+     * \param contacts  Numéros des contacts dont on attend l'activation.
+     * \param no_loco   Numéro de la loco attendue, -1 pour n'importe quelle loco.
+     * \return le numéro du premier contact activé, ou -1 si aucun contact n'est valide
+     *         ou si les attentes sont annulées.
+     */
+    int attendre_contacts(const QList<int> &contacts, int no_loco = -1);
+
+    /**
+     * Libère tous les threads attendant un contact. Jusqu'à l'appel de retablir_attentes,
+     * les attentes suivantes retournent immédiatement.
+     */
+    void annuler_attentes();
+
+    /**
+     * Rétablit les attentes de contacts après annuler_attentes.
+     */
+    void retablir_attentes();
+
+    /**
+     * Enregistre une fonction appelée à la fermeture du simulateur, pour que le programme
+     * client puisse demander l'arrêt de ses threads. Les attentes de contacts sont
+     * annulées juste après.
+     * \param fonction  Fonction appelée dans le thread de l'interface.
+     */
+    void sur_arret_programme(std::function<void()> fonction);
+
+    /**
+     * Met une loco en pause ou la fait reprendre, comme la commande de pause de
+     * l'interface. En pause, la loco est figée sur place.
+     * \param no_loco   Numéro de la loco.
+     * \param en_pause  Vrai pour mettre la loco en pause, faux pour la faire reprendre.
+     */
+    void mettre_loco_en_pause(int no_loco, bool en_pause);
+
+    /**
+     * Indique si une loco est en pause.
+     * \param no_loco  Numéro de la loco.
+     * \return vrai si la loco est en pause.
+     */
+    bool loco_en_pause(int no_loco);
+
+    /**
+     * Enregistre une fonction appelée à chaque mise en pause ou reprise d'une loco,
+     * depuis l'interface ou le programme.
+     * Remarque : la fonction est appelée dans le thread de la simulation : elle doit être
+     *            brève et ne pas bloquer.
+     * \param fonction  Fonction appelée avec le numéro de la loco et son nouvel état.
+     */
+    void sur_pause_loco(std::function<void(int, bool)> fonction);
+
+    /**
+     * Enregistre une fonction appelée à chaque changement de l'alerte de collision
+     * d'une loco : niveau de l'alerte ou loco avec laquelle la collision est prévue.
+     * Remarque : la fonction est appelée dans le thread de la simulation : elle doit être
+     *            brève et ne pas bloquer.
+     * \param fonction  Fonction appelée avec le numéro de la loco, celui de l'autre loco
+     *                  (-1 si l'alerte est levée), le niveau de l'alerte et le temps
+     *                  avant collision en secondes (-1 si l'alerte est levée).
+     */
+    void sur_alerte_collision(std::function<void(int, int, int, qreal)> fonction);
+
+    /**
+     * Abonne une fonction aux activations d'un contact, sans bloquer le thread appelant.
+     * Remarque : la fonction est appelée dans le thread de la simulation : elle doit être
+     *            brève et ne pas bloquer.
+     * \param no_contact  Numéro du contact.
+     * \param rappel      Fonction appelée avec les numéros du contact et de la loco l'ayant
+     *                    activé, à chaque activation.
+     * \return le numéro de l'abonnement, ou -1 si le contact n'est pas valide.
+     */
+    int abonner_contact(int no_contact, std::function<void(int, int)> rappel);
+
+    /**
+     * Met fin à un abonnement. Au retour, la fonction abonnée n'est plus appelée.
+     * Remarque : les abonnements prennent fin d'eux-mêmes au rechargement de la maquette.
+     * \param abonnement  Numéro de l'abonnement retourné par abonner_contact.
+     */
+    void desabonner_contact(int abonnement);
+
     /**
      * Arrete une locomotive (met sa vitesse à  VITESSE_NULLE).
      * \param no_loco  Numéro de la loco à  stopper.
@@ -136,18 +245,119 @@ public:
      * La méthode indique également entre quels contacts elle se trouve, ainsi que sa vitesse.
      * \param contact_a  Identifiant du contact vers lequel la loco va se diriger.
      * \param contact_b  Identifiant du contact à l'arrière de la loco.
-     * \param no_loco    Numéro de la loco choisie.
+     * \param no_loco    Numéro de la loco choisie, entre 0 et MAX_LOCOS. Un numéro
+     *                   hors de ces bornes est signalé et ignoré.
      * \param vitesse    Vitesse à laquelle la loco devra se déplacer.
      */
     void assigner_loco(int contact_a,int contact_b,int no_loco,int vitesse);
 
+    /**
+     * Retourne la distance que la loco doit encore parcourir avant d'activer un contact,
+     * selon l'état actuel des aiguillages.
+     * Remarque : bloque jusqu'à ce que la simulation ait répondu. A n'appeler que
+     *            depuis le programme client.
+     * \param no_loco     Numéro de la loco.
+     * \param no_contact  Numéro du contact.
+     * \return la distance, ou -1 si le contact n'est pas sur le parcours de la loco.
+     */
+    double distance_jusqu_au_contact(int no_loco, int no_contact);
+
+    /**
+     * Retourne le temps nécessaire à la loco pour atteindre un contact à sa vitesse actuelle.
+     * Remarque : bloque jusqu'à ce que la simulation ait répondu. A n'appeler que
+     *            depuis le programme client.
+     * \param no_loco     Numéro de la loco.
+     * \param no_contact  Numéro du contact.
+     * \return le temps en secondes, ou -1 si la loco est arrêtée ou si le contact
+     *         n'est pas sur son parcours.
+     */
+    double temps_jusqu_au_contact(int no_loco, int no_contact);
+
+    /**
+     * Programme l'arrêt immédiat d'une loco juste avant un contact, sans inertie.
+     * Le contact n'est pas activé.
+     * \param no_loco     Numéro de la loco.
+     * \param no_contact  Numéro du contact devant lequel la loco doit s'arrêter.
+     */
+    void programmer_arret_loco(int no_loco, int no_contact);
+
+    /**
+     * Annule l'arrêt programmé d'une loco, s'il n'a pas encore eu lieu.
+     * \param no_loco  Numéro de la loco.
+     */
+    void annuler_arret_loco(int no_loco);
+
+    /**
+     * Active ou désactive le bloc mobile d'une loco : sa vitesse est alors limitée
+     * pour qu'elle puisse toujours s'arrêter avant la loco qui la précède.
+     * \param no_loco  Numéro de la loco.
+     * \param actif    Vrai pour activer le bloc mobile.
+     */
+    void mettre_bloc_mobile_loco(int no_loco, bool actif);
+
+    /**
+     * Arrête toutes les locos au plus tard au pas de simulation suivant, sans inertie.
+     * Les locos restent arrêtées jusqu'à l'appel de lever_arret_urgence.
+     * Peut être appelée depuis n'importe quel thread.
+     */
+    void arret_urgence();
+
+    /**
+     * Lève l'arrêt d'urgence : les locos reprennent les vitesses commandées depuis.
+     */
+    void lever_arret_urgence();
+
+    /**
+     * Suspend ou reprend la simulation. Au retour, plus aucun pas de simulation n'est
+     * effectué jusqu'à la reprise.
+     * Remarque : bloque jusqu'à ce que la simulation ait répondu. A n'appeler que
+     *            depuis le programme client.
+     * \param suspendue  Vrai pour suspendre la simulation.
+     */
+    void suspendre_simulation(bool suspendue);
+
+    /**
+     * Sauvegarde l'état complet de la simulation dans un fichier binaire, avec les
+     * données du programme client. Pour que les deux soient cohérents, la simulation
+     * devrait être suspendue pendant que le programme client prépare ses données.
+     * Remarque : bloque jusqu'à ce que la simulation ait répondu. A n'appeler que
+     *            depuis le programme client.
+     * \param fichier   Chemin du fichier.
+     * \param donnees   Données du programme client, sauvegardées telles quelles.
+     * \return vrai si le fichier a été écrit.
+     */
+    bool sauvegarder_etat(const QString &fichier, const QByteArray &donnees);
+
+    /**
+     * Restaure l'état de la simulation sauvegardé dans un fichier. La maquette doit
+     * être celle de la sauvegarde et les locos doivent avoir été placées.
+     * Remarque : bloque jusqu'à ce que la simulation ait répondu. A n'appeler que
+     *            depuis le programme client.
+     * \param fichier   Chemin du fichier.
+     * \param donnees   Reçoit les données du programme client sauvegardées avec l'état.
+     * \return vrai si l'état a été restauré.
+     */
+    bool restaurer_etat(const QString &fichier, QByteArray &donnees);
+
     /**
       * Sélectionne la maquette à  utiliser.
       * Cette fonction termine l'application si la maquette n'est pas trouvée.
+      * Si la maquette a été préchargée, attend seulement la fin de son chargement.
       * \param maquette Nom de la maquette.
       */
     void selection_maquette(QString maquette);
 
+    /**
+      * Charge une maquette choisie au lancement, pendant que le programme client
+      * démarre. A appeler depuis le thread principal, après init_maquette ou
+      * init_batch. Le programme client la sélectionne ensuite comme d'habitude.
+      * \param maquette Nom de la maquette.
+      * \param demarrer Vrai pour lancer la simulation une fois la maquette chargée.
+      *                 Sans effet sans fenêtre principale, où le programme client
+      *                 lance la simulation.
+      */
+    void precharger_maquette(QString maquette, bool demarrer = false);
+
     void afficher_message(const char *message);
 
     void afficher_message_loco(int numLoco,const char *message);
@@ -160,6 +370,28 @@ public slots:
 protected slots:
     void timerTrigger();
 
+    /**
+     * Demande au programme client de s'arrêter et attend sa fin, au plus
+     * DELAI_ARRET_PROGRAMME_MS millisecondes.
+     */
+    void arreterProgramme();
+
+    /**
+     * Enregistre le nouvel état d'une loco et appelle les fonctions de sur_pause_loco.
+     */
+    void notifierPause(int numLoco, bool enPause);
+
+    /**
+     * Appelle les fonctions de sur_alerte_collision.
+     */
+    void notifierAlerteCollision(int numLoco, int numAutreLoco, int niveau, qreal tempsAvantCollision);
+
+    /**
+     * Met fin à tous les abonnements aux contacts, avant que la maquette ne soit vidée
+     * et ses contacts détruits. Les numéros d'abonnement deviennent invalides.
+     */
+    void oublierAbonnements();
+
 signals:
     void addLoco(int no_loco);
     void setLoco(int contactA, int contactB, int numLoco, int vitesseLoco);
@@ -169,15 +401,45 @@ signals:
     void setVitesseProgressiveLoco(int numLoco, int vitesseLoco);
     void stopLoco(int numLoco);
     void setVoieVariable(int numVoieVariable, int direction);
+    void setAlimentation(bool alimentee);
+    void programmerArret(int numLoco, int numContact);
+    void annulerArret(int numLoco);
+    void setBlocMobile(int numLoco, bool actif);
+    void leverArretUrgence();
+    void setPauseLoco(int numLoco, bool enPause);
     void selectMaquette(QString maquette);
     void afficheMessage(QString message);
     void afficheMessageLoco(int numLoco,QString message);
 
 private:
+    /** signale un numéro de loco hors des bornes du simulateur.
+      * \param no_loco le numéro de la loco.
+      * \return vrai si le numéro est valide.
+      */
+    bool verifierNumeroLoco(int no_loco);
+
     QString command;
     QWaitCondition* VarCond;
     QMutex* mutex;
     bool waitingOn;
+    //! abonnements aux contacts, par numéro d'abonnement.
+    QMap<int, QPair<Contact*, AbonnementContact*> > abonnements;
+    int prochainAbonnement;
+    QMutex mutexAbonnements;
+    //! attentes de contacts en cours et fonctions d'arrêt, protégées par mutexAttentes.
+    QList<AttenteContacts*> attentes;
+    bool attentesAnnulees;
+    QList<std::function<void()> > fonctionsArret;
+    QMutex mutexAttentes;
+    //! locos en pause et fonctions de sur_pause_loco, protégées par mutexPause.
+    QSet<int> locosEnPause;
+    QList<std::function<void(int, bool)> > fonctionsPause;
+    QMutex mutexPause;
+    //! fonctions de sur_alerte_collision, protégées par mutexAlertes.
+    QList<std::function<void(int, int, int, qreal)> > fonctionsAlerte;
+    QMutex mutexAlertes;
+    //! maquette préchargée dont selection_maquette n'a pas encore attendu le chargement.
+    QString maquettePrechargee;
 };
 
 #endif // COMMANDETRAIN_H
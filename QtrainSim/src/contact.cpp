@@ -1,5 +1,6 @@
 #include "contact.h"
 #include "trainsimsettings.h"
+#include "metriques.h"
 
 /** Constructeur de classe Contact.
   * @param numContact, le numero du contact.
@@ -15,7 +16,12 @@ Contact::Contact(int numContact, int numVoiePorteuse, QObject *parent) :
     mutex = new QMutex();
     VarCond = new QWaitCondition();
     setZValue(ZVAL_CONTACT);
-    waitingOn=false;
+    this->fonte = FONTE_CONTACT;
+    this->texteNumero.setText(QString::number(numContact));
+    this->texteNumero.prepare(QTransform(), fonte);
+    this->numeroAffiche = TrainSimSettings::getInstance()->getViewContactNumber();
+    threadNotifiant = nullptr;
+    setAngle(0.0);
 }
 
 int Contact::getNumContact()
@@ -26,20 +32,73 @@ int Contact::getNumContact()
 
 void Contact::attendContact()
 {
+    // L'affichage est rafraîchi par SimView à partir des instantanés :
+    // ce thread ne touche pas à la scène.
     mutex->lock();
-    waitingOn=true;
-    update();
+    nbEnAttente.ref();
     VarCond->wait(mutex);
-    waitingOn=false;
-    update();
+    nbEnAttente.deref();
     mutex->unlock();
 }
 
-void Contact::active()
+bool Contact::estEnAttente() const
 {
+    return nbEnAttente.loadAcquire() > 0;
+}
+
+void Contact::active(int numLoco)
+{
+    Metriques::getInstance()->activationContact(numContact);
+
+    // Les observateurs sont notifiés hors du verrou, afin qu'ils puissent se
+    // désabonner. Un observateur désabonné entre-temps n'est plus notifié.
+    mutexObservateurs.lock();
+    QList<ObservateurContact*> aNotifier = observateurs;
+    threadNotifiant = QThread::currentThreadId();
+    mutexObservateurs.unlock();
+
+    foreach(ObservateurContact* observateur, aNotifier)
+    {
+        mutexObservateurs.lock();
+        bool abonne = observateurs.contains(observateur);
+        mutexObservateurs.unlock();
+        if(abonne)
+            observateur->contactActive(numContact, numLoco);
+    }
+
+    mutexObservateurs.lock();
+    threadNotifiant = nullptr;
+    finNotification.wakeAll();
+    mutexObservateurs.unlock();
+
     VarCond->wakeAll();
 }
 
+void Contact::abonner(ObservateurContact *observateur, bool enAttente)
+{
+    mutexObservateurs.lock();
+    observateurs.append(observateur);
+    if(enAttente)
+    {
+        observateursEnAttente.append(observateur);
+        nbEnAttente.ref();
+    }
+    mutexObservateurs.unlock();
+}
+
+void Contact::desabonner(ObservateurContact *observateur)
+{
+    mutexObservateurs.lock();
+    observateurs.removeOne(observateur);
+    if(observateursEnAttente.removeOne(observateur))
+        nbEnAttente.deref();
+    // l'observateur peut être en cours de notification : au retour, il ne doit plus
+    // l'être, sauf s'il se désabonne depuis sa propre notification.
+    while(threadNotifiant != nullptr && threadNotifiant != QThread::currentThreadId())
+        finNotification.wait(&mutexObservateurs);
+    mutexObservateurs.unlock();
+}
+
 int Contact::getNumVoiePorteuse()
 {
     return this->numVoiePorteuse;
@@ -47,18 +106,47 @@ int Contact::getNumVoiePorteuse()
 
 void Contact::setAngle(qreal angle)
 {
+    prepareGeometryChange();
     this->angle = angle;
+
+    qreal theangle=angle;
+    while (theangle>PI)
+         theangle-=PI;
+    while (theangle<0.0)
+         theangle+=PI;
+
+    decalageNumero = QPointF(TRANSLATION_NUM_CONTACT * cos(theangle), TRANSLATION_NUM_CONTACT * sin(theangle));
+}
+
+void Contact::actualiserNumero()
+{
+    bool affiche = TrainSimSettings::getInstance()->getViewContactNumber();
+    if(affiche != numeroAffiche)
+    {
+        prepareGeometryChange();
+        numeroAffiche = affiche;
+    }
 }
 
 QRectF Contact::boundingRect() const
 {
-    return QRectF(- 100.0, - 100.0, 200.0, 200.0);
+    QRectF rect(- TAILLE_CONTACT - 1.0, - TAILLE_CONTACT - 1.0, 2.0 * TAILLE_CONTACT + 2.0, 2.0 * TAILLE_CONTACT + 2.0);
+
+    if (numeroAffiche)
+        rect |= QRectF(decalageNumero.x() - 3.0 * TAILLE_CONTACT,
+                       decalageNumero.y() - 3.0 * TAILLE_CONTACT,
+                       6.0 * TAILLE_CONTACT,
+                       6.0 * TAILLE_CONTACT);
+
+    return rect;
 }
 
 #include <QGraphicsScene>
 
 void Contact::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
+    bool waitingOn = estEnAttente();
+
     if (waitingOn)
     {
         painter->setPen(COULEUR_CONTACT_WAITING);
@@ -71,46 +159,20 @@ void Contact::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*
     }
     painter->drawEllipse(QPointF(0.0,0.0),TAILLE_CONTACT, TAILLE_CONTACT);
 
-    if (TrainSimSettings::getInstance()->getViewContactNumber())
+    if (numeroAffiche)
     {
-        QString t;
-        t.setNum(numContact);
-
         if (waitingOn)
         {
             painter->setPen(COULEUR_CONTACT_WAITING);
-            painter->setFont(FONTE_CONTACT);
         }
         else
         {
             painter->setPen(COULEUR_FONTE_CONTACT);
-            painter->setFont(FONTE_CONTACT);
         }
-        qreal theangle=angle;
-        while (theangle>PI)
-             theangle-=PI;
-        while (theangle<0.0)
-             theangle+=PI;
-
-        QRectF r=QRectF(TRANSLATION_NUM_CONTACT * cos(theangle) - 3.0 * TAILLE_CONTACT,
-                        TRANSLATION_NUM_CONTACT * sin(theangle) - 3.0 * TAILLE_CONTACT,
-                        6.0 * TAILLE_CONTACT,
-                        6.0 * TAILLE_CONTACT);
-/*
-        r.translate(this->scenePos());
-        if (this->scene()->items(r,Qt::IntersectsItemShape,Qt::AscendingOrder).size()>=2) {
-            theangle+=PI;
-            r=QRectF(TRANSLATION_NUM_CONTACT * cos(theangle) - 3.0 * TAILLE_CONTACT,
-                                    TRANSLATION_NUM_CONTACT * sin(theangle) - 3.0 * TAILLE_CONTACT,
-                                    6.0 * TAILLE_CONTACT,
-                                    6.0 * TAILLE_CONTACT);
-        }
-        else
-            r.translate(-this->scenePos());
-  */
-        painter->drawText(r,
-                          t,
-                          QTextOption(Qt::AlignHCenter|Qt::AlignVCenter));
-        painter->drawLine(QPointF(0.0,0.0), QPointF(TRANSLATION_NUM_CONTACT * cos(theangle) / 2.0, TRANSLATION_NUM_CONTACT * sin(theangle) / 2.0));
+        painter->setFont(fonte);
+
+        QSizeF taille = texteNumero.size();
+        painter->drawStaticText(decalageNumero - QPointF(taille.width() / 2.0, taille.height() / 2.0), texteNumero);
+        painter->drawLine(QPointF(0.0,0.0), decalageNumero / 2.0);
     }
 }
@@ -2,15 +2,34 @@
 #define CONTACT_H
 
 #include <QObject>
+#include <QList>
 #include <QAbstractGraphicsShapeItem>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QPainter>
+#include <QStaticText>
+#include <QThread>
 #include <QDebug>
 #include <math.h>
 
 #include "general.h"
 
+/** Interface des objets notifiés de l'activation d'un contact.
+  */
+class ObservateurContact
+{
+public:
+    virtual ~ObservateurContact() {}
+
+    /** Méthode appelée par le thread de la simulation quand un contact observé est
+      * activé. Ne doit pas bloquer.
+      * \param numContact le numéro du contact activé.
+      * \param numLoco le numéro de la loco ayant activé le contact.
+      */
+    virtual void contactActive(int numContact, int numLoco) = 0;
+};
+
 class Contact : public QObject, public QAbstractGraphicsShapeItem
 {
     Q_OBJECT
@@ -27,9 +46,25 @@ public:
     void attendContact();
 
     /** Méthode appelée quand une loco passe sur le contact.
-      * Libère les threads en attente.
+      * Notifie les observateurs, dans le thread appelant, et libère les threads en attente.
+      * \param numLoco le numéro de la loco passant sur le contact.
+      */
+    void active(int numLoco);
+
+    /** Abonne un observateur aux activations du contact.
+      * Peut être appelée depuis n'importe quel thread.
+      * \param observateur l'observateur à notifier.
+      * \param enAttente vrai si un thread attend l'activation au travers de
+      *        l'observateur : le contact est alors affiché comme attendu.
+      */
+    void abonner(ObservateurContact* observateur, bool enAttente = false);
+
+    /** Désabonne un observateur. Au retour, il n'est plus notifié : si une notification
+      * est en cours dans un autre thread, elle est attendue. Peut être appelée depuis la
+      * notification d'un observateur.
+      * \param observateur l'observateur à désabonner.
       */
-    void active();
+    void desabonner(ObservateurContact* observateur);
 
     /** retourne le numéro de la voie porteuse.
       * \return le numéro de la voie porteuse.
@@ -41,6 +76,11 @@ public:
       */
     void setAngle(qreal angle);
 
+    /** Relit l'option d'affichage des numéros de contact et adapte le rectangle
+      * englobant du contact en conséquence.
+      */
+    void actualiserNumero();
+
     /** retourne le rectangle englobant le contact. Nécessaire à l'affichage.
       * \return le rectangle englobant le contact.
       */
@@ -55,6 +95,12 @@ public:
       * \return le numéro du contact.
       */
     int getNumContact();
+
+    /** indique si un thread attend l'activation du contact.
+      * Peut être appelée depuis n'importe quel thread.
+      * \return vrai si au moins un thread attend sur le contact.
+      */
+    bool estEnAttente() const;
 signals:
 
 public slots:
@@ -65,7 +111,23 @@ private:
     QWaitCondition* VarCond;
     QMutex* mutex;
     qreal angle;
-    bool waitingOn;
+    //! vrai si le numéro du contact est affiché.
+    bool numeroAffiche;
+    //! décalage du numéro par rapport au contact, calculé par setAngle().
+    QPointF decalageNumero;
+    QFont fonte;
+    QStaticText texteNumero;
+    //! nombre de threads en attente. Lu par l'affichage, modifié par les threads en attente.
+    QAtomicInt nbEnAttente;
+    //! observateurs abonnés, protégés par mutexObservateurs.
+    QList<ObservateurContact*> observateurs;
+    //! observateurs au travers desquels un thread attend le contact.
+    QList<ObservateurContact*> observateursEnAttente;
+    QMutex mutexObservateurs;
+    //! thread notifiant les observateurs, hors de mutexObservateurs, nul sinon.
+    Qt::HANDLE threadNotifiant;
+    //! signalée à la fin de chaque notification des observateurs.
+    QWaitCondition finNotification;
 };
 
 #endif // CONTACT_H
@@ -9,6 +9,8 @@
  * Revision         : 27.3.2009 (CEZ)
  */
  
+#include <cstring>
+
 #include "ctrain_handler.h"
 #include "commandetrain.h"
 
@@ -57,6 +59,119 @@ void attendre_contact(int no_contact) {
     CMD_TRAIN->attendre_contact(no_contact);
 }
 
+/*
+ * Attend qu'une loco donnee active un contact.
+ *   no_contact : No du contact dont on attend l'activation.
+ *   no_loco    : No de la loco attendue.
+ */
+void attendre_contact_loco(int no_contact, int no_loco) {
+    CMD_TRAIN->attendre_contact_loco(no_contact, no_loco);
+}
+
+/*
+ * Attend l'activation de l'un des contacts donnes.
+ *   contacts    : tableau des No des contacts dont on attend l'activation.
+ *   nb_contacts : nombre de contacts du tableau.
+ *   return      : le No du premier contact active.
+ */
+int attendre_contacts(const int *contacts, int nb_contacts) {
+    QList<int> liste;
+    for (int i = 0; i < nb_contacts; i++)
+        liste.append(contacts[i]);
+    return CMD_TRAIN->attendre_contacts(liste);
+}
+
+/*
+ * Attend qu'une loco donnee active l'un des contacts donnes.
+ *   contacts    : tableau des No des contacts dont on attend l'activation.
+ *   nb_contacts : nombre de contacts du tableau.
+ *   no_loco     : No de la loco attendue.
+ *   return      : le No du premier contact active par la loco.
+ */
+int attendre_contacts_loco(const int *contacts, int nb_contacts, int no_loco) {
+    QList<int> liste;
+    for (int i = 0; i < nb_contacts; i++)
+        liste.append(contacts[i]);
+    return CMD_TRAIN->attendre_contacts(liste, no_loco);
+}
+
+/*
+ * Abonne une fonction aux activations d'un contact.
+ *   no_contact : No du contact.
+ *   fonction   : fonction appelee a chaque activation, dans le thread du simulateur.
+ *   donnees    : pointeur passe tel quel a la fonction.
+ */
+int abonner_contact(int no_contact, fonction_contact fonction, void *donnees) {
+    return CMD_TRAIN->abonner_contact(no_contact, [fonction, donnees](int contact, int loco) {
+        fonction(contact, loco, donnees);
+    });
+}
+
+/*
+ * Libere tous les threads attendant un contact.
+ */
+void annuler_attentes(void) {
+    CMD_TRAIN->annuler_attentes();
+}
+
+/*
+ * Retablit les attentes de contacts.
+ */
+void retablir_attentes(void) {
+    CMD_TRAIN->retablir_attentes();
+}
+
+/*
+ * Enregistre une fonction appelee a la fermeture du simulateur.
+ *   fonction : fonction appelee dans le thread du simulateur.
+ *   donnees  : pointeur passe tel quel a la fonction.
+ */
+void sur_arret_programme(fonction_arret fonction, void *donnees) {
+    CMD_TRAIN->sur_arret_programme([fonction, donnees]() {
+        fonction(donnees);
+    });
+}
+
+/*
+ * Met une loco en pause ou la fait reprendre.
+ */
+void mettre_loco_en_pause(int no_loco, int en_pause) {
+    CMD_TRAIN->mettre_loco_en_pause(no_loco, en_pause != 0);
+}
+
+/*
+ * Indique si une loco est en pause.
+ */
+int loco_en_pause(int no_loco) {
+    return CMD_TRAIN->loco_en_pause(no_loco) ? 1 : 0;
+}
+
+/*
+ * Enregistre une fonction appelee a chaque mise en pause ou reprise d'une loco.
+ */
+void sur_pause_loco(fonction_pause fonction, void *donnees) {
+    CMD_TRAIN->sur_pause_loco([fonction, donnees](int loco, bool enPause) {
+        fonction(loco, enPause ? 1 : 0, donnees);
+    });
+}
+
+/*
+ * Enregistre une fonction appelee a chaque changement d'alerte de collision.
+ */
+void sur_alerte_collision(fonction_alerte_collision fonction, void *donnees) {
+    CMD_TRAIN->sur_alerte_collision([fonction, donnees](int loco, int autreLoco, int niveau, qreal temps) {
+        fonction(loco, autreLoco, niveau, temps, donnees);
+    });
+}
+
+/*
+ * Met fin a un abonnement.
+ *   abonnement : No de l'abonnement retourne par abonner_contact.
+ */
+void desabonner_contact(int abonnement) {
+    CMD_TRAIN->desabonner_contact(abonnement);
+}
+
 /*
  * Arrete une locomotive (met sa vitesse a VITESSE_NULLE).
  *   no_loco : No de la loco a arreter.
@@ -152,6 +267,62 @@ void afficher_message_loco(int numLoco,const char* message)
     CMD_TRAIN->afficher_message_loco(numLoco,message);
 }
 
+double distance_jusqu_au_contact(int no_loco, int no_contact)
+{
+    return CMD_TRAIN->distance_jusqu_au_contact(no_loco, no_contact);
+}
+
+double temps_jusqu_au_contact(int no_loco, int no_contact)
+{
+    return CMD_TRAIN->temps_jusqu_au_contact(no_loco, no_contact);
+}
+
+void programmer_arret_loco(int no_loco, int no_contact)
+{
+    CMD_TRAIN->programmer_arret_loco(no_loco, no_contact);
+}
+
+void annuler_arret_loco(int no_loco)
+{
+    CMD_TRAIN->annuler_arret_loco(no_loco);
+}
+
+void mettre_bloc_mobile_loco(int no_loco, int actif)
+{
+    CMD_TRAIN->mettre_bloc_mobile_loco(no_loco, actif != 0);
+}
+
+void arret_urgence(void)
+{
+    CMD_TRAIN->arret_urgence();
+}
+
+void lever_arret_urgence(void)
+{
+    CMD_TRAIN->lever_arret_urgence();
+}
+
+void suspendre_simulation(int suspendue)
+{
+    CMD_TRAIN->suspendre_simulation(suspendue != 0);
+}
+
+int sauvegarder_etat(const char *fichier, const void *donnees, int taille)
+{
+    QByteArray d(static_cast<const char*>(donnees), donnees != nullptr ? taille : 0);
+    return CMD_TRAIN->sauvegarder_etat(QString::fromLocal8Bit(fichier), d) ? 1 : 0;
+}
+
+int restaurer_etat(const char *fichier, void *donnees, int taille_max)
+{
+    QByteArray d;
+    if (!CMD_TRAIN->restaurer_etat(QString::fromLocal8Bit(fichier), d))
+        return -1;
+    if (donnees != nullptr)
+        memcpy(donnees, d.constData(), static_cast<size_t>(qBound(0, d.size(), taille_max)));
+    return d.size();
+}
+
 const char *getCommand()
 {
     static QByteArray cmd;
@@ -50,6 +50,12 @@ extern "C" {
 #define ETEINT 0
 #define ALLUME 1
 
+// Niveaux des alertes de collision
+#define ALERTE_AUCUNE 0
+#define ALERTE_INFORMATION 1
+#define ALERTE_ATTENTION 2
+#define ALERTE_DANGER 3
+
 /*
  * Initialise la communication avec la maquette/simulateur.
  * A appeler au debut du programme client.
@@ -80,6 +86,143 @@ void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim);
  */
 void attendre_contact(int no_contact);
 
+/*
+ * Attend qu'une loco donnee active un contact. Les activations du contact par
+ * d'autres locos sont ignorees.
+ *   no_contact : No du contact dont on attend l'activation.
+ *   no_loco    : No de la loco attendue.
+ */
+void attendre_contact_loco(int no_contact, int no_loco);
+
+/*
+ * Attend l'activation de l'un des contacts donnes.
+ *   contacts    : tableau des No des contacts dont on attend l'activation.
+ *   nb_contacts : nombre de contacts du tableau.
+ *   return      : le No du premier contact active, ou -1 si aucun contact n'est valide.
+ */
+int attendre_contacts(const int *contacts, int nb_contacts);
+
+/*
+ * Attend qu'une loco donnee active l'un des contacts donnes. Les activations des
+ * contacts par d'autres locos sont ignorees.
+ *   contacts    : tableau des No des contacts dont on attend l'activation.
+ *   nb_contacts : nombre de contacts du tableau.
+ *   no_loco     : No de la loco attendue.
+ *   return      : le No du premier contact active par la loco, ou -1 si aucun contact
+ *                 n'est valide.
+ */
+int attendre_contacts_loco(const int *contacts, int nb_contacts, int no_loco);
+
+/*
+ * Libere tous les threads attendant un contact. Jusqu'a l'appel de retablir_attentes(),
+ * les attentes suivantes retournent immediatement, sans activation.
+ */
+void annuler_attentes(void);
+
+/*
+ * Retablit les attentes de contacts apres annuler_attentes().
+ */
+void retablir_attentes(void);
+
+/*
+ * Fonction appelee a la fermeture du simulateur.
+ *   donnees : pointeur donne lors de l'enregistrement.
+ */
+typedef void (*fonction_arret)(void *donnees);
+
+/*
+ * Enregistre une fonction appelee a la fermeture du simulateur, pour que le programme
+ * client puisse demander l'arret de ses threads. Les attentes de contacts sont
+ * annulees juste apres, puis le simulateur attend la fin du programme client un
+ * court instant avant de l'interrompre.
+ *   fonction : fonction appelee dans le thread du simulateur.
+ *   donnees  : pointeur passe tel quel a la fonction.
+ */
+void sur_arret_programme(fonction_arret fonction, void *donnees);
+
+/*
+ * Met une loco en pause ou la fait reprendre, comme la commande de pause du
+ * simulateur. En pause, la loco est figee sur place et n'active plus de contacts.
+ *   no_loco  : No de la loco.
+ *   en_pause : 1 pour mettre la loco en pause, 0 pour la faire reprendre.
+ * Remarque : n'a d'effet que dans le simulateur.
+ */
+void mettre_loco_en_pause(int no_loco, int en_pause);
+
+/*
+ * Indique si une loco est en pause.
+ *   no_loco : No de la loco.
+ *   return  : 1 si la loco est en pause, 0 sinon.
+ */
+int loco_en_pause(int no_loco);
+
+/*
+ * Fonction appelee a chaque mise en pause ou reprise d'une loco.
+ *   no_loco  : No de la loco.
+ *   en_pause : 1 si la loco vient d'etre mise en pause, 0 si elle reprend.
+ *   donnees  : pointeur donne lors de l'enregistrement.
+ */
+typedef void (*fonction_pause)(int no_loco, int en_pause, void *donnees);
+
+/*
+ * Enregistre une fonction appelee a chaque mise en pause ou reprise d'une loco,
+ * depuis le simulateur ou le programme.
+ *   fonction : fonction appelee dans le thread du simulateur. Elle doit etre breve
+ *              et ne pas bloquer.
+ *   donnees  : pointeur passe tel quel a la fonction.
+ */
+void sur_pause_loco(fonction_pause fonction, void *donnees);
+
+/*
+ * Fonction appelee a chaque changement de l'alerte de collision d'une loco.
+ *   no_loco      : No de la loco.
+ *   no_autre_loco: No de la loco avec laquelle la collision est prevue, -1 si
+ *                  l'alerte est levee.
+ *   niveau       : niveau de l'alerte (ALERTE_AUCUNE a ALERTE_DANGER).
+ *   temps        : temps avant la collision prevue, en secondes, -1 si l'alerte
+ *                  est levee.
+ *   donnees      : pointeur donne lors de l'enregistrement.
+ */
+typedef void (*fonction_alerte_collision)(int no_loco, int no_autre_loco, int niveau,
+                                          double temps, void *donnees);
+
+/*
+ * Enregistre une fonction appelee lorsque le simulateur prevoit une collision.
+ * Le temps avant collision est calcule a chaque pas pour chaque paire de locos dont
+ * les parcours se rejoignent, avec l'etat actuel des aiguillages. La fonction est
+ * appelee lorsque le niveau de l'alerte d'une loco change, ou la loco concernee.
+ *   fonction : fonction appelee dans le thread du simulateur. Elle doit etre breve
+ *              et ne pas bloquer.
+ *   donnees  : pointeur passe tel quel a la fonction.
+ */
+void sur_alerte_collision(fonction_alerte_collision fonction, void *donnees);
+
+/*
+ * Fonction appelee a chaque activation d'un contact abonne.
+ *   no_contact : No du contact active.
+ *   no_loco    : No de la loco ayant active le contact.
+ *   donnees    : pointeur donne lors de l'abonnement.
+ */
+typedef void (*fonction_contact)(int no_contact, int no_loco, void *donnees);
+
+/*
+ * Abonne une fonction aux activations d'un contact, sans bloquer le thread appelant.
+ *   no_contact : No du contact.
+ *   fonction   : fonction appelee a chaque activation.
+ *   donnees    : pointeur passe tel quel a la fonction.
+ *   return     : le No de l'abonnement, ou -1 si le contact n'est pas valide.
+ * Remarque : la fonction est appelee par le simulateur, dans un autre thread que le
+ *            programme client. Elle doit etre breve et ne pas bloquer.
+ */
+int abonner_contact(int no_contact, fonction_contact fonction, void *donnees);
+
+/*
+ * Met fin a un abonnement. Au retour, la fonction abonnee n'est plus appelee.
+ * Les abonnements prennent fin d'eux-memes au rechargement de la maquette.
+ *   abonnement : No de l'abonnement retourne par abonner_contact.
+ */
+void desabonner_contact(int abonnement);
+
 /*
  * Arrete une locomotive (met sa vitesse a VITESSE_NULLE).
  *   no_loco : No de la loco a arreter.
@@ -150,6 +293,8 @@ void assigner_loco(int contact_a, int contact_b, int no_loco, int vitesse);
  * Cette fonction termine l'application si la maquette n'est pas trouvee.
  * La maquette est cherchee dans le repertoire contenant les maquettes.
  *   maquette : Nom de la maquette.
+ * Si la maquette a ete prechargee au lancement (option --maquette), attend
+ * seulement la fin de son chargement.
  */
 void selection_maquette(const char *maquette);
 
@@ -166,6 +311,96 @@ void afficher_message(const char* message);
  */
 void afficher_message_loco(int numLoco,const char* message);
 
+/*
+ * Retourne la distance qu'une loco doit encore parcourir avant d'activer un contact,
+ * selon l'etat actuel des aiguillages.
+ *   no_loco    : No de la loco.
+ *   no_contact : No du contact.
+ *   return     : la distance, ou -1 si le contact n'est pas sur le parcours de la loco.
+ * Remarque : n'a de sens que dans le simulateur.
+ */
+double distance_jusqu_au_contact(int no_loco, int no_contact);
+
+/*
+ * Retourne le temps necessaire a une loco pour atteindre un contact a sa vitesse actuelle.
+ *   no_loco    : No de la loco.
+ *   no_contact : No du contact.
+ *   return     : le temps en secondes, ou -1 si la loco est arretee ou si le contact
+ *                n'est pas sur son parcours.
+ * Remarque : n'a de sens que dans le simulateur.
+ */
+double temps_jusqu_au_contact(int no_loco, int no_contact);
+
+/*
+ * Programme l'arret immediat d'une loco juste avant un contact, sans inertie.
+ * Le contact n'est pas active.
+ *   no_loco    : No de la loco.
+ *   no_contact : No du contact devant lequel la loco doit s'arreter.
+ */
+void programmer_arret_loco(int no_loco, int no_contact);
+
+/*
+ * Annule l'arret programme d'une loco, s'il n'a pas encore eu lieu.
+ *   no_loco : No de la loco.
+ */
+void annuler_arret_loco(int no_loco);
+
+/*
+ * Active ou desactive le bloc mobile d'une loco. Sa vitesse est alors limitee a chaque
+ * instant pour qu'elle puisse s'arreter avant la queue de la loco qui la precede.
+ *   no_loco : No de la loco.
+ *   actif   : 1 pour activer le bloc mobile, 0 pour le desactiver.
+ * Remarque : n'a d'effet que dans le simulateur.
+ */
+void mettre_bloc_mobile_loco(int no_loco, int actif);
+
+/*
+ * Arrete toutes les locos, sans inertie, au plus tard au pas de simulation suivant.
+ * Les locos restent arretees jusqu'a l'appel de lever_arret_urgence(). Le delai de
+ * reaction est affiche dans la console et comptabilise dans les statistiques.
+ * Remarque : peut etre appelee depuis n'importe quel thread.
+ */
+void arret_urgence(void);
+
+/*
+ * Leve l'arret d'urgence. Les locos reprennent les vitesses commandees depuis.
+ */
+void lever_arret_urgence(void);
+
+/*
+ * Suspend ou reprend la simulation. Au retour, plus aucun pas de simulation n'est
+ * effectue jusqu'a la reprise.
+ *   suspendue : 1 pour suspendre la simulation, 0 pour la reprendre.
+ * Remarque : n'a d'effet que dans le simulateur.
+ */
+void suspendre_simulation(int suspendue);
+
+/*
+ * Sauvegarde l'etat complet de la simulation dans un fichier binaire : position et
+ * vitesse des locos, etat des aiguillages, arrets programmes, pauses et statistiques.
+ * Les donnees du programme (etat des sections partagees, avancement des threads)
+ * sont sauvegardees avec, telles quelles. Pour qu'elles soient coherentes avec la
+ * simulation, suspendre la simulation pendant leur preparation.
+ *   fichier : chemin du fichier.
+ *   donnees : donnees du programme, peut etre NULL si taille vaut 0.
+ *   taille  : taille des donnees, en octets.
+ *   return  : 1 si le fichier a ete ecrit, 0 sinon.
+ * Remarque : n'a d'effet que dans le simulateur.
+ */
+int sauvegarder_etat(const char *fichier, const void *donnees, int taille);
+
+/*
+ * Restaure l'etat de la simulation sauvegarde par sauvegarder_etat(). La maquette
+ * doit etre celle de la sauvegarde et les locos doivent avoir ete placees.
+ *   fichier    : chemin du fichier.
+ *   donnees    : recoit les donnees du programme, tronquees a taille_max octets.
+ *   taille_max : taille du tampon donnees.
+ *   return     : la taille des donnees sauvegardees, -1 si l'etat n'a pas pu etre
+ *                restaure.
+ * Remarque : n'a d'effet que dans le simulateur.
+ */
+int restaurer_etat(const char *fichier, void *donnees, int taille_max);
+
 /*
  * Fonction bloquante permettant de recevoir la prochaine commande
  * entree par l'utilisateur.
@@ -0,0 +1,80 @@
+#include "fenetreoccupation.h"
+
+FenetreOccupation::FenetreOccupation(int nbTranches, qreal dureeTranche)
+    : nbTranches(nbTranches),
+      dureeTranche(dureeTranche)
+{
+    reinitialiser(0);
+}
+
+void FenetreOccupation::reinitialiser(int nbSegments)
+{
+    this->nbSegments = nbSegments;
+    trancheCourante = 0;
+    numeroTranche = 0;
+    durees.fill(0.0, nbTranches);
+    duree = 0.0;
+    occupations.fill(0.0, nbTranches * nbSegments);
+    attentes.fill(0.0, nbTranches * nbSegments);
+    totalOccupations.fill(0.0, nbSegments);
+    totalAttentes.fill(0.0, nbSegments);
+}
+
+void FenetreOccupation::enregistrerPas(qreal ms)
+{
+    if(durees.at(trancheCourante) >= dureeTranche)
+    {
+        // la tranche la plus ancienne est réutilisée pour la nouvelle.
+        trancheCourante = (trancheCourante + 1) % nbTranches;
+        numeroTranche++;
+
+        duree -= durees.at(trancheCourante);
+        durees[trancheCourante] = 0.0;
+
+        const int debut = trancheCourante * nbSegments;
+        for(int i = 0; i < nbSegments; i++)
+        {
+            totalOccupations[i] -= occupations.at(debut + i);
+            totalAttentes[i] -= attentes.at(debut + i);
+            occupations[debut + i] = 0.0;
+            attentes[debut + i] = 0.0;
+        }
+    }
+
+    durees[trancheCourante] += ms;
+    duree += ms;
+}
+
+void FenetreOccupation::ajouterOccupation(int indiceSegment, qreal ms)
+{
+    occupations[trancheCourante * nbSegments + indiceSegment] += ms;
+    totalOccupations[indiceSegment] += ms;
+}
+
+void FenetreOccupation::ajouterAttente(int indiceSegment, qreal ms)
+{
+    attentes[trancheCourante * nbSegments + indiceSegment] += ms;
+    totalAttentes[indiceSegment] += ms;
+}
+
+qreal FenetreOccupation::getTauxOccupation(int indiceSegment) const
+{
+    if(duree <= 0.0)
+        return 0.0;
+    return qBound(0.0, totalOccupations.at(indiceSegment) / duree, 1.0);
+}
+
+qreal FenetreOccupation::getAttente(int indiceSegment) const
+{
+    return qMax(0.0, totalAttentes.at(indiceSegment));
+}
+
+qreal FenetreOccupation::getDuree() const
+{
+    return duree;
+}
+
+quint64 FenetreOccupation::getNumeroTranche() const
+{
+    return numeroTranche;
+}
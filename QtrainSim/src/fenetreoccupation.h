@@ -0,0 +1,86 @@
+#ifndef FENETREOCCUPATION_H
+#define FENETREOCCUPATION_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/** Occupation des segments et temps d'attente des locos sur une fenêtre glissante.
+  * La fenêtre est découpée en tranches de durée fixe : à chaque nouvelle tranche, la
+  * plus ancienne est retirée des totaux, si bien qu'aucune mise à jour ne dépend de la
+  * longueur de la fenêtre. Les temps sont en millisecondes de simulation. Mise à jour
+  * par SimView à chaque pas de simulation, lue par l'affichage.
+  */
+class FenetreOccupation
+{
+public:
+    /** Constructeur de classe.
+      * \param nbTranches le nombre de tranches de la fenêtre.
+      * \param dureeTranche la durée d'une tranche, en millisecondes.
+      */
+    FenetreOccupation(int nbTranches, qreal dureeTranche);
+
+    /** vide la fenêtre et la dimensionne pour un nombre de segments.
+      * \param nbSegments le nombre de segments suivis.
+      */
+    void reinitialiser(int nbSegments);
+
+    /** comptabilise un pas de simulation, et passe à la tranche suivante lorsque
+      * la tranche courante est pleine.
+      * \param ms la durée du pas, en millisecondes.
+      */
+    void enregistrerPas(qreal ms);
+
+    /** ajoute du temps d'occupation à un segment.
+      * \param indiceSegment l'indice du segment.
+      * \param ms la durée, en millisecondes.
+      */
+    void ajouterOccupation(int indiceSegment, qreal ms);
+
+    /** ajoute du temps d'attente, d'une loco arrêtée sur un segment.
+      * \param indiceSegment l'indice du segment.
+      * \param ms la durée, en millisecondes.
+      */
+    void ajouterAttente(int indiceSegment, qreal ms);
+
+    /** retourne la part de la fenêtre pendant laquelle un segment était occupé.
+      * \param indiceSegment l'indice du segment.
+      * \return le taux d'occupation, entre 0 et 1.
+      */
+    qreal getTauxOccupation(int indiceSegment) const;
+
+    /** retourne le temps d'attente cumulé des locos arrêtées sur un segment, pendant
+      * la fenêtre.
+      * \param indiceSegment l'indice du segment.
+      * \return le temps d'attente, en millisecondes.
+      */
+    qreal getAttente(int indiceSegment) const;
+
+    /** retourne la durée couverte par la fenêtre, plus courte que la fenêtre tant
+      * qu'elle n'a pas été remplie.
+      * \return la durée, en millisecondes.
+      */
+    qreal getDuree() const;
+
+    /** retourne le nombre de tranches commencées depuis la réinitialisation, pour
+      * savoir si les totaux ont changé depuis la dernière lecture.
+      */
+    quint64 getNumeroTranche() const;
+
+private:
+    int nbTranches;
+    qreal dureeTranche;
+    int nbSegments;
+    //! indice de la tranche courante dans les tableaux de tranches.
+    int trancheCourante;
+    quint64 numeroTranche;
+    //! durée de chaque tranche, et durée totale de la fenêtre.
+    QVector<qreal> durees;
+    qreal duree;
+    //! temps de chaque segment dans chaque tranche, tranche par tranche, et leurs totaux.
+    QVector<qreal> occupations;
+    QVector<qreal> attentes;
+    QVector<qreal> totalOccupations;
+    QVector<qreal> totalAttentes;
+};
+
+#endif // FENETREOCCUPATION_H
@@ -23,6 +23,16 @@
 //! de la valeur de vitesse de 1.
 #define INERTIE_LOCO 100
 
+//! distance qu'une loco en bloc mobile garde libre, en plus de sa distance de
+//! freinage, devant la queue de la loco qui la précède.
+#define MARGE_BLOC_MOBILE 60.0
+
+//! temps avant collision, en secondes, en dessous duquel une alerte de chaque
+//! niveau est signalée.
+#define TTC_INFORMATION 8.0
+#define TTC_ATTENTION 4.0
+#define TTC_DANGER 1.5
+
 //! NE PAS CHANGER!!! nécessaire au calcul des poses de voies.
 #define DIRECTION_VOIE_GAUCHE 1.0
 #define DIRECTION_VOIE_DROITE -1.0
@@ -47,6 +57,45 @@
 //! Valeurs conseillées : 30-60.
 #define FRAME_RATE 60
 
+//! durée d'un pas de simulation, en millisecondes de simulation.
+#define PAS_SIMULATION_MS (1000.0 / FRAME_RATE)
+
+//! nombre maximal de pas effectués d'un coup pour rattraper un retard de
+//! l'interface. Au-delà, le retard est abandonné.
+#define MAX_PAS_RATTRAPAGE 10
+
+//! nombre minimal de locos par tranche lors d'un pas de simulation réparti
+//! sur plusieurs threads. En dessous, le pas est calculé dans un seul thread.
+#define NB_LOCOS_PAR_TRANCHE 4
+
+//! nombre de niveaux de zoom dont le rendu des voies fixes est gardé en cache.
+#define NB_MAX_CACHE_VOIES 8
+
+//! taille maximale, en pixels, d'une image du cache des voies fixes. Au-delà,
+//! les voies fixes sont dessinées directement.
+#define TAILLE_MAX_CACHE_VOIES (4096 * 4096)
+
+//! fenêtre glissante de la carte d'occupation des segments : nombre de tranches
+//! et durée d'une tranche, en millisecondes de simulation.
+#define NB_TRANCHES_CARTE_OCCUPATION 60
+#define DUREE_TRANCHE_CARTE_OCCUPATION_MS 1000.0
+
+//! largeur du tracé des segments sur la carte d'occupation.
+#define LARGEUR_CARTE_OCCUPATION 24.0
+
+//! nombre maximal de sections partagées suivies par les métriques.
+#define MAX_SECTIONS 32
+
+//! période de rafraîchissement du panneau des métriques, en millisecondes.
+#define PERIODE_METRIQUES_MS 1000
+
+//! période d'export des métriques au format CSV, en millisecondes.
+#define PERIODE_EXPORT_METRIQUES_MS 10000
+
+//! délai laissé au programme client pour se terminer à la fermeture du simulateur,
+//! en millisecondes. Au-delà, son thread est interrompu.
+#define DELAI_ARRET_PROGRAMME_MS 2000
+
 //! permet d'ajuster la vitesse des locos. Ne pas changer.
 #define FACTEUR_VITESSE 0.05
 
@@ -87,6 +136,12 @@
 #define ETEINT 0
 #define ALLUME 1
 
+//! Niveaux des alertes de collision
+#define ALERTE_AUCUNE 0
+#define ALERTE_INFORMATION 1
+#define ALERTE_ATTENTION 2
+#define ALERTE_DANGER 3
+
 
 #define DATADIR QCoreApplication::applicationDirPath()+"/data"
 
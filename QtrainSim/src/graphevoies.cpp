@@ -0,0 +1,100 @@
+#include "graphevoies.h"
+
+GrapheVoies::GrapheVoies(const QMap<int, Voie*> &voies)
+{
+    this->voies.reserve(voies.size());
+    foreach(Voie* v, voies)
+    {
+        indices.insert(v, this->voies.size());
+        this->voies.append(v);
+    }
+
+    noeuds.resize(this->voies.size());
+    for(int i = 0; i < this->voies.size(); i++)
+    {
+        Voie* v = this->voies.at(i);
+        Noeud &n = noeuds[i];
+        n.nbLiaisons = qMin(v->getNbreLiaisons(), int(MAX_LIAISONS));
+        n.contact = v->getContact() != nullptr;
+        for(int l = 0; l < n.nbLiaisons; l++)
+        {
+            Voie* voisin = v->getVoieVoisineDOrdre(l);
+            n.voisins[l] = indice(voisin);
+            n.arrivees[l] = voisin != nullptr ? voisin->getOrdreLiaison(v) : 0;
+            // les sorties vers des extrémités non liées sont ignorées.
+            n.sorties[l] = v->sortiesExploration(l) & ((1 << n.nbLiaisons) - 1);
+        }
+    }
+}
+
+int GrapheVoies::indice(Voie *v) const
+{
+    return indices.value(v, -1);
+}
+
+Voie* GrapheVoies::voie(int indice) const
+{
+    return voies.at(indice);
+}
+
+void GrapheVoies::explorerDepuis(int depart, QVector<int> &chemins, QVector<int> &fins)
+{
+    const Noeud &n = noeuds.at(depart);
+
+    for(int l = 0; l < n.nbLiaisons; l++)
+    {
+        if(n.voisins[l] < 0)
+            continue;
+
+        chemin.clear();
+        pile.clear();
+        chemin.append(depart);
+        visiter(n.voisins[l], n.arrivees[l], chemins, fins);
+
+        while(!pile.isEmpty())
+        {
+            Cadre &cadre = pile.last();
+            if(cadre.sorties == 0)
+            {
+                pile.removeLast();
+                chemin.removeLast();
+                continue;
+            }
+
+            // sortie de plus petit ordre, comme l'exploration récursive.
+            int sortie = 0;
+            while(!(cadre.sorties & (1 << sortie)))
+                sortie++;
+            cadre.sorties &= ~(1 << sortie);
+
+            const Noeud &courant = noeuds.at(cadre.noeud);
+            if(courant.voisins[sortie] >= 0)
+                visiter(courant.voisins[sortie], courant.arrivees[sortie], chemins, fins);
+        }
+    }
+}
+
+void GrapheVoies::visiter(int noeud, int arrivee, QVector<int> &chemins, QVector<int> &fins)
+{
+    const Noeud &n = noeuds.at(noeud);
+    chemin.append(noeud);
+
+    // une boucle sans contact ne termine jamais le chemin : on l'abandonne.
+    if(chemin.size() > noeuds.size())
+    {
+        qDebug() << "Exploration des segments : boucle sans contact depuis la voie"
+                 << voies.at(chemin.first())->getIdVoie();
+        chemin.removeLast();
+        return;
+    }
+
+    const int sorties = arrivee < n.nbLiaisons ? n.sorties[arrivee] : 0;
+    if(n.contact || sorties == 0)
+    {
+        chemins += chemin;
+        fins.append(chemins.size());
+        chemin.removeLast();
+    }
+    else
+        pile.append({noeud, sorties});
+}
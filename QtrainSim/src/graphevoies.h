@@ -0,0 +1,80 @@
+#ifndef GRAPHEVOIES_H
+#define GRAPHEVOIES_H
+
+#include <QHash>
+#include <QMap>
+#include <QVector>
+
+#include "voie.h"
+
+/** Représentation compacte des liaisons entre les voies d'une maquette, pour les
+  * parcourir sans passer par les objets voies. Les voies sont désignées par
+  * leur indice dans le graphe.
+  */
+class GrapheVoies
+{
+public:
+    /** Construit le graphe d'une maquette dont toutes les voies sont liées.
+      * \param voies les voies de la maquette, par identifiant.
+      */
+    explicit GrapheVoies(const QMap<int, Voie*> &voies);
+
+    /** retourne l'indice d'une voie dans le graphe.
+      * \param v la voie.
+      * \return l'indice de la voie, -1 si elle n'est pas dans le graphe.
+      */
+    int indice(Voie* v) const;
+
+    /** retourne la voie d'indice donné.
+      * \param indice l'indice de la voie.
+      * \return la voie.
+      */
+    Voie* voie(int indice) const;
+
+    /** Explore en profondeur, sans récursion, les chemins partant d'une voie et
+      * finissant sur la prochaine voie portant un contact ou sur un buttoir, dans
+      * l'ordre des liaisons. Les tampons de l'exploration sont réutilisés d'un appel
+      * à l'autre.
+      * \param depart l'indice de la voie de départ.
+      * \param chemins reçoit les indices des voies des chemins, mis bout à bout. Chaque
+      *        chemin commence par la voie de départ.
+      * \param fins reçoit l'indice dans chemins de la fin de chaque chemin.
+      */
+    void explorerDepuis(int depart, QVector<int> &chemins, QVector<int> &fins);
+
+private:
+    //! nombre maximal de liaisons d'une voie (croisements, traversées-jonctions...).
+    static const int MAX_LIAISONS = 4;
+
+    struct Noeud
+    {
+        //! indice de la voie liée à chaque extrémité.
+        int voisins[MAX_LIAISONS];
+        //! ordre de l'extrémité de la voie liée par laquelle on arrive sur elle.
+        int arrivees[MAX_LIAISONS];
+        //! extrémités de sortie selon l'extrémité d'arrivée, voir Voie::sortiesExploration().
+        int sorties[MAX_LIAISONS];
+        int nbLiaisons;
+        bool contact;
+    };
+
+    //! voie en cours d'exploration et extrémités qu'il reste à explorer.
+    struct Cadre
+    {
+        int noeud;
+        int sorties;
+    };
+
+    /** ajoute une voie au chemin en cours, puis termine le chemin ou empile la voie.
+      */
+    void visiter(int noeud, int arrivee, QVector<int> &chemins, QVector<int> &fins);
+
+    QVector<Voie*> voies;
+    QVector<Noeud> noeuds;
+    QHash<Voie*, int> indices;
+
+    QVector<int> chemin;
+    QVector<Cadre> pile;
+};
+
+#endif // GRAPHEVOIES_H
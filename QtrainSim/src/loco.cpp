@@ -5,6 +5,9 @@ panneauNumLoco::panneauNumLoco(int numLoco, QObject *parent) :
     QObject(parent)
 {
     this->numLoco = numLoco;
+    this->fonte = QFont("Verdana", 22, 99);
+    this->texte.setText(QString::number(numLoco));
+    this->texte.prepare(QTransform(), fonte);
 }
 
 QRectF panneauNumLoco::boundingRect() const
@@ -21,12 +24,10 @@ void panneauNumLoco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
 
     painter->setPen(Qt::black);
 
-    QString t;
-    t.setNum(numLoco);
+    painter->setFont(fonte);
 
-    painter->setFont(QFont("Verdana", 22, 99));
-
-    painter->drawText(QRectF(-LARGEUR_LOCO * 0.45, - LARGEUR_LOCO * 0.45, LARGEUR_LOCO * 0.9, LARGEUR_LOCO * 0.9), t, QTextOption(Qt::AlignHCenter | Qt::AlignVCenter));
+    QSizeF taille = texte.size();
+    painter->drawStaticText(QPointF(- taille.width() / 2.0, - taille.height() / 2.0), texte);
 }
 
 int panneauNumLoco::getNumLoco()
@@ -46,48 +47,72 @@ Loco::Loco(int numLoco, QObject *parent) :
     this->numLoco2->setVisible(true);
     this->numLoco2->setPos(- LONGUEUR_LOCO * 0.3, 0.0);
     this->numLoco2->setRotation(this->numLoco2->rotation() + 180.0);
-    this->vitesse = 0;
-    this->vitesseFuture = 0;
-    this->active = true;
-    this->direction = DIRECTION_LOCO_GAUCHE;
-    this->angleCumule = 0.0;
-    this->alerteProximite = false;
-    this->inverser = false;
-    this->deraille = false;
-    this->timer = new QTimer(this);
-    this->mutex = new QMutex();
-    this->VarCond = new QWaitCondition();
+    this->numero = numLoco;
+    this->store = LocoStore::getInstance();
+    this->controller = nullptr;
+    this->store->ajouterLoco(numLoco);
     setZValue(ZVAL_LOCO);
-
-    CONNECT(timer, SIGNAL(timeout()), this, SLOT(adapterVitesse()));
 }
 
 void Loco::setVitesse(int v)
 {
     if(TrainSimSettings::getInstance()->getInertie())
     {
-        this->vitesseFuture = v;
-        this->timer->start(INERTIE_LOCO);
+        store->vitesseFuture[numero] = v;
+        store->inertieEnCours[numero] = true;
+        store->tempsInertie[numero] = 0.0;
     }
     else
     {
-        this->vitesse = this->vitesseFuture = v;
+        store->vitesse[numero] = store->vitesseFuture[numero] = v;
+    }
+}
+
+void Loco::limiterVitesse(int v)
+{
+    if(TrainSimSettings::getInstance()->getInertie())
+    {
+        if(!store->inertieEnCours[numero])
+            store->tempsInertie[numero] = 0.0;
+        store->vitesseFuture[numero] = v;
+        store->inertieEnCours[numero] = true;
     }
+    else
+    {
+        store->vitesse[numero] = store->vitesseFuture[numero] = v;
+    }
+}
+
+void Loco::setConsigne(int v)
+{
+    store->consigne[numero] = v;
+    setVitesse(v);
+}
+
+int Loco::getConsigne()
+{
+    return store->consigne[numero];
 }
 
 int Loco::getVitesse()
 {
-    return this->vitesse;
+    return store->vitesse[numero];
+}
+
+void Loco::arreterImmediatement()
+{
+    store->vitesse[numero] = store->vitesseFuture[numero] = store->consigne[numero] = 0;
+    store->inertieEnCours[numero] = false;
 }
 
 void Loco::setDirection(int d)
 {
-    this->direction = d;
+    store->direction[numero] = d;
 }
 
 int Loco::getDirection()
 {
-    return this->direction;
+    return store->direction[numero];
 }
 
 void Loco::setCouleur(int r, int g, int b)
@@ -110,7 +135,6 @@ QRectF Loco::boundingRect() const
 
 void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
-
     painter->setBrush(couleur);
 
     painter->drawRect(QRectF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0, LONGUEUR_LOCO, LARGEUR_LOCO));
@@ -119,7 +143,7 @@ void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/,
     painter->setBrush(Qt::yellow);
     painter->setOpacity(0.65);
 
-    if(direction == DIRECTION_LOCO_DROITE)
+    if(store->direction[numero] == DIRECTION_LOCO_DROITE)
     {
         painter->drawPie(QRectF(- LONGUEUR_LOCO / 2.0 - LONGUEUR_FEUX,
                                 - 3.0 * LARGEUR_LOCO / 4.0,
@@ -150,7 +174,7 @@ void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/,
                          20 *16);
     }
 
-    if(alerteProximite)
+    if(store->alerteProximite[numero])
     {
         painter->setPen(Qt::red);
         painter->setBrush(QBrush());
@@ -163,32 +187,58 @@ void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/,
 
 void Loco::setVoie(Voie *v)
 {
-    this->voieActuelle = v;
+    store->voieActuelle[numero] = v;
 }
 
 Voie* Loco::getVoie()
 {
-    return this->voieActuelle;
+    return store->voieActuelle[numero];
 }
 
 void Loco::setVoieSuivante(Voie *v)
 {
-    this->voieSuivante = v;
+    store->voieSuivante[numero] = v;
 }
 
 Voie* Loco::getVoieSuivante()
 {
-    return this->voieSuivante;
+    return store->voieSuivante[numero];
 }
 
 void Loco::setActive(bool active)
 {
-    this->active = active;
+    store->active[numero] = active;
 }
 
 bool Loco::getActive()
 {
-    return active;
+    return store->active[numero];
+}
+
+void Loco::setPosition(QPointF p)
+{
+    store->x[numero] = p.x();
+    store->y[numero] = p.y();
+}
+
+QPointF Loco::getPosition()
+{
+    return store->getPosition(numero);
+}
+
+void Loco::setOrientation(qreal o)
+{
+    store->orientation[numero] = o;
+}
+
+qreal Loco::getOrientation()
+{
+    return store->orientation[numero];
+}
+
+int Loco::getNumero()
+{
+    return numero;
 }
 
 #include <iostream>
@@ -207,6 +257,9 @@ void CHECK(bool /*condition*/) {}
 
 void Loco::avanceDUneVoie()
 {
+    Voie* &voieActuelle = store->voieActuelle[numero];
+    Voie* &voieSuivante = store->voieSuivante[numero];
+
     CHECK(voieActuelle != nullptr);
     Voie* viensDe = voieActuelle;
 
@@ -216,9 +269,9 @@ void Loco::avanceDUneVoie()
     voieSuivante = voieActuelle->getVoieSuivante(viensDe);
     CHECK(voieSuivante != nullptr);
 
-    setPos(voieActuelle->getPosAbsLiaison(viensDe));
+    setPosition(voieActuelle->getPosAbsLiaison(viensDe));
 
-    corrigerAngle(voieActuelle->getNouvelAngle(viensDe));
+    corrigerAngle(voieActuelle->getNouvelAngle(viensDe), voieActuelle->getNouvelleDirection(viensDe));
 
     if(voieActuelle->getContact() != nullptr)
     {
@@ -241,8 +294,8 @@ void Loco::avanceDUneVoie()
 
         nouveauSegment(ctc1, ctc2, this);
 
-        voieActuelle->getContact()->active(); //pas ideal... A revoir.
-        if (TrainSimSettings::getInstance()->getViewLocoLog())
+        voieActuelle->getContact()->active(numero); //pas ideal... A revoir.
+        if (TrainSimSettings::getInstance()->getViewLocoLog() && this->controller != nullptr)
         {
             this->controller->console->append(QString("# Passe le contact numéro %1").arg(voieActuelle->getContact()->getNumContact()));
             std::cout << "Loco " << this->numLoco1->getNumLoco() << " : Passe le contact " << voieActuelle->getContact()->getNumContact() << std::endl;
@@ -255,10 +308,11 @@ void Loco::avancer(qreal distance)
     qreal dist = distance;
     qreal angle = 0.0;
     qreal rayon = 0.0;
+    qreal &angleCumule = store->angleCumule[numero];
 
     while(true)
     {
-        this->voieActuelle->avanceLoco(dist, angle, rayon, this->angleCumule, this->pos(), this->voieSuivante);
+        store->voieActuelle[numero]->avanceLoco(dist, angle, rayon, angleCumule, getPosition(), store->voieSuivante[numero]);
 
         if(rayon == 0.0)
         {
@@ -284,88 +338,113 @@ void Loco::avancer(qreal distance)
 
 void Loco::avancerDroit(qreal distance)
 {
-    qreal x =  distance * cos(angleCumule * (PI / 180.0));
-    qreal y = -distance * sin(angleCumule * (PI / 180.0));
+    qreal x =  distance * store->cosCap[numero];
+    qreal y = -distance * store->sinCap[numero];
     CHECK(!isnan(x));
     CHECK(!isnan(y));
-    voieActuelle->correctionPositionLoco(x, y);
+    store->voieActuelle[numero]->correctionPositionLoco(x, y);
     CHECK(!isnan(x));
     CHECK(!isnan(y));
-    moveBy(x,y);
+    store->x[numero] += x;
+    store->y[numero] += y;
 
 }
 
 void Loco::avancerCourbe(qreal angle, qreal rayon)
 {
-    qreal angleAbs = angle < 0.0 ? -angle : angle;
-    qreal dist = rayon * tan(angleAbs * PI / 360.0);
-    avancerDroit(dist);
-    setRotation(rotation() + angle);
-    avancerDroit(dist);
+    // L'incrément ne change qu'en entrée et en sortie de courbe ou avec la vitesse.
+    if(angle != store->angleCourbe[numero])
+    {
+        store->angleCourbe[numero] = angle;
+        store->cosDemiAngleCourbe[numero] = cos(angle * PI / 360.0);
+        store->sinDemiAngleCourbe[numero] = sin(angle * PI / 360.0);
+    }
+
+    // angle est une rotation dans le sens horaire : le cap tourne de -angle.
+    qreal c = store->cosCap[numero];
+    qreal s = store->sinCap[numero];
+    qreal ch = store->cosDemiAngleCourbe[numero];
+    qreal sh = - store->sinDemiAngleCourbe[numero];
+
+    // La loco parcourt la corde de l'arc, orientée selon le cap tourné de la moitié de l'angle.
+    qreal corde = 2.0 * rayon * (sh < 0.0 ? -sh : sh);
+    store->x[numero] += corde * (c * ch - s * sh);
+    store->y[numero] -= corde * (s * ch + c * sh);
+
+    qreal cosAngle = ch * ch - sh * sh;
+    qreal sinAngle = 2.0 * sh * ch;
+    store->cosCap[numero] = c * cosAngle - s * sinAngle;
+    store->sinCap[numero] = s * cosAngle + c * sinAngle;
+
+    store->orientation[numero] += angle;
 }
 
 void Loco::setAngleCumule(qreal a)
 {
-    this->angleCumule = a;
+    store->angleCumule[numero] = a;
+    store->cosCap[numero] = cos(a * (PI / 180.0));
+    store->sinCap[numero] = sin(a * (PI / 180.0));
 }
 
 qreal Loco::getAngleCumule()
 {
-    return this->angleCumule;
+    return store->angleCumule[numero];
 }
 
 void Loco::setSegmentActuel(Segment *s)
 {
-    this->segmentActuel = s;
+    store->segmentActuel[numero] = s;
 }
 
 void Loco::setAlerteProximite(bool b)
 {
-    this->alerteProximite = b;
+    store->alerteProximite[numero] = b;
 }
 
 bool Loco::getAlerteProximite()
 {
-    return this->alerteProximite;
+    return store->alerteProximite[numero];
 }
 
 QPolygonF Loco::getContour()
 {
-    return mapToScene(QRectF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0, LONGUEUR_LOCO, LARGEUR_LOCO));
+    return store->getContour(numero);
 }
 
 void Loco::inverserSens()
 {
     if(TrainSimSettings::getInstance()->getInertie())
     {
-        inverser = true;
-        this->timer->start(INERTIE_LOCO);
+        store->inverser[numero] = true;
+        store->inertieEnCours[numero] = true;
+        store->tempsInertie[numero] = 0.0;
     }
     else
     {
-        this->setRotation(this->rotation() + 180.0);
-        Voie* viensDe = voieSuivante;
-        voieSuivante = voieActuelle->getVoieSuivante(viensDe);
-        CHECK(voieSuivante != nullptr);
-        this->angleCumule -= 180.0;
+        store->orientation[numero] += 180.0;
+        Voie* viensDe = store->voieSuivante[numero];
+        store->voieSuivante[numero] = store->voieActuelle[numero]->getVoieSuivante(viensDe);
+        CHECK(store->voieSuivante[numero] != nullptr);
+        store->angleCumule[numero] -= 180.0;
+        store->cosCap[numero] = - store->cosCap[numero];
+        store->sinCap[numero] = - store->sinCap[numero];
     }
 }
 
-void Loco::corrigerAngle(qreal nouvelAngle)
+void Loco::corrigerAngle(qreal nouvelAngle, QPointF direction)
 {
-    QPointF avantLoco = mapToScene(LONGUEUR_LOCO / 2.0, 0.0);
-    qreal angleReel = atan2(- avantLoco.y() + pos().y(), avantLoco.x() - pos().x()) * 180.0 / PI;
-
-    setRotation(rotation() + angleReel);
-
-    setRotation( rotation() - nouvelAngle);
+    // L'orientation (sens horaire) est l'opposée de la direction de déplacement
+    // (sens trigonométrique) : on l'impose directement, sans passer par la scène.
+    store->orientation[numero] = - nouvelAngle;
 
-    this->angleCumule = nouvelAngle;
+    store->angleCumule[numero] = nouvelAngle;
+    store->cosCap[numero] = direction.x();
+    store->sinCap[numero] = direction.y();
 }
 
 void Loco::locoSurSegment(Segment *s)
 {
-    if(s == segmentActuel)
+    if(s == store->segmentActuel[numero])
     {
         //Alerte collision!!!
         //l'alerte proximité a été implémentée de manière differente...
@@ -374,38 +453,71 @@ void Loco::locoSurSegment(Segment *s)
 
 void Loco::voieVariableModifiee(Voie *v)
 {
-    if(v == voieActuelle)
+    if(v == store->voieActuelle[numero])
     {
-        deraille = true;
-        vitesse = vitesseFuture = 0;
-        setRotation(rotation()+20.0);
+        bool dejaDeraillee = store->deraille[numero];
+        store->deraille[numero] = true;
+        store->vitesse[numero] = store->vitesseFuture[numero] = 0;
+        store->orientation[numero] += 20.0;
+        if(!dejaDeraillee)
+            deraillement(this);
     }
 }
 
 void Loco::adapterVitesse()
 {
-    if(inverser)
+    int &vitesse = store->vitesse[numero];
+
+    if(store->inverser[numero])
     {
         if (vitesse!=0)
             vitesse--;
         if(vitesse ==0)
         {
-            this->setRotation(rotation()+180.0);
-            Voie* viensDe = voieSuivante;
+            store->orientation[numero] += 180.0;
+            Voie* viensDe = store->voieSuivante[numero];
             CHECK(viensDe != nullptr);
-            voieSuivante = voieActuelle->getVoieSuivante(viensDe);
-            CHECK(voieSuivante != nullptr);
-            this->angleCumule -= 180.0;
-            inverser = false;
+            store->voieSuivante[numero] = store->voieActuelle[numero]->getVoieSuivante(viensDe);
+            CHECK(store->voieSuivante[numero] != nullptr);
+            store->angleCumule[numero] -= 180.0;
+            store->cosCap[numero] = - store->cosCap[numero];
+            store->sinCap[numero] = - store->sinCap[numero];
+            store->inverser[numero] = false;
         }
     }
     else
     {
-        if(vitesse - vitesseFuture < 0)
+        if(vitesse - store->vitesseFuture[numero] < 0)
             vitesse++;
-        else if(vitesse - vitesseFuture > 0)
+        else if(vitesse - store->vitesseFuture[numero] > 0)
             vitesse--;
         else
-            timer->stop();
+            store->inertieEnCours[numero] = false;
+    }
+}
+
+void Loco::avancerTemps(qreal ms)
+{
+    if(!store->inertieEnCours[numero])
+        return;
+
+    store->tempsInertie[numero] += ms;
+
+    while(store->inertieEnCours[numero] && store->tempsInertie[numero] >= INERTIE_LOCO)
+    {
+        store->tempsInertie[numero] -= INERTIE_LOCO;
+        adapterVitesse();
     }
 }
+
+void Loco::setPoseAffichee(QPointF position, qreal angle)
+{
+    setPos(position);
+    setRotation(angle);
+}
+
+void Loco::afficherPoseSimulation()
+{
+    setPos(getPosition());
+    setRotation(getOrientation());
+}
@@ -5,12 +5,12 @@
 #include <QAbstractGraphicsShapeItem>
 #include <QStaticText>
 #include <QPainter>
-#include <QTimer>
 
 #include "general.h"
 #include "voie.h"
 #include "segment.h"
 #include "connect.h"
+#include "locostore.h"
 
 class panneauNumLoco : public QObject, public QAbstractGraphicsShapeItem
 {
@@ -37,6 +37,8 @@ public:
     int getNumLoco();
 private:
     int numLoco;
+    QFont fonte;
+    QStaticText texte;
 };
 
 class LocoCtrl;
@@ -59,11 +61,32 @@ public:
       */
     void setVitesse(int v);
 
+    /** Change la vitesse visée, comme setVitesse, mais sans relancer le délai
+      * d'inertie en cours : appelée à chaque pas, elle ne retarde pas le freinage.
+      * \param v la nouvelle vitesse visée.
+      */
+    void limiterVitesse(int v);
+
+    /** Change la vitesse commandée par le programme. Elle est appliquée par setVitesse,
+      * sauf si le bloc mobile la limite.
+      * \param v la nouvelle vitesse commandée.
+      */
+    void setConsigne(int v);
+
+    /** retourne la dernière vitesse commandée par le programme.
+      * \return la vitesse commandée.
+      */
+    int getConsigne();
+
     /** Retourne la vitesse actuelle de la loco.
       * \return la vitesse actuelle de la loco.
       */
     int getVitesse();
 
+    /** Arrête la loco sur place, sans tenir compte de l'inertie.
+      */
+    void arreterImmediatement();
+
     /** permet de changer la direction de la loco.
       * N'est pas utilisé : pour changer de sens, on effectue une rotation de 180°.
       * \param d la nouvelle direction (DIRECTION_LOCO_GAUCHE ou DIRECTION_LOCO_DROITE)
@@ -187,8 +210,51 @@ public:
 
     /** Permet de corriger l'angle de la loco suite à des imprécisions de calcul.
       * \param nouvelAngle le nouvel angle.
+      * \param direction (cos, sin) du nouvel angle, précalculé par la voie.
+      */
+    void corrigerAngle(qreal nouvelAngle, QPointF direction);
+
+    /** Fait progresser l'inertie de la loco d'une durée de simulation.
+      * Tous les INERTIE_LOCO millisecondes de simulation, la vitesse est adaptée d'un cran.
+      * \param ms la durée écoulée, en millisecondes de simulation.
+      */
+    void avancerTemps(qreal ms);
+
+    /** permet de placer la loco dans la scène (pose de simulation).
+      * \param p la nouvelle position du centre de la loco, en coordonnées de la scène.
+      */
+    void setPosition(QPointF p);
+
+    /** retourne la position de simulation de la loco.
+      * \return la position du centre de la loco, en coordonnées de la scène.
+      */
+    QPointF getPosition();
+
+    /** permet de changer l'orientation de simulation de la loco.
+      * \param o la nouvelle orientation, en degrés (sens horaire).
+      */
+    void setOrientation(qreal o);
+
+    /** retourne l'orientation de simulation de la loco.
+      * \return l'orientation de la loco, en degrés (sens horaire).
+      */
+    qreal getOrientation();
+
+    /** retourne le numéro de la loco, qui est aussi son indice dans le LocoStore.
+      * \return le numéro de la loco.
+      */
+    int getNumero();
+
+    /** Indique la pose à laquelle la loco doit être dessinée. Elle peut différer de la
+      * pose de simulation, l'affichage interpolant entre les deux derniers instantanés.
+      * \param position la position à afficher, en coordonnées de la scène.
+      * \param angle la rotation à afficher, en degrés.
+      */
+    void setPoseAffichee(QPointF position, qreal angle);
+
+    /** Affiche la loco à sa pose de simulation.
       */
-    void corrigerAngle(qreal nouvelAngle);
+    void afficherPoseSimulation();
 
     LocoCtrl *controller;
 signals:
@@ -216,27 +282,16 @@ public slots:
       */
     void voieVariableModifiee(Voie* v);
 
-    /** Reçoit le signal qu'il faut adapter la vitesse d'un incrément / décrément.
+    /** Adapte la vitesse d'un incrément / décrément.
       */
     void adapterVitesse();
 private:
     panneauNumLoco* numLoco1{nullptr};
     panneauNumLoco* numLoco2{nullptr};
-    qreal angleCumule;
-    bool active;
-    int vitesse;
-    int vitesseFuture;
-    int direction;
     QColor couleur;
-    Voie* voieActuelle{nullptr};
-    Voie* voieSuivante{nullptr};
-    Segment* segmentActuel{nullptr};
-    bool alerteProximite;
-    bool inverser;
-    bool deraille;
-    QTimer* timer{nullptr};
-    QWaitCondition* VarCond{nullptr};
-    QMutex* mutex{nullptr};
+    //! numéro de la loco, indice de son état dans le LocoStore.
+    int numero;
+    LocoStore* store{nullptr};
 };
 
 #endif // LOCO_H
@@ -0,0 +1,87 @@
+#include <cmath>
+
+#include <QDebug>
+
+#include "locostore.h"
+
+LocoStore* LocoStore::getInstance()
+{
+    static LocoStore instance;
+    return &instance;
+}
+
+LocoStore::LocoStore()
+{
+    for(int i = 0; i <= MAX_LOCOS; i++)
+        presente[i] = false;
+}
+
+bool LocoStore::numeroValide(int numLoco)
+{
+    return numLoco >= 0 && numLoco <= MAX_LOCOS;
+}
+
+void LocoStore::ajouterLoco(int numLoco)
+{
+    if(!numeroValide(numLoco))
+    {
+        qDebug() << "Numéro de loco non valide :" << numLoco;
+        return;
+    }
+
+    x[numLoco] = 0.0;
+    y[numLoco] = 0.0;
+    orientation[numLoco] = 0.0;
+    angleCumule[numLoco] = 0.0;
+    cosCap[numLoco] = 1.0;
+    sinCap[numLoco] = 0.0;
+    angleCourbe[numLoco] = 0.0;
+    cosDemiAngleCourbe[numLoco] = 1.0;
+    sinDemiAngleCourbe[numLoco] = 0.0;
+    tempsInertie[numLoco] = 0.0;
+    facteurVitesse[numLoco] = 1.0;
+    vitesse[numLoco] = 0;
+    vitesseFuture[numLoco] = 0;
+    consigne[numLoco] = 0;
+    direction[numLoco] = DIRECTION_LOCO_GAUCHE;
+    voieActuelle[numLoco] = nullptr;
+    voieSuivante[numLoco] = nullptr;
+    segmentActuel[numLoco] = nullptr;
+    active[numLoco] = true;
+    alerteProximite[numLoco] = false;
+    inverser[numLoco] = false;
+    deraille[numLoco] = false;
+    inertieEnCours[numLoco] = false;
+    blocMobile[numLoco] = false;
+    presente[numLoco] = true;
+}
+
+bool LocoStore::contient(int numLoco) const
+{
+    return numLoco >= 0 && numLoco <= MAX_LOCOS && presente[numLoco];
+}
+
+QPointF LocoStore::getPosition(int numLoco) const
+{
+    return QPointF(x[numLoco], y[numLoco]);
+}
+
+QPolygonF LocoStore::getContour(int numLoco) const
+{
+    qreal a = orientation[numLoco] * (PI / 180.0);
+    qreal c = cos(a);
+    qreal s = sin(a);
+
+    // demi-longueur et demi-largeur, tournées selon l'orientation de la loco.
+    qreal lx = c * LONGUEUR_LOCO / 2.0;
+    qreal ly = s * LONGUEUR_LOCO / 2.0;
+    qreal wx = -s * LARGEUR_LOCO / 2.0;
+    qreal wy = c * LARGEUR_LOCO / 2.0;
+
+    QPolygonF contour(4);
+    contour[0] = QPointF(x[numLoco] - lx - wx, y[numLoco] - ly - wy);
+    contour[1] = QPointF(x[numLoco] + lx - wx, y[numLoco] + ly - wy);
+    contour[2] = QPointF(x[numLoco] + lx + wx, y[numLoco] + ly + wy);
+    contour[3] = QPointF(x[numLoco] - lx + wx, y[numLoco] - ly + wy);
+    return contour;
+}
@@ -0,0 +1,95 @@
+#ifndef LOCOSTORE_H
+#define LOCOSTORE_H
+
+#include <QPointF>
+#include <QPolygonF>
+
+#include "general.h"
+
+class Voie;
+class Segment;
+
+/** Etat de simulation de toutes les locos, rangé par attribut (structure de tableaux)
+  * et indexé par numéro de loco. Les boucles sur toutes les locos parcourent ainsi des
+  * tableaux contigus ; la classe Loco n'est plus qu'une vue servant à l'affichage.
+  * Les tableaux ne sont modifiés que par le thread de l'interface ; pendant un pas de
+  * simulation, ils peuvent être lus par plusieurs threads.
+  */
+class LocoStore
+{
+public:
+
+    static LocoStore *getInstance();
+
+    /** indique si un numéro de loco a un emplacement dans les tableaux.
+      * \param numLoco le numéro de la loco.
+      * \return vrai si le numéro est entre 0 et MAX_LOCOS.
+      */
+    static bool numeroValide(int numLoco);
+
+    /** Réserve et initialise l'emplacement d'une loco. Un numéro non valide est ignoré.
+      * \param numLoco le numéro de la loco, entre 0 et MAX_LOCOS.
+      */
+    void ajouterLoco(int numLoco);
+
+    /** indique si une loco de ce numéro existe.
+      * \param numLoco le numéro de la loco.
+      * \return vrai si l'emplacement de la loco est utilisé.
+      */
+    bool contient(int numLoco) const;
+
+    /** retourne la position de la loco, en coordonnées de la scène.
+      * \param numLoco le numéro de la loco.
+      * \return la position du centre de la loco.
+      */
+    QPointF getPosition(int numLoco) const;
+
+    /** retourne le contour de la loco en coordonnées de la scène.
+      * \param numLoco le numéro de la loco.
+      * \return les quatre coins de la loco.
+      */
+    QPolygonF getContour(int numLoco) const;
+
+    //! position du centre de la loco, en coordonnées de la scène.
+    qreal x[MAX_LOCOS + 1];
+    qreal y[MAX_LOCOS + 1];
+    //! rotation de la loco dans la scène, en degrés (sens horaire).
+    qreal orientation[MAX_LOCOS + 1];
+    //! angle de la direction de déplacement, en degrés (sens trigonométrique).
+    qreal angleCumule[MAX_LOCOS + 1];
+    //! cos et sin de angleCumule, tenus à jour pour éviter la trigonométrie à chaque pas.
+    qreal cosCap[MAX_LOCOS + 1];
+    qreal sinCap[MAX_LOCOS + 1];
+    //! dernier incrément d'angle en courbe (en degrés) et cos / sin de sa moitié.
+    //! A vitesse constante, l'incrément est le même d'un pas à l'autre.
+    qreal angleCourbe[MAX_LOCOS + 1];
+    qreal cosDemiAngleCourbe[MAX_LOCOS + 1];
+    qreal sinDemiAngleCourbe[MAX_LOCOS + 1];
+    qreal tempsInertie[MAX_LOCOS + 1];
+    //! facteur appliqué à la distance parcourue, 1.0 pour une loco nominale.
+    qreal facteurVitesse[MAX_LOCOS + 1];
+
+    int vitesse[MAX_LOCOS + 1];
+    int vitesseFuture[MAX_LOCOS + 1];
+    //! dernière vitesse commandée par le programme, que le bloc mobile peut limiter.
+    int consigne[MAX_LOCOS + 1];
+    int direction[MAX_LOCOS + 1];
+
+    Voie* voieActuelle[MAX_LOCOS + 1];
+    Voie* voieSuivante[MAX_LOCOS + 1];
+    Segment* segmentActuel[MAX_LOCOS + 1];
+
+    bool presente[MAX_LOCOS + 1];
+    bool active[MAX_LOCOS + 1];
+    bool alerteProximite[MAX_LOCOS + 1];
+    bool inverser[MAX_LOCOS + 1];
+    bool deraille[MAX_LOCOS + 1];
+    bool inertieEnCours[MAX_LOCOS + 1];
+    //! la vitesse de la loco est limitée par la distance à la loco qui la précède.
+    bool blocMobile[MAX_LOCOS + 1];
+
+protected:
+    LocoStore();
+};
+
+#endif // LOCOSTORE_H
@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QSettings>
 #include <QDebug>
 
@@ -21,6 +22,16 @@ int main(int argc, char *argv[])
 
     QApplication app(argc,argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption optionMaquette("maquette",
+        "Maquette chargee au lancement, pendant que le programme client demarre.", "nom");
+    QCommandLineOption optionDemarrer("demarrer",
+        "Lance la simulation des que la maquette est chargee.");
+    parser.addOption(optionMaquette);
+    parser.addOption(optionDemarrer);
+    parser.process(app);
+
     //Init the marklin maquette
 #ifdef MAQUETTE
     init_maquette();
@@ -28,5 +39,8 @@ int main(int argc, char *argv[])
 
     //Init the simulator GUI
     CommandeTrain::getInstance()->init_maquette();
+    if (parser.isSet(optionMaquette))
+        CommandeTrain::getInstance()->precharger_maquette(parser.value(optionMaquette),
+                                                          parser.isSet(optionDemarrer));
     return app.exec();
 }
@@ -17,14 +17,6 @@
 #include "trainsimsettings.h"
 #include "maquettemanager.h"
 
-// Define a compatibility symbol due to "QString::SkipEmptyParts" being
-// deprecated in newer versions of Qt
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-#define SkipEmptyParts      Qt::SkipEmptyParts
-#else
-#define SkipEmptyParts      QString::SkipEmptyParts
-#endif
-
  void outcallback( const char* ptr, std::streamsize count, void* pTextBox )
  {
    (void) count;
@@ -60,77 +52,24 @@ MainWindow::MainWindow(QWidget *parent) :
     inputDock->setWidget(inputWidget);
     addDockWidget(Qt::TopDockWidgetArea, inputDock, Qt::Horizontal);
     CONNECT(inputWidget, SIGNAL(returnPressed()), this, SLOT(onReturnPressed()));
+
+    panneauMetriques = new PanneauMetriques(this);
+    dockMetriques = new QDockWidget("Métriques", this);
+    dockMetriques->setWidget(panneauMetriques);
+    addDockWidget(Qt::BottomDockWidgetArea, dockMetriques, Qt::Horizontal);
+    tabifyDockWidget(dockGeneralConsole, dockMetriques);
+    dockGeneralConsole->raise();
     CommandeTrain* ct = CommandeTrain::getInstance();
     CONNECT(this, SIGNAL(commandSent(QString)), ct, SLOT(commandSent(QString)))
 
     myRedirector = new StdRedirector<>( std::cout, outcallback, generalConsole );
 
-    //Lecture des informations des voies.
-    QFile fichierInfosVoies(DATADIR+"/infosVoies.txt");
-    if (!fichierInfosVoies.open(QIODevice::ReadOnly))
+    //Lecture du fichier optionnel de description de voies.
+    if (!chargeur.estValide())
     {
-        QMessageBox::critical(0,"Erreur",QString("Le fichier de description des voies ne peut être trouvé. Vérifiez qu'il est bien présent dans le répertoire parent de l'exécutable.\n Le nom du fichier est: %1.\nAvez-vous effectué un \"make install\"?").arg(fichierInfosVoies.fileName()));
+        QMessageBox::critical(0,"Erreur",QString("Le fichier de description de voies supplémentaires ne peut être lu. Corrigez-le ou supprimez-le.\n Le nom du fichier est: %1.").arg(chargeur.getFichierInfosVoies()));
         exit(0);
     }
-    QTextStream lecture(&fichierInfosVoies);
-
-    QString ligne;
-
-    QStringList ligneDecoupee;
-
-    QList<double>* description;
-
-    ligne = lecture.readLine();
-
-    while(!ligne.startsWith("EOF"))
-    {
-        ligneDecoupee = ligne.split(QRegExp("\\s+"), SkipEmptyParts);
-
-        description = new QList<double>();
-
-        /* En l'etat, le programme gere 6 types de voies differentes :
-         * - droite : caracterisees par leur longueur.
-         * - courbe : caracterisees par leur rayon de courbure, et l'angle parcouru.
-         * - aiguillage : caracterisees par leur rayon de courbure et l'angle parcouru (pour la partie courbe)
-         *                et par leur longueur (pour la partie droite).
-         * - croisement : caracterisees par leur longueur (pour les deux parties droites) et l'angle aigu entre les deux parties droites.
-         *                Les parties droites se croisent toujours en leur milieu.
-         * - traversee-jonction : caracterisees par leur longueur (pour les deux parties droites, le rayon de courbure des parties courbes,
-         *                        et l'angle parcouru.
-         * - buttoir : caracterisees par leur longueur (utile uniquement pour le dessin.
-         *
-         * Il est possible d'ajouter des types de voies. Referez-vous a la documentation.
-         */
-        if(ligneDecoupee.at(1) == "droite")
-            description->append(1.0);
-        else if(ligneDecoupee.at(1) == "courbe")
-            description->append(2.0);
-        else if(ligneDecoupee.at(1) == "aiguillage")
-            description->append(3.0);
-        else if(ligneDecoupee.at(1) == "croisement")
-            description->append(4.0);
-        else if(ligneDecoupee.at(1) == "traversee-jonction")
-            description->append(5.0);
-        else if(ligneDecoupee.at(1) == "buttoir")
-            description->append(6.0);
-        else if(ligneDecoupee.at(1) == "aiguillageEnroule")
-            description->append(7.0);
-        else if(ligneDecoupee.at(1) == "aiguillageTriple")
-            description->append(8.0);
-
-
-        for(int i =2; i < ligneDecoupee.length(); i++)
-        {
-            description->append(ligneDecoupee.at(i).toDouble());
-        }
-
-        //chargement des informations des voies dans la QMap idoine.
-        infosVoies.insert(ligneDecoupee.at(0).toInt(), description);
-
-        ligne = lecture.readLine();
-
-    }
-
 
     m_state=PAUSE;
 
@@ -142,6 +81,8 @@ MainWindow::MainWindow(QWidget *parent) :
     setGeometry(0,0,530,580);
 
     simView = new SimView(this);
+    CONNECT(simView, SIGNAL(arretUrgence(qint64)), this, SLOT(afficherArretUrgence(qint64)));
+    CONNECT(simView, SIGNAL(pauseLoco(int,bool)), this, SLOT(afficherPauseLoco(int,bool)));
 
     setCentralWidget(simView);
 
@@ -183,6 +124,7 @@ void MainWindow::readSettings()
     viewLocoLogAct->setChecked(TrainSimSettings::getInstance()->getViewLocoLog());
     TrainSimSettings::getInstance()->setInertie(settings.value("inertie",true).toBool());
     inertieAct->setChecked(TrainSimSettings::getInstance()->getInertie());
+    TrainSimSettings::getInstance()->setNbThreadsSimulation(settings.value("nbThreadsSimulation",0).toInt());
 
 }
 
@@ -194,6 +136,7 @@ void MainWindow::writeSettings() const
     settings.setValue("viewContactNb",TrainSimSettings::getInstance()->getViewContactNumber());
     settings.setValue("viewLocoLog",TrainSimSettings::getInstance()->getViewLocoLog());
     settings.setValue("inertie",TrainSimSettings::getInstance()->getInertie());
+    settings.setValue("nbThreadsSimulation",TrainSimSettings::getInstance()->getNbThreadsSimulation());
 }
 
 
@@ -273,6 +216,12 @@ void MainWindow::toggleSimulation()
     updateMenus();
 }
 
+void MainWindow::demarrerSimulation()
+{
+    if (m_state==PAUSE)
+        toggleSimulation();
+}
+
 #ifdef CDEVELOP
 extern "C" {
 void emergency_stop();
@@ -302,14 +251,12 @@ void MainWindow::setLocoState(LocoCtrl *loco,LocoCtrl::STATE state)
         {
         case LocoCtrl::PAUSE: {
             loco->state=LocoCtrl::PAUSE;
-            loco->ptrLoco->setActive(false);
             loco->toggle->setText(tr("Restart the loco %1").arg(loco->loco));
             loco->toggle->setStatusTip(tr("Restart the loco %1").arg(loco->loco));
             loco->toggle->setIcon(QIcon(QPixmap(":images/simulate_start.png")));
     } break;
         case LocoCtrl::RUNNING: {
             loco->state=LocoCtrl::RUNNING;
-            loco->ptrLoco->setActive(true);
             loco->toggle->setText(QString("Pause loco %1").arg(loco->loco));
             loco->toggle->setStatusTip(tr("Pause the loco"));
             loco->toggle->setIcon(QIcon(QPixmap(":images/simulate_break.png")));
@@ -322,15 +269,16 @@ void MainWindow::toggleLoco(QObject *locoCtrl)
     LocoCtrl *locoC=dynamic_cast<LocoCtrl*>(locoCtrl);
     statusBar()->showMessage("Toggle");
 
-    switch(locoC->state)
-        {
-        case LocoCtrl::RUNNING: {
-            setLocoState(locoC,LocoCtrl::PAUSE);
-        } break;
-        case LocoCtrl::PAUSE: {
-            setLocoState(locoC,LocoCtrl::RUNNING);
-        } break;
-    };
+    // L'affichage est mis à jour par afficherPauseLoco, que la pause vienne
+    // de l'interface ou du programme.
+    simView->setPauseLoco(locoC->loco, locoC->state == LocoCtrl::RUNNING);
+}
+
+void MainWindow::afficherPauseLoco(int numLoco, bool enPause)
+{
+    foreach(LocoCtrl *c, locoCtrls)
+        if (c->loco == numLoco)
+            setLocoState(c, enPause ? LocoCtrl::PAUSE : LocoCtrl::RUNNING);
 }
 
 #include <QMessageBox>
@@ -476,8 +424,25 @@ void MainWindow::createActions()
     viewLocoLogAct->setCheckable(true);
     CONNECT(viewLocoLogAct, SIGNAL(triggered()), this, SLOT(viewLocoLog()));
 
+    viewCarteOccupationAct = new QAction(tr("Segment occupancy heatmap"), this);
+    viewCarteOccupationAct->setStatusTip(tr("Colour the segments by occupancy over the last minute"));
+    viewCarteOccupationAct->setCheckable(true);
+    CONNECT(viewCarteOccupationAct, SIGNAL(triggered()), this, SLOT(viewCarteOccupation()));
+
+    viewCarteAttenteAct = new QAction(tr("Waiting time heatmap"), this);
+    viewCarteAttenteAct->setStatusTip(tr("Colour the segments by the time locos waited on them over the last minute"));
+    viewCarteAttenteAct->setCheckable(true);
+    CONNECT(viewCarteAttenteAct, SIGNAL(triggered()), this, SLOT(viewCarteAttente()));
+
     viewInputAct = inputDock->toggleViewAction();
 
+    viewMetriquesAct = dockMetriques->toggleViewAction();
+
+    exportMetriquesAct = new QAction(tr("Export metrics to CSV..."), this);
+    exportMetriquesAct->setStatusTip(tr("Periodically append the metrics to a CSV file"));
+    exportMetriquesAct->setCheckable(true);
+    CONNECT(exportMetriquesAct, SIGNAL(triggered(bool)), this, SLOT(exporterMetriques(bool)));
+
     inertieAct = new QAction(tr("Inertia"), this);
     inertieAct->setShortcut(tr("Ctrl+I"));
     inertieAct->setStatusTip(tr("Enable inertia"));
@@ -490,6 +455,7 @@ void MainWindow::createMenus()
     QMenu *fileMenu = menuBar()->addMenu(tr("&File"));
     //fileMenu->addAction(chargerMaquetteAct);
     fileMenu->addAction(printAct);
+    fileMenu->addAction(exportMetriquesAct);
     fileMenu->addAction(exitAct);
 
     actionMenu = menuBar()->addMenu(tr("&Actions"));
@@ -511,6 +477,10 @@ void MainWindow::createMenus()
     view->addAction(viewContactNumberAct);
     view->addAction(viewAiguillageNumberAct);
     view->addAction(viewInputAct);
+    view->addAction(viewMetriquesAct);
+    view->addSeparator();
+    view->addAction(viewCarteOccupationAct);
+    view->addAction(viewCarteAttenteAct);
 
     QMenu *settings=menuBar()->addMenu(tr("&Settings"));
     settings->addAction(inertieAct);
@@ -565,6 +535,20 @@ void MainWindow::viewLocoLog()
     TrainSimSettings::getInstance()->setViewLocoLog(viewLocoLogAct->isChecked());
 }
 
+void MainWindow::viewCarteOccupation()
+{
+    viewCarteAttenteAct->setChecked(false);
+    simView->setCarteOccupation(viewCarteOccupationAct->isChecked() ? SimView::CarteOccupation
+                                                                    : SimView::CarteMasquee);
+}
+
+void MainWindow::viewCarteAttente()
+{
+    viewCarteOccupationAct->setChecked(false);
+    simView->setCarteOccupation(viewCarteAttenteAct->isChecked() ? SimView::CarteAttente
+                                                                 : SimView::CarteMasquee);
+}
+
 void MainWindow::toggleInertie()
 {
     TrainSimSettings::getInstance()->setInertie(inertieAct->isChecked());
@@ -581,270 +565,32 @@ void MainWindow::on_actionCharger_Maquette_triggered()
     chargerMaquette(filename);
 }
 
-void MainWindow::chargerMaquette(QString filename)
+bool MainWindow::chargerMaquette(QString filename)
 {
-    this->simView->viderMaquette();
-
-    // stockage temporaire des voies, avec les identifiants des voies a lier.
-    QMap <Voie*, QList<int>*> voiesALier;
-    // stockage temporaire des voies, indexees par identifiants.
-    QMap <int, Voie*> IDVoies;
-
-    QStringList listeTemporaire;
-    QList<qreal>* infosVoieEnTraitement;
-    int IDvoie;
-    qreal directionVoieEnTraitement;
-
-    QFile fichier(filename);
-
-    if(!fichier.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        //declaration d'erreur.
-    }
-
-    QTextStream lecture(&fichier);
-    QString ligne;
-    bool premiereInfoValide;
-    int limite;
-
-    //avance rapide pour passer une eventuelle introduction.
-
-    ligne = lecture.readLine();
-
-    listeTemporaire = ligne.split(" ", SkipEmptyParts);
-
-    limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
-
-    while((listeTemporaire.length() != 1) && !premiereInfoValide)
+    if (!chargeur.charger(filename, this->simView))
     {
-        if(lecture.atEnd())
-            qDebug() << "Erreur de lecture de fichier : fichier non standard. (nombre de voies mal indique)";
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", SkipEmptyParts);
-
-        limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
-
+        QMessageBox::warning(this, "Maquette invalide",
+                             QString("La maquette ne peut être chargée.\nLe nom du fichier est: %1.").arg(filename));
+        return false;
     }
-
-    // lecture des informations relatives aux voies, creation des voies.
-
-    VoieDroite* vd;
-    VoieCourbe* vc;
-    VoieAiguillage* va;
-    VoieAiguillageEnroule* vae;
-    VoieAiguillageTriple* vat;
-    VoieCroisement* vcr;
-    VoieTraverseeJonction* vt;
-    VoieButtoir* vb;
-
-    for(int i =0; i < limite; i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", SkipEmptyParts);
-
-        IDvoie = listeTemporaire.at(0).toInt();
-
-        //recuperation des infos de la voie en traitement.
-        infosVoieEnTraitement = infosVoies[listeTemporaire.at(1).toInt()];
-
-        if(infosVoieEnTraitement->at(0) == 1.0)//voie Droite
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vd = new VoieDroite(infosVoieEnTraitement->at(1));
-            vd->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vd);
-            voiesALier.insert(vd, new QList<int>());
-            voiesALier[vd]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vd]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vd, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 2.0)//voie Courbe
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(4).toLower() == "gauche")
-            {
-                directionVoieEnTraitement = 1.0;
-            }
-            else if(listeTemporaire.at(4).toLower() == "droite")
-            {
-                directionVoieEnTraitement = -1.0;
-            }
-            else //en cas d'erreur dans le fichier...
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction de courbe). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vc = new VoieCourbe(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), directionVoieEnTraitement);
-            vc->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vc);
-            voiesALier.insert(vc, new QList<int>());
-            voiesALier[vc]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vc]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vc, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 3.0)//voie Aiguillage
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(5).toLower() == "gauche")
-                directionVoieEnTraitement = 1.0;
-            else if(listeTemporaire.at(5).toLower() == "droite")
-                directionVoieEnTraitement = -1.0;
-            else
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            va = new VoieAiguillage(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
-            va->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, va);
-            voiesALier.insert(va, new QList<int>());
-            voiesALier[va]->append(listeTemporaire.at(2).toInt());
-            voiesALier[va]->append(listeTemporaire.at(3).toInt());
-            voiesALier[va]->append(listeTemporaire.at(4).toInt());
-            this->simView->addVoie(va, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 4.0)//voie Croisement
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vcr = new VoieCroisement(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2));
-            vcr->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vcr);
-            voiesALier.insert(vcr, new QList<int>());
-            voiesALier[vcr]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vcr, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 5.0)//voie Traversee-Jonction
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vt= new VoieTraverseeJonction(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
-            vt->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vt);
-            voiesALier.insert(vt, new QList<int>());
-            voiesALier[vt]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vt, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 6.0)//voie Buttoir
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vb = new VoieButtoir(infosVoieEnTraitement->at(1));
-            vb->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vb);
-            voiesALier.insert(vb, new QList<int>());
-            voiesALier[vb]->append(listeTemporaire.at(2).toInt());
-            this->simView->addVoie(vb, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 7.0)//voie Aiguillage Enroule
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(5).toLower() == "gauche")
-                directionVoieEnTraitement = 1.0;
-            else if(listeTemporaire.at(5).toLower() == "droite")
-                directionVoieEnTraitement = -1.0;
-            else
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vae = new VoieAiguillageEnroule(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
-            vae->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vae);
-            voiesALier.insert(vae, new QList<int>());
-            voiesALier[vae]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vae]->append(listeTemporaire.at(4).toInt()); //ordre inversé, pour la cohérence du code...
-            voiesALier[vae]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vae, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 8.0)//voie Aiguillage Triple
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vat = new VoieAiguillageTriple(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
-            vat->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vat);
-            voiesALier.insert(vat, new QList<int>());
-            voiesALier[vat]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vat, listeTemporaire.at(0).toInt());
-        }
-    }
-    //finalisation de la creation des voies.
-
-    for(int i = 1; i <= IDVoies.size(); i++)
-    {
-        for(int j = 0; j < voiesALier[IDVoies[i]]->length(); j++)
-        {
-            IDVoies[i]->lier(IDVoies[voiesALier[IDVoies[i]]->at(j)], j);
-        }
-    }
-
-    //debut de la lecture des contacts.
-
-    limite = lecture.readLine().toInt();
-
-    Contact* c;
-
-    for(int i=0; i < limite;i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", SkipEmptyParts);
-
-        //creation des contacts.
-        c = new Contact(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt());
-
-        IDVoies[listeTemporaire.at(1).toInt()]->setContact(c);
-        this->simView->addContact(c, listeTemporaire.at(0).toInt());
-    }
-
-    //debut de la lecture des aiguillages.
-
-    limite = lecture.readLine().toInt();
-
-    for(int i=0; i < limite;i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", SkipEmptyParts);
-
-        VoieVariable *v=dynamic_cast<VoieVariable *>(IDVoies[listeTemporaire.at(1).toInt()]);
-
-        this->simView->addVoieVariable(v, listeTemporaire.at(0).toInt());
-
-        v->setNumVoieVariable(listeTemporaire.at(0).toInt());
-
-    }
-
-    //indication de la premiere voie a poser.
-
-    Voie * premiereVoie = IDVoies[lecture.readLine().toInt()];
-
-    this->simView->setPremiereVoie(premiereVoie);
-
-    this->simView->construireMaquette();
-
-    this->simView->genererSegments();
+    Metriques::getInstance()->reinitialiser();
 
     this->simView->zoomFit();
 
     this->simView->repaint();
 
-    // On détruit la map qui contient des pointeurs sur des QList
-    QMapIterator<Voie*, QList<int>*> it(voiesALier);
-    while (it.hasNext()) {
-        it.next();
-        delete it.value();
-    }
-
     this->maquetteFinie.release();
+    return true;
+}
+
+void MainWindow::exporterMetriques(bool actif)
+{
+    QString fichier;
+    if (actif)
+        fichier = QFileDialog::getSaveFileName(this, tr("Exporter les métriques"), "metriques.csv", tr("CSV Files (*.csv)"));
+
+    exportMetriquesAct->setChecked(!fichier.isEmpty());
+    panneauMetriques->setFichierExport(fichier);
 }
 
 void MainWindow::afficherMessage(QString message)
@@ -852,6 +598,12 @@ void MainWindow::afficherMessage(QString message)
     this->generalConsole->append(message);
 }
 
+void MainWindow::afficherArretUrgence(qint64 latenceUs)
+{
+    afficherMessage(QString("Arrêt d'urgence : locos arrêtées en %1 ms.")
+                    .arg(latenceUs / 1000.0, 0, 'f', 2));
+}
+
 
 void MainWindow::selectionMaquette(QString maquette)
 {
@@ -875,7 +627,15 @@ void MainWindow::selectionMaquette(QString maquette)
         QMessageBox::warning(0,"La maquette n'existe pas",message);
         exit(1);
     }
-    chargerMaquette(manager.fichierMaquette(maquette));
+    if (!chargerMaquette(manager.fichierMaquette(maquette)))
+    {
+        // le programme est libéré de son attente de la maquette, puis arrêté avec
+        // l'application.
+        maquetteFinie.release();
+        semWaitMaquette.release();
+        QCoreApplication::exit(1);
+        return;
+    }
     semWaitMaquette.release();
 }
 
@@ -21,6 +21,9 @@
 #include "simview.h"
 #include "contact.h"
 #include "connect.h"
+#include "chargeurmaquette.h"
+#include "panneaumetriques.h"
+#include "metriques.h"
 
 template< class Elem = char, class Tr = std::char_traits< Elem > >
  class StdRedirector : public std::basic_streambuf< Elem, Tr >
@@ -127,13 +130,18 @@ public:
     QDockWidget* inputDock;
     QLineEdit* inputWidget;
 
+    QDockWidget* dockMetriques;
+    PanneauMetriques* panneauMetriques;
+
     void readSettings();
     void writeSettings() const;
 
-    /** Charge et construit la maquette dont le nom est filename
+    /** Charge et construit la maquette dont le nom est filename. Signale l'erreur si
+      * la maquette ne peut être chargée, la vue est alors vide.
       * \param filename le nom de la maquette à charger.
+      * \return vrai si la maquette a été chargée.
       */
-    void chargerMaquette(QString filename);
+    bool chargerMaquette(QString filename);
 
     void createActions();
     void createMenus();
@@ -156,6 +164,10 @@ public:
     QAction *viewAiguillageNumberAct;
     QAction *viewLocoLogAct;
     QAction *viewInputAct;
+    QAction *viewMetriquesAct;
+    QAction *viewCarteOccupationAct;
+    QAction *viewCarteAttenteAct;
+    QAction *exportMetriquesAct;
     QAction *inertieAct;
     QAction *emergencyStopAct;
     QAction *printAct;
@@ -177,13 +189,17 @@ private slots:
 
 private:
     SimView *simView;
-    QMap <int, QList<double>*> infosVoies;
+    ChargeurMaquette chargeur;
 
 public slots:
     void selectionMaquette(QString maquette);
     void addLoco(int no_loco);
     void closeEvent(QCloseEvent *event);
     void toggleSimulation();
+
+    /** lance la simulation si elle est en pause, comme le bouton de démarrage.
+      */
+    void demarrerSimulation();
     void emergencyStop();
     void simulationStep();
     void finishedAnimation();
@@ -195,9 +211,31 @@ public slots:
     void viewContactNumber();
     void viewAiguillageNumber();
     void viewLocoLog();
+
+    /** affiche la carte d'occupation des segments, ou celle des temps d'attente.
+      * Les deux cartes s'excluent.
+      */
+    void viewCarteOccupation();
+    void viewCarteAttente();
     void toggleLoco(QObject *locoCtrls);
+
+    /** met à jour la commande de pause d'une loco.
+      * \param numLoco le numéro de la loco.
+      * \param enPause vrai si la loco est en pause.
+      */
+    void afficherPauseLoco(int numLoco, bool enPause);
     void toggleInertie();
+
+    /** active ou désactive l'export périodique des métriques dans un fichier CSV.
+      * \param actif vrai pour choisir un fichier et démarrer l'export.
+      */
+    void exporterMetriques(bool actif);
     void afficherMessage(QString message);
+
+    /** affiche dans la console le délai de réaction d'un arrêt d'urgence.
+      * \param latenceUs le délai entre la demande et l'arrêt des locos, en microsecondes.
+      */
+    void afficherArretUrgence(qint64 latenceUs);
     void afficherMessageLoco(int numLoco,QString message);
     void print();
     void onReturnPressed();
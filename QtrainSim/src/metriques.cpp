@@ -0,0 +1,362 @@
+#include <QFile>
+#include <QTextStream>
+#include <QtAlgorithms>
+#include <QtMath>
+
+#include <QDebug>
+
+#include "metriques.h"
+
+//! drapeaux des tableaux de métriques dont le dépassement a été signalé.
+#define DEPASSEMENT_SECTIONS 1
+#define DEPASSEMENT_LOCOS 2
+#define DEPASSEMENT_CONTACTS 4
+
+Histogramme::Histogramme()
+{
+}
+
+int Histogramme::indiceSeau(qint64 valeur)
+{
+    const qint64 demi = SOUS_SEAUX_HISTOGRAMME / 2;
+    quint64 v = quint64(qBound(qint64(0), valeur, (qint64(1) << 40) - 1));
+
+    if (v < quint64(SOUS_SEAUX_HISTOGRAMME))
+        return int(v);
+
+    // m : position du bit de poids fort, au moins 5 pour 32 sous-seaux.
+    int m = 63 - qCountLeadingZeroBits(v);
+    int decalage = m - 4;
+    return int(SOUS_SEAUX_HISTOGRAMME + (m - 5) * demi + qint64(v >> decalage) - demi);
+}
+
+qint64 Histogramme::borneSuperieure(int indice)
+{
+    const int demi = SOUS_SEAUX_HISTOGRAMME / 2;
+
+    if (indice < SOUS_SEAUX_HISTOGRAMME)
+        return indice;
+
+    int k = indice - SOUS_SEAUX_HISTOGRAMME;
+    int m = k / demi + 5;
+    qint64 sousSeau = k % demi + demi;
+    return ((sousSeau + 1) << (m - 4)) - 1;
+}
+
+void Histogramme::enregistrer(qint64 valeur)
+{
+    if (valeur < 0)
+        valeur = 0;
+
+    seaux[indiceSeau(valeur)].fetchAndAddRelaxed(1);
+    nombre.fetchAndAddRelaxed(1);
+    somme.fetchAndAddRelaxed(valeur);
+
+    qint64 ancien = max.loadAcquire();
+    while (valeur > ancien && !max.testAndSetRelaxed(ancien, valeur, ancien))
+        ;
+}
+
+void Histogramme::reinitialiser()
+{
+    for (int i = 0; i < NB_SEAUX_HISTOGRAMME; i++)
+        seaux[i].storeRelease(0);
+    nombre.storeRelease(0);
+    somme.storeRelease(0);
+    max.storeRelease(0);
+}
+
+qint64 Histogramme::getNombre() const
+{
+    return nombre.loadAcquire();
+}
+
+qint64 Histogramme::getSomme() const
+{
+    return somme.loadAcquire();
+}
+
+qint64 Histogramme::getMax() const
+{
+    return max.loadAcquire();
+}
+
+qint64 Histogramme::getQuantile(qreal q) const
+{
+    qint64 total = getNombre();
+    if (total == 0)
+        return 0;
+
+    qint64 rang = qMax(qint64(1), qint64(qCeil(qBound(0.0, q, 1.0) * total)));
+    qint64 cumul = 0;
+    for (int i = 0; i < NB_SEAUX_HISTOGRAMME; i++)
+    {
+        cumul += seaux[i].loadAcquire();
+        if (cumul >= rang)
+            return qMin(borneSuperieure(i), getMax());
+    }
+    return getMax();
+}
+
+
+Metriques::Metriques()
+{
+    horloge.start();
+}
+
+Metriques* Metriques::getInstance()
+{
+    static Metriques instance;
+    return &instance;
+}
+
+qint64 Metriques::maintenant()
+{
+    return getInstance()->horloge.nsecsElapsed() / 1000;
+}
+
+void Metriques::reinitialiser()
+{
+    debut.storeRelease(maintenant());
+
+    for (int i = 0; i < MAX_SECTIONS; i++)
+    {
+        sections[i].nbAcces.storeRelease(0);
+        sections[i].nbAttentes.storeRelease(0);
+        sections[i].occupation.storeRelease(0);
+        sections[i].attente.reinitialiser();
+    }
+
+    for (int i = 0; i <= MAX_LOCOS; i++)
+    {
+        locos[i].nbTours.storeRelease(0);
+        locos[i].attente.storeRelease(0);
+        locos[i].sejourGare.reinitialiser();
+    }
+
+    for (int i = 0; i <= MAX_CONTACTS; i++)
+    {
+        activations[i].storeRelease(0);
+        attenteContacts[i].reinitialiser();
+    }
+}
+
+int Metriques::enregistrerSection(const QString &nom)
+{
+    QMutexLocker verrou(&mutexSections);
+
+    int section = nbSections.loadAcquire();
+    if (section >= MAX_SECTIONS)
+    {
+        signalerDepassement(DEPASSEMENT_SECTIONS,
+                            QString("plus de %1 sections partagées, les métriques de \"%2\" et des suivantes sont ignorées")
+                            .arg(MAX_SECTIONS).arg(nom));
+        return -1;
+    }
+
+    nomsSections[section] = nom;
+    nbSections.storeRelease(section + 1);
+    return section;
+}
+
+bool Metriques::sectionValide(int section)
+{
+    return section >= 0 && section < MAX_SECTIONS;
+}
+
+bool Metriques::locoValide(int numLoco) const
+{
+    if (numLoco > MAX_LOCOS)
+        signalerDepassement(DEPASSEMENT_LOCOS,
+                            QString("loco %1 au-delà de MAX_LOCOS (%2), ses métriques sont ignorées")
+                            .arg(numLoco).arg(MAX_LOCOS));
+    return numLoco >= 0 && numLoco <= MAX_LOCOS;
+}
+
+bool Metriques::contactValide(int numContact) const
+{
+    if (numContact > MAX_CONTACTS)
+        signalerDepassement(DEPASSEMENT_CONTACTS,
+                            QString("contact %1 au-delà de MAX_CONTACTS (%2), ses métriques sont ignorées")
+                            .arg(numContact).arg(MAX_CONTACTS));
+    return numContact >= 0 && numContact <= MAX_CONTACTS;
+}
+
+void Metriques::signalerDepassement(int depassement, const QString &message) const
+{
+    if (depassements.fetchAndOrRelaxed(depassement) & depassement)
+        return;
+    qDebug() << "Métriques :" << qPrintable(message);
+}
+
+void Metriques::accesSection(int section, int numLoco, qint64 attente)
+{
+    if (!sectionValide(section))
+        return;
+
+    sections[section].nbAcces.fetchAndAddRelaxed(1);
+    sections[section].attente.enregistrer(attente);
+    if (attente > 0)
+    {
+        sections[section].nbAttentes.fetchAndAddRelaxed(1);
+        if (locoValide(numLoco))
+            locos[numLoco].attente.fetchAndAddRelaxed(attente);
+    }
+}
+
+void Metriques::sortieSection(int section, qint64 occupation)
+{
+    if (sectionValide(section))
+        sections[section].occupation.fetchAndAddRelaxed(occupation);
+}
+
+void Metriques::sejourGare(int numLoco, qint64 duree)
+{
+    if (!locoValide(numLoco))
+        return;
+
+    locos[numLoco].nbTours.fetchAndAddRelaxed(1);
+    locos[numLoco].sejourGare.enregistrer(duree);
+}
+
+void Metriques::attenteContact(int numContact, qint64 duree)
+{
+    if (contactValide(numContact))
+        attenteContacts[numContact].enregistrer(duree);
+}
+
+void Metriques::activationContact(int numContact)
+{
+    if (contactValide(numContact))
+        activations[numContact].fetchAndAddRelaxed(1);
+}
+
+qint64 Metriques::getDuree() const
+{
+    return maintenant() - debut.loadAcquire();
+}
+
+int Metriques::getNbSections() const
+{
+    return nbSections.loadAcquire();
+}
+
+QString Metriques::getNomSection(int section) const
+{
+    QMutexLocker verrou(&mutexSections);
+    return sectionValide(section) ? nomsSections[section] : QString();
+}
+
+qint64 Metriques::getNbAcces(int section) const
+{
+    return sectionValide(section) ? sections[section].nbAcces.loadAcquire() : 0;
+}
+
+qint64 Metriques::getNbAttentes(int section) const
+{
+    return sectionValide(section) ? sections[section].nbAttentes.loadAcquire() : 0;
+}
+
+const Histogramme& Metriques::getAttenteSection(int section) const
+{
+    Q_ASSERT(sectionValide(section));
+    return sections[section].attente;
+}
+
+qreal Metriques::getOccupation(int section) const
+{
+    qint64 duree = getDuree();
+    if (!sectionValide(section) || duree <= 0)
+        return 0.0;
+    return qMin(1.0, qreal(sections[section].occupation.loadAcquire()) / duree);
+}
+
+qint64 Metriques::getNbTours(int numLoco) const
+{
+    return locoValide(numLoco) ? locos[numLoco].nbTours.loadAcquire() : 0;
+}
+
+qreal Metriques::getToursParHeure(int numLoco) const
+{
+    qint64 duree = getDuree();
+    if (duree <= 0)
+        return 0.0;
+    return getNbTours(numLoco) * 3600.0e6 / duree;
+}
+
+qint64 Metriques::getAttenteLoco(int numLoco) const
+{
+    return locoValide(numLoco) ? locos[numLoco].attente.loadAcquire() : 0;
+}
+
+const Histogramme& Metriques::getSejourGare(int numLoco) const
+{
+    Q_ASSERT(locoValide(numLoco));
+    return locos[numLoco].sejourGare;
+}
+
+qint64 Metriques::getNbActivations(int numContact) const
+{
+    return contactValide(numContact) ? activations[numContact].loadAcquire() : 0;
+}
+
+const Histogramme& Metriques::getAttenteContact(int numContact) const
+{
+    Q_ASSERT(contactValide(numContact));
+    return attenteContacts[numContact];
+}
+
+bool Metriques::exporterCsv(const QString &fichier) const
+{
+    QFile f(fichier);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return false;
+
+    QTextStream csv(&f);
+    if (f.size() == 0)
+        csv << "instant_s,categorie,nom,mesure,valeur\n";
+
+    QString instant = QString::number(getDuree() / 1.0e6, 'f', 3);
+    auto ligne = [&](const QString &categorie, const QString &nom, const QString &mesure, qreal valeur) {
+        csv << instant << ',' << categorie << ',' << nom << ',' << mesure << ',' << valeur << '\n';
+    };
+
+    for (int s = 0; s < getNbSections(); s++)
+    {
+        QString nom = getNomSection(s);
+        const Histogramme &attente = getAttenteSection(s);
+        ligne("section", nom, "acces", getNbAcces(s));
+        ligne("section", nom, "attentes", getNbAttentes(s));
+        ligne("section", nom, "attente_p50_s", attente.getQuantile(0.5) / 1.0e6);
+        ligne("section", nom, "attente_p99_s", attente.getQuantile(0.99) / 1.0e6);
+        ligne("section", nom, "attente_max_s", attente.getMax() / 1.0e6);
+        ligne("section", nom, "occupation", getOccupation(s));
+    }
+
+    for (int l = 0; l <= MAX_LOCOS; l++)
+    {
+        const Histogramme &sejour = getSejourGare(l);
+        if (getNbTours(l) == 0 && getAttenteLoco(l) == 0)
+            continue;
+        QString nom = QString::number(l);
+        ligne("loco", nom, "tours", getNbTours(l));
+        ligne("loco", nom, "tours_par_heure", getToursParHeure(l));
+        ligne("loco", nom, "attente_s", getAttenteLoco(l) / 1.0e6);
+        ligne("loco", nom, "sejour_gare_p50_s", sejour.getQuantile(0.5) / 1.0e6);
+        ligne("loco", nom, "sejour_gare_max_s", sejour.getMax() / 1.0e6);
+    }
+
+    for (int c = 0; c <= MAX_CONTACTS; c++)
+    {
+        const Histogramme &attente = attenteContacts[c];
+        if (getNbActivations(c) == 0 && attente.getNombre() == 0)
+            continue;
+        QString nom = QString::number(c);
+        ligne("contact", nom, "activations", getNbActivations(c));
+        ligne("contact", nom, "attentes", attente.getNombre());
+        ligne("contact", nom, "attente_p50_s", attente.getQuantile(0.5) / 1.0e6);
+        ligne("contact", nom, "attente_max_s", attente.getMax() / 1.0e6);
+    }
+
+    return f.error() == QFile::NoError;
+}
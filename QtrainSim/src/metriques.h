@@ -0,0 +1,201 @@
+#ifndef METRIQUES_H
+#define METRIQUES_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+
+#include "general.h"
+
+//! nombre de sous-seaux par puissance de deux d'un histogramme (précision ~3%).
+#define SOUS_SEAUX_HISTOGRAMME 32
+
+//! nombre de seaux d'un histogramme, couvrant les valeurs de 0 à 2^40.
+#define NB_SEAUX_HISTOGRAMME (SOUS_SEAUX_HISTOGRAMME + 35 * (SOUS_SEAUX_HISTOGRAMME / 2))
+
+/** Histogramme à précision relative constante, à la manière de HdrHistogram :
+  * chaque puissance de deux est découpée en SOUS_SEAUX_HISTOGRAMME / 2 seaux.
+  * L'enregistrement d'une valeur ne prend aucun verrou et peut être fait depuis
+  * n'importe quel thread.
+  */
+class Histogramme
+{
+public:
+    /** Constructeur de classe.
+      */
+    Histogramme();
+
+    /** enregistre une valeur.
+      * \param valeur la valeur, positive ou nulle.
+      */
+    void enregistrer(qint64 valeur);
+
+    /** remet l'histogramme à zéro. Ne doit pas être appelé pendant un enregistrement.
+      */
+    void reinitialiser();
+
+    qint64 getNombre() const;
+    qint64 getSomme() const;
+    qint64 getMax() const;
+
+    /** retourne une borne supérieure de la valeur au quantile q.
+      * \param q le quantile, entre 0 et 1.
+      * \return la borne supérieure du seau contenant le quantile, 0 si l'histogramme est vide.
+      */
+    qint64 getQuantile(qreal q) const;
+
+private:
+    static int indiceSeau(qint64 valeur);
+    static qint64 borneSuperieure(int indice);
+
+    QAtomicInteger<qint64> seaux[NB_SEAUX_HISTOGRAMME];
+    QAtomicInteger<qint64> nombre;
+    QAtomicInteger<qint64> somme;
+    QAtomicInteger<qint64> max;
+};
+
+/** Registre des métriques d'exploitation : accès aux sections partagées, séjours en
+  * gare, attentes sur les contacts et activations des contacts. Les durées sont en
+  * microsecondes. Les mises à jour ne prennent aucun verrou ; seul l'enregistrement
+  * d'une nouvelle section en prend un.
+  */
+class Metriques
+{
+public:
+    static Metriques *getInstance();
+
+    /** retourne l'instant courant, sur une horloge monotone.
+      * \return l'instant en microsecondes.
+      */
+    static qint64 maintenant();
+
+    /** remet toutes les métriques à zéro, sans oublier les sections enregistrées.
+      */
+    void reinitialiser();
+
+    /** enregistre une section partagée.
+      * \param nom le nom de la section.
+      * \return le numéro de la section, -1 si MAX_SECTIONS sections sont déjà enregistrées.
+      */
+    int enregistrerSection(const QString &nom);
+
+    /** comptabilise l'accès d'une loco à une section.
+      * \param section le numéro de la section.
+      * \param numLoco le numéro de la loco.
+      * \param attente le temps passé arrêté à attendre la section, 0 si la loco n'a pas attendu.
+      */
+    void accesSection(int section, int numLoco, qint64 attente);
+
+    /** comptabilise la sortie d'une loco d'une section.
+      * \param section le numéro de la section.
+      * \param occupation le temps passé dans la section.
+      */
+    void sortieSection(int section, qint64 occupation);
+
+    /** comptabilise un séjour en gare, qui termine un tour.
+      * \param numLoco le numéro de la loco.
+      * \param duree la durée du séjour.
+      */
+    void sejourGare(int numLoco, qint64 duree);
+
+    /** comptabilise une attente sur un contact.
+      * \param numContact le numéro du contact.
+      * \param duree la durée de l'attente.
+      */
+    void attenteContact(int numContact, qint64 duree);
+
+    /** comptabilise l'activation d'un contact par une loco.
+      * \param numContact le numéro du contact.
+      */
+    void activationContact(int numContact);
+
+    /** retourne la durée écoulée depuis la dernière remise à zéro.
+      * \return la durée en microsecondes.
+      */
+    qint64 getDuree() const;
+
+    int getNbSections() const;
+    QString getNomSection(int section) const;
+    qint64 getNbAcces(int section) const;
+    qint64 getNbAttentes(int section) const;
+    const Histogramme &getAttenteSection(int section) const;
+
+    /** retourne la fraction du temps pendant laquelle la section a été occupée.
+      * \param section le numéro de la section.
+      * \return la fraction, entre 0 et 1.
+      */
+    qreal getOccupation(int section) const;
+
+    qint64 getNbTours(int numLoco) const;
+
+    /** retourne le nombre de tours par heure d'une loco depuis la remise à zéro.
+      * \param numLoco le numéro de la loco.
+      * \return le nombre de tours par heure.
+      */
+    qreal getToursParHeure(int numLoco) const;
+
+    /** retourne le temps total passé par une loco arrêtée devant les sections.
+      * \param numLoco le numéro de la loco.
+      * \return la durée en microsecondes.
+      */
+    qint64 getAttenteLoco(int numLoco) const;
+    const Histogramme &getSejourGare(int numLoco) const;
+
+    qint64 getNbActivations(int numContact) const;
+    const Histogramme &getAttenteContact(int numContact) const;
+
+    /** ajoute l'état courant des métriques à un fichier CSV, une ligne par mesure
+      * (instant, catégorie, nom, mesure, valeur). L'en-tête est écrit si le fichier est vide.
+      * \param fichier le chemin du fichier.
+      * \return vrai si le fichier a pu être écrit.
+      */
+    bool exporterCsv(const QString &fichier) const;
+
+protected:
+    Metriques();
+
+private:
+    struct MetriquesSection
+    {
+        QAtomicInteger<qint64> nbAcces;
+        QAtomicInteger<qint64> nbAttentes;
+        QAtomicInteger<qint64> occupation;
+        Histogramme attente;
+    };
+
+    struct MetriquesLoco
+    {
+        QAtomicInteger<qint64> nbTours;
+        QAtomicInteger<qint64> attente;
+        Histogramme sejourGare;
+    };
+
+    static bool sectionValide(int section);
+
+    /** vérifient qu'un numéro est dans les limites des tableaux de métriques. Un numéro
+      * hors limites est signalé une fois, ses métriques sont ignorées.
+      */
+    bool locoValide(int numLoco) const;
+    bool contactValide(int numContact) const;
+
+    /** signale, la première fois seulement, des métriques ignorées faute de place.
+      * \param depassement le drapeau du tableau trop petit, DEPASSEMENT_*.
+      * \param message la description du dépassement.
+      */
+    void signalerDepassement(int depassement, const QString &message) const;
+
+    QElapsedTimer horloge;
+    QAtomicInteger<qint64> debut;
+    mutable QMutex mutexSections;
+    QAtomicInt nbSections;
+    QString nomsSections[MAX_SECTIONS];
+    MetriquesSection sections[MAX_SECTIONS];
+    MetriquesLoco locos[MAX_LOCOS + 1];
+    //! tableaux dont le dépassement a déjà été signalé.
+    mutable QAtomicInt depassements;
+    QAtomicInteger<qint64> activations[MAX_CONTACTS + 1];
+    Histogramme attenteContacts[MAX_CONTACTS + 1];
+};
+
+#endif // METRIQUES_H
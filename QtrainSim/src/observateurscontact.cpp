@@ -0,0 +1,48 @@
+#include "observateurscontact.h"
+
+AttenteContacts::AttenteContacts(int numLoco)
+    : locoAttendue(numLoco),
+      premierContact(-1),
+      annulee(false)
+{
+}
+
+void AttenteContacts::contactActive(int numContact, int numLoco)
+{
+    if(locoAttendue >= 0 && numLoco != locoAttendue)
+        return;
+
+    mutex.lock();
+    if(premierContact < 0)
+        premierContact = numContact;
+    condition.wakeAll();
+    mutex.unlock();
+}
+
+int AttenteContacts::attendre()
+{
+    mutex.lock();
+    while(premierContact < 0 && !annulee)
+        condition.wait(&mutex);
+    int numContact = premierContact;
+    mutex.unlock();
+    return numContact;
+}
+
+void AttenteContacts::annuler()
+{
+    mutex.lock();
+    annulee = true;
+    condition.wakeAll();
+    mutex.unlock();
+}
+
+AbonnementContact::AbonnementContact(std::function<void(int, int)> rappel)
+    : rappel(rappel)
+{
+}
+
+void AbonnementContact::contactActive(int numContact, int numLoco)
+{
+    rappel(numContact, numLoco);
+}
@@ -0,0 +1,71 @@
+#ifndef OBSERVATEURSCONTACT_H
+#define OBSERVATEURSCONTACT_H
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "contact.h"
+
+/** Attente de l'activation de l'un de plusieurs contacts. L'attente est abonnée à
+  * chacun des contacts, et retient le premier d'entre eux à être activé, le cas échéant
+  * par une loco donnée.
+  */
+class AttenteContacts : public ObservateurContact
+{
+public:
+    /** Constructeur de classe.
+      * \param numLoco le numéro de la loco attendue, -1 pour n'importe quelle loco.
+      */
+    explicit AttenteContacts(int numLoco = -1);
+
+    /** retient le contact s'il est le premier activé par la loco attendue, et libère
+      * le thread en attente. Les activations par d'autres locos sont ignorées.
+      * \param numContact le numéro du contact activé.
+      * \param numLoco le numéro de la loco ayant activé le contact.
+      */
+    void contactActive(int numContact, int numLoco) override;
+
+    /** Méthode bloquante, attendant l'activation de l'un des contacts observés.
+      * \return le numéro du premier contact activé, ou -1 si l'attente a été annulée.
+      */
+    int attendre();
+
+    /** libère le thread en attente sans qu'aucun contact n'ait été activé.
+      */
+    void annuler();
+
+private:
+    QMutex mutex;
+    QWaitCondition condition;
+    //! loco attendue, -1 pour n'importe quelle loco.
+    const int locoAttendue;
+    //! premier contact activé, -1 tant qu'aucun ne l'a été.
+    int premierContact;
+    //! vrai si l'attente a été annulée.
+    bool annulee;
+};
+
+/** Abonnement d'une fonction aux activations d'un contact.
+  */
+class AbonnementContact : public ObservateurContact
+{
+public:
+    /** Constructeur de classe.
+      * \param rappel la fonction appelée, dans le thread de la simulation, avec les
+      *        numéros du contact et de la loco à chaque activation.
+      */
+    explicit AbonnementContact(std::function<void(int, int)> rappel);
+
+    /** appelle la fonction abonnée.
+      * \param numContact le numéro du contact activé.
+      * \param numLoco le numéro de la loco ayant activé le contact.
+      */
+    void contactActive(int numContact, int numLoco) override;
+
+private:
+    std::function<void(int, int)> rappel;
+};
+
+#endif // OBSERVATEURSCONTACT_H
@@ -0,0 +1,134 @@
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <iostream>
+
+#include "panneaumetriques.h"
+#include "metriques.h"
+#include "connect.h"
+
+static QString secondes(qint64 us)
+{
+    return QString::number(us / 1.0e6, 'f', 2);
+}
+
+PanneauMetriques::PanneauMetriques(QWidget *parent) :
+    QWidget(parent)
+{
+    onglets = new QTabWidget(this);
+
+    tableauSections = new QTableWidget(0, 7, this);
+    tableauSections->setHorizontalHeaderLabels({tr("Section"), tr("Accès"), tr("Attentes"),
+                                                tr("Attente p50 (s)"), tr("Attente p99 (s)"),
+                                                tr("Attente max (s)"), tr("Occupation")});
+    tableauLocos = new QTableWidget(0, 6, this);
+    tableauLocos->setHorizontalHeaderLabels({tr("Loco"), tr("Tours"), tr("Tours/h"), tr("Arrêt (s)"),
+                                             tr("Gare p50 (s)"), tr("Gare max (s)")});
+    tableauContacts = new QTableWidget(0, 5, this);
+    tableauContacts->setHorizontalHeaderLabels({tr("Contact"), tr("Activations"), tr("Attentes"),
+                                                tr("Attente p50 (s)"), tr("Attente max (s)")});
+
+    foreach(QTableWidget *tableau, QList<QTableWidget*>({tableauSections, tableauLocos, tableauContacts}))
+    {
+        tableau->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        tableau->verticalHeader()->setVisible(false);
+        tableau->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    }
+
+    onglets->addTab(tableauSections, tr("Sections"));
+    onglets->addTab(tableauLocos, tr("Locos"));
+    onglets->addTab(tableauContacts, tr("Contacts"));
+
+    QVBoxLayout *disposition = new QVBoxLayout(this);
+    disposition->setContentsMargins(0, 0, 0, 0);
+    disposition->addWidget(onglets);
+
+    timerRafraichissement = new QTimer(this);
+    CONNECT(timerRafraichissement, SIGNAL(timeout()), this, SLOT(rafraichir()));
+    timerRafraichissement->start(PERIODE_METRIQUES_MS);
+
+    timerExport = new QTimer(this);
+    CONNECT(timerExport, SIGNAL(timeout()), this, SLOT(exporter()));
+}
+
+void PanneauMetriques::setFichierExport(const QString &fichier)
+{
+    fichierExport = fichier;
+    if (fichierExport.isEmpty())
+        timerExport->stop();
+    else
+        timerExport->start(PERIODE_EXPORT_METRIQUES_MS);
+}
+
+void PanneauMetriques::setCellule(QTableWidget *tableau, int ligne, int colonne, const QString &texte)
+{
+    QTableWidgetItem *item = tableau->item(ligne, colonne);
+    if (item == nullptr)
+        tableau->setItem(ligne, colonne, new QTableWidgetItem(texte));
+    else if (item->text() != texte)
+        item->setText(texte);
+}
+
+void PanneauMetriques::rafraichir()
+{
+    // Les tableaux ne sont mis à jour que s'ils sont visibles.
+    if (!isVisible())
+        return;
+
+    Metriques *m = Metriques::getInstance();
+
+    int nbSections = m->getNbSections();
+    tableauSections->setRowCount(nbSections);
+    for (int s = 0; s < nbSections; s++)
+    {
+        const Histogramme &attente = m->getAttenteSection(s);
+        setCellule(tableauSections, s, 0, m->getNomSection(s));
+        setCellule(tableauSections, s, 1, QString::number(m->getNbAcces(s)));
+        setCellule(tableauSections, s, 2, QString::number(m->getNbAttentes(s)));
+        setCellule(tableauSections, s, 3, secondes(attente.getQuantile(0.5)));
+        setCellule(tableauSections, s, 4, secondes(attente.getQuantile(0.99)));
+        setCellule(tableauSections, s, 5, secondes(attente.getMax()));
+        setCellule(tableauSections, s, 6, QString("%1 %").arg(m->getOccupation(s) * 100.0, 0, 'f', 1));
+    }
+
+    int ligne = 0;
+    for (int l = 0; l <= MAX_LOCOS; l++)
+    {
+        if (m->getNbTours(l) == 0 && m->getAttenteLoco(l) == 0)
+            continue;
+        const Histogramme &sejour = m->getSejourGare(l);
+        tableauLocos->setRowCount(ligne + 1);
+        setCellule(tableauLocos, ligne, 0, QString::number(l));
+        setCellule(tableauLocos, ligne, 1, QString::number(m->getNbTours(l)));
+        setCellule(tableauLocos, ligne, 2, QString::number(m->getToursParHeure(l), 'f', 1));
+        setCellule(tableauLocos, ligne, 3, secondes(m->getAttenteLoco(l)));
+        setCellule(tableauLocos, ligne, 4, secondes(sejour.getQuantile(0.5)));
+        setCellule(tableauLocos, ligne, 5, secondes(sejour.getMax()));
+        ligne++;
+    }
+    tableauLocos->setRowCount(ligne);
+
+    ligne = 0;
+    for (int c = 0; c <= MAX_CONTACTS; c++)
+    {
+        const Histogramme &attente = m->getAttenteContact(c);
+        if (m->getNbActivations(c) == 0 && attente.getNombre() == 0)
+            continue;
+        tableauContacts->setRowCount(ligne + 1);
+        setCellule(tableauContacts, ligne, 0, QString::number(c));
+        setCellule(tableauContacts, ligne, 1, QString::number(m->getNbActivations(c)));
+        setCellule(tableauContacts, ligne, 2, QString::number(attente.getNombre()));
+        setCellule(tableauContacts, ligne, 3, secondes(attente.getQuantile(0.5)));
+        setCellule(tableauContacts, ligne, 4, secondes(attente.getMax()));
+        ligne++;
+    }
+    tableauContacts->setRowCount(ligne);
+}
+
+void PanneauMetriques::exporter()
+{
+    if (!Metriques::getInstance()->exporterCsv(fichierExport))
+    {
+        std::cerr << "Impossible d'écrire les métriques dans " << qPrintable(fichierExport) << std::endl;
+        setFichierExport(QString());
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef PANNEAUMETRIQUES_H
+#define PANNEAUMETRIQUES_H
+
+#include <QWidget>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QTimer>
+#include <QString>
+
+/** Panneau affichant les métriques d'exploitation (voir Metriques), rafraîchi
+  * périodiquement, et exportant optionnellement ces métriques dans un fichier CSV.
+  */
+class PanneauMetriques : public QWidget
+{
+    Q_OBJECT
+public:
+    /** Constructeur de classe.
+      * \param parent le widget parent.
+      */
+    explicit PanneauMetriques(QWidget *parent = nullptr);
+
+    /** active l'export périodique des métriques.
+      * \param fichier le fichier CSV, une chaîne vide pour désactiver l'export.
+      */
+    void setFichierExport(const QString &fichier);
+
+public slots:
+    /** relit les métriques et met à jour les tableaux.
+      */
+    void rafraichir();
+
+private slots:
+    /** ajoute l'état courant des métriques au fichier d'export.
+      */
+    void exporter();
+
+private:
+    /** remplit une cellule d'un tableau, en la créant si nécessaire.
+      */
+    static void setCellule(QTableWidget *tableau, int ligne, int colonne, const QString &texte);
+
+    QTabWidget *onglets;
+    QTableWidget *tableauSections;
+    QTableWidget *tableauLocos;
+    QTableWidget *tableauContacts;
+    QTimer *timerRafraichissement;
+    QTimer *timerExport;
+    QString fichierExport;
+};
+
+#endif // PANNEAUMETRIQUES_H
@@ -1,30 +1,38 @@
 #include "segment.h"
 
-Segment::Segment(Contact *c1, Contact *c2, QList<Voie *> lv, QObject *parent) :
+Segment::Segment(Contact *c1, Contact *c2, const QVector<Voie *> *voies, int debut, int taille,
+                 QObject *parent) :
     QObject(parent)
 {
     this->contact1 = c1;
     this->contact2 = c2;
-    this->voies = lv;
+    this->voies = voies;
+    this->debut = debut;
+    this->taille = taille;
 }
 
-Voie* Segment::getMilieu()
+Voie* Segment::voie(int indice) const
+{
+    return voies->at(debut + indice);
+}
+
+int Segment::indiceMilieu() const
 {
-    int indiceMilieu = this->voies.length() / 2;
+    int indiceMilieu = this->taille / 2;
     int delta = 1;
 
     while(true)
     {
-        if(voies.at(indiceMilieu)->getNbreLiaisons() == 2)
+        if(voie(indiceMilieu)->getNbreLiaisons() == 2)
         {
-            return voies.at(indiceMilieu);
+            return indiceMilieu;
         }
         else
         {
             indiceMilieu += delta;
 
-            if(indiceMilieu < 0 || indiceMilieu >= voies.length())
-                return nullptr;
+            if(indiceMilieu < 0 || indiceMilieu >= taille)
+                return -1;
 
             delta *= -1;
             if(delta < 0)
@@ -35,18 +43,25 @@ Voie* Segment::getMilieu()
     }
 }
 
+Voie* Segment::getMilieu()
+{
+    int indice = indiceMilieu();
+
+    return indice >= 0 ? voie(indice) : nullptr;
+}
+
 Voie* Segment::getSuivantMilieu()
 {
-    int indiceMilieu = voies.indexOf(getMilieu());
+    int indice = indiceMilieu();
 
-    return voies.at(indiceMilieu +1); //pas de garde fou! probablement un peu risque...
+    return voie(indice +1); //pas de garde fou! probablement un peu risque...
 }
 
 Voie* Segment::getPrecedentMilieu()
 {
-    int indiceMilieu = voies.indexOf(getMilieu());
+    int indice = indiceMilieu();
 
-    return voies.at(indiceMilieu -1); //pas de garde fou! probablement un peu risque...
+    return voie(indice -1); //pas de garde fou! probablement un peu risque...
 }
 
 bool Segment::relie(Contact *c1, Contact *c2)
@@ -55,3 +70,29 @@ bool Segment::relie(Contact *c1, Contact *c2)
         return true;
     return false;
 }
+
+Contact* Segment::getContact1()
+{
+    return contact1;
+}
+
+Contact* Segment::getContact2()
+{
+    return contact2;
+}
+
+QPainterPath Segment::getTrace() const
+{
+    QPainterPath trace(contact1->scenePos());
+
+    for(int i = 0; i + 1 < taille; i++)
+        trace.lineTo(voie(i)->getPosAbsLiaison(voie(i + 1)));
+
+    // un segment sans second contact finit sur un buttoir.
+    if(contact2 != nullptr)
+        trace.lineTo(contact2->scenePos());
+    else
+        trace.lineTo(voie(taille - 1)->sceneBoundingRect().center());
+
+    return trace;
+}
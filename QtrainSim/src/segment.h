@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QDebug>
+#include <QPainterPath>
+#include <QVector>
 
 #include "contact.h"
 #include "voie.h"
@@ -14,9 +16,12 @@ public:
     /** Constructeur de classe
       * \param c1 le premier contact du segment
       * \param c2 le second contact du segment
-      * \param lv la liste des voies du segment
+      * \param voies les voies de tous les segments de la maquette, mises bout à bout.
+      * \param debut l'indice de la première voie du segment dans voies.
+      * \param taille le nombre de voies du segment.
       */
-    explicit Segment(Contact* c1, Contact* c2, QList<Voie*> lv, QObject *parent = 0);
+    explicit Segment(Contact* c1, Contact* c2, const QVector<Voie*> *voies, int debut, int taille,
+                     QObject *parent = 0);
 
     /** retourne la voie droite ou courbe la plus au milieu du segment.
       * \return la voie droite ou courbe la plus au milieu du segment.
@@ -39,14 +44,42 @@ public:
       * \return vrai si le segment relie c1 et c2, faux sinon.
       */
     bool relie(Contact* c1, Contact* c2);
+
+    /** retourne le premier contact du segment.
+      * \return le premier contact du segment.
+      */
+    Contact* getContact1();
+
+    /** retourne le second contact du segment, nullptr si le segment finit sur un buttoir.
+      * \return le second contact du segment.
+      */
+    Contact* getContact2();
+
+    /** retourne le tracé du segment, d'un contact à l'autre en passant par les
+      * jonctions de ses voies. Les courbes sont remplacées par leur corde.
+      * \return le tracé, en coordonnées de la scène.
+      */
+    QPainterPath getTrace() const;
 signals:
 
 public slots:
 
 private:
+    /** retourne l'indice dans le segment de la voie droite ou courbe la plus au milieu.
+      * \return l'indice de la voie, -1 s'il n'y en a pas.
+      */
+    int indiceMilieu() const;
+
+    /** retourne la voie d'indice donné dans le segment.
+      */
+    Voie* voie(int indice) const;
+
     Contact* contact1;
     Contact* contact2;
-    QList<Voie*> voies;
+    //! tableau partagé par les segments, dont celui-ci occupe [debut, debut + taille[.
+    const QVector<Voie*> *voies;
+    int debut;
+    int taille;
 };
 
 #endif // SEGMENT_H
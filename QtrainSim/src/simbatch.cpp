@@ -0,0 +1,183 @@
+#include <QCoreApplication>
+
+#include <iostream>
+
+#include "simbatch.h"
+#include "maquettemanager.h"
+#include "metriques.h"
+
+SimBatch::SimBatch(QObject *parent) :
+    QObject(parent)
+{
+    simView = new SimView(nullptr);
+    timer = new QTimer(this);
+    CONNECT(timer, SIGNAL(timeout()), this, SLOT(executerPas()));
+    verbeux = false;
+    dureeMax = 0.0;
+    nbToursMax = 0;
+    pasParSeconde = 0;
+}
+
+SimBatch::~SimBatch()
+{
+    timer->stop();
+    delete simView;
+}
+
+bool SimBatch::estValide() const
+{
+    return chargeur.estValide();
+}
+
+SimView* SimBatch::getSimView()
+{
+    return simView;
+}
+
+void SimBatch::setVerbeux(bool verbeux)
+{
+    this->verbeux = verbeux;
+}
+
+void SimBatch::setDureeMax(qreal ms)
+{
+    dureeMax = ms < 0.0 ? 0.0 : ms;
+}
+
+void SimBatch::setNbToursMax(int nbTours)
+{
+    nbToursMax = nbTours < 0 ? 0 : nbTours;
+}
+
+void SimBatch::setPasParSeconde(int pasParSeconde)
+{
+    this->pasParSeconde = pasParSeconde < 0 ? 0 : pasParSeconde;
+}
+
+void SimBatch::setContactTour(int numLoco, int numContact)
+{
+    contactsTour.insert(numLoco, numContact);
+}
+
+int SimBatch::getNbTours(int numLoco) const
+{
+    if (!contactsTour.contains(numLoco))
+        return 0;
+
+    int nbPassages = simView->getStatistiques().getNbPassages(numLoco, contactsTour.value(numLoco));
+    return qMax(0, nbPassages - 1);
+}
+
+QString SimBatch::getRaisonArret() const
+{
+    return raisonArret;
+}
+
+void SimBatch::addLoco(int no_loco)
+{
+    simView->addLoco(new Loco(no_loco), no_loco);
+}
+
+void SimBatch::selectionMaquette(QString maquette)
+{
+    MaquetteManager manager;
+
+    if (!manager.nomMaquettes().contains(maquette))
+    {
+        abandonnerMaquette(QString("La maquette \"%1\" n'existe pas.").arg(maquette));
+        return;
+    }
+
+    if (!chargeur.charger(manager.fichierMaquette(maquette), simView))
+    {
+        abandonnerMaquette(QString("Impossible de lire la maquette \"%1\".").arg(maquette));
+        return;
+    }
+    Metriques::getInstance()->reinitialiser();
+
+    maquetteFinie.release();
+    semWaitMaquette.release();
+}
+
+void SimBatch::abandonnerMaquette(const QString &message)
+{
+    std::cerr << qPrintable(message) << std::endl;
+
+    // Le programme est arrêté comme en fin de simulation, puis libéré de son attente
+    // de la maquette ; la boucle d'événements se termine ensuite normalement, ce qui
+    // laisse CommandeTrain attendre la fin du programme.
+    raisonArret = "layout";
+    emit termine();
+    maquetteFinie.release();
+    semWaitMaquette.release();
+    QCoreApplication::exit(1);
+}
+
+void SimBatch::afficherMessage(QString message)
+{
+    if (verbeux)
+        std::cout << qPrintable(message) << std::endl;
+}
+
+void SimBatch::afficherMessageLoco(int numLoco, QString message)
+{
+    if (verbeux)
+        std::cout << "Loco " << numLoco << " : " << qPrintable(message) << std::endl;
+}
+
+void SimBatch::demarrer()
+{
+    raisonArret.clear();
+    timer->start(pasParSeconde > 0 ? qMax(1, 1000 / pasParSeconde) : 0);
+}
+
+void SimBatch::arreter(QString raison)
+{
+    if (!timer->isActive())
+        return;
+
+    timer->stop();
+    raisonArret = raison;
+    emit termine();
+}
+
+void SimBatch::executerPas()
+{
+    simView->animationStep();
+
+    emit pasEffectue();
+    if (!timer->isActive())
+        return;
+
+    QString raison = verifierArret();
+    if (!raison.isEmpty())
+        arreter(raison);
+}
+
+QString SimBatch::verifierArret() const
+{
+    const StatistiquesSim &statistiques = simView->getStatistiques();
+
+    if (statistiques.getNbCollisions() > 0)
+        return "collision";
+
+    if (statistiques.getNbDeraillements() > 0)
+        return "derailment";
+
+    if (nbToursMax > 0 && !contactsTour.isEmpty())
+    {
+        bool toursAtteints = true;
+        foreach(int numLoco, contactsTour.keys())
+        {
+            if (getNbTours(numLoco) < nbToursMax)
+                toursAtteints = false;
+        }
+        if (toursAtteints)
+            return "laps";
+    }
+
+    if (dureeMax > 0.0 && statistiques.getTempsSimule() >= dureeMax)
+        return "duration";
+
+    return QString();
+}
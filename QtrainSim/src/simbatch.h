@@ -0,0 +1,138 @@
+#ifndef SIMBATCH_H
+#define SIMBATCH_H
+
+#include <QObject>
+#include <QString>
+#include <QSemaphore>
+#include <QTimer>
+#include <QMap>
+
+#include "simview.h"
+#include "chargeurmaquette.h"
+
+/** Hôte de la simulation sans fenêtre principale. Remplace MainWindow pour
+  * CommandeTrain : les maquettes sont chargées sans boîte de dialogue, les messages
+  * sont écrits sur la sortie standard et la simulation avance aussi vite que possible
+  * (ou à un nombre de pas par seconde donné), jusqu'à une condition d'arrêt.
+  */
+class SimBatch : public QObject
+{
+    Q_OBJECT
+public:
+    /** Constructeur de classe.
+      * \param parent l'objet parent.
+      */
+    explicit SimBatch(QObject *parent = nullptr);
+
+    /** Destructeur de classe.
+      */
+    ~SimBatch();
+
+    /** indique si le fichier optionnel de description de voies, s'il existe, a pu être lu.
+      * \return vrai si une maquette peut être chargée.
+      */
+    bool estValide() const;
+
+    /** retourne la vue de la simulation, jamais affichée.
+      * \return la vue de la simulation.
+      */
+    SimView* getSimView();
+
+    /** active l'écriture des messages de la simulation sur la sortie standard.
+      * \param verbeux vrai pour écrire les messages.
+      */
+    void setVerbeux(bool verbeux);
+
+    /** fixe la durée de simulation après laquelle la simulation s'arrête.
+      * \param ms la durée en millisecondes de simulation, 0 pour ne pas limiter.
+      */
+    void setDureeMax(qreal ms);
+
+    /** fixe le nombre de tours après lequel la simulation s'arrête. La simulation
+      * s'arrête quand toutes les locos ayant un contact de tour l'ont atteint.
+      * \param nbTours le nombre de tours, 0 pour ne pas limiter.
+      */
+    void setNbToursMax(int nbTours);
+
+    /** fixe le rythme de la simulation.
+      * \param pasParSeconde le nombre de pas par seconde, 0 pour aller aussi vite que possible.
+      */
+    void setPasParSeconde(int pasParSeconde);
+
+    /** indique le contact sur lequel les tours d'une loco sont comptés.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact, en général celui de sa gare.
+      */
+    void setContactTour(int numLoco, int numContact);
+
+    /** retourne le nombre de tours effectués par une loco. Le premier passage sur
+      * le contact de tour est l'arrivée en gare depuis la position de départ et
+      * n'est pas compté.
+      * \param numLoco le numéro de la loco.
+      * \return le nombre de tours, 0 si aucun contact de tour n'est défini.
+      */
+    int getNbTours(int numLoco) const;
+
+    /** retourne la raison de l'arrêt de la simulation.
+      * \return "duration", "laps", "collision", "derailment", "layout" si la maquette
+      *         n'a pas pu être chargée, la raison passée à arreter() ou une chaîne vide.
+      */
+    QString getRaisonArret() const;
+
+    QSemaphore semWaitMaquette;
+    QSemaphore maquetteFinie;
+
+signals:
+    /** Signale que la simulation s'est arrêtée. La raison est donnée par getRaisonArret().
+      */
+    void termine();
+
+    /** Signale qu'un pas de simulation vient d'être effectué, avant la vérification
+      * des conditions d'arrêt.
+      */
+    void pasEffectue();
+
+public slots:
+    void addLoco(int no_loco);
+    void selectionMaquette(QString maquette);
+    void afficherMessage(QString message);
+    void afficherMessageLoco(int numLoco, QString message);
+
+    /** démarre la simulation.
+      */
+    void demarrer();
+
+    /** arrête la simulation.
+      * \param raison la raison de l'arrêt.
+      */
+    void arreter(QString raison);
+
+private slots:
+    /** effectue un pas de simulation puis vérifie les conditions d'arrêt.
+      */
+    void executerPas();
+
+private:
+    /** vérifie les conditions d'arrêt.
+      * \return la raison de l'arrêt, une chaîne vide si la simulation continue.
+      */
+    QString verifierArret() const;
+
+    /** abandonne la simulation lorsque la maquette ne peut pas être chargée : arrête le
+      * programme client et termine la boucle d'événements avec le code 1.
+      * \param message la cause, affichée sur la sortie d'erreur.
+      */
+    void abandonnerMaquette(const QString &message);
+
+    SimView* simView;
+    ChargeurMaquette chargeur;
+    QTimer* timer;
+    bool verbeux;
+    qreal dureeMax;
+    int nbToursMax;
+    int pasParSeconde;
+    QMap<int, int> contactsTour;
+    QString raisonArret;
+};
+
+#endif // SIMBATCH_H
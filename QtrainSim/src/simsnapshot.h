@@ -0,0 +1,32 @@
+#ifndef SIMSNAPSHOT_H
+#define SIMSNAPSHOT_H
+
+#include <QPointF>
+#include <QVector>
+
+/** Pose d'une loco à la fin d'un pas de simulation.
+  */
+struct PoseLoco
+{
+    int numLoco;
+    QPointF position;
+    qreal rotation;
+    bool active;
+    bool alerteProximite;
+};
+
+/** Instantané de l'état de la simulation, pris après chaque série de pas. L'affichage
+  * interpole la pose des locos entre les deux derniers instantanés.
+  * La simulation et l'affichage se partagent le thread de l'interface : les instantanés
+  * ne sont jamais lus pendant leur écriture.
+  */
+struct SimSnapshot
+{
+    //! numéro du dernier pas de simulation effectué.
+    quint64 numeroPas{0};
+    //! instant de publication, en millisecondes depuis le démarrage de la simulation.
+    qint64 instant{0};
+    QVector<PoseLoco> locos;
+};
+
+#endif // SIMSNAPSHOT_H
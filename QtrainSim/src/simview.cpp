@@ -1,17 +1,45 @@
+#include <QGuiApplication>
+#include <QScreen>
+#include <QLineF>
+
+#include <utility>
+
 #include "simview.h"
+#include "graphevoies.h"
+#include "trainsimsettings.h"
+#include "metriques.h"
+
+//! identifie les états sauvegardés par SimView::sauvegarderEtat().
+#define ETAT_MAGIQUE 0x51545345
+#define ETAT_VERSION 1
 
 SimView::SimView(QWidget */*parent*/)
-    : QGraphicsView()
+    : QGraphicsView(),
+      fenetreOccupation(NB_TRANCHES_CARTE_OCCUPATION, DUREE_TRANCHE_CARTE_OCCUPATION_MS)
 {
     scene = new QGraphicsScene();
     this->setScene(scene);
     this->setRenderHints(QPainter::Antialiasing);
     timer = new QTimer(this);
-    CONNECT(timer, SIGNAL(timeout()), this, SLOT(animationStep()));
+    CONNECT(timer, SIGNAL(timeout()), this, SLOT(animationTick()));
+    timerAffichage = new QTimer(this);
+    CONNECT(timerAffichage, SIGNAL(timeout()), this, SLOT(rafraichirAffichage()));
+    dernierInstant = 0;
+    accumulateur = 0.0;
+    numeroPas = 0;
+    alimentee = true;
+    suspendue = false;
+    urgence = false;
+    demandeUrgence.storeRelease(-1);
+    modeCarte = CarteMasquee;
+    trancheAffichee = 0;
 }
 
 void SimView::redraw()
 {
+    foreach(Contact* c, contacts)
+        c->actualiserNumero();
+
     scene->update(sceneRect());
 }
 
@@ -20,6 +48,10 @@ void SimView::addVoie(Voie *v, int ID)
     this->Voies.insert(ID, v);
     this->scene->addItem(v);
     v->setVisible(true);
+
+    // Les voies fixes sont dessinées par drawBackground(), depuis le cache.
+    if(v->estFixe())
+        v->setFlag(QGraphicsItem::ItemHasNoContents);
 }
 
 void SimView::addContact(Contact *c, int ID)
@@ -47,47 +79,205 @@ void SimView::construireMaquette()
 {
     this->premiereVoie->calculerAnglesEtCoordonnees();
 
-    this->premiereVoie->calculerPosition();
+    ecartsFermeture.clear();
+    this->premiereVoie->calculerPosition(nullptr, &ecartsFermeture);
+
+    invaliderCacheVoies();
 }
 
 void SimView::viderMaquette()
 {
+    emit maquetteAVider();
+
     foreach(Voie* v, this->Voies)
         delete v;
 
     this->Voies.clear();
+    ecartsFermeture.clear();
+
+    invaliderCacheVoies();
+    statistiques.reinitialiser();
+    arretsProgrammes.clear();
+    alertesCollision.clear();
+    urgence = false;
+    demandeUrgence.storeRelease(-1);
+}
+
+void SimView::invaliderCacheVoies()
+{
+    cacheVoies.clear();
+    ordreCacheVoies.clear();
+    zoneVoiesFixes = QRectF();
+    viewport()->update();
+}
+
+void SimView::dessinerVoiesFixes(QPainter *painter)
+{
+    foreach(Voie* v, this->Voies)
+    {
+        if(!v->estFixe())
+            continue;
+
+        painter->save();
+        painter->setTransform(v->sceneTransform(), true);
+        v->paint(painter, nullptr, nullptr);
+        painter->restore();
+    }
+}
+
+void SimView::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+
+    if(Voies.isEmpty())
+        return;
+
+    if(zoneVoiesFixes.isNull())
+    {
+        foreach(Voie* v, this->Voies)
+        {
+            if(v->estFixe())
+                zoneVoiesFixes |= v->sceneBoundingRect();
+        }
+    }
+
+    // La vue ne fait que des mises à l'échelle : m11() est le niveau de zoom.
+    qreal echelle = transform().m11();
+    QSize taille = (zoneVoiesFixes.size() * echelle).toSize();
+
+    // Impression, ou zoom trop grand pour une image : dessin direct.
+    if(painter->device() != viewport() || qint64(taille.width()) * taille.height() > TAILLE_MAX_CACHE_VOIES)
+    {
+        dessinerVoiesFixes(painter);
+        return;
+    }
+
+    int cle = qRound(echelle * 1000.0);
+
+    if(!cacheVoies.contains(cle))
+    {
+        if(ordreCacheVoies.size() >= NB_MAX_CACHE_VOIES)
+            cacheVoies.remove(ordreCacheVoies.takeFirst());
+
+        QPixmap image(taille);
+        image.fill(Qt::transparent);
+
+        QPainter painterImage(&image);
+        painterImage.setRenderHints(renderHints());
+        painterImage.scale(echelle, echelle);
+        painterImage.translate(- zoneVoiesFixes.topLeft());
+        dessinerVoiesFixes(&painterImage);
+        painterImage.end();
+
+        cacheVoies.insert(cle, image);
+        ordreCacheVoies.append(cle);
+    }
+
+    // Seule la partie exposée de l'image est copiée.
+    QRectF cible = rect & zoneVoiesFixes;
+    if(cible.isEmpty())
+        return;
+
+    QRectF source((cible.topLeft() - zoneVoiesFixes.topLeft()) * echelle, cible.size() * echelle);
+    painter->drawPixmap(cible, cacheVoies.value(cle), source);
+}
+
+void SimView::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    if(modeCarte == CarteMasquee || Voies.isEmpty())
+        return;
+
+    if(tracesSegments.size() != segments.size())
+    {
+        tracesSegments.clear();
+        foreach(Segment* s, segments)
+            tracesSegments.append(s->getTrace());
+    }
+
+    trancheAffichee = fenetreOccupation.getNumeroTranche();
+    qreal duree = fenetreOccupation.getDuree();
+    if(duree <= 0.0)
+        return;
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    qreal marge = LARGEUR_CARTE_OCCUPATION / 2.0;
+
+    for(int i = 0; i < tracesSegments.size(); i++)
+    {
+        const QPainterPath &trace = tracesSegments.at(i);
+        if(!trace.controlPointRect().adjusted(-marge, -marge, marge, marge).intersects(rect))
+            continue;
+
+        // l'attente est rapportée à la durée de la fenêtre : 1 correspond à une loco
+        // arrêtée sur le segment pendant toute la fenêtre.
+        qreal valeur = modeCarte == CarteOccupation ? fenetreOccupation.getTauxOccupation(i)
+                                                     : qMin(1.0, fenetreOccupation.getAttente(i) / duree);
+        if(valeur <= 0.0)
+            continue;
+
+        // du vert, peu utilisé, au rouge, saturé.
+        QColor couleur = QColor::fromHsvF((1.0 - valeur) / 3.0, 1.0, 1.0, 0.6);
+        painter->setPen(QPen(couleur, LARGEUR_CARTE_OCCUPATION, Qt::SolidLine, Qt::FlatCap, Qt::RoundJoin));
+        painter->drawPath(trace);
+    }
+
+    painter->restore();
+}
+
+void SimView::setCarteOccupation(ModeCarteOccupation mode)
+{
+    // les compteurs ne sont pas tenus carte masquée : ils repartent de zéro.
+    if(modeCarte == CarteMasquee && mode != CarteMasquee)
+        fenetreOccupation.reinitialiser(segments.size());
+
+    modeCarte = mode;
+    viewport()->update();
 }
 
 void SimView::genererSegments()
 {
+    qDeleteAll(segments);
+    segments.clear();
+    voiesSegments.clear();
+
+    GrapheVoies graphe(this->Voies);
+    QVector<int> chemins;
+    QVector<int> fins;
+
     for(int i = 1; i <= this->contacts.size(); i++)
     {
-        QList<QList<Voie*>*> parcours;
-        parcours = this->Voies.value(contacts.value(i)->getNumVoiePorteuse())->startExplorationContactAContact();
+        Contact* depart = contacts.value(i);
+        chemins.clear();
+        fins.clear();
+        graphe.explorerDepuis(graphe.indice(this->Voies.value(depart->getNumVoiePorteuse())), chemins, fins);
 
-        foreach(QList<Voie*>* lv, parcours)
+        int debut = 0;
+        foreach(int fin, fins)
         {
-            if(lv->last()->getContact() != nullptr)
-            {
-                if(contacts.key(lv->first()->getContact()) < contacts.key(lv->last()->getContact()))
-                {
-                    segments.append(new Segment(lv->first()->getContact(), lv->last()->getContact(), *lv));
-                }
-            }
-            else
+            Contact* arrivee = graphe.voie(chemins.at(fin - 1))->getContact();
+
+            // chaque segment entre deux contacts est trouvé depuis ses deux extrémités,
+            // il n'est gardé que depuis le contact de plus petit numéro.
+            // Les segments entre un contact et une voie buttoir sont tous gardés.
+            if(arrivee == nullptr || depart->getNumContact() < arrivee->getNumContact())
             {
-                //gestion de segments entre un contact et une voie buttoir...
-                segments.append(new Segment(lv->first()->getContact(), nullptr, *lv));
+                const int premiere = voiesSegments.size();
+                for(int j = debut; j < fin; j++)
+                    voiesSegments.append(graphe.voie(chemins.at(j)));
+                segments.append(new Segment(depart, arrivee, &voiesSegments, premiere, fin - debut));
             }
-        }
-
-        // On détruit les QList*
-        while (!parcours.isEmpty()) {
-            QList<Voie*> *l = parcours.at(0);
-            delete l;
-            parcours.pop_front();
+            debut = fin;
         }
     }
+
+    indicesSegments.clear();
+    for(int i = 0; i < segments.size(); i++)
+        indicesSegments.insert(segments.at(i), i);
+    tracesSegments.clear();
+    fenetreOccupation.reinitialiser(segments.size());
 }
 
 void SimView::addLoco(Loco *l, int ID)
@@ -98,6 +288,7 @@ void SimView::addLoco(Loco *l, int ID)
     CONNECT(l, SIGNAL(nouveauSegment(Contact*,Contact*,Loco*)), this, SLOT(locoSurNouveauSegment(Contact*,Contact*,Loco*)));
     CONNECT(this, SIGNAL(locoSurSegment(Segment*)), l, SLOT(locoSurSegment(Segment*)));
     CONNECT(this, SIGNAL(notificationVoieVariableModifiee(Voie*)), l, SLOT(voieVariableModifiee(Voie*)));
+    CONNECT(l, SIGNAL(deraillement(Loco*)), this, SLOT(locoDeraillee(Loco*)));
 
     peintLocos();
 }
@@ -195,7 +386,15 @@ Segment* SimView::getSegmentByContacts(int contactA, int contactB)
 
 void SimView::animationStart()
 {
+    horloge.start();
+    dernierInstant = 0;
+    accumulateur = 0.0;
     timer->start(1000/FRAME_RATE);
+
+    qreal frequenceEcran = FRAME_RATE;
+    if(QGuiApplication::primaryScreen() != nullptr)
+        frequenceEcran = QGuiApplication::primaryScreen()->refreshRate();
+    timerAffichage->start(qMax(1, qRound(1000.0 / frequenceEcran)));
 }
 
 
@@ -229,110 +428,676 @@ protected:
 
 #endif // WITHSOUND
 
-void SimView::animationStep()
+/** Tâche exécutée par le pool de threads de la simulation.
+  */
+class TacheSimulation : public QRunnable
 {
-    QList<Loco*> listeLocos = this->Locos.values();
+public:
+    explicit TacheSimulation(const std::function<void()> &tache)
+        : tache(tache)
+    {
+        setAutoDelete(true);
+    }
 
-    bool tropProche;
+    void run() override
+    {
+        tache();
+    }
+
+private:
+    std::function<void()> tache;
+};
+
+int SimView::executerEnParallele(int nbElements, const std::function<void(int, int, int)> &traitement)
+{
+    int nbThreads = TrainSimSettings::getInstance()->getNbThreadsSimulation();
+    if (nbThreads == 0)
+        nbThreads = QThread::idealThreadCount();
 
-    QList<Voie*> prochainesVoies;
+    int nbTranches = qMin(nbThreads, nbElements / NB_LOCOS_PAR_TRANCHE);
 
-    foreach(Loco* l, listeLocos)
+    if (nbTranches <= 1)
     {
-        if(l->getActive() && l->getVoie() != nullptr)
-        {
-            if(l->getVitesse() != 0)
-                l->avancer((l->getVitesse() * 1000.0 / FRAME_RATE) * FACTEUR_VITESSE);
+        traitement(0, nbElements, 0);
+        return 1;
+    }
+
+    // Le thread appelant traite la première tranche, le pool les suivantes.
+    for (int t = 1; t < nbTranches; t++)
+    {
+        int debut = t * nbElements / nbTranches;
+        int fin = (t + 1) * nbElements / nbTranches;
+        poolSimulation.start(new TacheSimulation([=, &traitement]() {
+            traitement(debut, fin, t);
+        }));
+    }
+    traitement(0, nbElements / nbTranches, 0);
+    poolSimulation.waitForDone();
+
+    return nbTranches;
+}
+
+void SimView::deplacerLocos(const QList<Loco*> &locos)
+{
+    // Les locos modifient la scène et l'état des voies qu'elles parcourent:
+    // cette phase reste dans le thread de l'interface.
+    if(!alimentee || urgence)
+        return;
 
-            QPolygonF contourLoco = l->getContour();
-            QPolygonF contourAutreLoco;
-            //test de collision
-            foreach(Loco* otherLoco, listeLocos)
+    const LocoStore* store = LocoStore::getInstance();
+
+    foreach(Loco* l, locos)
+    {
+        if(!l->getActive() || l->getVoie() == nullptr)
+            continue;
+
+        l->avancerTemps(PAS_SIMULATION_MS);
+
+        if(l->getVitesse() == 0)
+            continue;
+
+        int n = l->getNumero();
+        qreal distance = (l->getVitesse() * 1000.0 / FRAME_RATE) * FACTEUR_VITESSE * store->facteurVitesse[n];
+
+        // la loco s'arrête juste avant le contact programmé si elle l'atteignait pendant ce pas.
+        if(arretsProgrammes.contains(n))
+        {
+            qreal reste = distanceJusquAuContact(n, arretsProgrammes.value(n));
+            if(reste >= 0.0 && reste <= distance)
             {
-                if(l != otherLoco)
-                {
-                    contourAutreLoco = otherLoco->getContour();
-
-                    if(contourLoco.subtracted(contourAutreLoco) != contourLoco)
-                    {
-                        animationStop();
-                        l->setActive(false);
-                        otherLoco->setActive(false);
-                        ExplosionItem *item=new ExplosionItem();
-                        QPixmap img(":images/explosion.png");
-                        item->setPixmap(img);
-                        scene->addItem(item);
-                        QPointF debPoint((l->pos().x()+otherLoco->pos().x())/2,
-                                    (l->pos().y()+otherLoco->pos().y())/2);
-                        QPointF endPoint((l->pos().x()+otherLoco->pos().x())/2-256,
-                                    (l->pos().y()+otherLoco->pos().y())/2-256);
-                        item->setPos(endPoint);
-
-                        QPropertyAnimation *animation1=new QPropertyAnimation(item, "pos");
-                        animation1->setDuration(500);
-                        animation1->setStartValue(debPoint);
-                        animation1->setEndValue(endPoint);
-
-                        QPropertyAnimation *animation2=new QPropertyAnimation(item, "scale");
-                        animation2->setDuration(500);
-                        animation2->setStartValue(0.0);
-                        animation2->setEndValue(1.0);
-
-                        QParallelAnimationGroup *animationGroup=new QParallelAnimationGroup();
-
-                        animationGroup->addAnimation(animation1);
-                        animationGroup->addAnimation(animation2);
-
-                        item->setZValue(ZVAL_EXPLOSION);
-                        item->show();
-                        animationGroup->start();
-#ifdef WITHSOUND
-                        SoundThread *thread=new SoundThread(this);
-                        thread->start();
-#endif // WITHSOUND
-                    }
-                }
+                arretsProgrammes.remove(n);
+                l->arreterImmediatement();
+                continue;
             }
+        }
 
+        l->avancer(distance);
+    }
+}
+
+QVector<SimView::CollisionLocos> SimView::detecterCollisions(const QList<Loco*> &locos)
+{
+    int nbLocos = locos.size();
+    const LocoStore* store = LocoStore::getInstance();
 
-            //alerte proximite. Pas encore optimal.
-            qreal distanceSecurite = l->getVitesse() * 2000.0 * FACTEUR_VITESSE;
+    QVector<int> numeros(nbLocos);
+    for(int i = 0; i < nbLocos; i++)
+        numeros[i] = locos.at(i)->getNumero();
 
-            prochainesVoies.append(l->getVoie());
-            prochainesVoies.append(l->getVoieSuivante());
-            distanceSecurite -= prochainesVoies.last()->getLongueurAParcourir();
+    // Les contours sont calculés une seule fois par pas, à partir du LocoStore.
+    QVector<QPolygonF> contours(nbLocos);
+    QVector<QRectF> englobants(nbLocos);
+    QVector<bool> placees(nbLocos);
+    QVector<bool> actives(nbLocos);
 
-            while(distanceSecurite > 0)
+    executerEnParallele(nbLocos, [&](int debut, int fin, int /*tranche*/) {
+        for(int i = debut; i < fin; i++)
+        {
+            int n = numeros.at(i);
+            placees[i] = store->voieActuelle[n] != nullptr;
+            actives[i] = placees[i] && store->active[n];
+            if(placees[i])
             {
-                prochainesVoies.append(prochainesVoies.last()->getVoieSuivante(prochainesVoies.at(prochainesVoies.length()-2)));
-                distanceSecurite -= prochainesVoies.last()->getLongueurAParcourir();
+                contours[i] = store->getContour(n);
+                englobants[i] = contours[i].boundingRect();
             }
+        }
+    });
 
-            tropProche = false;
+    // Chaque ligne i n'est écrite que par une seule tranche.
+    QVector<QVector<int>> collisionsParLoco(nbLocos);
 
-            foreach(Voie* v, prochainesVoies)
+    executerEnParallele(nbLocos, [&](int debut, int fin, int /*tranche*/) {
+        for(int i = debut; i < fin; i++)
+        {
+            if(!placees[i])
+                continue;
+            for(int j = i + 1; j < nbLocos; j++)
             {
-                foreach(Loco* autreLoco, listeLocos)
+                if(!placees[j] || (!actives[i] && !actives[j]))
+                    continue;
+                if(!englobants[i].intersects(englobants[j]))
+                    continue;
+                if(contours[i].subtracted(contours[j]) != contours[i])
+                    collisionsParLoco[i].append(j);
+            }
+        }
+    });
+
+    // Fusion déterministe, dans l'ordre des numéros de locos.
+    QVector<CollisionLocos> collisions;
+    for(int i = 0; i < nbLocos; i++)
+    {
+        foreach(int j, collisionsParLoco.at(i))
+            collisions.append({i, j});
+    }
+    return collisions;
+}
+
+SimView::ParcoursLoco SimView::construireParcours(int numLoco) const
+{
+    const LocoStore* store = LocoStore::getInstance();
+    ParcoursLoco parcours;
+    Voie* voie = store->voieActuelle[numLoco];
+    Voie* suivante = store->voieSuivante[numLoco];
+    if(voie == nullptr || suivante == nullptr)
+        return parcours;
+
+    if(store->active[numLoco])
+        parcours.vitesse = store->vitesse[numLoco] * 1000.0 * FACTEUR_VITESSE * store->facteurVitesse[numLoco];
+    qreal horizon = parcours.vitesse * TTC_INFORMATION + LONGUEUR_LOCO;
+
+    // la loco est entrée dans sa voie actuelle par la voie où mènerait un demi-tour.
+    qreal parcouru = QLineF(store->getPosition(numLoco), voie->getPosAbsLiaison(suivante)).length();
+    parcours.voies.append(voie);
+    parcours.provenances.append(voie->getVoieSuivante(suivante));
+    parcours.entrees.append(parcouru - voie->getLongueurAParcourir());
+
+    Voie* viensDe = voie;
+    voie = suivante;
+    for(int i = 0; (i == 0 || parcouru <= horizon) && i < Voies.size(); i++)
+    {
+        parcours.voies.append(voie);
+        parcours.provenances.append(viensDe);
+        parcours.entrees.append(parcouru);
+
+        parcouru += voie->getLongueurAParcourir();
+        suivante = voie->getVoieSuivante(viensDe);
+        if(suivante == nullptr)
+            break;
+        viensDe = voie;
+        voie = suivante;
+    }
+
+    return parcours;
+}
+
+qreal SimView::tempsAvantRattrapage(int numLoco, const ParcoursLoco &parcours, int indiceVoie,
+                                    int numAutreLoco, qreal vitesseAutre) const
+{
+    const LocoStore* store = LocoStore::getInstance();
+    Voie* voie = parcours.voies.at(indiceVoie);
+    QPointF position = store->getPosition(numAutreLoco);
+
+    // distance entre les centres des locos, le long du parcours.
+    qreal ecart;
+    if(indiceVoie == 0)
+    {
+        // sur la voie actuelle, seules les locos plus proches de la sortie sont devant.
+        QPointF sortie = voie->getPosAbsLiaison(parcours.voies.at(1));
+        ecart = QLineF(store->getPosition(numLoco), sortie).length() - QLineF(position, sortie).length();
+        if(ecart < 0.0)
+            return -1.0;
+    }
+    else
+        ecart = parcours.entrees.at(indiceVoie) + QLineF(voie->getPosAbsLiaison(parcours.provenances.at(indiceVoie)), position).length();
+
+    // l'autre loco vient en sens inverse si elle se dirige vers la provenance de la loco.
+    qreal rapprochement = parcours.vitesse;
+    Voie* provenance = parcours.provenances.at(indiceVoie);
+    if(provenance != nullptr && store->voieSuivante[numAutreLoco] == provenance)
+        rapprochement += vitesseAutre;
+    else
+        rapprochement -= vitesseAutre;
+
+    if(rapprochement <= 0.0)
+        return -1.0;
+    return qMax(0.0, ecart - LONGUEUR_LOCO) / rapprochement;
+}
+
+qreal SimView::tempsAvantJonction(const ParcoursLoco &parcours, const ParcoursLoco &autreParcours) const
+{
+    qreal tempsMin = -1.0;
+
+    for(int k = 1; k < parcours.voies.size(); k++)
+    {
+        int m = autreParcours.voies.indexOf(parcours.voies.at(k), 1);
+        // les locos qui entrent par le même côté se suivent : le rattrapage s'en charge.
+        if(m < 0 || autreParcours.provenances.at(m) == parcours.provenances.at(k))
+            continue;
+
+        // chaque loco occupe la voie de l'entrée de sa tête à la sortie de sa queue.
+        qreal longueur = parcours.voies.at(k)->getLongueurAParcourir() + LONGUEUR_LOCO / 2.0;
+        qreal debut = qMax(0.0, parcours.entrees.at(k) - LONGUEUR_LOCO / 2.0) / parcours.vitesse;
+        qreal fin = (parcours.entrees.at(k) + longueur) / parcours.vitesse;
+        qreal autreDebut = qMax(0.0, autreParcours.entrees.at(m) - LONGUEUR_LOCO / 2.0) / autreParcours.vitesse;
+        qreal autreFin = (autreParcours.entrees.at(m) + longueur) / autreParcours.vitesse;
+
+        if(debut < autreFin && autreDebut < fin)
+        {
+            qreal temps = qMax(debut, autreDebut);
+            if(tempsMin < 0.0 || temps < tempsMin)
+                tempsMin = temps;
+        }
+    }
+
+    return tempsMin;
+}
+
+int SimView::niveauAlerte(qreal temps)
+{
+    if(temps < 0.0 || temps > TTC_INFORMATION)
+        return ALERTE_AUCUNE;
+    if(temps <= TTC_DANGER)
+        return ALERTE_DANGER;
+    if(temps <= TTC_ATTENTION)
+        return ALERTE_ATTENTION;
+    return ALERTE_INFORMATION;
+}
+
+QVector<SimView::PredictionCollision> SimView::calculerAlertesCollision(const QList<Loco*> &locos)
+{
+    int nbLocos = locos.size();
+    QVector<PredictionCollision> predictions(nbLocos);
+    if(!alimentee || urgence)
+        return predictions;
+
+    const LocoStore* store = LocoStore::getInstance();
+
+    QVector<int> numeros(nbLocos);
+    QMultiHash<Voie*, int> occupation;
+    for(int i = 0; i < nbLocos; i++)
+    {
+        numeros[i] = locos.at(i)->getNumero();
+        if(store->voieActuelle[numeros.at(i)] != nullptr)
+            occupation.insert(store->voieActuelle[numeros.at(i)], i);
+    }
+
+    QVector<ParcoursLoco> parcours(nbLocos);
+    executerEnParallele(nbLocos, [&](int debut, int fin, int /*tranche*/) {
+        for(int i = debut; i < fin; i++)
+            parcours[i] = construireParcours(numeros.at(i));
+    });
+
+    executerEnParallele(nbLocos, [&](int debut, int fin, int /*tranche*/) {
+        QVector<bool> surParcours(nbLocos);
+
+        for(int i = debut; i < fin; i++)
+        {
+            const ParcoursLoco &p = parcours.at(i);
+            if(p.vitesse <= 0.0)
+                continue;
+
+            PredictionCollision &prediction = predictions[i];
+            auto retenir = [&](qreal temps, int j) {
+                if(temps >= 0.0 && temps <= TTC_INFORMATION && (prediction.autreLoco < 0 || temps < prediction.temps))
                 {
-                    if(autreLoco != l && v == autreLoco->getVoie())
-                    {
-                        tropProche = true;
-                    }
+                    prediction.autreLoco = numeros.at(j);
+                    prediction.temps = temps;
                 }
+            };
+
+            // locos se trouvant sur le parcours : rattrapage ou face à face.
+            surParcours.fill(false);
+            for(int k = 0; k < p.voies.size(); k++)
+            {
+                for(auto it = occupation.constFind(p.voies.at(k)); it != occupation.constEnd() && it.key() == p.voies.at(k); ++it)
+                {
+                    int j = it.value();
+                    if(j == i || surParcours.at(j))
+                        continue;
+                    surParcours[j] = true;
+                    retenir(tempsAvantRattrapage(numeros.at(i), p, k, numeros.at(j), parcours.at(j).vitesse), j);
+                }
+            }
+
+            // locos dont le parcours rejoint celui de la loco.
+            for(int j = 0; j < nbLocos; j++)
+            {
+                if(j != i && !surParcours.at(j) && parcours.at(j).vitesse > 0.0)
+                    retenir(tempsAvantJonction(p, parcours.at(j)), j);
             }
-            if(tropProche)
-                l->setAlerteProximite(true);
-            else
-                l->setAlerteProximite(false);
 
-            prochainesVoies.clear();
+            prediction.niveau = niveauAlerte(prediction.temps);
+        }
+    });
+
+    return predictions;
+}
+
+void SimView::signalerAlertesCollision(const QList<Loco*> &locos, const QVector<PredictionCollision> &predictions)
+{
+    for(int i = 0; i < locos.size(); i++)
+    {
+        int n = locos.at(i)->getNumero();
+        const PredictionCollision &prediction = predictions.at(i);
+        PredictionCollision precedente = alertesCollision.value(n);
+
+        // seuls les changements de niveau ou de loco sont signalés, pas l'évolution du temps.
+        if(prediction.niveau == precedente.niveau && prediction.autreLoco == precedente.autreLoco)
+            continue;
+
+        if(prediction.niveau == ALERTE_AUCUNE)
+            alertesCollision.remove(n);
+        else
+            alertesCollision.insert(n, prediction);
+        emit alerteCollision(n, prediction.autreLoco, prediction.niveau, prediction.temps);
+    }
+}
+
+void SimView::declencherCollision(Loco* l, Loco* otherLoco)
+{
+    animationStop();
+    statistiques.enregistrerCollision();
+    l->setActive(false);
+    otherLoco->setActive(false);
+    ExplosionItem *item=new ExplosionItem();
+    QPixmap img(":images/explosion.png");
+    item->setPixmap(img);
+    scene->addItem(item);
+    QPointF debPoint((l->getPosition().x()+otherLoco->getPosition().x())/2,
+                (l->getPosition().y()+otherLoco->getPosition().y())/2);
+    QPointF endPoint((l->getPosition().x()+otherLoco->getPosition().x())/2-256,
+                (l->getPosition().y()+otherLoco->getPosition().y())/2-256);
+    item->setPos(endPoint);
+
+    QPropertyAnimation *animation1=new QPropertyAnimation(item, "pos");
+    animation1->setDuration(500);
+    animation1->setStartValue(debPoint);
+    animation1->setEndValue(endPoint);
+
+    QPropertyAnimation *animation2=new QPropertyAnimation(item, "scale");
+    animation2->setDuration(500);
+    animation2->setStartValue(0.0);
+    animation2->setEndValue(1.0);
+
+    QParallelAnimationGroup *animationGroup=new QParallelAnimationGroup();
+
+    animationGroup->addAnimation(animation1);
+    animationGroup->addAnimation(animation2);
+
+    item->setZValue(ZVAL_EXPLOSION);
+    item->show();
+    animationGroup->start();
+#ifdef WITHSOUND
+    SoundThread *thread=new SoundThread(this);
+    thread->start();
+#endif // WITHSOUND
+}
+
+void SimView::animationStep()
+{
+    // Les locos sont triées par numéro : toutes les phases les traitent dans
+    // cet ordre, ce qui rend le résultat indépendant du nombre de threads.
+    if(suspendue)
+        return;
+
+    QList<Loco*> listeLocos = this->Locos.values();
+
+    numeroPas++;
+
+    // Une demande d'arrêt d'urgence faite pendant le pas précédent est appliquée
+    // avant tout déplacement, même si le signal qui la porte n'est pas encore traité.
+    appliquerArretUrgence();
+
+    deplacerLocos(listeLocos);
+
+    QVector<CollisionLocos> collisions = detecterCollisions(listeLocos);
+
+    QVector<PredictionCollision> predictions = calculerAlertesCollision(listeLocos);
+
+    for(int i = 0; i < listeLocos.size(); i++)
+    {
+        Loco* l = listeLocos.at(i);
+        if(l->getActive() && l->getVoie() != nullptr)
+            l->setAlerteProximite(predictions.at(i).niveau >= ALERTE_ATTENTION);
+    }
+
+    signalerAlertesCollision(listeLocos, predictions);
+
+    appliquerBlocMobile(listeLocos);
+
+    foreach(const CollisionLocos &c, collisions)
+    {
+        declencherCollision(listeLocos.at(c.indiceLocoA), listeLocos.at(c.indiceLocoB));
+    }
+
+    comptabiliserPas(listeLocos);
+}
+
+void SimView::appliquerBlocMobile(const QList<Loco*> &locos)
+{
+    LocoStore* store = LocoStore::getInstance();
+
+    QMultiHash<Voie*, int> occupation;
+    bool blocMobile = false;
+    foreach(Loco* l, locos)
+    {
+        int n = l->getNumero();
+        // Une loco en pause ou accidentée reste un obstacle.
+        if(store->voieActuelle[n] != nullptr)
+            occupation.insert(store->voieActuelle[n], n);
+        blocMobile = blocMobile || store->blocMobile[n];
+    }
+
+    if(!blocMobile || !alimentee)
+        return;
+
+    foreach(Loco* l, locos)
+    {
+        int n = l->getNumero();
+        if(!store->blocMobile[n] || !store->active[n] || store->inverser[n] ||
+           store->voieActuelle[n] == nullptr || store->voieSuivante[n] == nullptr)
+            continue;
+
+        // vitesse la plus élevée, jusqu'à la consigne, permettant de s'arrêter à temps.
+        int vitesse = store->consigne[n];
+        qreal libre = distanceLibre(n, occupation, distanceFreinage(n, vitesse) + MARGE_BLOC_MOBILE);
+        if(libre >= 0.0)
+        {
+            while(vitesse > 0 && distanceFreinage(n, vitesse) + MARGE_BLOC_MOBILE > libre)
+                vitesse--;
+        }
+
+        if(vitesse != store->vitesseFuture[n])
+            l->limiterVitesse(vitesse);
+    }
+}
+
+qreal SimView::distanceLibre(int numLoco, const QMultiHash<Voie*, int> &occupation, qreal horizon)
+{
+    const LocoStore* store = LocoStore::getInstance();
+    QPointF position = store->getPosition(numLoco);
+    Voie* viensDe = store->voieActuelle[numLoco];
+    Voie* voie = store->voieSuivante[numLoco];
+
+    // sur la voie actuelle, seules les locos plus proches de la sortie sont devant.
+    QPointF sortie = viensDe->getPosAbsLiaison(voie);
+    qreal parcouru = QLineF(position, sortie).length();
+    qreal plusProche = -1.0;
+    for(auto it = occupation.constFind(viensDe); it != occupation.constEnd() && it.key() == viensDe; ++it)
+    {
+        qreal ecart = parcouru - QLineF(store->getPosition(it.value()), sortie).length();
+        if(it.value() != numLoco && ecart >= 0.0 && (plusProche < 0.0 || ecart < plusProche))
+            plusProche = ecart;
+    }
+
+    // puis voie par voie, jusqu'à la première loco ou jusqu'à l'horizon.
+    for(int i = 0; plusProche < 0.0 && parcouru - LONGUEUR_LOCO <= horizon && i < Voies.size(); i++)
+    {
+        QPointF entree = voie->getPosAbsLiaison(viensDe);
+        for(auto it = occupation.constFind(voie); it != occupation.constEnd() && it.key() == voie; ++it)
+        {
+            qreal ecart = parcouru + QLineF(entree, store->getPosition(it.value())).length();
+            if(it.value() != numLoco && (plusProche < 0.0 || ecart < plusProche))
+                plusProche = ecart;
+        }
+
+        parcouru += voie->getLongueurAParcourir();
+        Voie* suivante = voie->getVoieSuivante(viensDe);
+        if(suivante == nullptr)
+            break;
+        viensDe = voie;
+        voie = suivante;
+    }
+
+    // les positions sont celles des centres des locos.
+    if(plusProche < 0.0)
+        return -1.0;
+    return qMax(0.0, plusProche - LONGUEUR_LOCO);
+}
+
+qreal SimView::distanceFreinage(int numLoco, int vitesse) const
+{
+    const LocoStore* store = LocoStore::getInstance();
+    qreal distanceParSeconde = 1000.0 * FACTEUR_VITESSE * store->facteurVitesse[numLoco];
+
+    // le pas en cours est parcouru avant que la nouvelle vitesse soit appliquée.
+    qreal distance = vitesse * distanceParSeconde / FRAME_RATE;
+    if(TrainSimSettings::getInstance()->getInertie())
+        distance += distanceParSeconde * (INERTIE_LOCO / 1000.0) * vitesse * (vitesse + 1) / 2.0;
+    return distance;
+}
+
+void SimView::comptabiliserPas(const QList<Loco*> &locos)
+{
+    LocoStore* store = LocoStore::getInstance();
+    QList<Segment*> segmentsOccupes;
+    const bool carte = modeCarte != CarteMasquee;
+
+    statistiques.enregistrerPas(PAS_SIMULATION_MS);
+    if(carte)
+        fenetreOccupation.enregistrerPas(PAS_SIMULATION_MS);
+
+    foreach(Loco* l, locos)
+    {
+        int n = l->getNumero();
+        if(!store->presente[n] || store->voieActuelle[n] == nullptr)
+            continue;
+
+        Segment* s = store->segmentActuel[n];
+        if(!store->active[n] || store->vitesse[n] == 0)
+        {
+            statistiques.ajouterTempsArret(n, PAS_SIMULATION_MS);
+            if(carte && s != nullptr)
+                fenetreOccupation.ajouterAttente(indicesSegments.value(s), PAS_SIMULATION_MS);
         }
+
+        if(s != nullptr && !segmentsOccupes.contains(s))
+            segmentsOccupes.append(s);
+    }
+
+    foreach(Segment* s, segmentsOccupes)
+    {
+        int contactA = s->getContact1() != nullptr ? s->getContact1()->getNumContact() : 0;
+        int contactB = s->getContact2() != nullptr ? s->getContact2()->getNumContact() : 0;
+        statistiques.ajouterOccupation(qMin(contactA, contactB), qMax(contactA, contactB), PAS_SIMULATION_MS);
+        if(carte)
+            fenetreOccupation.ajouterOccupation(indicesSegments.value(s), PAS_SIMULATION_MS);
+    }
+}
+
+void SimView::animationTick()
+{
+    qint64 maintenant = horloge.elapsed();
+    accumulateur += maintenant - dernierInstant;
+    dernierInstant = maintenant;
+
+    int nbPas = 0;
+
+    // animationStep() arrête le timer en cas de collision.
+    while(accumulateur >= PAS_SIMULATION_MS && nbPas < MAX_PAS_RATTRAPAGE && timer->isActive())
+    {
+        animationStep();
+        accumulateur -= PAS_SIMULATION_MS;
+        nbPas++;
+    }
+
+    if(nbPas == MAX_PAS_RATTRAPAGE)
+        accumulateur = 0.0;
+
+    if(nbPas > 0)
+        publierSnapshot(maintenant);
+}
+
+void SimView::publierSnapshot(qint64 instant)
+{
+    // l'instantané le plus ancien est réutilisé, pour garder ses allocations.
+    std::swap(snapshotPrecedent, snapshotCourant);
+    SimSnapshot &snapshot = snapshotCourant;
+
+    snapshot.numeroPas = numeroPas;
+    snapshot.instant = instant;
+    snapshot.locos.clear();
+
+    QMapIterator<int, Loco*> itLocos(Locos);
+    while(itLocos.hasNext())
+    {
+        itLocos.next();
+        Loco* l = itLocos.value();
+        snapshot.locos.append({itLocos.key(), l->getPosition(), l->getOrientation(), l->getActive(), l->getAlerteProximite()});
     }
 }
 
+void SimView::rafraichirAffichage()
+{
+    // Rafraîchit les contacts dont l'état d'attente a changé depuis leur dernier
+    // affichage. Les threads en attente ne touchent pas à la scène.
+    QMapIterator<int, Contact*> itContacts(contacts);
+    while(itContacts.hasNext())
+    {
+        itContacts.next();
+        bool attente = itContacts.value()->estEnAttente();
+        if(attente != attentesAffichees.value(itContacts.key(), false))
+        {
+            attentesAffichees.insert(itContacts.key(), attente);
+            itContacts.value()->update();
+        }
+    }
+
+    const SimSnapshot &dernier = snapshotCourant;
+
+    qreal intervalle = dernier.instant - snapshotPrecedent.instant;
+    qreal alpha = 1.0;
+    if(intervalle > 0.0)
+        alpha = qBound(0.0, (horloge.elapsed() - dernier.instant) / intervalle, 1.0);
+
+    // Au-delà de cette distance entre deux instantanés, la loco a été replacée :
+    // elle est affichée directement à sa nouvelle pose.
+    qreal sautMax = VITESSE_MAXIMUM * PAS_SIMULATION_MS * FACTEUR_VITESSE * MAX_PAS_RATTRAPAGE;
+
+    for(int i = 0; i < dernier.locos.size(); i++)
+    {
+        const PoseLoco &pose = dernier.locos.at(i);
+        Loco* l = Locos.value(pose.numLoco);
+        if(l == nullptr)
+            continue;
+
+        // Les locos sont publiées dans l'ordre des numéros : l'indice est le même
+        // d'un instantané à l'autre, sauf si une loco a été ajoutée entre temps.
+        if(i >= snapshotPrecedent.locos.size() || snapshotPrecedent.locos.at(i).numLoco != pose.numLoco)
+        {
+            l->setPoseAffichee(pose.position, pose.rotation);
+            continue;
+        }
+
+        const PoseLoco &avant = snapshotPrecedent.locos.at(i);
+        QPointF delta = pose.position - avant.position;
+        qreal deltaAngle = pose.rotation - avant.rotation;
+        while(deltaAngle > 180.0)
+            deltaAngle -= 360.0;
+        while(deltaAngle < -180.0)
+            deltaAngle += 360.0;
+
+        if(delta.manhattanLength() > sautMax || deltaAngle > 90.0 || deltaAngle < -90.0)
+            l->setPoseAffichee(pose.position, pose.rotation);
+        else
+            l->setPoseAffichee(avant.position + delta * alpha, avant.rotation + deltaAngle * alpha);
+    }
+
+    // la carte d'occupation n'est redessinée qu'à chaque nouvelle tranche de sa fenêtre.
+    if(modeCarte != CarteMasquee && fenetreOccupation.getNumeroTranche() != trancheAffichee)
+        viewport()->update();
+}
+
 void SimView::animationStop()
 {
     timer->stop();
+    timerAffichage->stop();
+
+    // A l'arrêt, les locos sont affichées à leur pose de simulation.
+    foreach(Loco* l, Locos)
+        l->afficherPoseSimulation();
 }
 
 void SimView::setLoco(int contactA, int contactB, int numLoco, int vitesseLoco)
@@ -350,24 +1115,26 @@ void SimView::setLoco(int contactA, int contactB, int numLoco, int vitesseLoco)
 
     Loco* l = this->Locos.value(numLoco);
 
-    this->Locos.value(numLoco)->setVitesse(vitesseLoco);
+    this->Locos.value(numLoco)->setConsigne(vitesseLoco);
 
     l->setVoie(v);
 
     l->setVoieSuivante(contactA > contactB ? s->getSuivantMilieu() : s->getPrecedentMilieu());
 
-    l->setPos(v->pos());
+    l->setPosition(v->pos());
 
     if(l->getVoieSuivante() == l->getVoie()->getVoieVoisineDOrdre(0))
     {
-        l->setRotation(l->rotation() - v->getAngleDeg(0));
+        l->setOrientation(l->getOrientation() - v->getAngleDeg(0));
         l->setAngleCumule(l->getAngleCumule() + v->getAngleDeg(0));
     }
     else
     {
-        l->setRotation(l->rotation() + (- v->getAngleDeg(0) - 180.0) < 0.0 ? (- v->getAngleDeg(0) + 180.0) : (- v->getAngleDeg(0) - 180.0));
+        l->setOrientation(l->getOrientation() + (- v->getAngleDeg(0) - 180.0) < 0.0 ? (- v->getAngleDeg(0) + 180.0) : (- v->getAngleDeg(0) - 180.0));
         l->setAngleCumule(l->getAngleCumule() + ((v->getAngleDeg(0) - 180.0) < 0.0 ? (v->getAngleDeg(0) + 180.0) : (v->getAngleDeg(0) - 180.0)));
     }
+
+    l->afficherPoseSimulation();
 }
 
 void SimView::askLoco(int /*contactA*/, int /*contactB*/)
@@ -379,7 +1146,7 @@ void SimView::setVitesseLoco(int numLoco, int vitesseLoco)
 {
     if (!checkLoco(numLoco))
         return;
-    this->Locos.value(numLoco)->setVitesse(vitesseLoco);
+    this->Locos.value(numLoco)->setConsigne(vitesseLoco);
 }
 
 void SimView::reverseLoco(int numLoco)
@@ -393,14 +1160,14 @@ void SimView::setVitesseProgressiveLoco(int numLoco, int vitesseLoco)
 {
     if (!checkLoco(numLoco))
         return;
-    this->Locos.value(numLoco)->setVitesse(vitesseLoco); //similaire à setVitesseLoco!
+    this->Locos.value(numLoco)->setConsigne(vitesseLoco); //similaire à setVitesseLoco!
 }
 
 void SimView::stopLoco(int numLoco)
 {
     if (!checkLoco(numLoco))
         return;
-    this->Locos.value(numLoco)->setVitesse(0);
+    this->Locos.value(numLoco)->setConsigne(0);
 }
 
 void SimView::setVoieVariable(int numVoieVariable, int direction)
@@ -413,6 +1180,341 @@ void SimView::setVoieVariable(int numVoieVariable, int direction)
 void SimView::locoSurNouveauSegment(Contact *ctc1, Contact *ctc2, Loco *l)
 {
     l->setSegmentActuel(getSegmentByContacts(contacts.key(ctc1), contacts.key(ctc2)));
+    statistiques.enregistrerPassageContact(l->getNumero(), ctc1->getNumContact());
+    emit passageContact(l->getNumero(), ctc1->getNumContact());
+}
+
+void SimView::setFacteurVitesseLoco(int numLoco, qreal facteur)
+{
+    if (!checkLoco(numLoco))
+        return;
+    LocoStore::getInstance()->facteurVitesse[numLoco] = qMax(0.0, facteur);
+}
+
+void SimView::setAlimentation(bool alimentee)
+{
+    this->alimentee = alimentee;
+}
+
+void SimView::demanderArretUrgence(qint64 instant)
+{
+    if (!demandeUrgence.testAndSetOrdered(-1, instant))
+        return;
+    QMetaObject::invokeMethod(this, "appliquerArretUrgence", Qt::QueuedConnection);
+}
+
+void SimView::appliquerArretUrgence()
+{
+    qint64 demande = demandeUrgence.fetchAndStoreOrdered(-1);
+    if (demande < 0)
+        return;
+
+    urgence = true;
+    foreach(Loco* l, Locos)
+        l->arreterImmediatement();
+    arretsProgrammes.clear();
+
+    qint64 latence = Metriques::maintenant() - demande;
+    statistiques.enregistrerArretUrgence(latence);
+    emit arretUrgence(latence);
+}
+
+void SimView::leverArretUrgence()
+{
+    urgence = false;
+}
+
+void SimView::setPauseLoco(int numLoco, bool enPause)
+{
+    if (!checkLoco(numLoco) || locosEnPause.contains(numLoco) == enPause)
+        return;
+
+    if (enPause)
+        locosEnPause.insert(numLoco);
+    else
+        locosEnPause.remove(numLoco);
+    Locos.value(numLoco)->setActive(!enPause);
+    emit pauseLoco(numLoco, enPause);
+}
+
+void SimView::setSuspendue(bool suspendue)
+{
+    this->suspendue = suspendue;
+}
+
+namespace {
+
+/** état d'une loco tel qu'il est sauvegardé, les voies et le segment étant repérés
+  * par leur identifiant.
+  */
+struct EtatLoco
+{
+    qint32 numero;
+    qreal x, y, orientation, angleCumule, cosCap, sinCap;
+    qreal angleCourbe, cosDemiAngleCourbe, sinDemiAngleCourbe;
+    qreal tempsInertie, facteurVitesse;
+    qint32 vitesse, vitesseFuture, consigne, direction;
+    qint32 voieActuelle, voieSuivante, segmentActuel;
+    bool presente, active, alerteProximite, inverser, deraille, inertieEnCours, blocMobile;
+};
+
+QDataStream& operator<<(QDataStream &flux, const EtatLoco &e)
+{
+    return flux << e.numero << e.x << e.y << e.orientation << e.angleCumule << e.cosCap << e.sinCap
+                << e.angleCourbe << e.cosDemiAngleCourbe << e.sinDemiAngleCourbe
+                << e.tempsInertie << e.facteurVitesse
+                << e.vitesse << e.vitesseFuture << e.consigne << e.direction
+                << e.voieActuelle << e.voieSuivante << e.segmentActuel
+                << e.presente << e.active << e.alerteProximite << e.inverser << e.deraille
+                << e.inertieEnCours << e.blocMobile;
+}
+
+QDataStream& operator>>(QDataStream &flux, EtatLoco &e)
+{
+    return flux >> e.numero >> e.x >> e.y >> e.orientation >> e.angleCumule >> e.cosCap >> e.sinCap
+                >> e.angleCourbe >> e.cosDemiAngleCourbe >> e.sinDemiAngleCourbe
+                >> e.tempsInertie >> e.facteurVitesse
+                >> e.vitesse >> e.vitesseFuture >> e.consigne >> e.direction
+                >> e.voieActuelle >> e.voieSuivante >> e.segmentActuel
+                >> e.presente >> e.active >> e.alerteProximite >> e.inverser >> e.deraille
+                >> e.inertieEnCours >> e.blocMobile;
+}
+
+} // namespace
+
+QByteArray SimView::sauvegarderEtat()
+{
+    const LocoStore* store = LocoStore::getInstance();
+
+    QByteArray etat;
+    QDataStream flux(&etat, QIODevice::WriteOnly);
+    flux << quint32(ETAT_MAGIQUE) << quint16(ETAT_VERSION);
+    flux << quint64(numeroPas) << alimentee << urgence;
+
+    flux << qint32(Locos.size());
+    for(QMap<int, Loco*>::const_iterator it = Locos.constBegin(); it != Locos.constEnd(); ++it)
+    {
+        int n = it.key();
+        EtatLoco e;
+        e.numero = n;
+        e.x = store->x[n];
+        e.y = store->y[n];
+        e.orientation = store->orientation[n];
+        e.angleCumule = store->angleCumule[n];
+        e.cosCap = store->cosCap[n];
+        e.sinCap = store->sinCap[n];
+        e.angleCourbe = store->angleCourbe[n];
+        e.cosDemiAngleCourbe = store->cosDemiAngleCourbe[n];
+        e.sinDemiAngleCourbe = store->sinDemiAngleCourbe[n];
+        e.tempsInertie = store->tempsInertie[n];
+        e.facteurVitesse = store->facteurVitesse[n];
+        e.vitesse = store->vitesse[n];
+        e.vitesseFuture = store->vitesseFuture[n];
+        e.consigne = store->consigne[n];
+        e.direction = store->direction[n];
+        e.voieActuelle = Voies.key(store->voieActuelle[n], -1);
+        e.voieSuivante = Voies.key(store->voieSuivante[n], -1);
+        e.segmentActuel = segments.indexOf(store->segmentActuel[n]);
+        e.presente = store->presente[n];
+        e.active = store->active[n];
+        e.alerteProximite = store->alerteProximite[n];
+        e.inverser = store->inverser[n];
+        e.deraille = store->deraille[n];
+        e.inertieEnCours = store->inertieEnCours[n];
+        e.blocMobile = store->blocMobile[n];
+        flux << e;
+    }
+
+    QMap<int, int> etatsVoiesVariables;
+    for(QMap<int, VoieVariable*>::const_iterator it = VoiesVariables.constBegin(); it != VoiesVariables.constEnd(); ++it)
+        etatsVoiesVariables.insert(it.key(), it.value()->getEtat());
+
+    flux << etatsVoiesVariables << arretsProgrammes << locosEnPause << statistiques;
+    return etat;
+}
+
+bool SimView::restaurerEtat(const QByteArray &etat)
+{
+    QDataStream flux(etat);
+    quint32 magique;
+    quint16 version;
+    flux >> magique >> version;
+    if (magique != ETAT_MAGIQUE || version != ETAT_VERSION)
+        return false;
+
+    quint64 pas;
+    bool etatAlimentee, etatUrgence;
+    qint32 nbLocos;
+    flux >> pas >> etatAlimentee >> etatUrgence >> nbLocos;
+
+    // Tout est lu et vérifié avant la moindre modification.
+    QVector<EtatLoco> etatsLocos;
+    for (int i = 0; i < nbLocos && flux.status() == QDataStream::Ok; i++)
+    {
+        EtatLoco e;
+        flux >> e;
+        if (!Locos.contains(e.numero) ||
+            (e.voieActuelle >= 0 && !Voies.contains(e.voieActuelle)) ||
+            (e.voieSuivante >= 0 && !Voies.contains(e.voieSuivante)) ||
+            e.segmentActuel >= segments.size())
+            return false;
+        etatsLocos.append(e);
+    }
+
+    QMap<int, int> etatsVoiesVariables;
+    QMap<int, int> arrets;
+    QSet<int> pauses;
+    StatistiquesSim stats;
+    flux >> etatsVoiesVariables >> arrets >> pauses >> stats;
+    if (flux.status() != QDataStream::Ok)
+        return false;
+    foreach(int numVoie, etatsVoiesVariables.keys())
+        if (!VoiesVariables.contains(numVoie))
+            return false;
+
+    LocoStore* store = LocoStore::getInstance();
+
+    // Une voie variable qui change d'état sous une loco la fait dérailler : les
+    // locos sont retirées des voies le temps de poser les aiguillages.
+    foreach(const EtatLoco &e, etatsLocos)
+        store->voieActuelle[e.numero] = nullptr;
+    for(QMap<int, int>::const_iterator it = etatsVoiesVariables.constBegin(); it != etatsVoiesVariables.constEnd(); ++it)
+        VoiesVariables.value(it.key())->setEtat(it.value());
+
+    foreach(const EtatLoco &e, etatsLocos)
+    {
+        int n = e.numero;
+        store->x[n] = e.x;
+        store->y[n] = e.y;
+        store->orientation[n] = e.orientation;
+        store->angleCumule[n] = e.angleCumule;
+        store->cosCap[n] = e.cosCap;
+        store->sinCap[n] = e.sinCap;
+        store->angleCourbe[n] = e.angleCourbe;
+        store->cosDemiAngleCourbe[n] = e.cosDemiAngleCourbe;
+        store->sinDemiAngleCourbe[n] = e.sinDemiAngleCourbe;
+        store->tempsInertie[n] = e.tempsInertie;
+        store->facteurVitesse[n] = e.facteurVitesse;
+        store->vitesse[n] = e.vitesse;
+        store->vitesseFuture[n] = e.vitesseFuture;
+        store->consigne[n] = e.consigne;
+        store->direction[n] = e.direction;
+        store->voieActuelle[n] = Voies.value(e.voieActuelle, nullptr);
+        store->voieSuivante[n] = Voies.value(e.voieSuivante, nullptr);
+        store->segmentActuel[n] = e.segmentActuel >= 0 ? segments.at(e.segmentActuel) : nullptr;
+        store->presente[n] = e.presente;
+        store->active[n] = e.active;
+        store->alerteProximite[n] = e.alerteProximite;
+        store->inverser[n] = e.inverser;
+        store->deraille[n] = e.deraille;
+        store->inertieEnCours[n] = e.inertieEnCours;
+        store->blocMobile[n] = e.blocMobile;
+        Locos.value(n)->afficherPoseSimulation();
+    }
+
+    numeroPas = pas;
+    alimentee = etatAlimentee;
+    urgence = etatUrgence;
+    demandeUrgence.storeRelease(-1);
+    arretsProgrammes = arrets;
+    statistiques = stats;
+
+    // Les changements de pause sont signalés, pour que l'interface et le programme
+    // suivent l'état restauré.
+    QSet<int> anciennesPauses = locosEnPause;
+    locosEnPause = pauses;
+    foreach(int numLoco, Locos.keys())
+        if (anciennesPauses.contains(numLoco) != pauses.contains(numLoco))
+            emit pauseLoco(numLoco, pauses.contains(numLoco));
+
+    scene->update(sceneRect());
+    return true;
+}
+
+void SimView::programmerArret(int numLoco, int numContact)
+{
+    if (!checkLoco(numLoco))
+        return;
+    arretsProgrammes.insert(numLoco, numContact);
+}
+
+void SimView::annulerArret(int numLoco)
+{
+    arretsProgrammes.remove(numLoco);
+}
+
+void SimView::setBlocMobile(int numLoco, bool actif)
+{
+    if (!checkLoco(numLoco))
+        return;
+
+    LocoStore* store = LocoStore::getInstance();
+    store->blocMobile[numLoco] = actif;
+    if(!actif && store->vitesseFuture[numLoco] != store->consigne[numLoco])
+        this->Locos.value(numLoco)->setVitesse(store->consigne[numLoco]);
+}
+
+qreal SimView::distanceJusquAuContact(int numLoco, int numContact)
+{
+    if (!Locos.contains(numLoco) || !contacts.contains(numContact))
+        return -1.0;
+
+    LocoStore* store = LocoStore::getInstance();
+    Voie* viensDe = store->voieActuelle[numLoco];
+    Voie* voie = store->voieSuivante[numLoco];
+    if(viensDe == nullptr || voie == nullptr)
+        return -1.0;
+
+    Contact* cible = contacts.value(numContact);
+
+    // reste de la voie actuelle, puis voies entières jusqu'à celle portant le contact.
+    qreal distance = QLineF(Locos.value(numLoco)->getPosition(), viensDe->getPosAbsLiaison(voie)).length();
+    for(int i = 0; i < Voies.size(); i++)
+    {
+        if(voie->getContact() == cible)
+            return distance;
+
+        distance += voie->getLongueurAParcourir();
+        Voie* suivante = voie->getVoieSuivante(viensDe);
+        if(suivante == nullptr)
+            return -1.0;
+        viensDe = voie;
+        voie = suivante;
+    }
+    return -1.0;
+}
+
+qreal SimView::tempsJusquAuContact(int numLoco, int numContact)
+{
+    qreal distance = distanceJusquAuContact(numLoco, numContact);
+    if(distance < 0.0)
+        return -1.0;
+
+    LocoStore* store = LocoStore::getInstance();
+    qreal distanceParSeconde = store->vitesse[numLoco] * 1000.0 * FACTEUR_VITESSE * store->facteurVitesse[numLoco];
+    if(distanceParSeconde <= 0.0)
+        return -1.0;
+    return distance / distanceParSeconde;
+}
+
+void SimView::locoDeraillee(Loco *l)
+{
+    statistiques.enregistrerDeraillement(l->getNumero());
+}
+
+const StatistiquesSim& SimView::getStatistiques() const
+{
+    return statistiques;
+}
+
+const QMap<int, Voie*>& SimView::getVoies() const
+{
+    return Voies;
+}
+
+const QVector<EcartJointure>& SimView::getEcartsFermeture() const
+{
+    return ecartsFermeture;
 }
 
 void SimView::voieVariableModifiee(Voie *v)
@@ -4,12 +4,26 @@
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QVector>
+#include <QMap>
+#include <QMultiHash>
+#include <QSet>
+#include <QPixmap>
+#include <QByteArray>
+#include <QAtomicInteger>
+
+#include <functional>
 
 #include "connect.h"
 #include "voie.h"
 #include "voievariable.h"
 #include "loco.h"
 #include "segment.h"
+#include "simsnapshot.h"
+#include "statistiquessim.h"
+#include "fenetreoccupation.h"
 
 
 class ExplosionItem :  public QObject, public QGraphicsPixmapItem
@@ -110,6 +124,80 @@ public:
       */
     Contact* getContact(int n);
 
+    /** retourne les statistiques accumulées depuis le chargement de la maquette.
+      * \return les statistiques de la simulation.
+      */
+    const StatistiquesSim& getStatistiques() const;
+
+    /** Grandeur représentée par la carte d'occupation des segments.
+      */
+    enum ModeCarteOccupation
+    {
+        CarteMasquee,
+        //! part du temps pendant laquelle le segment est occupé.
+        CarteOccupation,
+        //! temps passé par les locos arrêtées sur le segment.
+        CarteAttente
+    };
+
+    /** affiche ou masque la carte d'occupation des segments, calculée sur les
+      * NB_TRANCHES_CARTE_OCCUPATION dernières secondes de simulation. Les compteurs
+      * ne sont tenus que lorsque la carte est affichée, et repartent de zéro à chaque
+      * affichage.
+      * \param mode la grandeur à représenter, CarteMasquee pour masquer la carte.
+      */
+    void setCarteOccupation(ModeCarteOccupation mode);
+
+    /** retourne les voies de la maquette chargée.
+      * \return les voies, par numéro.
+      */
+    const QMap<int, Voie*>& getVoies() const;
+
+    /** retourne les écarts constatés à la fermeture des boucles, lors du placement
+      * des voies de la maquette chargée, avant leur correction.
+      * \return les écarts, dans l'ordre du placement.
+      */
+    const QVector<EcartJointure>& getEcartsFermeture() const;
+
+    /** retourne la distance que la loco doit encore parcourir, dans son sens de marche,
+      * avant d'activer le contact. Les aiguillages sont pris dans leur état actuel.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact.
+      * \return la distance, ou -1 si le contact n'est pas sur le parcours de la loco.
+      */
+    Q_INVOKABLE qreal distanceJusquAuContact(int numLoco, int numContact);
+
+    /** retourne le temps nécessaire à la loco pour atteindre le contact à sa vitesse
+      * actuelle.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact.
+      * \return le temps en secondes de simulation, ou -1 si la loco est arrêtée ou si
+      *         le contact n'est pas sur son parcours.
+      */
+    Q_INVOKABLE qreal tempsJusquAuContact(int numLoco, int numContact);
+
+    /** demande l'arrêt d'urgence de toutes les locos. Peut être appelée depuis
+      * n'importe quel thread : l'arrêt a lieu au plus tard au début du prochain pas de
+      * simulation. Une demande faite alors qu'une autre est en cours est ignorée.
+      * \param instant l'instant de la demande, selon Metriques::maintenant().
+      */
+    void demanderArretUrgence(qint64 instant);
+
+    /** sauvegarde l'état complet de la simulation : état des locos dans le LocoStore,
+      * état des voies variables, arrêts programmés, locos en pause et statistiques.
+      * A appeler entre deux pas de simulation, dans le thread de l'interface.
+      * \return l'état, sous forme binaire.
+      */
+    Q_INVOKABLE QByteArray sauvegarderEtat();
+
+    /** restaure un état sauvegardé par sauvegarderEtat(). La maquette doit être celle de
+      * la sauvegarde, et les locos de l'état doivent y avoir été ajoutées.
+      * \param etat l'état sauvegardé.
+      * \return vrai si l'état a été restauré, faux s'il ne correspond pas à la maquette,
+      *         auquel cas la simulation n'est pas modifiée.
+      */
+    Q_INVOKABLE bool restaurerEtat(const QByteArray &etat);
+
     /** raffraichit l'affichage.
       *
       */
@@ -125,6 +213,39 @@ signals:
       * \param v la voie variable ayant changé.
       */
     void notificationVoieVariableModifiee(Voie* v);
+
+    /** Signale le passage d'une loco sur un contact.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact.
+      */
+    void passageContact(int numLoco, int numContact);
+
+    /** Signale que toutes les locos ont été arrêtées suite à une demande d'arrêt
+      * d'urgence.
+      * \param latenceUs le délai entre la demande et l'arrêt, en microsecondes.
+      */
+    void arretUrgence(qint64 latenceUs);
+
+    /** Signale la mise en pause ou la reprise d'une loco.
+      * \param numLoco le numéro de la loco.
+      * \param enPause vrai si la loco vient d'être mise en pause.
+      */
+    void pauseLoco(int numLoco, bool enPause);
+
+    /** Signale le changement de l'alerte de collision d'une loco : niveau de l'alerte,
+      * ou loco avec laquelle la collision est prévue.
+      * \param numLoco le numéro de la loco.
+      * \param numAutreLoco le numéro de l'autre loco, -1 si l'alerte est levée.
+      * \param niveau le niveau de l'alerte, de ALERTE_AUCUNE à ALERTE_DANGER.
+      * \param tempsAvantCollision le temps avant la collision prévue, en secondes,
+      *        -1 si l'alerte est levée.
+      */
+    void alerteCollision(int numLoco, int numAutreLoco, int niveau, qreal tempsAvantCollision);
+
+    /** Signale que la maquette va être vidée : ses voies et ses contacts sont détruits
+      * au retour.
+      */
+    void maquetteAVider();
 public slots:
 
     /** effectue un nouveau pas d'animation.
@@ -132,6 +253,17 @@ public slots:
       */
     void animationStep();
 
+    /** effectue autant de pas de simulation que le temps écoulé depuis le dernier appel
+      * le demande, puis publie un instantané. Un retard de l'interface est ainsi rattrapé
+      * au lieu de ralentir la simulation.
+      */
+    void animationTick();
+
+    /** affiche le dernier instantané publié, en interpolant la pose des locos
+      * entre les deux derniers instantanés. Appelé à la fréquence de l'écran.
+      */
+    void rafraichirAffichage();
+
     /** démarre l'animation
       *
       */
@@ -177,6 +309,65 @@ public slots:
       */
     void stopLoco(int numLoco);
 
+    /** modifie le facteur appliqué à la distance parcourue par une loco à chaque pas,
+      * pour simuler une loco plus rapide ou plus lente que sa consigne.
+      * \param numLoco le numéro de la loco.
+      * \param facteur le facteur, 1.0 pour une loco nominale.
+      */
+    void setFacteurVitesseLoco(int numLoco, qreal facteur);
+
+    /** coupe ou rétablit l'alimentation de la maquette. Sans alimentation, les locos
+      * s'arrêtent immédiatement et gardent leur consigne de vitesse, qu'elles
+      * reprennent au rétablissement.
+      * \param alimentee vrai pour alimenter la maquette.
+      */
+    void setAlimentation(bool alimentee);
+
+    /** programme l'arrêt d'une loco juste avant un contact, qu'elle n'active donc pas.
+      * L'arrêt est immédiat, sans tenir compte de l'inertie, et n'a lieu qu'une fois.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact.
+      */
+    void programmerArret(int numLoco, int numContact);
+
+    /** annule l'arrêt programmé d'une loco, s'il n'a pas encore eu lieu.
+      * \param numLoco le numéro de la loco.
+      */
+    void annulerArret(int numLoco);
+
+    /** active ou désactive le bloc mobile d'une loco. En bloc mobile, la vitesse de la
+      * loco est limitée à chaque pas pour qu'elle puisse s'arrêter avant la queue de la
+      * loco qui la précède sur son parcours. A la désactivation, la loco reprend la
+      * vitesse commandée.
+      * \param numLoco le numéro de la loco.
+      * \param actif vrai pour activer le bloc mobile.
+      */
+    void setBlocMobile(int numLoco, bool actif);
+
+    /** arrête immédiatement toutes les locos si un arrêt d'urgence a été demandé.
+      * Les locos restent ensuite immobiles, quelles que soient les commandes reçues,
+      * jusqu'à leverArretUrgence().
+      */
+    void appliquerArretUrgence();
+
+    /** lève l'arrêt d'urgence. Les locos repartent avec les commandes reçues depuis.
+      */
+    void leverArretUrgence();
+
+    /** met une loco en pause ou la fait reprendre. En pause, la loco est figée sur
+      * place : elle n'avance plus et n'active plus de contacts, mais reste un obstacle
+      * pour les autres locos. Sans effet si la loco est déjà dans l'état demandé.
+      * \param numLoco le numéro de la loco.
+      * \param enPause vrai pour mettre la loco en pause, faux pour la faire reprendre.
+      */
+    void setPauseLoco(int numLoco, bool enPause);
+
+    /** suspend ou reprend la simulation. Suspendue, la simulation n'effectue plus aucun
+      * pas, et son état peut être sauvegardé de manière cohérente avec celui du programme.
+      * \param suspendue vrai pour suspendre la simulation.
+      */
+    void setSuspendue(bool suspendue);
+
     /** modifie l'etat d'une voie variable.
       * \param numVoieVariable le numéro de la voie variable.
       * \param direction la nouvelle direction de la voie (DEVIE ou TOUT_DROIT)
@@ -194,16 +385,233 @@ public slots:
       */
     void voieVariableModifiee(Voie* v);
 
+    /** reçoit l'information qu'une loco a déraillé.
+      * \param l la loco ayant déraillé.
+      */
+    void locoDeraillee(Loco* l);
+
+protected:
+    /** dessine le fond de la vue : les voies fixes, à partir du cache correspondant
+      * au niveau de zoom actuel.
+      * \param painter l'outil de dessin.
+      * \param rect la zone de la scène à redessiner.
+      */
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+
+    /** dessine la carte d'occupation des segments par dessus la scène, si elle est
+      * affichée. Les valeurs sont celles des compteurs tenus par comptabiliserPas().
+      * \param painter l'outil de dessin.
+      * \param rect la zone de la scène à redessiner.
+      */
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
 
 private:
+    /** Paire de locos entrées en collision lors d'un pas d'animation, désignées
+      * par leur indice dans la liste des locos triée par numéro.
+      * indiceLocoA est toujours inférieur à indiceLocoB.
+      */
+    struct CollisionLocos
+    {
+        int indiceLocoA;
+        int indiceLocoB;
+    };
+
+    /** Phase de déplacement : fait avancer toutes les locos actives, par ordre de numéro.
+      * \param locos les locos de la simulation, triées par numéro.
+      */
+    void deplacerLocos(const QList<Loco*> &locos);
+
+    /** Phase de détection des collisions. Un premier tri par rectangles englobants
+      * élimine les paires éloignées, puis les contours des paires restantes sont comparés.
+      * \param locos les locos de la simulation, triées par numéro.
+      * \return les collisions détectées, triées par numéros de locos.
+      */
+    QVector<CollisionLocos> detecterCollisions(const QList<Loco*> &locos);
+
+    /** Collision prévue pour une loco : la plus proche dans le temps, parmi celles
+      * prévues avec chacune des autres locos.
+      */
+    struct PredictionCollision
+    {
+        //! numéro de l'autre loco, -1 si aucune collision n'est prévue.
+        int autreLoco{-1};
+        //! temps avant collision, en secondes.
+        qreal temps{-1.0};
+        int niveau{ALERTE_AUCUNE};
+    };
+
+    /** Parcours prévu d'une loco, avec l'état actuel des voies variables.
+      */
+    struct ParcoursLoco
+    {
+        //! voies du parcours, en commençant par la voie actuelle.
+        QVector<Voie*> voies;
+        //! voie par laquelle la loco entre dans chaque voie du parcours.
+        QVector<Voie*> provenances;
+        //! distance entre le centre de la loco et l'entrée de chaque voie du
+        //! parcours, négative pour la voie actuelle.
+        QVector<qreal> entrees;
+        //! vitesse de la loco, en mm/s.
+        qreal vitesse{0.0};
+    };
+
+    /** Phase de calcul des alertes de collision. Ne modifie pas l'état de la simulation.
+      * Le temps avant collision est calculé pour chaque paire de locos dont l'une se
+      * trouve sur le parcours de l'autre, ou dont les parcours se rejoignent.
+      * \param locos les locos de la simulation, triées par numéro.
+      * \return pour chaque loco, la collision prévue la plus proche.
+      */
+    QVector<PredictionCollision> calculerAlertesCollision(const QList<Loco*> &locos);
+
+    /** construit le parcours prévu d'une loco, jusqu'à la distance qu'elle parcourt en
+      * TTC_INFORMATION secondes.
+      * \param numLoco le numéro de la loco.
+      * \return le parcours, vide si la loco n'est pas sur une voie.
+      */
+    ParcoursLoco construireParcours(int numLoco) const;
+
+    /** calcule le temps avant collision d'une loco avec une autre loco qui se trouve
+      * sur son parcours.
+      * \param numLoco le numéro de la loco.
+      * \param parcours le parcours de la loco.
+      * \param indiceVoie l'indice, dans le parcours, de la voie de l'autre loco.
+      * \param numAutreLoco le numéro de l'autre loco.
+      * \param vitesseAutre la vitesse de l'autre loco, en mm/s.
+      * \return le temps avant collision, en secondes, ou -1 si les locos ne se rapprochent pas.
+      */
+    qreal tempsAvantRattrapage(int numLoco, const ParcoursLoco &parcours, int indiceVoie,
+                               int numAutreLoco, qreal vitesseAutre) const;
+
+    /** calcule le temps avant collision de deux locos dont les parcours se rejoignent,
+      * à partir des intervalles de temps pendant lesquels chacune occupe la voie commune.
+      * \param parcours le parcours de la première loco.
+      * \param autreParcours le parcours de la seconde loco.
+      * \return le temps avant collision, en secondes, ou -1 si les locos ne se croisent pas.
+      */
+    qreal tempsAvantJonction(const ParcoursLoco &parcours, const ParcoursLoco &autreParcours) const;
+
+    /** retourne le niveau d'alerte correspondant à un temps avant collision.
+      * \param temps le temps avant collision, en secondes.
+      * \return le niveau d'alerte.
+      */
+    static int niveauAlerte(qreal temps);
+
+    /** Signale les alertes de collision qui ont changé depuis le pas précédent.
+      * \param locos les locos de la simulation, triées par numéro.
+      * \param predictions les collisions prévues pour chaque loco.
+      */
+    void signalerAlertesCollision(const QList<Loco*> &locos, const QVector<PredictionCollision> &predictions);
+
+    /** Phase du bloc mobile : limite la vitesse des locos en bloc mobile selon la
+      * distance libre devant elles.
+      * \param locos les locos de la simulation, triées par numéro.
+      */
+    void appliquerBlocMobile(const QList<Loco*> &locos);
+
+    /** calcule la distance libre devant une loco, le long de son parcours, jusqu'à la
+      * queue de la loco qui la précède.
+      * \param numLoco le numéro de la loco.
+      * \param occupation les locos présentes sur chaque voie.
+      * \param horizon la distance au-delà de laquelle la recherche s'arrête.
+      * \return la distance libre, ou -1 si aucune loco ne se trouve avant l'horizon.
+      */
+    qreal distanceLibre(int numLoco, const QMultiHash<Voie*, int> &occupation, qreal horizon);
+
+    /** retourne la distance nécessaire à une loco pour s'arrêter depuis une vitesse,
+      * en tenant compte de l'inertie et du pas de simulation en cours.
+      * \param numLoco le numéro de la loco.
+      * \param vitesse la vitesse initiale.
+      * \return la distance de freinage.
+      */
+    qreal distanceFreinage(int numLoco, int vitesse) const;
+
+    /** Affiche l'explosion de deux locos entrées en collision et arrête la simulation.
+      * \param l la première loco
+      * \param autreLoco la seconde loco
+      */
+    void declencherCollision(Loco* l, Loco* autreLoco);
+
+    /** Comptabilise un pas de simulation dans les statistiques : temps simulé, temps
+      * d'arrêt des locos et occupation des segments.
+      * \param locos les locos de la simulation, triées par numéro.
+      */
+    void comptabiliserPas(const QList<Loco*> &locos);
+
+    /** Dessine les voies fixes de la maquette.
+      * \param painter l'outil de dessin, en coordonnées de la scène.
+      */
+    void dessinerVoiesFixes(QPainter* painter);
+
+    /** Vide le cache des voies fixes. A appeler lorsque la maquette change.
+      */
+    void invaliderCacheVoies();
+
+    /** Prend un instantané de l'état de la simulation ; le précédent devient l'origine
+      * de l'interpolation de l'affichage.
+      * \param instant l'instant de publication, en millisecondes.
+      */
+    void publierSnapshot(qint64 instant);
+
+    /** Découpe l'intervalle [0, nbElements[ en tranches traitées par le pool de threads.
+      * Si une seule tranche suffit, le traitement est effectué dans le thread appelant.
+      * \param nbElements le nombre d'éléments à traiter.
+      * \param traitement la fonction traitant une tranche [debut, fin[ avec son numéro de tranche.
+      * \return le nombre de tranches utilisées.
+      */
+    int executerEnParallele(int nbElements, const std::function<void(int, int, int)> &traitement);
+
     QTimer* timer;
+    QTimer* timerAffichage;
+    QElapsedTimer horloge;
+    qint64 dernierInstant;
+    qreal accumulateur;
+    quint64 numeroPas;
+    bool alimentee;
+    //! vrai tant que la simulation est suspendue par setSuspendue().
+    bool suspendue;
+    //! vrai tant que l'arrêt d'urgence n'a pas été levé.
+    bool urgence;
+    //! instant de la demande d'arrêt d'urgence en attente, -1 s'il n'y en a pas.
+    QAtomicInteger<qint64> demandeUrgence;
+    //! deux derniers instantanés pris, entre lesquels les locos sont affichées.
+    SimSnapshot snapshotPrecedent;
+    SimSnapshot snapshotCourant;
+    //! état d'attente de chaque contact lors de son dernier affichage.
+    QMap<int, bool> attentesAffichees;
+    StatistiquesSim statistiques;
+    QThreadPool poolSimulation;
+    //! rendu des voies fixes, par niveau de zoom (échelle * 1000).
+    QMap<int, QPixmap> cacheVoies;
+    //! niveaux de zoom du cache, du plus ancien au plus récent.
+    QList<int> ordreCacheVoies;
+    //! zone de la scène couverte par les voies fixes.
+    QRectF zoneVoiesFixes;
     QGraphicsScene * scene;
     QMap<int, Voie*> Voies;
+    //! écarts à la fermeture des boucles, constatés par construireMaquette().
+    QVector<EcartJointure> ecartsFermeture;
     QMap<int, VoieVariable*> VoiesVariables;
     QMap<int, Contact*> contacts;
     Voie* premiereVoie;
     QMap<int, Loco*> Locos;
     QList<Segment*> segments;
+    //! voies de tous les segments mises bout à bout, chaque segment en occupe un intervalle.
+    QVector<Voie*> voiesSegments;
+    //! indice de chaque segment dans segments.
+    QHash<Segment*, int> indicesSegments;
+    ModeCarteOccupation modeCarte;
+    //! occupation et attente de chaque segment, tenues si la carte est affichée.
+    FenetreOccupation fenetreOccupation;
+    //! tracé de chaque segment, calculé au premier affichage de la carte.
+    QVector<QPainterPath> tracesSegments;
+    //! tranche de la fenêtre lors du dernier dessin de la carte.
+    quint64 trancheAffichee;
+    //! contact sur lequel chaque loco doit s'arrêter, par numéro de loco.
+    QMap<int, int> arretsProgrammes;
+    //! numéros des locos en pause.
+    QSet<int> locosEnPause;
+    //! dernière alerte de collision signalée, par numéro de loco.
+    QHash<int, PredictionCollision> alertesCollision;
 
     /** retourne le segment correspondant à la paire de contacts passée en paramètre
       * \param contactA et contactB les contacts définissant les segment.
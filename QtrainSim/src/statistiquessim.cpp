@@ -0,0 +1,124 @@
+#include "statistiquessim.h"
+
+StatistiquesSim::StatistiquesSim()
+{
+    reinitialiser();
+}
+
+void StatistiquesSim::reinitialiser()
+{
+    nbPas = 0;
+    tempsSimule = 0.0;
+    nbCollisions = 0;
+    nbDeraillements = 0;
+    nbArretsUrgence = 0;
+    latenceMaxArretUrgence = 0;
+    passagesContacts.clear();
+    tempsArret.clear();
+    occupationSegments.clear();
+}
+
+void StatistiquesSim::enregistrerPas(qreal ms)
+{
+    nbPas++;
+    tempsSimule += ms;
+}
+
+void StatistiquesSim::enregistrerCollision()
+{
+    nbCollisions++;
+}
+
+void StatistiquesSim::enregistrerDeraillement(int /*numLoco*/)
+{
+    nbDeraillements++;
+}
+
+void StatistiquesSim::enregistrerArretUrgence(qint64 latenceUs)
+{
+    nbArretsUrgence++;
+    latenceMaxArretUrgence = qMax(latenceMaxArretUrgence, latenceUs);
+}
+
+void StatistiquesSim::enregistrerPassageContact(int numLoco, int numContact)
+{
+    passagesContacts[numLoco][numContact]++;
+}
+
+void StatistiquesSim::ajouterTempsArret(int numLoco, qreal ms)
+{
+    tempsArret[numLoco] += ms;
+}
+
+void StatistiquesSim::ajouterOccupation(int contactA, int contactB, qreal ms)
+{
+    occupationSegments[qMakePair(contactA, contactB)] += ms;
+}
+
+qint64 StatistiquesSim::getNbPas() const
+{
+    return nbPas;
+}
+
+qreal StatistiquesSim::getTempsSimule() const
+{
+    return tempsSimule;
+}
+
+int StatistiquesSim::getNbCollisions() const
+{
+    return nbCollisions;
+}
+
+int StatistiquesSim::getNbDeraillements() const
+{
+    return nbDeraillements;
+}
+
+int StatistiquesSim::getNbArretsUrgence() const
+{
+    return nbArretsUrgence;
+}
+
+qint64 StatistiquesSim::getLatenceMaxArretUrgence() const
+{
+    return latenceMaxArretUrgence;
+}
+
+int StatistiquesSim::getNbPassages(int numLoco, int numContact) const
+{
+    return passagesContacts.value(numLoco).value(numContact, 0);
+}
+
+const QMap<int, QMap<int, int>>& StatistiquesSim::getPassagesContacts() const
+{
+    return passagesContacts;
+}
+
+const QMap<int, qreal>& StatistiquesSim::getTempsArret() const
+{
+    return tempsArret;
+}
+
+const QMap<QPair<int, int>, qreal>& StatistiquesSim::getOccupationSegments() const
+{
+    return occupationSegments;
+}
+
+QDataStream& operator<<(QDataStream &flux, const StatistiquesSim &statistiques)
+{
+    return flux << statistiques.nbPas << statistiques.tempsSimule
+                << statistiques.nbCollisions << statistiques.nbDeraillements
+                << statistiques.nbArretsUrgence << statistiques.latenceMaxArretUrgence
+                << statistiques.passagesContacts << statistiques.tempsArret
+                << statistiques.occupationSegments;
+}
+
+QDataStream& operator>>(QDataStream &flux, StatistiquesSim &statistiques)
+{
+    return flux >> statistiques.nbPas >> statistiques.tempsSimule
+                >> statistiques.nbCollisions >> statistiques.nbDeraillements
+                >> statistiques.nbArretsUrgence >> statistiques.latenceMaxArretUrgence
+                >> statistiques.passagesContacts >> statistiques.tempsArret
+                >> statistiques.occupationSegments;
+}
@@ -0,0 +1,110 @@
+#ifndef STATISTIQUESSIM_H
+#define STATISTIQUESSIM_H
+
+#include <QDataStream>
+#include <QMap>
+#include <QPair>
+
+/** Compteurs accumulés pendant la simulation : temps simulé, collisions, déraillements,
+  * passages sur les contacts, temps d'arrêt des locos et occupation des segments.
+  * Les temps sont en millisecondes de simulation. Mis à jour par SimView, dans le
+  * thread de l'interface, à chaque pas de simulation.
+  */
+class StatistiquesSim
+{
+public:
+    /** Constructeur de classe.
+      */
+    StatistiquesSim();
+
+    /** remet tous les compteurs à zéro.
+      */
+    void reinitialiser();
+
+    /** comptabilise un pas de simulation.
+      * \param ms la durée du pas, en millisecondes.
+      */
+    void enregistrerPas(qreal ms);
+
+    /** comptabilise une collision entre deux locos.
+      */
+    void enregistrerCollision();
+
+    /** comptabilise un déraillement.
+      * \param numLoco le numéro de la loco ayant déraillé.
+      */
+    void enregistrerDeraillement(int numLoco);
+
+    /** comptabilise le passage d'une loco sur un contact.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact.
+      */
+    void enregistrerPassageContact(int numLoco, int numContact);
+
+    /** ajoute du temps d'arrêt à une loco.
+      * \param numLoco le numéro de la loco.
+      * \param ms la durée, en millisecondes.
+      */
+    void ajouterTempsArret(int numLoco, qreal ms);
+
+    /** ajoute du temps d'occupation à un segment.
+      * \param contactA le plus petit numéro de contact du segment (0 pour un buttoir).
+      * \param contactB le plus grand numéro de contact du segment.
+      * \param ms la durée, en millisecondes.
+      */
+    void ajouterOccupation(int contactA, int contactB, qreal ms);
+
+    /** comptabilise un arrêt d'urgence.
+      * \param latenceUs le délai entre la demande et l'arrêt des locos, en microsecondes.
+      */
+    void enregistrerArretUrgence(qint64 latenceUs);
+
+    qint64 getNbPas() const;
+    qreal getTempsSimule() const;
+    int getNbCollisions() const;
+    int getNbDeraillements() const;
+    int getNbArretsUrgence() const;
+
+    /** retourne le plus long délai entre une demande d'arrêt d'urgence et l'arrêt
+      * des locos, en microsecondes.
+      */
+    qint64 getLatenceMaxArretUrgence() const;
+
+    /** retourne le nombre de passages d'une loco sur un contact.
+      * \param numLoco le numéro de la loco.
+      * \param numContact le numéro du contact.
+      * \return le nombre de passages.
+      */
+    int getNbPassages(int numLoco, int numContact) const;
+
+    /** retourne, pour chaque loco, le nombre de passages sur chaque contact.
+      */
+    const QMap<int, QMap<int, int>>& getPassagesContacts() const;
+
+    /** retourne le temps d'arrêt cumulé de chaque loco, en millisecondes.
+      */
+    const QMap<int, qreal>& getTempsArret() const;
+
+    /** retourne le temps d'occupation cumulé de chaque segment, indexé par
+      * ses deux contacts, en millisecondes.
+      */
+    const QMap<QPair<int, int>, qreal>& getOccupationSegments() const;
+
+    /** écrit ou relit tous les compteurs, pour la sauvegarde de l'état de la simulation.
+      */
+    friend QDataStream& operator<<(QDataStream &flux, const StatistiquesSim &statistiques);
+    friend QDataStream& operator>>(QDataStream &flux, StatistiquesSim &statistiques);
+
+private:
+    qint64 nbPas;
+    qreal tempsSimule;
+    int nbCollisions;
+    int nbDeraillements;
+    int nbArretsUrgence;
+    qint64 latenceMaxArretUrgence;
+    QMap<int, QMap<int, int>> passagesContacts;
+    QMap<int, qreal> tempsArret;
+    QMap<QPair<int, int>, qreal> occupationSegments;
+};
+
+#endif // STATISTIQUESSIM_H
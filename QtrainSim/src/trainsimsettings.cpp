@@ -6,6 +6,7 @@ TrainSimSettings::TrainSimSettings()
     viewContactNumber = false;
     viewAiguillageNumber = false;
     inertie = true;
+    nbThreadsSimulation = 0;
 }
 
 
@@ -55,3 +56,13 @@ void TrainSimSettings::setInertie(bool enable)
     inertie = enable;
 }
 
+
+int TrainSimSettings::getNbThreadsSimulation()
+{
+    return nbThreadsSimulation;
+}
+
+void TrainSimSettings::setNbThreadsSimulation(int nbThreads)
+{
+    nbThreadsSimulation = nbThreads < 0 ? 0 : nbThreads;
+}
@@ -20,6 +20,12 @@ public:
     bool getInertie();
     void setInertie(bool enable);
 
+    /** retourne le nombre de threads utilisés pour un pas de simulation.
+      * 0 signifie que le nombre de coeurs disponibles est utilisé.
+      */
+    int getNbThreadsSimulation();
+    void setNbThreadsSimulation(int nbThreads);
+
 protected:
     TrainSimSettings();
 
@@ -27,6 +33,7 @@ protected:
     bool viewAiguillageNumber;
     bool viewLocoLog;
     bool inertie;
+    int nbThreadsSimulation;
 };
 
 
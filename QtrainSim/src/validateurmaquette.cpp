@@ -0,0 +1,96 @@
+#include <QLineF>
+#include <QSet>
+
+#include <cmath>
+
+#include "validateurmaquette.h"
+
+ValidateurMaquette::ValidateurMaquette(qreal toleranceFermeture, qreal toleranceJointure, qreal toleranceAngle,
+                                       qreal toleranceContact)
+    : toleranceFermeture(toleranceFermeture),
+      toleranceJointure(toleranceJointure),
+      toleranceAngle(toleranceAngle),
+      toleranceContact(toleranceContact)
+{
+}
+
+RapportGeometrie ValidateurMaquette::valider(const SimView *simView) const
+{
+    RapportGeometrie rapport;
+
+    verifierFermetures(simView, rapport);
+
+    foreach(Voie* v, simView->getVoies())
+    {
+        rapport.nbVoies++;
+        verifierJointures(v, rapport);
+        verifierContact(v, rapport);
+    }
+
+    return rapport;
+}
+
+void ValidateurMaquette::verifierFermetures(const SimView *simView, RapportGeometrie &rapport) const
+{
+    // Une boucle est vue depuis ses deux extrémités : la première fois avec l'écart
+    // réel, la seconde après correction. Seule la première est retenue.
+    QSet<QPair<int, int>> vues;
+
+    foreach(const EcartJointure& e, simView->getEcartsFermeture())
+    {
+        int idVoie = e.voie->getIdVoie();
+        int idVoisin = e.voisin->getIdVoie();
+        QPair<int, int> paire(qMin(idVoie, idVoisin), qMax(idVoie, idVoisin));
+        if(vues.contains(paire))
+            continue;
+        vues.insert(paire);
+
+        qreal erreur = std::hypot(e.ecart.x(), e.ecart.y());
+        rapport.boucles.append({idVoie, idVoisin, erreur});
+        rapport.fermetureMax = qMax(rapport.fermetureMax, erreur);
+
+        if(erreur > toleranceFermeture)
+            rapport.defauts << QString("boucle fermee entre les voies %1 et %2 : erreur de %3 mm")
+                               .arg(idVoie).arg(idVoisin).arg(erreur, 0, 'f', 3);
+    }
+}
+
+void ValidateurMaquette::verifierJointures(Voie *v, RapportGeometrie &rapport) const
+{
+    for(int i = 0; i < v->getNbreLiaisons(); i++)
+    {
+        Voie* voisin = v->getVoieVoisineDOrdre(i);
+
+        // chaque jointure n'est vérifiée que depuis la voie de plus petit numéro.
+        if(voisin == nullptr || voisin->getIdVoie() < v->getIdVoie())
+            continue;
+
+        qreal ecart = QLineF(v->getPosAbsLiaison(voisin), voisin->getPosAbsLiaison(v)).length();
+        if(ecart > toleranceJointure)
+            rapport.defauts << QString("jointure entre les voies %1 et %2 : ecart de %3 mm")
+                               .arg(v->getIdVoie()).arg(voisin->getIdVoie()).arg(ecart, 0, 'f', 3);
+
+        // les deux extrémités doivent être orientées en sens opposés.
+        qreal ecartAngle = std::fabs(std::remainder(v->getAngleVoisin(voisin) - voisin->getAngleVoisin(v) - 180.0, 360.0));
+        if(ecartAngle > toleranceAngle)
+            rapport.defauts << QString("jointure entre les voies %1 et %2 : ecart d'angle de %3 degres")
+                               .arg(v->getIdVoie()).arg(voisin->getIdVoie()).arg(ecartAngle, 0, 'f', 2);
+    }
+}
+
+void ValidateurMaquette::verifierContact(Voie *v, RapportGeometrie &rapport) const
+{
+    Contact* c = v->getContact();
+    if(c == nullptr)
+        return;
+
+    rapport.nbContacts++;
+
+    // le contact est un enfant de la voie : sa position est dans le repère de la voie.
+    qreal distance = v->distanceAuTrace(c->pos());
+    if(distance > toleranceContact)
+        rapport.defauts << QString("contact %1 hors de la voie %2 : position (%3, %4), a %5 mm du trace")
+                           .arg(c->getNumContact()).arg(v->getIdVoie())
+                           .arg(c->pos().x(), 0, 'f', 1).arg(c->pos().y(), 0, 'f', 1)
+                           .arg(distance, 0, 'f', 3);
+}
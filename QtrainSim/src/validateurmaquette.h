@@ -0,0 +1,84 @@
+#ifndef VALIDATEURMAQUETTE_H
+#define VALIDATEURMAQUETTE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "simview.h"
+
+/** Erreur de fermeture d'une boucle de la maquette : écart entre les extrémités des
+  * deux voies qui la ferment, lors de leur placement.
+  */
+struct FermetureBoucle
+{
+    int idVoie;
+    int idVoisin;
+    //! norme de l'écart, avant correction.
+    qreal erreur;
+};
+
+/** Résultat de la validation de la géométrie d'une maquette.
+  */
+struct RapportGeometrie
+{
+    int nbVoies{0};
+    int nbContacts{0};
+    //! erreur de fermeture de chaque boucle, dans l'ordre du placement.
+    QVector<FermetureBoucle> boucles;
+    //! plus grande erreur de fermeture.
+    qreal fermetureMax{0.0};
+    //! description de chaque défaut dépassant les tolérances.
+    QStringList defauts;
+
+    /** indique si la géométrie respecte les tolérances.
+      * \return vrai si aucun défaut n'a été relevé.
+      */
+    bool estValide() const { return defauts.isEmpty(); }
+};
+
+/** Vérifie la géométrie d'une maquette construite dans un SimView :
+  * - erreur de fermeture de chaque boucle, avant que le placement ne la corrige ;
+  * - accord des extrémités liées, en position et en angle, une fois les voies posées ;
+  * - position de chaque contact sur la voie qui le porte.
+  */
+class ValidateurMaquette
+{
+public:
+    /** Constructeur de classe.
+      * \param toleranceFermeture l'erreur de fermeture tolérée par boucle, en mm.
+      * \param toleranceJointure l'écart toléré entre deux extrémités liées, en mm.
+      * \param toleranceAngle l'écart d'angle toléré entre deux extrémités liées, en degrés.
+      * \param toleranceContact l'écart toléré entre un contact et le tracé de sa voie, en mm.
+      */
+    explicit ValidateurMaquette(qreal toleranceFermeture = 1.0,
+                                qreal toleranceJointure = 0.1,
+                                qreal toleranceAngle = 0.5,
+                                qreal toleranceContact = 1.0);
+
+    /** valide la maquette chargée dans la vue.
+      * \param simView la vue, dans laquelle ChargeurMaquette a construit la maquette.
+      * \return le rapport de validation.
+      */
+    RapportGeometrie valider(const SimView* simView) const;
+
+private:
+    /** relève les erreurs de fermeture des boucles.
+      */
+    void verifierFermetures(const SimView* simView, RapportGeometrie &rapport) const;
+
+    /** relève les extrémités liées qui ne coïncident pas.
+      */
+    void verifierJointures(Voie* v, RapportGeometrie &rapport) const;
+
+    /** vérifie que le contact de la voie, s'il y en a un, est sur le tracé de la voie.
+      */
+    void verifierContact(Voie* v, RapportGeometrie &rapport) const;
+
+    qreal toleranceFermeture;
+    qreal toleranceJointure;
+    qreal toleranceAngle;
+    qreal toleranceContact;
+};
+
+#endif // VALIDATEURMAQUETTE_H
@@ -1,10 +1,14 @@
+#include <QLineF>
+
 #include "voie.h"
 
 
 /** Constructeur de classe Voie.
   *
   */
-Voie::Voie()
+Voie::Voie(LiaisonVoie *liaisons, int nbLiaisons)
+    : liaisons(liaisons),
+      nbLiaisons(nbLiaisons)
 {
     this->contact = nullptr;
     setZValue(ZVAL_VOIE);
@@ -21,7 +25,7 @@ void Voie::setNewPen(const QColor &color)
     setPen(pen);
 }
 
-void Voie::calculerPosition(Voie *v)
+void Voie::calculerPosition(Voie *v, QVector<EcartJointure> *ecarts)
 {
     if(v == nullptr)
     {
@@ -31,62 +35,48 @@ void Voie::calculerPosition(Voie *v)
     {
         QPointF positionLiaison = v->getPosAbsLiaison(this);
 
-        setPos(positionLiaison.x() - coordonneesLiaison[ordreLiaison.key(v)]->x(),
-               positionLiaison.y() - coordonneesLiaison[ordreLiaison.key(v)]->y());
+        setPos(positionLiaison.x() - liaisons[getOrdreLiaison(v)].coordonnees.x(),
+               positionLiaison.y() - liaisons[getOrdreLiaison(v)].coordonnees.y());
     }
 
     posee = true;
 
     qreal deltaX, deltaY;
 
-    for(int i =0; i < ordreLiaison.size(); i++)
+    for(int i =0; i < nbLiaisons; i++)
     {
-        if(!ordreLiaison[i]->estPosee())
-            ordreLiaison[i]->calculerPosition(this);
+        if(!liaisons[i].voisin->estPosee())
+            liaisons[i].voisin->calculerPosition(this, ecarts);
         else
         {
-            if((getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x()) < -1e-10 ||
-               (getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y()) < -1e-10 ||
-               (getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x()) > 1e-10 ||
-               (getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y()) > 1e-10)
+            if(ecarts != nullptr && liaisons[i].voisin != v)
+                ecarts->append({this, liaisons[i].voisin,
+                                getPosAbsLiaison(liaisons[i].voisin) - liaisons[i].voisin->getPosAbsLiaison(this)});
+
+            if((getPosAbsLiaison(liaisons[i].voisin).x() - liaisons[i].voisin->getPosAbsLiaison(this).x()) < -1e-10 ||
+               (getPosAbsLiaison(liaisons[i].voisin).y() - liaisons[i].voisin->getPosAbsLiaison(this).y()) < -1e-10 ||
+               (getPosAbsLiaison(liaisons[i].voisin).x() - liaisons[i].voisin->getPosAbsLiaison(this).x()) > 1e-10 ||
+               (getPosAbsLiaison(liaisons[i].voisin).y() - liaisons[i].voisin->getPosAbsLiaison(this).y()) > 1e-10)
             {
-                deltaX = getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x();
-                deltaY = getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y();
+                deltaX = getPosAbsLiaison(liaisons[i].voisin).x() - liaisons[i].voisin->getPosAbsLiaison(this).x();
+                deltaY = getPosAbsLiaison(liaisons[i].voisin).y() - liaisons[i].voisin->getPosAbsLiaison(this).y();
 
 
-                ordreLiaison[i]->correctionPosition(deltaX / 2.0, deltaY / 2.0, this);
-                this->correctionPosition(- deltaX / 2.0, - deltaY / 2.0, ordreLiaison[i]);
+                liaisons[i].voisin->correctionPosition(deltaX / 2.0, deltaY / 2.0, this);
+                this->correctionPosition(- deltaX / 2.0, - deltaY / 2.0, liaisons[i].voisin);
 
-                deltaX = getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x();
-                deltaY = getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y();
+                deltaX = getPosAbsLiaison(liaisons[i].voisin).x() - liaisons[i].voisin->getPosAbsLiaison(this).x();
+                deltaY = getPosAbsLiaison(liaisons[i].voisin).y() - liaisons[i].voisin->getPosAbsLiaison(this).y();
             }
         }
     }
 }
 
 
-QList<QList<Voie*>*> Voie::startExplorationContactAContact()
-{
-    QList<QList<Voie*>*> temp;
-
-    for(int i=0; i<ordreLiaison.size(); i++)
-    {
-        temp.append(ordreLiaison[i]->explorationContactAContact(this));
-    }
-
-    foreach(QList<Voie*>* lv, temp)
-    {
-        lv->prepend(this);
-    }
-
-    return temp;
-}
-
 void Voie::lier(Voie *v, int ordre)
 {
-    ordreLiaison.insert(ordre, v);
-    coordonneesLiaison.insert(ordre, new QPointF());
-    angleLiaison.insert(ordre, 0.0);
+    Q_ASSERT(ordre >= 0 && ordre < nbLiaisons);
+    liaisons[ordre].voisin = v;
 }
 
 bool Voie::estOrientee()
@@ -112,8 +102,8 @@ double Voie::normaliserAngle(double angle) const
 
 QPointF Voie::getPosAbsLiaison(Voie *v)
 {
-    return QPointF(this->scenePos().x() + coordonneesLiaison[ordreLiaison.key(v)]->x(),
-                                this->scenePos().y() + coordonneesLiaison[ordreLiaison.key(v)]->y());
+    return QPointF(this->scenePos().x() + liaisons[getOrdreLiaison(v)].coordonnees.x(),
+                                this->scenePos().y() + liaisons[getOrdreLiaison(v)].coordonnees.y());
 }
 
 void Voie::setContact(Contact *c)
@@ -127,9 +117,26 @@ Contact* Voie::getContact() const
     return this->contact;
 }
 
+qreal Voie::distanceAuTrace(const QPointF &p) const
+{
+    const QPointF &a = liaisons[0].coordonnees;
+    qreal distance = QLineF(p, a).length();
+
+    for(int i = 1; i < nbLiaisons; i++)
+    {
+        // projection du point sur la corde, bornée à ses extrémités.
+        const QPointF ab = liaisons[i].coordonnees - a;
+        const qreal longueur2 = QPointF::dotProduct(ab, ab);
+        const qreal t = longueur2 > 0.0 ? qBound(0.0, QPointF::dotProduct(p - a, ab) / longueur2, 1.0) : 0.0;
+        distance = qMin(distance, QLineF(p, a + t * ab).length());
+    }
+
+    return distance;
+}
+
 int Voie::getNbreLiaisons() const
 {
-    return ordreLiaison.size();
+    return nbLiaisons;
 }
 
 qreal Voie::getXmin() const
@@ -154,22 +161,28 @@ qreal Voie::getYmax() const
 
 qreal Voie::getAngleVoisin(Voie *voisin) const
 {
-    return angleLiaison[ordreLiaison.key(voisin)];
+    return liaisons[getOrdreLiaison(voisin)].angle;
 }
 
 qreal Voie::getNouvelAngle(Voie *voisin) const
 {
-    return normaliserAngle(angleLiaison[ordreLiaison.key(voisin)] + 180.0);
+    return normaliserAngle(liaisons[getOrdreLiaison(voisin)].angle + 180.0);
+}
+
+QPointF Voie::getNouvelleDirection(Voie *voisin) const
+{
+    // angle + 180° : direction opposée à celle de la liaison.
+    return - liaisons[getOrdreLiaison(voisin)].direction;
 }
 
 qreal Voie::getAngleDeg(int liaison) const
 {
-    return angleLiaison[liaison];
+    return liaisons[liaison].angle;
 }
 
 qreal Voie::getAngleRad(int liaison) const
 {
-    return (angleLiaison[liaison] /180.0) * PI;
+    return (liaisons[liaison].angle /180.0) * PI;
 }
 
 void Voie::setAngleDeg(int liaison, qreal angle)
@@ -181,7 +194,8 @@ void Voie::setAngleDeg(int liaison, qreal angle)
     else
         temp = ceil(temp) / 4.0;
 
-    angleLiaison[liaison] = normaliserAngle(temp);
+    liaisons[liaison].angle = normaliserAngle(temp);
+    liaisons[liaison].direction = QPointF(cos(getAngleRad(liaison)), sin(getAngleRad(liaison)));
 }
 
 void Voie::setAngleRad(int liaison, qreal angle)
@@ -195,13 +209,31 @@ void Voie::setAngleRad(int liaison, qreal angle)
         temp1 = ceil(temp) / 4.0;
 
     qreal nouvel=normaliserAngle(temp1);
-    angleLiaison[liaison] = normaliserAngle(nouvel);
+    liaisons[liaison].angle = normaliserAngle(nouvel);
+    liaisons[liaison].direction = QPointF(cos(getAngleRad(liaison)), sin(getAngleRad(liaison)));
+
+}
 
+bool Voie::estFixe() const
+{
+    return true;
 }
 
 Voie* Voie::getVoieVoisineDOrdre(int n)
 {
-    return ordreLiaison.value(n);
+    if(n < 0 || n >= nbLiaisons)
+        return nullptr;
+    return liaisons[n].voisin;
+}
+
+int Voie::getOrdreLiaison(Voie *voisin) const
+{
+    for(int i = 0; i < nbLiaisons; i++)
+    {
+        if(liaisons[i].voisin == voisin)
+            return i;
+    }
+    return 0;
 }
 
 void Voie::drawBoundingRect(QPainter *
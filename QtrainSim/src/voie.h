@@ -5,6 +5,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 #include <QMap>
 #include <QPointF>
 #include <QDebug>
@@ -17,21 +18,56 @@
 #include "general.h"
 #include "contact.h"
 
+class Voie;
+
+/** Données d'une extrémité de voie. Chaque type de voie les stocke dans un tableau
+  * de taille fixe, dimensionné selon son nombre d'extrémités.
+  */
+struct LiaisonVoie
+{
+    //! voie liée à cette extrémité.
+    Voie* voisin{nullptr};
+    //! coordonnées locales de l'extrémité.
+    QPointF coordonnees;
+    //! angle de l'extrémité en degrés.
+    qreal angle{0.0};
+    //! (cos, sin) de l'angle, mis à jour avec l'angle.
+    QPointF direction{1.0, 0.0};
+};
+
+/** Ecart constaté, lors du placement des voies, entre les extrémités de deux voies liées
+  * qui étaient déjà posées toutes les deux. Chaque écart correspond à la fermeture
+  * d'une boucle de la maquette.
+  */
+struct EcartJointure
+{
+    //! voie en cours de placement.
+    Voie* voie;
+    //! voie voisine, déjà posée.
+    Voie* voisin;
+    //! position de l'extrémité de voie moins celle de l'extrémité de voisin, avant correction.
+    QPointF ecart;
+};
+
 class Voie : public QObject, public QAbstractGraphicsShapeItem
 {
     Q_OBJECT
 
 public:
     /** Constructeur de classe.
+      * \param liaisons le tableau des extrémités, membre de la classe dérivée.
+      * \param nbLiaisons le nombre d'extrémités de la voie.
       */
-    Voie();
+    Voie(LiaisonVoie* liaisons, int nbLiaisons);
 
     /** Méthode permettant de calculer la position de la voie, en fonction d'une voie
       * voisine déjà posée. S'il s'agit de la première voie posée, on lui attribue une position
       * par défaut.
       * \param v pointeur sur la voie voisine déjà posée.
+      * \param ecarts si non nul, reçoit les écarts constatés entre voies déjà posées,
+      *        avant qu'ils ne soient corrigés.
       */
-    void calculerPosition(Voie* v = nullptr);
+    void calculerPosition(Voie* v = nullptr, QVector<EcartJointure>* ecarts = nullptr);
 
     /** méthode virtuelle visant à calculer les angles et coordonnées (locales) de chaque extrémité
       * de la voie.
@@ -80,18 +116,21 @@ public:
       */
     virtual void calculerPositionContact()=0;
 
-    /** Permet l'exploration récursive des voies en vue de la création des segments.
-      * \param voieAppelante pointeur sur la voie appelant récursivement celle-ci.
-      * \return Une liste de liste de voies, correspondant à tous chemins partant de cette voie
-      *         et terminant sur un contact, sauf le chemin partant depuis la voie appelante.
+    /** retourne la distance d'un point au tracé de la voie. Par défaut, le tracé est
+      * approché par les cordes menant de la première extrémité à chacune des autres.
+      * \param p le point, en coordonnées locales.
+      * \return la distance, en mm.
       */
-    virtual QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante)=0;
+    virtual qreal distanceAuTrace(const QPointF &p) const;
 
-    /** Démarre l'exploration contact à contact en vue de la création des segments.
-      * \return Une liste de liste de voies, correspondant à tous chemins partant de cette voie
-      *         et terminant sur un contact.
+    /** indique par quelles extrémités se poursuit l'exploration contact à contact, en vue
+      * de la création des segments, lorsqu'elle arrive sur la voie par une extrémité donnée.
+      * L'exploration s'arrête sur les voies portant un contact sans appeler cette méthode.
+      * \param liaisonArrivee l'ordre de l'extrémité d'arrivée.
+      * \return les ordres des extrémités de sortie, un bit par extrémité. 0 termine le
+      *         chemin sur cette voie, comme sur un buttoir.
       */
-    QList<QList<Voie*>*> startExplorationContactAContact();
+    virtual int sortiesExploration(int liaisonArrivee) const = 0;
 
     /** retourne le nombre de liaisons (en d'autres termes d'extrémités) de la voie.
       * \return le nombre de liaisons de la voie.
@@ -130,6 +169,13 @@ public:
       */
     qreal getNouvelAngle(Voie* voisin) const;
 
+    /** retourne le vecteur unitaire correspondant à getNouvelAngle(), précalculé
+      * lorsque l'angle de l'extrémité est fixé.
+      * \param voisin la voie d'ou vient la loco.
+      * \return (cos, sin) de l'angle ajusté de la loco.
+      */
+    QPointF getNouvelleDirection(Voie* voisin) const;
+
     /** retourne l'angle en degrés de l'extrémité d'ordre spécifié en paramètre.
       * \param liaison l'ordre de l'extrémité dont on veut l'angle.
       * \return l'angle en degrés.
@@ -183,6 +229,12 @@ public:
       */
     Voie* getVoieVoisineDOrdre(int n);
 
+    /** retourne l'ordre de l'extrémité liant cette voie à la voie voisine.
+      * \param voisin la voie voisine.
+      * \return l'ordre de l'extrémité, 0 si la voie n'est pas voisine.
+      */
+    int getOrdreLiaison(Voie* voisin) const;
+
     /** permet de spécifier la manière dont la voie sera dessinée.
       * \param color la couleur de la voie.
       */
@@ -211,12 +263,19 @@ public:
       */
     virtual void correctionPositionLoco(qreal &x, qreal &y)=0;
 
+    /** indique si l'apparence de la voie est fixe une fois la maquette chargée.
+      * Les voies fixes sont dessinées par SimView dans une image en cache.
+      * \return vrai si la voie ne change jamais d'apparence.
+      */
+    virtual bool estFixe() const;
+
     void setIdVoie(int id);
 
     int getIdVoie();
 protected:
-    QMap<int, Voie*> ordreLiaison;
-    QMap<int, QPointF*> coordonneesLiaison;
+    //! extrémités de la voie, indexées par leur ordre.
+    LiaisonVoie* liaisons;
+    int nbLiaisons;
     bool orientee, posee;
 
     /** normalise l'angle entre 0 et 360 degrés.
@@ -224,14 +283,10 @@ protected:
       * \return l'angle normalisé
       */
     double normaliserAngle(double angle) const;
-    QPointF* position;
-    QRectF* bRect;
     Contact* contact;
     int idVoie;
 
     //virtual void mousePressEvent ( QGraphicsSceneMouseEvent * event );
-private:
-    QMap<int, qreal> angleLiaison;
 };
 
 #endif // VOIE_H
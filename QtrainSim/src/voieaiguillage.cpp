@@ -10,7 +10,7 @@
   */
 
 VoieAiguillage::VoieAiguillage(qreal angle, qreal rayon, qreal longueur, qreal direction)
-    :VoieVariable()
+    :VoieVariable(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_AIGUILLAGE);
     this->rayon = rayon;
@@ -50,7 +50,7 @@ void VoieAiguillage::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -75,24 +75,24 @@ void VoieAiguillage::calculerAnglesEtCoordonnees(Voie *v)
     centre.setY(- rayon * sin(getAngleRad(0) - (direction / 2.0) * PI));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX(centre.x() + rayon * cos(getAngleRad(2) - (direction / 2.0) * PI));
-    coordonneesLiaison[2]->setY(centre.y() - rayon * sin(getAngleRad(2) - (direction / 2.0) * PI));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(longueur * cos(getAngleRad(1)));
+    liaisons[1].coordonnees.setY(- longueur * sin(getAngleRad(1)));
+    liaisons[2].coordonnees.setX(centre.x() + rayon * cos(getAngleRad(2) - (direction / 2.0) * PI));
+    liaisons[2].coordonnees.setY(centre.y() - rayon * sin(getAngleRad(2) - (direction / 2.0) * PI));
 
     if(this->contact != nullptr)
         calculerPositionContact();
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[2].voisin->estOrientee())
+        liaisons[2].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieAiguillage::calculerPositionContact()
@@ -101,35 +101,9 @@ void VoieAiguillage::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillage::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillage::sortiesExploration(int liaisonArrivee) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    return liaisonArrivee == 0 ? (1 << 1) | (1 << 2) : 1 << 0;
 }
 
 qreal VoieAiguillage::getLongueurAParcourir()
@@ -146,7 +120,7 @@ qreal VoieAiguillage::getLongueurAParcourir()
 
 void VoieAiguillage::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
 {
-    if(ordreLiaison.key(voieSuivante) == 0)
+    if(getOrdreLiaison(voieSuivante) == 0)
     {
         if(normaliserAngle(angleCumule - getAngleDeg(1) - 180.0) < 1.0 &&
            normaliserAngle(angleCumule - getAngleDeg(1) - 180.0) > -1.0)
@@ -305,27 +279,27 @@ void VoieAiguillage::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal a
 void VoieAiguillage::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(getOrdreLiaison(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
+        liaisons[2].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[2].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        liaisons[getOrdreLiaison(v)].coordonnees.setX(liaisons[getOrdreLiaison(v)].coordonnees.x() + deltaX);
+        liaisons[getOrdreLiaison(v)].coordonnees.setY(liaisons[getOrdreLiaison(v)].coordonnees.y() + deltaY);
     }
 
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[2]->x() *
-                               coordonneesLiaison[2]->x() +
-                               coordonneesLiaison[2]->y() *
-                               coordonneesLiaison[2]->y());
+    qreal nouvelleCorde = sqrt(liaisons[2].coordonnees.x() *
+                               liaisons[2].coordonnees.x() +
+                               liaisons[2].coordonnees.y() *
+                               liaisons[2].coordonnees.y());
     this->rayon = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[2]->y(), - coordonneesLiaison[2]->x()) -
+    qreal anglePourCentre = atan2(- liaisons[2].coordonnees.y(), - liaisons[2].coordonnees.x()) -
                             direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre.
@@ -356,10 +330,10 @@ void VoieAiguillage::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
 
 QRectF VoieAiguillage::boundingRect() const
 {
-    qreal x1=min3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal x2=max3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal y1=min3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
-    qreal y2=max3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
+    qreal x1=min3(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x(),liaisons[2].coordonnees.x());
+    qreal x2=max3(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x(),liaisons[2].coordonnees.x());
+    qreal y1=min3(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y(),liaisons[2].coordonnees.y());
+    qreal y2=max3(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y(),liaisons[2].coordonnees.y());
     QRectF rect=QRectF(QPointF(x1,y1),QPointF(x2,y2));
     rect.adjust(-LARGEUR_VOIE,-LARGEUR_VOIE,LARGEUR_VOIE,LARGEUR_VOIE);
     return rect;
@@ -379,12 +353,12 @@ void VoieAiguillage::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
                          static_cast<int>((getAngleDeg(0) - (direction * 270.0)) *16),
                          static_cast<int>((direction * angle) *16));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
     }
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
         painter->setPen(p1);
         painter->drawArc(QRectF(centre.x() - rayon, centre.y() - rayon, 2.0 * rayon, 2.0 * rayon),
                          static_cast<int>((getAngleDeg(0) - (direction * 270.0)) *16.0),
@@ -402,7 +376,7 @@ void VoieAiguillage::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) - PI / 2.0;
 
 /*        if (angleTranslation>PI)
             angleTranslation-=PI;
@@ -410,13 +384,13 @@ void VoieAiguillage::paint(QPainter *painter, const QStyleOptionGraphicsItem */*
             angleTranslation+=PI;
   */
         if (direction==1.0)
-            rect = QRectF((coordonneesLiaison[1]->x()-coordonneesLiaison[0]->x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
-                        (coordonneesLiaison[1]->y()-coordonneesLiaison[0]->y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
+            rect = QRectF((liaisons[1].coordonnees.x()-liaisons[0].coordonnees.x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
+                        (liaisons[1].coordonnees.y()-liaisons[0].coordonnees.y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT); //meme constantes que pour les contacts.
         else
-            rect = QRectF((coordonneesLiaison[1]->x()-coordonneesLiaison[0]->x())/2-TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
-                        (coordonneesLiaison[1]->y()-coordonneesLiaison[0]->y())/2-TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
+            rect = QRectF((liaisons[1].coordonnees.x()-liaisons[0].coordonnees.x())/2-TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
+                        (liaisons[1].coordonnees.y()-liaisons[0].coordonnees.y())/2-TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT,
                         6.0 * TAILLE_CONTACT); //meme constantes que pour les contacts.
 
@@ -433,18 +407,18 @@ Voie* VoieAiguillage::getVoieSuivante(Voie *voieArrivee)
 {
     //gestion des deraillements!
 
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    int ordreVoieArrivee = getOrdreLiaison(voieArrivee);
 
     if(ordreVoieArrivee == 0)
     {
         if(etat == TOUT_DROIT)
         {
-            return ordreLiaison.value(1);
+            return liaisons[1].voisin;
         }
         else
         {
-            return ordreLiaison.value(2);
+            return liaisons[2].voisin;
         }
     }
-    else return ordreLiaison.value(0);
+    else return liaisons[0].voisin;
 }
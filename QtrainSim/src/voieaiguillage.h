@@ -13,7 +13,7 @@ public:
     void setNumVoieVariable(int numVoieVariable) override;
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
@@ -24,6 +24,8 @@ public:
 
     void mousePressEvent (QGraphicsSceneMouseEvent *) override;
 private:
+    static const int NB_LIAISONS = 3;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     qreal rayon, angle, longueur, direction;
     QPointF centre;
     qreal lastDistDel;
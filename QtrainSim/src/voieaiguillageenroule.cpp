@@ -2,7 +2,7 @@
 #include "trainsimsettings.h"
 
 VoieAiguillageEnroule::VoieAiguillageEnroule(qreal angle, qreal rayon, qreal longueur, qreal direction)
-    :VoieVariable()
+    :VoieVariable(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_AIGUILLAGE);
     this->rayonInterieur = rayon;
@@ -37,7 +37,7 @@ void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -66,24 +66,24 @@ void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
                           rayonExterieur * sin(getAngleRad(0) - (direction / 2.0) * PI));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(centreExterieur.x() + rayonExterieur * cos(getAngleRad(2) - (direction / 2.0) * PI));
-    coordonneesLiaison[1]->setY(centreExterieur.y() - rayonExterieur * sin(getAngleRad(2) - (direction / 2.0) * PI));
-    coordonneesLiaison[2]->setX(centreInterieur.x() + rayonInterieur * cos(getAngleRad(1) - (direction / 2.0) * PI));
-    coordonneesLiaison[2]->setY(centreInterieur.y() - rayonInterieur * sin(getAngleRad(1) - (direction / 2.0) * PI));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(centreExterieur.x() + rayonExterieur * cos(getAngleRad(2) - (direction / 2.0) * PI));
+    liaisons[1].coordonnees.setY(centreExterieur.y() - rayonExterieur * sin(getAngleRad(2) - (direction / 2.0) * PI));
+    liaisons[2].coordonnees.setX(centreInterieur.x() + rayonInterieur * cos(getAngleRad(1) - (direction / 2.0) * PI));
+    liaisons[2].coordonnees.setY(centreInterieur.y() - rayonInterieur * sin(getAngleRad(1) - (direction / 2.0) * PI));
 
     if(this->contact != nullptr)
         calculerPositionContact();
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[2].voisin->estOrientee())
+        liaisons[2].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 
@@ -99,35 +99,9 @@ void VoieAiguillageEnroule::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillageEnroule::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillageEnroule::sortiesExploration(int liaisonArrivee) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    return liaisonArrivee == 0 ? (1 << 1) | (1 << 2) : 1 << 0;
 }
 
 qreal VoieAiguillageEnroule::getLongueurAParcourir()
@@ -146,7 +120,7 @@ void VoieAiguillageEnroule::avanceLoco(qreal &dist, qreal &angle, qreal &rayon,
 {
     QPointF positionLocoRelative = mapFromParent(posActuelle);
 
-    if(ordreLiaison.key(voieSuivante) == 0)
+    if(getOrdreLiaison(voieSuivante) == 0)
     {
         if(sqrt((positionLocoRelative.x() - centreInterieur.x()) * (positionLocoRelative.x() - centreInterieur.x()) +
                 (positionLocoRelative.y() - centreInterieur.y()) * (positionLocoRelative.y() - centreInterieur.y())) - this->rayonInterieur < 0.1 &&
@@ -224,7 +198,7 @@ void VoieAiguillageEnroule::avanceLoco(qreal &dist, qreal &angle, qreal &rayon,
 
                 qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
 
-                qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
+                qreal angleRestant = (getAngleDeg(getOrdreLiaison(voieSuivante)) + 360.0) - (angleCumule + 360.0);
 
                 while(angleRestant < - this->angle * 2.0)
                 {
@@ -295,7 +269,7 @@ void VoieAiguillageEnroule::avanceLoco(qreal &dist, qreal &angle, qreal &rayon,
 
                 qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
 
-                qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
+                qreal angleRestant = (getAngleDeg(getOrdreLiaison(voieSuivante)) + 360.0) - (angleCumule + 360.0);
 
                 while(angleRestant < - this->angle * 2.0)
                 {
@@ -401,55 +375,55 @@ void VoieAiguillageEnroule::avanceLoco(qreal &dist, qreal &angle, qreal &rayon,
 void VoieAiguillageEnroule::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(getOrdreLiaison(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
+        liaisons[2].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[2].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        liaisons[getOrdreLiaison(v)].coordonnees.setX(liaisons[getOrdreLiaison(v)].coordonnees.x() + deltaX);
+        liaisons[getOrdreLiaison(v)].coordonnees.setY(liaisons[getOrdreLiaison(v)].coordonnees.y() + deltaY);
     }
 
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[2]->x() *
-                               coordonneesLiaison[2]->x() +
-                               coordonneesLiaison[2]->y() *
-                               coordonneesLiaison[2]->y());
+    qreal nouvelleCorde = sqrt(liaisons[2].coordonnees.x() *
+                               liaisons[2].coordonnees.x() +
+                               liaisons[2].coordonnees.y() *
+                               liaisons[2].coordonnees.y());
     this->rayonInterieur = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[2]->y(), - coordonneesLiaison[2]->x()) -
+    qreal anglePourCentre = atan2(- liaisons[2].coordonnees.y(), - liaisons[2].coordonnees.x()) -
                            direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre interieur.
     centreInterieur.setX(- rayonInterieur * cos(anglePourCentre));
     centreInterieur.setY(- rayonInterieur * sin(anglePourCentre));
 
-    nouvelleCorde = sqrt((coordonneesLiaison[1]->x()- longueur * cos(getAngleRad(0) + PI)) *
-                         (coordonneesLiaison[1]->x()- longueur * cos(getAngleRad(0) + PI)) +
-                         (- coordonneesLiaison[1]->y()- longueur * sin(getAngleRad(0) + PI)) *
-                         (- coordonneesLiaison[1]->y()- longueur * sin(getAngleRad(0) + PI)));
+    nouvelleCorde = sqrt((liaisons[1].coordonnees.x()- longueur * cos(getAngleRad(0) + PI)) *
+                         (liaisons[1].coordonnees.x()- longueur * cos(getAngleRad(0) + PI)) +
+                         (- liaisons[1].coordonnees.y()- longueur * sin(getAngleRad(0) + PI)) *
+                         (- liaisons[1].coordonnees.y()- longueur * sin(getAngleRad(0) + PI)));
     this->rayonExterieur = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    anglePourCentre = atan2(+ coordonneesLiaison[1]->y() - longueur * sin(getAngleRad(0)),
-                            - coordonneesLiaison[1]->x()- longueur * cos(getAngleRad(0))) -
+    anglePourCentre = atan2(+ liaisons[1].coordonnees.y() - longueur * sin(getAngleRad(0)),
+                            - liaisons[1].coordonnees.x()- longueur * cos(getAngleRad(0))) -
                             direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre exterieur.
-    centreExterieur.setX(coordonneesLiaison[1]->x() + rayonExterieur * cos(anglePourCentre));
-    centreExterieur.setY(coordonneesLiaison[1]->y() - rayonExterieur * sin(anglePourCentre));
+    centreExterieur.setX(liaisons[1].coordonnees.x() + rayonExterieur * cos(anglePourCentre));
+    centreExterieur.setY(liaisons[1].coordonnees.y() - rayonExterieur * sin(anglePourCentre));
 
 
     setAngleRad(0, atan2(- centreInterieur.y(), centreInterieur.x()) + direction * PI / 2.0);
 
-    setAngleRad(1, atan2(- centreExterieur.y() + coordonneesLiaison[1]->y(),
-                         centreExterieur.x() - coordonneesLiaison[1]->x()) - direction * PI / 2.0);
+    setAngleRad(1, atan2(- centreExterieur.y() + liaisons[1].coordonnees.y(),
+                         centreExterieur.x() - liaisons[1].coordonnees.x()) - direction * PI / 2.0);
 
-    setAngleRad(2, atan2(- centreInterieur.y() - coordonneesLiaison[2]->y(),
-                         centreInterieur.x() + coordonneesLiaison[2]->x()) - direction * PI / 2.0);
+    setAngleRad(2, atan2(- centreInterieur.y() - liaisons[2].coordonnees.y(),
+                         centreInterieur.x() + liaisons[2].coordonnees.x()) - direction * PI / 2.0);
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -463,10 +437,10 @@ void VoieAiguillageEnroule::correctionPosition(qreal deltaX, qreal deltaY, Voie
 
 QRectF VoieAiguillageEnroule::boundingRect() const
 {
-    qreal x1=min3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal x2=max3(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x());
-    qreal y1=min3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
-    qreal y2=max3(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y());
+    qreal x1=min3(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x(),liaisons[2].coordonnees.x());
+    qreal x2=max3(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x(),liaisons[2].coordonnees.x());
+    qreal y1=min3(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y(),liaisons[2].coordonnees.y());
+    qreal y2=max3(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y(),liaisons[2].coordonnees.y());
     QRectF rect=QRectF(QPointF(x1,y1),QPointF(x2,y2));
     rect.adjust(-LARGEUR_VOIE,-LARGEUR_VOIE,LARGEUR_VOIE,LARGEUR_VOIE);
     return rect;
@@ -489,7 +463,7 @@ void VoieAiguillageEnroule::paint(QPainter *painter, const QStyleOptionGraphicsI
                      static_cast<int>((getAngleDeg(0) - (direction * 270.0)) *16),
                      static_cast<int>((direction * angle) *16));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], QPointF(longueur * cos(getAngleRad(0) + PI),
+        painter->drawLine(liaisons[0].coordonnees, QPointF(longueur * cos(getAngleRad(0) + PI),
                                                           - longueur * sin(getAngleRad(0) + PI)));
         painter->drawArc(QRectF(centreExterieur.x() - rayonExterieur,
                                 centreExterieur.y() - rayonExterieur,
@@ -501,7 +475,7 @@ void VoieAiguillageEnroule::paint(QPainter *painter, const QStyleOptionGraphicsI
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], QPointF(longueur * cos(getAngleRad(0) + PI),
+        painter->drawLine(liaisons[0].coordonnees, QPointF(longueur * cos(getAngleRad(0) + PI),
                                                           - longueur * sin(getAngleRad(0) + PI)));
         painter->drawArc(QRectF(centreExterieur.x() - rayonExterieur,
                                 centreExterieur.y() - rayonExterieur,
@@ -528,7 +502,7 @@ void VoieAiguillageEnroule::paint(QPainter *painter, const QStyleOptionGraphicsI
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) - PI / 2.0;
 
         rect = QRectF(TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
                       TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
@@ -548,18 +522,18 @@ Voie* VoieAiguillageEnroule::getVoieSuivante(Voie *voieArrivee)
 {
     //gestion des deraillements!
 
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    int ordreVoieArrivee = getOrdreLiaison(voieArrivee);
 
     if(ordreVoieArrivee == 0)
     {
         if(etat == TOUT_DROIT)
         {
-            return ordreLiaison.value(1);
+            return liaisons[1].voisin;
         }
         else
         {
-            return ordreLiaison.value(2);
+            return liaisons[2].voisin;
         }
     }
-    else return ordreLiaison.value(0);
+    else return liaisons[0].voisin;
 }
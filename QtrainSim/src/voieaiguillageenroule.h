@@ -12,7 +12,7 @@ public:
     void setNumVoieVariable(int numVoieVariable) override;
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
@@ -23,6 +23,8 @@ public:
 
     void mousePressEvent (QGraphicsSceneMouseEvent *) override;
 private:
+    static const int NB_LIAISONS = 3;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     qreal rayonInterieur, rayonExterieur, angle, longueur, direction;
     QPointF centreInterieur;
     QPointF centreExterieur;
@@ -10,7 +10,7 @@
   */
 
 VoieAiguillageTriple::VoieAiguillageTriple(qreal angle, qreal rayon, qreal longueur)
-    :VoieVariable()
+    :VoieVariable(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_AIGUILLAGE);
     this->rayonGauche = this->rayonDroite = rayon;
@@ -45,7 +45,7 @@ void VoieAiguillageTriple::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -81,28 +81,28 @@ void VoieAiguillageTriple::calculerAnglesEtCoordonnees(Voie *v)
     centreDroite.setY(- rayonDroite * sin(getAngleRad(0) + (PI / 2.0)));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX(centreGauche.x() + rayonGauche * cos(getAngleRad(2) - (PI / 2.0)));
-    coordonneesLiaison[2]->setY(centreGauche.y() - rayonGauche * sin(getAngleRad(2) - (PI / 2.0)));
-    coordonneesLiaison[3]->setX(centreDroite.x() + rayonDroite * cos(getAngleRad(3) + (PI / 2.0)));
-    coordonneesLiaison[3]->setY(centreDroite.y() - rayonDroite * sin(getAngleRad(3) + (PI / 2.0)));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(longueur * cos(getAngleRad(1)));
+    liaisons[1].coordonnees.setY(- longueur * sin(getAngleRad(1)));
+    liaisons[2].coordonnees.setX(centreGauche.x() + rayonGauche * cos(getAngleRad(2) - (PI / 2.0)));
+    liaisons[2].coordonnees.setY(centreGauche.y() - rayonGauche * sin(getAngleRad(2) - (PI / 2.0)));
+    liaisons[3].coordonnees.setX(centreDroite.x() + rayonDroite * cos(getAngleRad(3) + (PI / 2.0)));
+    liaisons[3].coordonnees.setY(centreDroite.y() - rayonDroite * sin(getAngleRad(3) + (PI / 2.0)));
 
     if(this->contact != nullptr)
         calculerPositionContact();
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[3]->estOrientee())
-        ordreLiaison[3]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[2].voisin->estOrientee())
+        liaisons[2].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[3].voisin->estOrientee())
+        liaisons[3].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieAiguillageTriple::calculerPositionContact()
@@ -111,36 +111,9 @@ void VoieAiguillageTriple::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillageTriple::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillageTriple::sortiesExploration(int liaisonArrivee) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    return liaisonArrivee == 0 ? (1 << 1) | (1 << 2) | (1 << 3) : 1 << 0;
 }
 
 qreal VoieAiguillageTriple::getLongueurAParcourir()
@@ -163,7 +136,7 @@ void VoieAiguillageTriple::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, q
 {
     QPointF positionLocoRelative = mapFromParent(posActuelle);
 
-    if(ordreLiaison.key(voieSuivante) == 0)
+    if(getOrdreLiaison(voieSuivante) == 0)
     {
         if(angleCumule == normaliserAngle(getAngleDeg(1) - 180.0))
         {
@@ -286,7 +259,7 @@ void VoieAiguillageTriple::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, q
 
             qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
 
-            qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
+            qreal angleRestant = (getAngleDeg(getOrdreLiaison(voieSuivante)) + 360.0) - (angleCumule + 360.0);
 
             while(angleRestant < - this->angle)
             {
@@ -354,30 +327,30 @@ void VoieAiguillageTriple::correctionPositionLoco(qreal &/*x*/, qreal &/*y*/)
 void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(getOrdreLiaison(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
-        coordonneesLiaison[3]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[3]->setY(coordonneesLiaison[2]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
+        liaisons[2].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[2].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
+        liaisons[3].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[3].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        liaisons[getOrdreLiaison(v)].coordonnees.setX(liaisons[getOrdreLiaison(v)].coordonnees.x() + deltaX);
+        liaisons[getOrdreLiaison(v)].coordonnees.setY(liaisons[getOrdreLiaison(v)].coordonnees.y() + deltaY);
     }
 
     //modifications pour courbe gauche.
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[2]->x() *
-                               coordonneesLiaison[2]->x() +
-                               coordonneesLiaison[2]->y() *
-                               coordonneesLiaison[2]->y());
+    qreal nouvelleCorde = sqrt(liaisons[2].coordonnees.x() *
+                               liaisons[2].coordonnees.x() +
+                               liaisons[2].coordonnees.y() *
+                               liaisons[2].coordonnees.y());
     this->rayonGauche = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[2]->y(), - coordonneesLiaison[2]->x()) -
+    qreal anglePourCentre = atan2(- liaisons[2].coordonnees.y(), - liaisons[2].coordonnees.x()) -
                             ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre gauche.
@@ -385,13 +358,13 @@ void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *
     centreGauche.setY(- rayonGauche * sin(anglePourCentre));
 
     //modifications pour courbe droite.
-    nouvelleCorde = sqrt(coordonneesLiaison[3]->x() *
-                         coordonneesLiaison[3]->x() +
-                         coordonneesLiaison[3]->y() *
-                         coordonneesLiaison[3]->y());
+    nouvelleCorde = sqrt(liaisons[3].coordonnees.x() *
+                         liaisons[3].coordonnees.x() +
+                         liaisons[3].coordonnees.y() *
+                         liaisons[3].coordonnees.y());
     this->rayonDroite = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    anglePourCentre = atan2(- coordonneesLiaison[3]->y(), - coordonneesLiaison[3]->x()) +
+    anglePourCentre = atan2(- liaisons[3].coordonnees.y(), - liaisons[3].coordonnees.x()) +
                       ((180.0 - angle) / 360.0) * PI;
 
 
@@ -401,13 +374,13 @@ void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *
 
     setAngleRad(0, atan2(- centreGauche.y(), centreGauche.x()) + PI / 2.0);
 
-    setAngleDeg(1, atan2(- coordonneesLiaison[1]->y(), -coordonneesLiaison[1]->x()));
+    setAngleDeg(1, atan2(- liaisons[1].coordonnees.y(), -liaisons[1].coordonnees.x()));
 
-    setAngleRad(2, atan2(- centreGauche.y() + coordonneesLiaison[2]->y(),
-                         centreGauche.x() - coordonneesLiaison[2]->x()) - PI / 2.0);
+    setAngleRad(2, atan2(- centreGauche.y() + liaisons[2].coordonnees.y(),
+                         centreGauche.x() - liaisons[2].coordonnees.x()) - PI / 2.0);
 
-    setAngleRad(3, atan2(- centreDroite.y() + coordonneesLiaison[3]->y(),
-                         centreDroite.x() - coordonneesLiaison[3]->x()) + PI / 2.0);
+    setAngleRad(3, atan2(- centreDroite.y() + liaisons[3].coordonnees.y(),
+                         centreDroite.x() - liaisons[3].coordonnees.x()) + PI / 2.0);
 
 
     if(this->contact != nullptr)
@@ -425,10 +398,10 @@ void VoieAiguillageTriple::correctionPosition(qreal deltaX, qreal deltaY, Voie *
 
 QRectF VoieAiguillageTriple::boundingRect() const
 {
-    qreal x1=min4(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x(),coordonneesLiaison[3]->x());
-    qreal x2=max4(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x(),coordonneesLiaison[2]->x(),coordonneesLiaison[3]->x());
-    qreal y1=min4(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y(),coordonneesLiaison[3]->y());
-    qreal y2=max4(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y(),coordonneesLiaison[2]->y(),coordonneesLiaison[3]->y());
+    qreal x1=min4(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x(),liaisons[2].coordonnees.x(),liaisons[3].coordonnees.x());
+    qreal x2=max4(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x(),liaisons[2].coordonnees.x(),liaisons[3].coordonnees.x());
+    qreal y1=min4(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y(),liaisons[2].coordonnees.y(),liaisons[3].coordonnees.y());
+    qreal y2=max4(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y(),liaisons[2].coordonnees.y(),liaisons[3].coordonnees.y());
     QRectF rect=QRectF(QPointF(x1,y1),QPointF(x2,y2));
     rect.adjust(-LARGEUR_VOIE,-LARGEUR_VOIE,LARGEUR_VOIE,LARGEUR_VOIE);
     return rect;
@@ -451,12 +424,12 @@ void VoieAiguillageTriple::paint(QPainter *painter, const QStyleOptionGraphicsIt
                      static_cast<int>(-(getAngleDeg(0) *16.0 - 4320.0)),
                      static_cast<int>(-(angle *16.0)));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
     }
     else if(etat == -1)
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
         painter->drawArc(QRectF(centreDroite.x() - rayonDroite, centreDroite.y() - rayonDroite, 2.0 * rayonDroite, 2.0 * rayonDroite),
                      static_cast<int>(-(getAngleDeg(0) *16.0 - 4320.0)),
                      static_cast<int>(-(angle *16.0)));
@@ -468,7 +441,7 @@ void VoieAiguillageTriple::paint(QPainter *painter, const QStyleOptionGraphicsIt
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
         painter->drawArc(QRectF(centreGauche.x() - rayonGauche, centreGauche.y() - rayonGauche, 2.0 * rayonGauche, 2.0 * rayonGauche),
                      static_cast<int>((getAngleDeg(0) *16.0 - 4320.0)),
                      static_cast<int>(angle *16.0));
@@ -489,7 +462,7 @@ void VoieAiguillageTriple::paint(QPainter *painter, const QStyleOptionGraphicsIt
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) - PI / 2.0;
 
         rect = QRectF(TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
                       TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
@@ -509,18 +482,18 @@ Voie* VoieAiguillageTriple::getVoieSuivante(Voie *voieArrivee)
 {
     //gestion des deraillements!
 
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    int ordreVoieArrivee = getOrdreLiaison(voieArrivee);
 
     if(ordreVoieArrivee == 0)
     {
         if(etat == TOUT_DROIT)
         {
-            return ordreLiaison.value(1);
+            return liaisons[1].voisin;
         }
         else
         {
-            return ordreLiaison.value(2);
+            return liaisons[2].voisin;
         }
     }
-    else return ordreLiaison.value(0);
+    else return liaisons[0].voisin;
 }
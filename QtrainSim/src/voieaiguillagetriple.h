@@ -11,7 +11,7 @@ public:
     void setNumVoieVariable(int numVoieVariable) override;
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
@@ -22,6 +22,8 @@ public:
 
     void mousePressEvent (QGraphicsSceneMouseEvent *) override;
 private:
+    static const int NB_LIAISONS = 4;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     qreal rayonGauche, rayonDroite, angle, longueur;
     QPointF centreGauche;
     QPointF centreDroite;
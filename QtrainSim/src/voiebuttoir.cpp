@@ -1,7 +1,7 @@
 #include "voiebuttoir.h"
 
 VoieButtoir::VoieButtoir(qreal longueur)
-    :Voie()
+    :Voie(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_BUTTOIR);
     this->longueur = longueur;
@@ -21,16 +21,16 @@ void VoieButtoir::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
 
     if(this->contact != nullptr)
         calculerPositionContact();
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieButtoir::calculerPositionContact()
@@ -39,14 +39,9 @@ void VoieButtoir::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieButtoir::explorationContactAContact(Voie */*voieAppelante*/)
+int VoieButtoir::sortiesExploration(int /*liaisonArrivee*/) const
 {
-    QList<QList<Voie*>*> temp;
-
-    temp.append(new QList<Voie*>);
-    temp.at(0)->append(this);
-
-    return temp;
+    return 0;
 }
 
 qreal VoieButtoir::getLongueurAParcourir()
@@ -117,10 +112,10 @@ QRectF VoieButtoir::boundingRect() const
 {
     QPointF temp = QPointF(- longueur * cos(getAngleRad(0)),
                                 longueur * sin(getAngleRad(0)));
-    QRectF rect(min(coordonneesLiaison[0]->x(),temp.x()),
-                min(coordonneesLiaison[0]->y(),temp.y()),
-                fabs(coordonneesLiaison[0]->x()-temp.x()),
-                fabs(coordonneesLiaison[0]->y()-temp.y()));
+    QRectF rect(min(liaisons[0].coordonnees.x(),temp.x()),
+                min(liaisons[0].coordonnees.y(),temp.y()),
+                fabs(liaisons[0].coordonnees.x()-temp.x()),
+                fabs(liaisons[0].coordonnees.y()-temp.y()));
     rect.adjust(-10,-10,10,10);
     return rect;
 }
@@ -132,7 +127,7 @@ void VoieButtoir::paint(QPainter *painter, const QStyleOptionGraphicsItem */*opt
     QPointF temp = QPointF(- longueur * cos(getAngleRad(0)),
                                 longueur * sin(getAngleRad(0)));
 
-    painter->drawLine(*coordonneesLiaison[0], temp);
+    painter->drawLine(liaisons[0].coordonnees, temp);
     painter->drawEllipse(temp, 5.0, 5.0);
     drawBoundingRect(painter);
 
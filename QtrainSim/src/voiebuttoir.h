@@ -12,7 +12,7 @@ public:
     VoieButtoir(qreal longueur);
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie *) override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie*) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal, QPointF posActuelle, Voie *voieSuivante) override;
@@ -23,6 +23,8 @@ public:
     void setEtat(int) override;
 
 private:
+    static const int NB_LIAISONS = 1;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     qreal longueur;
 };
 
@@ -1,7 +1,9 @@
+#include <QLineF>
+
 #include "voiecourbe.h"
 
 VoieCourbe::VoieCourbe(qreal angle, qreal rayon, int direction)
-    :Voie()
+    :Voie(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_COURBE);
     this->rayon = rayon;
@@ -22,7 +24,7 @@ void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
 
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
@@ -41,10 +43,10 @@ void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
     centre.setY(- rayon * sin(getAngleRad(0) - (direction / 2.0) * PI));
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(centre.x() + rayon * cos(getAngleRad(1) - (direction / 2.0) * PI));
-    coordonneesLiaison[1]->setY(centre.y() - rayon * sin(getAngleRad(1) - (direction / 2.0) * PI));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(centre.x() + rayon * cos(getAngleRad(1) - (direction / 2.0) * PI));
+    liaisons[1].coordonnees.setY(centre.y() - rayon * sin(getAngleRad(1) - (direction / 2.0) * PI));
 
     if(this->contact != nullptr)
     {
@@ -53,43 +55,40 @@ void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieCourbe::calculerPositionContact()
 {
     this->contact->setPos(centre.x() + rayon * cos(getAngleRad(1) - direction * (PI + angle * PI / 180.0) / 2.0),
                           centre.y() - rayon * sin(getAngleRad(1) - direction * (PI + angle * PI / 180.0) / 2.0));
-    this->contact->setAngle(atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) + direction * PI / 2.0);
+    this->contact->setAngle(atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) + direction * PI / 2.0);
 }
 
-QList<QList<Voie*>*> VoieCourbe::explorationContactAContact(Voie* voieAppelante)
+qreal VoieCourbe::distanceAuTrace(const QPointF &p) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-            temp.append(ordreLiaison.value(1)->explorationContactAContact(this));
-        else
-            temp.append(ordreLiaison.value(0)->explorationContactAContact(this));
-
-        for(int i=0; i< temp.length(); i++)
-        {
-            temp.at(i)->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
+    const QPointF a = liaisons[0].coordonnees - centre;
+    const QPointF b = liaisons[1].coordonnees - centre;
+    const QPointF v = p - centre;
+
+    // l'arc fait moins d'un demi-tour : le point est dans son secteur s'il est du même
+    // côté que b par rapport à a, et que a par rapport à b.
+    const qreal ab = a.x() * b.y() - a.y() * b.x();
+    const qreal av = a.x() * v.y() - a.y() * v.x();
+    const qreal vb = v.x() * b.y() - v.y() * b.x();
+    if(av * ab >= 0.0 && vb * ab >= 0.0)
+        return qAbs(sqrt(QPointF::dotProduct(v, v)) - rayon);
+
+    return qMin(QLineF(p, liaisons[0].coordonnees).length(),
+                QLineF(p, liaisons[1].coordonnees).length());
+}
 
-    return temp;
+int VoieCourbe::sortiesExploration(int liaisonArrivee) const
+{
+    return liaisonArrivee == 0 ? 1 << 1 : 1 << 0;
 }
 
 qreal VoieCourbe::getLongueurAParcourir()
@@ -99,7 +98,7 @@ qreal VoieCourbe::getLongueurAParcourir()
 
 Voie* VoieCourbe::getVoieSuivante(Voie *voieArrivee)
 {
-    return ordreLiaison.value((ordreLiaison.key(voieArrivee) +1) % 2);
+    return liaisons[(getOrdreLiaison(voieArrivee) + 1) % 2].voisin;
 }
 
 void VoieCourbe::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante)
@@ -108,7 +107,7 @@ void VoieCourbe::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angle
 
     qreal angleAParcourir = (dist / this->rayon) * (180.0 / PI);
 
-    qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
+    qreal angleRestant = (getAngleDeg(getOrdreLiaison(voieSuivante)) + 360.0) - (angleCumule + 360.0);
 
     while(angleRestant < - this->angle * 2.0)
     {
@@ -167,25 +166,25 @@ void VoieCourbe::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angle
 void VoieCourbe::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction...
-    if(ordreLiaison.key(v) ==0)
+    if(getOrdreLiaison(v) ==0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() + deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() + deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() + deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() + deltaY);
     }
 
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[1]->x() *
-                               coordonneesLiaison[1]->x() +
-                               coordonneesLiaison[1]->y() *
-                               coordonneesLiaison[1]->y());
+    qreal nouvelleCorde = sqrt(liaisons[1].coordonnees.x() *
+                               liaisons[1].coordonnees.x() +
+                               liaisons[1].coordonnees.y() *
+                               liaisons[1].coordonnees.y());
     this->rayon = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) -
+    qreal anglePourCentre = atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) -
                             direction * ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre.
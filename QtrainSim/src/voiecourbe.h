@@ -12,7 +12,8 @@ public:
     VoieCourbe(qreal angle, qreal rayon, int direction);
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    qreal distanceAuTrace(const QPointF &p) const override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
@@ -23,6 +24,8 @@ public:
     void setEtat(int) override;
 
 private:
+    static const int NB_LIAISONS = 2;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     QPointF centre;
     qreal rayon, angle;
     int direction;
@@ -1,7 +1,7 @@
 #include "voiecroisement.h"
 
 VoieCroisement::VoieCroisement(qreal angle, qreal longueur)
-    :Voie()
+    :Voie(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_CROISEMENT);
     this->angle = angle;
@@ -21,7 +21,7 @@ void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -51,28 +51,28 @@ void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
-    coordonneesLiaison[2]->setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
-    coordonneesLiaison[3]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
-    coordonneesLiaison[3]->setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(longueur * cos(getAngleRad(1)));
+    liaisons[1].coordonnees.setY(- longueur * sin(getAngleRad(1)));
+    liaisons[2].coordonnees.setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
+    liaisons[2].coordonnees.setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
+    liaisons[3].coordonnees.setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
+    liaisons[3].coordonnees.setY(-((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
 
     if(this->contact != nullptr)
         calculerPositionContact();
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[3]->estOrientee())
-        ordreLiaison[3]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[2].voisin->estOrientee())
+        liaisons[2].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[3].voisin->estOrientee())
+        liaisons[3].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieCroisement::calculerPositionContact()
@@ -81,42 +81,10 @@ void VoieCroisement::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieCroisement::explorationContactAContact(Voie* voieAppelante)
+int VoieCroisement::sortiesExploration(int liaisonArrivee) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 1)
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 2)
-        {
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 3)
-        {
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    // chaque partie droite est parcourue de bout en bout : 0 et 1, 2 et 3.
+    return 1 << (liaisonArrivee ^ 1);
 }
 
 qreal VoieCroisement::getLongueurAParcourir()
@@ -126,16 +94,16 @@ qreal VoieCroisement::getLongueurAParcourir()
 
 Voie* VoieCroisement::getVoieSuivante(Voie *voieArrivee)
 {
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    int ordreVoieArrivee = getOrdreLiaison(voieArrivee);
 
     if( ordreVoieArrivee == 0)
-        return ordreLiaison.value(1);
+        return liaisons[1].voisin;
     else if (ordreVoieArrivee == 1)
-        return ordreLiaison.value(0);
+        return liaisons[0].voisin;
     else if (ordreVoieArrivee == 2)
-        return ordreLiaison.value(3);
+        return liaisons[3].voisin;
     else
-        return ordreLiaison.value(2);
+        return liaisons[2].voisin;
 }
 
 void VoieCroisement::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal /*angleCumule*/, QPointF posActuelle, Voie *voieSuivante)
@@ -173,20 +141,20 @@ void VoieCroisement::avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal /
 void VoieCroisement::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //correction
-    if(ordreLiaison.key(v) == 0)
+    if(getOrdreLiaison(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
-        coordonneesLiaison[3]->setX(coordonneesLiaison[3]->x() - deltaX);
-        coordonneesLiaison[3]->setY(coordonneesLiaison[3]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
+        liaisons[2].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[2].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
+        liaisons[3].coordonnees.setX(liaisons[3].coordonnees.x() - deltaX);
+        liaisons[3].coordonnees.setY(liaisons[3].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        liaisons[getOrdreLiaison(v)].coordonnees.setX(liaisons[getOrdreLiaison(v)].coordonnees.x() + deltaX);
+        liaisons[getOrdreLiaison(v)].coordonnees.setY(liaisons[getOrdreLiaison(v)].coordonnees.y() + deltaY);
     }
 
     if(this->contact != nullptr)
@@ -209,8 +177,8 @@ QRectF VoieCroisement::boundingRect() const
 void VoieCroisement::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
     painter->setPen(this->pen());
-    painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
-    painter->drawLine(*coordonneesLiaison[2], *coordonneesLiaison[3]);
+    painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
+    painter->drawLine(liaisons[2].coordonnees, liaisons[3].coordonnees);
     drawBoundingRect(painter);
 
 }
@@ -1,7 +1,7 @@
 #include "voiedroite.h"
 
 VoieDroite::VoieDroite(qreal longueur)
-    :Voie()
+    :Voie(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_DROITE);
     this->longueur = longueur;
@@ -20,7 +20,7 @@ void VoieDroite::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -34,52 +34,31 @@ void VoieDroite::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(longueur * cos(getAngleRad(1)));
+    liaisons[1].coordonnees.setY(- longueur * sin(getAngleRad(1)));
 
     if(this->contact != nullptr)
         calculerPositionContact();
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieDroite::calculerPositionContact()
 {
-    this->contact->setPos(longueur * cos(getAngleRad(1)) / 2.0, longueur * sin(getAngleRad(1)) / 2.0);
-    this->contact->setAngle(atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) + PI / 2.0);
+    this->contact->setPos((liaisons[0].coordonnees + liaisons[1].coordonnees) / 2.0);
+    this->contact->setAngle(atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) + PI / 2.0);
 }
 
-QList<QList<Voie*>*> VoieDroite::explorationContactAContact(Voie* voieAppelante)
+int VoieDroite::sortiesExploration(int liaisonArrivee) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-            temp.append(ordreLiaison.value(1)->explorationContactAContact(this));
-        else
-            temp.append(ordreLiaison.value(0)->explorationContactAContact(this));
-
-        for(int i=0; i< temp.length(); i++)
-        {
-            temp.at(i)->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    return liaisonArrivee == 0 ? 1 << 1 : 1 << 0;
 }
 
 qreal VoieDroite::getLongueurAParcourir()
@@ -89,7 +68,7 @@ qreal VoieDroite::getLongueurAParcourir()
 
 Voie* VoieDroite::getVoieSuivante(Voie *voieArrivee)
 {
-    return ordreLiaison.value((ordreLiaison.key(voieArrivee) +1) % 2);
+    return liaisons[(getOrdreLiaison(voieArrivee) + 1) % 2].voisin;
 }
 
 void VoieDroite::avanceLoco(qreal &dist, qreal &/*angle*/, qreal &/*rayon*/, qreal /*angleCumule*/, QPointF posActuelle, Voie *voieSuivante)
@@ -121,20 +100,20 @@ void VoieDroite::avanceLoco(qreal &dist, qreal &/*angle*/, qreal &/*rayon*/, qre
 void VoieDroite::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //Correction...
-    if(ordreLiaison.key(v) == 0)
+    if(getOrdreLiaison(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() + deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() + deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() + deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() + deltaY);
     }
 
-//    setAngleRad(0, atan2(coordonneesLiaison[1]->y(), coordonneesLiaison[1]->x()));
-//    setAngleRad(1, atan2(-coordonneesLiaison[1]->y(), -coordonneesLiaison[1]->x()));
+//    setAngleRad(0, atan2(liaisons[1].coordonnees.y(), liaisons[1].coordonnees.x()));
+//    setAngleRad(1, atan2(-liaisons[1].coordonnees.y(), -liaisons[1].coordonnees.x()));
 
 
     if(this->contact != nullptr)
@@ -145,8 +124,8 @@ void VoieDroite::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 void VoieDroite::correctionPositionLoco(qreal &x, qreal &y)
 {
     QPointF p0(x, y);
-    QPointF p1 = *coordonneesLiaison[0];
-    QPointF p2 = *coordonneesLiaison[1];
+    QPointF p1 = liaisons[0].coordonnees;
+    QPointF p2 = liaisons[1].coordonnees;
 
     qreal distP1P0 = sqrt((p1.x()-p0.x())*(p1.x()-p0.x()) + (p1.y()-p0.y())*(p1.y()-p0.y()));
     qreal dx = p1.x()-p2.x();
@@ -159,7 +138,7 @@ void VoieDroite::correctionPositionLoco(qreal &x, qreal &y)
     qreal angleP2P1P0 = add/(sqrt1*sqrt2);
 
     // This situation can happen if two points are equal, for instance if
-    // (x,y) are just exactly on a coordonneesLiaison. In that case, no
+    // (x,y) are just exactly on a link end point. In that case, no
     // need to adjust, so that's all right
     if (isnan(angleP2P1P0)) {
         return;
@@ -180,10 +159,10 @@ void VoieDroite::correctionPositionLoco(qreal &x, qreal &y)
 
 QRectF VoieDroite::boundingRect() const
 {
-    QRectF rect(min(coordonneesLiaison[0]->x(),coordonneesLiaison[1]->x()),
-                min(coordonneesLiaison[0]->y(),coordonneesLiaison[1]->y()),
-                fabs(coordonneesLiaison[0]->x()-coordonneesLiaison[1]->x()),
-                fabs(coordonneesLiaison[0]->y()-coordonneesLiaison[1]->y()));
+    QRectF rect(min(liaisons[0].coordonnees.x(),liaisons[1].coordonnees.x()),
+                min(liaisons[0].coordonnees.y(),liaisons[1].coordonnees.y()),
+                fabs(liaisons[0].coordonnees.x()-liaisons[1].coordonnees.x()),
+                fabs(liaisons[0].coordonnees.y()-liaisons[1].coordonnees.y()));
     rect.adjust(-10,-10,10,10);
     return rect;
 }
@@ -191,7 +170,7 @@ QRectF VoieDroite::boundingRect() const
 void VoieDroite::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/, QWidget */*widget*/)
 {
     painter->setPen(this->pen());
-    painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
+    painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
 
     drawBoundingRect(painter);
 }
@@ -12,7 +12,7 @@ public:
     VoieDroite(qreal longueur);
     void calculerAnglesEtCoordonnees(Voie *v = nullptr) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &, qreal &, qreal, QPointF posActuelle, Voie *voieSuivante) override;
@@ -22,6 +22,8 @@ public:
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
     void setEtat(int) override;
 private:
+    static const int NB_LIAISONS = 2;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     qreal longueur;
     qreal lastDistDel;
 };
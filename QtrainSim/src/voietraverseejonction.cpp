@@ -1,7 +1,7 @@
 #include "voietraverseejonction.h"
 
 VoieTraverseeJonction::VoieTraverseeJonction(qreal angle, qreal rayon, qreal longueur)
-    :VoieVariable()
+    :VoieVariable(stockageLiaisons, NB_LIAISONS)
 {
     setNewPen(COULEUR_TRAVERSEEJONCTION);
     this->rayon03 = this->rayon12 = rayon;
@@ -28,7 +28,7 @@ void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
     }
     else
     {
-        ordreVoieFixe = ordreLiaison.key(v);
+        ordreVoieFixe = getOrdreLiaison(v);
         setAngleDeg(ordreVoieFixe, normaliserAngle(v->getAngleVoisin(this) + 180.0));
     }
 
@@ -58,18 +58,18 @@ void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     //calculer position relative de 0 et 1.
-    coordonneesLiaison[0]->setX(0.0);
-    coordonneesLiaison[0]->setY(0.0);
-    coordonneesLiaison[1]->setX(longueur * cos(getAngleRad(1)));
-    coordonneesLiaison[1]->setY(- longueur * sin(getAngleRad(1)));
-    coordonneesLiaison[2]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
-    coordonneesLiaison[2]->setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
-    coordonneesLiaison[3]->setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
-    coordonneesLiaison[3]->setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
+    liaisons[0].coordonnees.setX(0.0);
+    liaisons[0].coordonnees.setY(0.0);
+    liaisons[1].coordonnees.setX(longueur * cos(getAngleRad(1)));
+    liaisons[1].coordonnees.setY(- longueur * sin(getAngleRad(1)));
+    liaisons[2].coordonnees.setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(2))));
+    liaisons[2].coordonnees.setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(2)))));
+    liaisons[3].coordonnees.setX((longueur / 2.0) * (cos(getAngleRad(1)) + cos(getAngleRad(3))));
+    liaisons[3].coordonnees.setY(- ((longueur / 2.0) * (sin(getAngleRad(1)) + sin(getAngleRad(3)))));
 
     //calculer coordonnees du centre12.
-    centre12.setX(coordonneesLiaison.value(1)->x() + rayon12 * cos(getAngleRad(1) - PI / 2.0));
-    centre12.setY(coordonneesLiaison.value(1)->y() +- rayon12 * sin(getAngleRad(1) - PI / 2.0));
+    centre12.setX(liaisons[1].coordonnees.x() + rayon12 * cos(getAngleRad(1) - PI / 2.0));
+    centre12.setY(liaisons[1].coordonnees.y() +- rayon12 * sin(getAngleRad(1) - PI / 2.0));
     //calculer coordonnees du centre03.
     centre03.setX(rayon03 * cos(getAngleRad(0) - PI / 2.0));
     centre03.setY(- rayon03 * sin(getAngleRad(0) - PI / 2.0));
@@ -80,14 +80,14 @@ void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
 
     orientee = true;
 
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[3]->estOrientee())
-        ordreLiaison[3]->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[0].voisin->estOrientee())
+        liaisons[0].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[1].voisin->estOrientee())
+        liaisons[1].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[2].voisin->estOrientee())
+        liaisons[2].voisin->calculerAnglesEtCoordonnees(this);
+    if(!liaisons[3].voisin->estOrientee())
+        liaisons[3].voisin->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieTraverseeJonction::calculerPositionContact()
@@ -96,36 +96,11 @@ void VoieTraverseeJonction::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieTraverseeJonction::explorationContactAContact(Voie* voieAppelante)
+int VoieTraverseeJonction::sortiesExploration(int liaisonArrivee) const
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0 || ordreLiaison.key(voieAppelante) == 2)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 1 || ordreLiaison.key(voieAppelante) == 3)
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    if(liaisonArrivee == 0 || liaisonArrivee == 2)
+        return (1 << 1) | (1 << 3);
+    return (1 << 0) | (1 << 2);
 }
 
 qreal VoieTraverseeJonction::getLongueurAParcourir()
@@ -142,29 +117,29 @@ qreal VoieTraverseeJonction::getLongueurAParcourir()
 
 Voie* VoieTraverseeJonction::getVoieSuivante(Voie *voieArrivee)
 {
-    int ordreVoieArrivee = ordreLiaison.key(voieArrivee);
+    int ordreVoieArrivee = getOrdreLiaison(voieArrivee);
 
     if(this->etat == TOUT_DROIT)
     {
         if( ordreVoieArrivee == 0)
-            return ordreLiaison.value(1);
+            return liaisons[1].voisin;
         else if (ordreVoieArrivee == 1)
-            return ordreLiaison.value(0);
+            return liaisons[0].voisin;
         else if (ordreVoieArrivee == 2)
-            return ordreLiaison.value(3);
+            return liaisons[3].voisin;
         else
-            return ordreLiaison.value(2);
+            return liaisons[2].voisin;
     }
     else
     {
         if( ordreVoieArrivee == 0)
-            return ordreLiaison.value(3);
+            return liaisons[3].voisin;
         else if (ordreVoieArrivee == 1)
-            return ordreLiaison.value(2);
+            return liaisons[2].voisin;
         else if (ordreVoieArrivee == 2)
-            return ordreLiaison.value(1);
+            return liaisons[1].voisin;
         else
-            return ordreLiaison.value(0);
+            return liaisons[0].voisin;
     }
 }
 
@@ -211,7 +186,7 @@ void VoieTraverseeJonction::avanceLoco(qreal &dist, qreal &angle, qreal &rayon,
         }
         qreal angleAParcourir = (dist / rayon) * (180.0 / PI);
 
-        qreal angleRestant = (getAngleDeg(ordreLiaison.key(voieSuivante)) + 360.0) - (angleCumule + 360.0);
+        qreal angleRestant = (getAngleDeg(getOrdreLiaison(voieSuivante)) + 360.0) - (angleCumule + 360.0);
 
         while(angleRestant < - this->angle)
         {
@@ -271,30 +246,30 @@ void VoieTraverseeJonction::avanceLoco(qreal &dist, qreal &angle, qreal &rayon,
 void VoieTraverseeJonction::correctionPosition(qreal deltaX, qreal deltaY, Voie *v)
 {
     //Correction
-    if(ordreLiaison.key(v) == 0)
+    if(getOrdreLiaison(v) == 0)
     {
         setPos(this->pos().x() + deltaX, this->pos().y() + deltaY);
-        coordonneesLiaison[1]->setX(coordonneesLiaison[1]->x() - deltaX);
-        coordonneesLiaison[1]->setY(coordonneesLiaison[1]->y() - deltaY);
-        coordonneesLiaison[2]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[2]->setY(coordonneesLiaison[2]->y() - deltaY);
-        coordonneesLiaison[3]->setX(coordonneesLiaison[2]->x() - deltaX);
-        coordonneesLiaison[3]->setY(coordonneesLiaison[2]->y() - deltaY);
+        liaisons[1].coordonnees.setX(liaisons[1].coordonnees.x() - deltaX);
+        liaisons[1].coordonnees.setY(liaisons[1].coordonnees.y() - deltaY);
+        liaisons[2].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[2].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
+        liaisons[3].coordonnees.setX(liaisons[2].coordonnees.x() - deltaX);
+        liaisons[3].coordonnees.setY(liaisons[2].coordonnees.y() - deltaY);
     }
     else
     {
-        coordonneesLiaison[ordreLiaison.key(v)]->setX(coordonneesLiaison[ordreLiaison.key(v)]->x() + deltaX);
-        coordonneesLiaison[ordreLiaison.key(v)]->setY(coordonneesLiaison[ordreLiaison.key(v)]->y() + deltaY);
+        liaisons[getOrdreLiaison(v)].coordonnees.setX(liaisons[getOrdreLiaison(v)].coordonnees.x() + deltaX);
+        liaisons[getOrdreLiaison(v)].coordonnees.setY(liaisons[getOrdreLiaison(v)].coordonnees.y() + deltaY);
     }
 
     //modifications pour courbe 03.
-    qreal nouvelleCorde = sqrt(coordonneesLiaison[3]->x() *
-                               coordonneesLiaison[3]->x() +
-                               coordonneesLiaison[3]->y() *
-                               coordonneesLiaison[3]->y());
+    qreal nouvelleCorde = sqrt(liaisons[3].coordonnees.x() *
+                               liaisons[3].coordonnees.x() +
+                               liaisons[3].coordonnees.y() *
+                               liaisons[3].coordonnees.y());
     this->rayon03 = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    qreal anglePourCentre = atan2(- coordonneesLiaison[3]->y(), - coordonneesLiaison[3]->x()) -
+    qreal anglePourCentre = atan2(- liaisons[3].coordonnees.y(), - liaisons[3].coordonnees.x()) -
                             ((180.0 - angle) / 360.0) * PI;
 
     //calculer coordonnees du centre 03.
@@ -302,30 +277,30 @@ void VoieTraverseeJonction::correctionPosition(qreal deltaX, qreal deltaY, Voie
     centre03.setY(- rayon03 * sin(anglePourCentre));
 
     //modifications pour courbe 12.
-    nouvelleCorde = sqrt((coordonneesLiaison[1]->x() - coordonneesLiaison[2]->x()) *
-                         (coordonneesLiaison[1]->x() - coordonneesLiaison[2]->x()) +
-                         (coordonneesLiaison[1]->y() - coordonneesLiaison[2]->y()) *
-                         (coordonneesLiaison[1]->y() - coordonneesLiaison[2]->y()));
+    nouvelleCorde = sqrt((liaisons[1].coordonnees.x() - liaisons[2].coordonnees.x()) *
+                         (liaisons[1].coordonnees.x() - liaisons[2].coordonnees.x()) +
+                         (liaisons[1].coordonnees.y() - liaisons[2].coordonnees.y()) *
+                         (liaisons[1].coordonnees.y() - liaisons[2].coordonnees.y()));
     this->rayon12 = nouvelleCorde / (2.0 * sin((angle / 360.0) * PI));
 
-    anglePourCentre = atan2(- coordonneesLiaison[1]->y() + coordonneesLiaison[2]->y(), - coordonneesLiaison[1]->x() + coordonneesLiaison[2]->x()) +
+    anglePourCentre = atan2(- liaisons[1].coordonnees.y() + liaisons[2].coordonnees.y(), - liaisons[1].coordonnees.x() + liaisons[2].coordonnees.x()) +
                       ((180.0 - angle) / 360.0) * PI;
 
 
     //calculer coordonnees du centre 12.
-    centre12.setX(coordonneesLiaison[2]->x() - rayon12 * cos(anglePourCentre));
-    centre12.setY(coordonneesLiaison[2]->y() - rayon12 * sin(anglePourCentre));
+    centre12.setX(liaisons[2].coordonnees.x() - rayon12 * cos(anglePourCentre));
+    centre12.setY(liaisons[2].coordonnees.y() - rayon12 * sin(anglePourCentre));
 
     setAngleRad(0, atan2(- centre03.y(), centre03.x()) + PI / 2.0);
 
-    setAngleRad(1, atan2(- centre12.y() + coordonneesLiaison[1]->y(),
-                         centre12.x() - coordonneesLiaison[1]->x()) + PI / 2.0);
+    setAngleRad(1, atan2(- centre12.y() + liaisons[1].coordonnees.y(),
+                         centre12.x() - liaisons[1].coordonnees.x()) + PI / 2.0);
 
-    setAngleRad(2, atan2(- centre12.y() + coordonneesLiaison[2]->y(),
-                         centre12.x() - coordonneesLiaison[2]->x()) - PI / 2.0);
+    setAngleRad(2, atan2(- centre12.y() + liaisons[2].coordonnees.y(),
+                         centre12.x() - liaisons[2].coordonnees.x()) - PI / 2.0);
 
-    setAngleRad(3, atan2(- centre03.y() + coordonneesLiaison[3]->y(),
-                         centre03.x() - coordonneesLiaison[3]->x()) - PI / 2.0);
+    setAngleRad(3, atan2(- centre03.y() + liaisons[3].coordonnees.y(),
+                         centre03.x() - liaisons[3].coordonnees.x()) - PI / 2.0);
 
     if(this->contact != nullptr)
         calculerPositionContact();
@@ -362,14 +337,14 @@ void VoieTraverseeJonction::paint(QPainter *painter, const QStyleOptionGraphicsI
                          static_cast<int>((getAngleDeg(3) + 270.0) *16),
                          static_cast<int>(- angle *16));
         painter->setPen(p1);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
-        painter->drawLine(*coordonneesLiaison[2], *coordonneesLiaison[3]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
+        painter->drawLine(liaisons[2].coordonnees, liaisons[3].coordonnees);
     }
     else
     {
         painter->setPen(p2);
-        painter->drawLine(*coordonneesLiaison[0], *coordonneesLiaison[1]);
-        painter->drawLine(*coordonneesLiaison[2], *coordonneesLiaison[3]);
+        painter->drawLine(liaisons[0].coordonnees, liaisons[1].coordonnees);
+        painter->drawLine(liaisons[2].coordonnees, liaisons[3].coordonnees);
         painter->setPen(p1);
         painter->drawArc(QRectF(centre12.x() - rayon12, centre12.y() - rayon12, 2.0 * rayon12, 2.0 * rayon12),
                          static_cast<int>((getAngleDeg(1) - 270.0) *16),
@@ -397,10 +372,10 @@ void VoieTraverseeJonction::paint(QPainter *painter, const QStyleOptionGraphicsI
 
         QRectF rect;
 
-        qreal angleTranslation = atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) - PI / 2.0;
+        qreal angleTranslation = atan2(- liaisons[1].coordonnees.y(), - liaisons[1].coordonnees.x()) - PI / 2.0;
 
-        rect = QRectF((coordonneesLiaison[1]->x()-coordonneesLiaison[0]->x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
-                      (coordonneesLiaison[1]->y()-coordonneesLiaison[0]->y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
+        rect = QRectF((liaisons[1].coordonnees.x()-liaisons[0].coordonnees.x())/2+TRANSLATION_NUM_CONTACT * cos(angleTranslation) - 3.0 * TAILLE_CONTACT,
+                      (liaisons[1].coordonnees.y()-liaisons[0].coordonnees.y())/2+TRANSLATION_NUM_CONTACT * sin(angleTranslation) - 3.0 * TAILLE_CONTACT,
                       6.0 * TAILLE_CONTACT,
                       6.0 * TAILLE_CONTACT); //meme constantes que pour les contacts.
 
@@ -13,7 +13,7 @@ public:
     VoieTraverseeJonction(qreal angle, qreal rayon, qreal longueur);
     void calculerAnglesEtCoordonnees(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int sortiesExploration(int liaisonArrivee) const override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
@@ -25,6 +25,8 @@ public:
 
     void mousePressEvent (QGraphicsSceneMouseEvent *) override;
 private:
+    static const int NB_LIAISONS = 4;
+    LiaisonVoie stockageLiaisons[NB_LIAISONS];
     qreal rayon03, rayon12, angle, longueur;
     QPointF centre03;
     QPointF centre12;
@@ -1,7 +1,7 @@
 #include "voievariable.h"
 
-VoieVariable::VoieVariable()
-    :Voie()
+VoieVariable::VoieVariable(LiaisonVoie *liaisons, int nbLiaisons)
+    :Voie(liaisons, nbLiaisons)
 {
 }
 
@@ -11,3 +11,13 @@ void VoieVariable::setEtat(int nouvelEtat)
     this->update(boundingRect());
     etatModifie(this);
 }
+
+int VoieVariable::getEtat() const
+{
+    return etat;
+}
+
+bool VoieVariable::estFixe() const
+{
+    return false;
+}
@@ -9,9 +9,20 @@ class VoieVariable : public Voie
     Q_OBJECT
 
 public:
-    VoieVariable();
+    VoieVariable(LiaisonVoie* liaisons, int nbLiaisons);
 
     void setEtat(int nouvelEtat) override;
+
+    /** retourne l'état de la voie variable.
+      * \return l'état courant.
+      */
+    int getEtat() const;
+
+    /** une voie variable change d'apparence avec son état.
+      * \return faux.
+      */
+    bool estFixe() const override;
+
     /** permet d'indiquer à la voie variable quel est son numéro.
       * \param numVoieVariable le numéro de la voie variable.
       */
@@ -0,0 +1,81 @@
+# Generates the compile-time track catalogue (cataloguevoies_gen.h) from
+# infosVoies.txt. The output is only rewritten when its content changes.
+#
+# Usage: cmake -DENTREE=<infosVoies.txt> -DSORTIE=<cataloguevoies_gen.h> -P gencatalogue.cmake
+
+if (NOT ENTREE OR NOT SORTIE)
+    message(FATAL_ERROR "Usage: cmake -DENTREE=<infosVoies.txt> -DSORTIE=<header> -P gencatalogue.cmake")
+endif ()
+
+# Track type names of infosVoies.txt and the matching TypeVoie values
+set(TYPE_droite Droite)
+set(TYPE_courbe Courbe)
+set(TYPE_aiguillage Aiguillage)
+set(TYPE_croisement Croisement)
+set(TYPE_traversee-jonction TraverseeJonction)
+set(TYPE_buttoir Buttoir)
+set(TYPE_aiguillageEnroule AiguillageEnroule)
+set(TYPE_aiguillageTriple AiguillageTriple)
+
+file(STRINGS ${ENTREE} LIGNES)
+
+set(ENTREES "")
+foreach (LIGNE IN LISTS LIGNES)
+    string(STRIP "${LIGNE}" LIGNE)
+    if (LIGNE MATCHES "^EOF")
+        break()
+    endif ()
+    if (LIGNE STREQUAL "")
+        continue()
+    endif ()
+
+    string(REGEX REPLACE "[ \t]+" ";" CHAMPS "${LIGNE}")
+    list(LENGTH CHAMPS NB_CHAMPS)
+    list(GET CHAMPS 0 REFERENCE)
+    list(GET CHAMPS 1 NOM_TYPE)
+
+    if (NOT REFERENCE MATCHES "^[0-9]+$" OR NOT DEFINED TYPE_${NOM_TYPE})
+        message(FATAL_ERROR "${ENTREE}: invalid track description: ${LIGNE}")
+    endif ()
+
+    math(EXPR NB_PARAMETRES "${NB_CHAMPS} - 2")
+    if (NB_PARAMETRES LESS 1 OR NB_PARAMETRES GREATER 3)
+        message(FATAL_ERROR "${ENTREE}: expected 1 to 3 parameters: ${LIGNE}")
+    endif ()
+
+    set(PARAMETRES "")
+    foreach (I RANGE 2 4)
+        if (I LESS NB_CHAMPS)
+            list(GET CHAMPS ${I} VALEUR)
+            if (NOT VALEUR MATCHES "^[0-9]+(\\.[0-9]+)?$")
+                message(FATAL_ERROR "${ENTREE}: invalid parameter '${VALEUR}': ${LIGNE}")
+            endif ()
+            if (NOT VALEUR MATCHES "\\.")
+                string(APPEND VALEUR ".0")
+            endif ()
+        else ()
+            set(VALEUR "0.0")
+        endif ()
+        list(APPEND PARAMETRES ${VALEUR})
+    endforeach ()
+    string(REPLACE ";" ", " PARAMETRES "${PARAMETRES}")
+
+    string(APPEND ENTREES "    {${REFERENCE}, TypeVoie::${TYPE_${NOM_TYPE}}, {${PARAMETRES}}},\n")
+endforeach ()
+
+if (ENTREES STREQUAL "")
+    message(FATAL_ERROR "${ENTREE}: no track description found")
+endif ()
+
+file(WRITE ${SORTIE}.tmp
+"// Generated from infosVoies.txt by gencatalogue.cmake. Do not edit.
+#ifndef CATALOGUEVOIES_GEN_H
+#define CATALOGUEVOIES_GEN_H
+
+constexpr DescriptionVoie CATALOGUE_VOIES[] = {
+${ENTREES}};
+
+#endif // CATALOGUEVOIES_GEN_H
+")
+configure_file(${SORTIE}.tmp ${SORTIE} COPYONLY)
+file(REMOVE ${SORTIE}.tmp)
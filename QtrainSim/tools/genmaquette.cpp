@@ -0,0 +1,554 @@
+/** Générateur de grandes maquettes pour les tests de montée en charge.
+  *
+  * Construit une grille de circuits à partir des voies du catalogue infosVoies.txt
+  * et l'écrit au format des fichiers de maquette, avec une définition de parcours
+  * (JSON, lue par trainsim-run) pour deux locos par circuit.
+  *
+  * Chaque ligne de la grille est un circuit à double voie : un anneau intérieur et un
+  * anneau extérieur concentriques, reliés par des bretelles sur les lignes droites.
+  * Les lignes sont empilées, l'anneau extérieur de l'une longeant celui de la
+  * suivante, et reliées elles aussi par des bretelles. Les lignes droites sont faites
+  * de modules de même longueur, qui portent chacun un contact par voie et, selon leur
+  * position, une bretelle, une voie de garage terminée par un buttoir, ou rien.
+  */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <QtMath>
+
+#include <cmath>
+#include <iostream>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+#define SkipEmptyParts      Qt::SkipEmptyParts
+#else
+#define SkipEmptyParts      QString::SkipEmptyParts
+#endif
+
+//! nombre de locos au plus, comme dans la simulation.
+#define MAX_LOCOS 80
+
+//! écart toléré entre les cotes du catalogue et la géométrie des modules, en mm.
+#define TOLERANCE_MM 0.5
+
+// Références du catalogue utilisées par le générateur.
+#define REF_DROITE_LONGUE   2206
+#define REF_DROITE_COURTE   2207
+#define REF_COURBE_R1       2221
+#define REF_COURBE_R2       2231
+#define REF_COURBE_GARAGE   2232
+#define REF_AIGUILLAGE      2261
+#define REF_BUTTOIR         7391
+
+/** Description d'une voie du catalogue : son type et ses cotes.
+  */
+struct InfoVoie
+{
+    QString type;
+    QVector<double> cotes;
+};
+
+/** Lit le catalogue des voies.
+  * \param fichier le chemin de infosVoies.txt.
+  * \param catalogue reçoit les voies, par référence.
+  * \return vrai si le fichier a pu être lu.
+  */
+static bool lireCatalogue(const QString &fichier, QMap<int, InfoVoie> &catalogue)
+{
+    QFile f(fichier);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream lecture(&f);
+    QString ligne = lecture.readLine();
+    while (!ligne.isNull() && !ligne.startsWith("EOF"))
+    {
+        QStringList champs = ligne.split(QRegExp("\\s+"), SkipEmptyParts);
+        if (champs.size() >= 2)
+        {
+            InfoVoie info;
+            info.type = champs.at(1);
+            for (int i = 2; i < champs.size(); i++)
+                info.cotes.append(champs.at(i).toDouble());
+            catalogue.insert(champs.at(0).toInt(), info);
+        }
+        ligne = lecture.readLine();
+    }
+    return true;
+}
+
+/** Voie posée par le générateur.
+  */
+struct Piece
+{
+    int reference;
+    //! identifiants des voies liées, dans l'ordre des liaisons de la voie.
+    QVector<int> liens;
+    //! "Gauche" ou "Droite" pour les courbes et les aiguillages, vide sinon.
+    QString direction;
+};
+
+/** Extrémité libre d'une voie en cours de pose.
+  */
+struct Fil
+{
+    int voie = 0;
+    int lien = 0;
+    int premiere = 0;
+    int lienPremiere = 0;
+};
+
+/** Un anneau d'une ligne de la grille et ce qu'en retient le parcours.
+  */
+struct Anneau
+{
+    Fil fil;
+    //! contacts de la voie principale, dans le sens de pose.
+    QVector<int> contacts;
+    //! aiguillage de l'anneau et aiguillage opposé de la bretelle de section.
+    int aiguillageSection = 0;
+    int aiguillageOppose = 0;
+};
+
+class Generateur
+{
+public:
+    /** Constructeur de classe.
+      * \param catalogue le catalogue des voies.
+      * \param lignes le nombre de lignes de la grille.
+      * \param modules le nombre de modules par ligne droite.
+      */
+    Generateur(const QMap<int, InfoVoie> &catalogue, int lignes, int modules)
+        : catalogue(catalogue), lignes(lignes), modules(modules)
+    {
+    }
+
+    /** vérifie que les voies du catalogue forment des modules qui se raccordent.
+      * \param erreur reçoit la raison de l'échec.
+      * \return vrai si la grille peut être construite.
+      */
+    bool verifierCatalogue(QString &erreur)
+    {
+        const int references[] = {REF_DROITE_LONGUE, REF_DROITE_COURTE, REF_COURBE_R1,
+                                  REF_COURBE_R2, REF_COURBE_GARAGE, REF_AIGUILLAGE,
+                                  REF_BUTTOIR};
+        for (int reference : references)
+        {
+            if (!catalogue.contains(reference))
+            {
+                erreur = QString("la voie %1 manque au catalogue").arg(reference);
+                return false;
+            }
+        }
+
+        const InfoVoie &r1 = catalogue[REF_COURBE_R1];
+        const InfoVoie &r2 = catalogue[REF_COURBE_R2];
+        const InfoVoie &garage = catalogue[REF_COURBE_GARAGE];
+        const InfoVoie &aiguillage = catalogue[REF_AIGUILLAGE];
+
+        // Demi-cercles : les deux anneaux tournent du même angle par voie.
+        if (r1.cotes.at(0) != r2.cotes.at(0) || std::fmod(180.0, r1.cotes.at(0)) != 0.0)
+        {
+            erreur = "les courbes des anneaux ne forment pas de demi-cercle";
+            return false;
+        }
+        courbesParDemiCercle = int(180.0 / r1.cotes.at(0));
+
+        // Entraxe des anneaux, repris par les bretelles et les voies de garage.
+        const double entraxe = r2.cotes.at(1) - r1.cotes.at(1);
+        const double angle = qDegreesToRadians(aiguillage.cotes.at(0));
+        const double rayon = aiguillage.cotes.at(1);
+        const double decalage = 2.0 * rayon * (1.0 - std::cos(angle));
+        const double longueurBretelle = 2.0 * rayon * std::sin(angle);
+        const double longueurModule = catalogue[REF_DROITE_LONGUE].cotes.at(0) +
+                                      catalogue[REF_DROITE_COURTE].cotes.at(0);
+
+        if (std::fabs(decalage - entraxe) > TOLERANCE_MM ||
+            std::fabs(longueurBretelle - longueurModule) > TOLERANCE_MM ||
+            std::fabs(aiguillage.cotes.at(2) - catalogue[REF_DROITE_LONGUE].cotes.at(0)) > TOLERANCE_MM ||
+            garage.cotes.at(0) != aiguillage.cotes.at(0) || garage.cotes.at(1) != rayon)
+        {
+            erreur = "les aiguillages du catalogue ne raccordent pas les anneaux";
+            return false;
+        }
+        return true;
+    }
+
+    /** construit la grille.
+      */
+    void generer()
+    {
+        anneaux.resize(2 * lignes);
+        QVector<int> pendants(modules, 0);
+
+        for (int ligne = 0; ligne < lignes; ligne++)
+        {
+            Anneau &interieur = anneaux[2 * ligne];
+            Anneau &exterieur = anneaux[2 * ligne + 1];
+            QVector<int> suivants(modules, 0);
+
+            // Sens de pose anti-horaire : ligne droite du bas, demi-cercle de droite,
+            // ligne droite du haut, demi-cercle de gauche. L'anneau intérieur est
+            // toujours à gauche de l'extérieur.
+            for (int j = 0; j < modules; j++)
+                poserModule(interieur, exterieur, j, ligne > 0 ? &pendants : nullptr,
+                            nullptr);
+            poserDemiCercle(interieur, exterieur);
+            for (int j = 0; j < modules; j++)
+                poserModule(interieur, exterieur, modules - 1 - j, nullptr,
+                            ligne < lignes - 1 ? &suivants : nullptr);
+            poserDemiCercle(interieur, exterieur);
+
+            fermer(interieur.fil);
+            fermer(exterieur.fil);
+            pendants = suivants;
+        }
+    }
+
+    /** écrit la maquette au format lu par ChargeurMaquette.
+      * \param fichier le chemin du fichier.
+      * \return vrai si le fichier a pu être écrit.
+      */
+    bool ecrireMaquette(const QString &fichier) const
+    {
+        QFile f(fichier);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Text))
+            return false;
+
+        QTextStream ecriture(&f);
+        ecriture << "Maquette generee : " << lignes << " lignes de " << modules
+                 << " modules\n";
+
+        ecriture << pieces.size() << "\n";
+        for (int i = 0; i < pieces.size(); i++)
+        {
+            const Piece &p = pieces.at(i);
+            ecriture << i + 1 << " " << p.reference;
+            foreach (int lien, p.liens)
+                ecriture << " " << lien;
+            if (!p.direction.isEmpty())
+                ecriture << " " << p.direction;
+            ecriture << "\n";
+        }
+
+        ecriture << contacts.size() << "\n";
+        for (int i = 0; i < contacts.size(); i++)
+            ecriture << i + 1 << " " << contacts.at(i) << "\n";
+
+        ecriture << aiguillages.size() << "\n";
+        for (int i = 0; i < aiguillages.size(); i++)
+            ecriture << i + 1 << " " << aiguillages.at(i) << "\n";
+
+        ecriture << 1 << "\n";
+        return ecriture.status() == QTextStream::Ok;
+    }
+
+    /** construit le parcours : deux locos par ligne, une par anneau, qui se partagent
+      * la bretelle du premier module de la ligne et se retrouvent en gare. Tous les
+      * aiguillages sont tout droit, chaque loco reste sur son anneau.
+      * \param maquette le nom de la maquette.
+      * \return la définition du parcours.
+      */
+    QJsonObject parcours(const QString &maquette) const
+    {
+        QJsonArray junctions;
+        for (int i = 1; i <= aiguillages.size(); i++)
+            junctions.append(QJsonObject{{"id", i}, {"direction", "TOUT_DROIT"}});
+
+        QJsonArray locos;
+        const int nbLignes = qMin(lignes, MAX_LOCOS / 2);
+        const int dernier = 2 * modules + 1;
+        for (int ligne = 0; ligne < nbLignes; ligne++)
+        {
+            for (int a = 0; a < 2; a++)
+            {
+                const Anneau &anneau = anneaux.at(2 * ligne + a);
+                const QVector<int> &c = anneau.contacts;
+
+                // L'aiguillage de la bretelle est entre les contacts 0 et 1 de
+                // l'anneau intérieur, entre le dernier et le contact 0 de l'extérieur.
+                const int avertissement = a == 0 ? c.at(dernier) : c.at(dernier - 1);
+                const int entree = a == 0 ? c.at(0) : c.at(dernier);
+                const int sortie = a == 0 ? c.at(1) : c.at(0);
+
+                QJsonObject section{
+                    {"synchro", QString("ligne%1").arg(ligne)},
+                    {"entry", QJsonObject{{"id", anneau.aiguillageSection},
+                                          {"direction", "TOUT_DROIT"}}},
+                    {"exit", QJsonObject{{"id", anneau.aiguillageOppose},
+                                         {"direction", "TOUT_DROIT"}}},
+                    {"contact_warn", avertissement},
+                    {"contact_enter", entree},
+                    {"contact_exit", sortie},
+                };
+
+                locos.append(QJsonObject{
+                    {"number", 2 * ligne + a + 1},
+                    {"speed", a == 0 ? 10 : 12},
+                    {"station", QJsonObject{{"front", c.at(modules + 2)},
+                                            {"back", c.at(modules + 1)}}},
+                    {"sections", QJsonArray{section}},
+                });
+            }
+        }
+
+        return QJsonObject{
+            {"maquette", maquette},
+            {"junctions", junctions},
+            {"locos", locos},
+        };
+    }
+
+    int nbPieces() const { return pieces.size(); }
+    int nbContacts() const { return contacts.size(); }
+    int nbAiguillages() const { return aiguillages.size(); }
+    int nbLocos() const { return 2 * qMin(lignes, MAX_LOCOS / 2); }
+
+private:
+    /** ajoute une voie non liée.
+      * \return l'identifiant de la voie.
+      */
+    int poser(int reference, int nbLiens, const QString &direction = QString())
+    {
+        pieces.append({reference, QVector<int>(nbLiens, 0), direction});
+        if (reference == REF_AIGUILLAGE)
+            aiguillages.append(pieces.size());
+        return pieces.size();
+    }
+
+    /** lie deux voies par l'une de leurs liaisons.
+      */
+    void lier(int a, int lienA, int b, int lienB)
+    {
+        pieces[a - 1].liens[lienA] = b;
+        pieces[b - 1].liens[lienB] = a;
+    }
+
+    /** prolonge un fil par une voie.
+      * \param entree la liaison de la voie du côté du fil.
+      * \param sortie la liaison de la voie qui devient l'extrémité du fil.
+      */
+    void enchainer(Fil &fil, int voie, int entree, int sortie)
+    {
+        if (fil.voie == 0)
+        {
+            fil.premiere = voie;
+            fil.lienPremiere = entree;
+        }
+        else
+            lier(fil.voie, fil.lien, voie, entree);
+        fil.voie = voie;
+        fil.lien = sortie;
+    }
+
+    void fermer(Fil &fil)
+    {
+        lier(fil.voie, fil.lien, fil.premiere, fil.lienPremiere);
+    }
+
+    /** pose un contact sur une voie de la voie principale d'un anneau.
+      */
+    void poserContact(Anneau &anneau, int voie)
+    {
+        contacts.append(voie);
+        anneau.contacts.append(contacts.size());
+    }
+
+    /** pose une voie de garage sur la sortie déviée d'un aiguillage. Elle rejoint
+      * l'entraxe voisin puis se termine par un buttoir.
+      */
+    void poserGarage(int aiguillage, const QString &direction)
+    {
+        int courbe = poser(REF_COURBE_GARAGE, 2, direction);
+        lier(aiguillage, 2, courbe, 0);
+        contacts.append(courbe);
+        int buttoir = poser(REF_BUTTOIR, 1);
+        lier(courbe, 1, buttoir, 0);
+    }
+
+    /** pose un module sur les deux voies d'une ligne droite.
+      * \param m la position du module, depuis la gauche de la grille.
+      * \param pendants les aiguillages de la ligne précédente à relier par une
+      *        bretelle, pour la ligne droite du bas.
+      * \param suivants reçoit les aiguillages à relier à la ligne suivante, pour la
+      *        ligne droite du haut.
+      */
+    void poserModule(Anneau &interieur, Anneau &exterieur, int m,
+                     QVector<int> *pendants, QVector<int> *suivants)
+    {
+        if (m % 3 == 0)
+        {
+            // Bretelle entre les deux anneaux.
+            int a1 = poser(REF_AIGUILLAGE, 3, "Gauche");
+            enchainer(exterieur.fil, a1, 0, 1);
+            int d1 = poser(REF_DROITE_COURTE, 2);
+            enchainer(exterieur.fil, d1, 0, 1);
+            poserContact(exterieur, d1);
+
+            int d2 = poser(REF_DROITE_COURTE, 2);
+            enchainer(interieur.fil, d2, 0, 1);
+            poserContact(interieur, d2);
+            int a2 = poser(REF_AIGUILLAGE, 3, "Gauche");
+            enchainer(interieur.fil, a2, 1, 0);
+
+            lier(a1, 2, a2, 2);
+
+            if (interieur.aiguillageSection == 0)
+            {
+                interieur.aiguillageSection = exterieur.aiguillageOppose = aiguillages.size();
+                exterieur.aiguillageSection = interieur.aiguillageOppose = aiguillages.size() - 1;
+            }
+        }
+        else if (m % 3 == 1)
+        {
+            // Voie de garage vers le centre de l'anneau intérieur.
+            int a = poser(REF_AIGUILLAGE, 3, "Gauche");
+            enchainer(interieur.fil, a, 0, 1);
+            poserGarage(a, "Droite");
+            int d = poser(REF_DROITE_COURTE, 2);
+            enchainer(interieur.fil, d, 0, 1);
+            poserContact(interieur, d);
+
+            // Bretelle vers la ligne voisine, voie de garage au bord de la grille.
+            a = poser(REF_AIGUILLAGE, 3, "Droite");
+            enchainer(exterieur.fil, a, 0, 1);
+            if (pendants != nullptr)
+                lier(a, 2, pendants->at(m), 2);
+            else if (suivants != nullptr)
+                (*suivants)[m] = a;
+            else
+                poserGarage(a, "Gauche");
+            d = poser(REF_DROITE_COURTE, 2);
+            enchainer(exterieur.fil, d, 0, 1);
+            poserContact(exterieur, d);
+        }
+        else
+        {
+            for (Anneau *anneau : {&interieur, &exterieur})
+            {
+                enchainer(anneau->fil, poser(REF_DROITE_LONGUE, 2), 0, 1);
+                int d = poser(REF_DROITE_COURTE, 2);
+                enchainer(anneau->fil, d, 0, 1);
+                poserContact(*anneau, d);
+            }
+        }
+    }
+
+    /** pose un demi-cercle sur les deux anneaux, avec un contact en son milieu.
+      */
+    void poserDemiCercle(Anneau &interieur, Anneau &exterieur)
+    {
+        for (int i = 0; i < courbesParDemiCercle; i++)
+        {
+            int c1 = poser(REF_COURBE_R1, 2, "Gauche");
+            enchainer(interieur.fil, c1, 0, 1);
+            int c2 = poser(REF_COURBE_R2, 2, "Gauche");
+            enchainer(exterieur.fil, c2, 0, 1);
+            if (i == courbesParDemiCercle / 2)
+            {
+                poserContact(interieur, c1);
+                poserContact(exterieur, c2);
+            }
+        }
+    }
+
+    const QMap<int, InfoVoie> &catalogue;
+    const int lignes;
+    const int modules;
+    int courbesParDemiCercle = 0;
+
+    QVector<Piece> pieces;
+    //! voie porteuse de chaque contact, par numéro de contact - 1.
+    QVector<int> contacts;
+    //! voie de chaque aiguillage, par numéro d'aiguillage - 1.
+    QVector<int> aiguillages;
+    //! anneaux intérieur et extérieur de chaque ligne.
+    QVector<Anneau> anneaux;
+};
+
+/**
+ * Programme principal
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("genmaquette");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Genere une grande maquette et son parcours pour les tests de montee en charge.");
+    parser.addHelpOption();
+    QCommandLineOption optionLignes("lignes", "Nombre de circuits empiles.", "n", "10");
+    QCommandLineOption optionModules("modules", "Modules par ligne droite, au moins 3.",
+                                     "n", "30");
+    QCommandLineOption optionNom("nom", "Nom de la maquette.", "nom", "GEN");
+    QCommandLineOption optionDossier("dossier", "Dossier de sortie.", "dossier", ".");
+    QCommandLineOption optionCatalogue("catalogue", "Catalogue des voies.", "fichier",
+        QCoreApplication::applicationDirPath() + "/data/infosVoies.txt");
+    parser.addOptions({optionLignes, optionModules, optionNom, optionDossier,
+                       optionCatalogue});
+    parser.process(app);
+
+    const int lignes = parser.value(optionLignes).toInt();
+    const int modules = parser.value(optionModules).toInt();
+    if (lignes < 1 || modules < 3)
+    {
+        std::cerr << "genmaquette: il faut au moins une ligne et trois modules" << std::endl;
+        return 2;
+    }
+
+    QMap<int, InfoVoie> catalogue;
+    if (!lireCatalogue(parser.value(optionCatalogue), catalogue))
+    {
+        std::cerr << "genmaquette: impossible de lire "
+                  << qPrintable(parser.value(optionCatalogue)) << std::endl;
+        return 2;
+    }
+
+    Generateur generateur(catalogue, lignes, modules);
+    QString erreur;
+    if (!generateur.verifierCatalogue(erreur))
+    {
+        std::cerr << "genmaquette: " << qPrintable(erreur) << std::endl;
+        return 2;
+    }
+    generateur.generer();
+
+    // MaquetteManager nomme la maquette d'après son fichier, sans le préfixe "Maquet_".
+    const QString nom = parser.value(optionNom);
+    const QString dossier = parser.value(optionDossier);
+    const QString fichierMaquette = dossier + "/Maquet_" + nom + ".txt";
+    const QString fichierParcours = dossier + "/route_" + nom + ".json";
+
+    if (!generateur.ecrireMaquette(fichierMaquette))
+    {
+        std::cerr << "genmaquette: impossible d'ecrire " << qPrintable(fichierMaquette)
+                  << std::endl;
+        return 1;
+    }
+
+    QFile parcours(fichierParcours);
+    const QByteArray json = QJsonDocument(generateur.parcours(nom)).toJson();
+    if (!parcours.open(QIODevice::WriteOnly) || parcours.write(json) != json.size())
+    {
+        std::cerr << "genmaquette: impossible d'ecrire " << qPrintable(fichierParcours)
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << qPrintable(fichierMaquette) << ": " << generateur.nbPieces() << " voies, "
+              << generateur.nbContacts() << " contacts, " << generateur.nbAiguillages()
+              << " aiguillages" << std::endl;
+    std::cout << qPrintable(fichierParcours) << ": " << generateur.nbLocos() << " locos"
+              << std::endl;
+    return 0;
+}
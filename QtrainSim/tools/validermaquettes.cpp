@@ -0,0 +1,116 @@
+/** Validation de la géométrie des maquettes.
+  *
+  * Charge chaque fichier de maquette d'un dossier (par défaut data/Maquettes) comme le
+  * fait la simulation, puis vérifie sa géométrie avec ValidateurMaquette : erreur de
+  * fermeture de chaque boucle, accord des extrémités liées une fois les voies posées
+  * et distance des contacts au tracé de leur voie. Le code de retour est 1 si une maquette ne
+  * peut être chargée ou dépasse les tolérances.
+  */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+
+#include <iostream>
+
+#include "chargeurmaquette.h"
+#include "simview.h"
+#include "validateurmaquette.h"
+
+int main(int argc, char *argv[])
+{
+    // SimView est un widget : sans affichage, on utilise la plateforme offscreen.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("validermaquettes");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Verifie la geometrie des maquettes : fermeture des boucles, jointures et contacts.");
+    parser.addHelpOption();
+    QCommandLineOption optionDossier("dossier", "Dossier des maquettes.", "dossier",
+        QApplication::applicationDirPath() + "/data/Maquettes");
+    QCommandLineOption optionFermeture("fermeture", "Erreur de fermeture toleree par boucle, en mm.",
+                                       "mm", "1.0");
+    QCommandLineOption optionJointure("jointure", "Ecart tolere entre extremites liees, en mm.",
+                                      "mm", "0.1");
+    QCommandLineOption optionAngle("angle", "Ecart d'angle tolere entre extremites liees, en degres.",
+                                   "degres", "0.5");
+    QCommandLineOption optionContact("contact", "Ecart tolere entre un contact et le trace de sa voie, en mm.",
+                                     "mm", "1.0");
+    QCommandLineOption optionDetails("details", "Affiche l'erreur de fermeture de chaque boucle.");
+    parser.addOptions({optionDossier, optionFermeture, optionJointure, optionAngle, optionContact, optionDetails});
+    parser.addPositionalArgument("fichiers", "Maquettes a verifier, a la place du dossier.",
+                                 "[fichiers...]");
+    parser.process(app);
+
+    QStringList fichiers = parser.positionalArguments();
+    if (fichiers.isEmpty())
+    {
+        QDir dossier(parser.value(optionDossier));
+        foreach (const QFileInfo &info, dossier.entryInfoList({"Maquet_*.txt", "MAQUET_*.TXT"},
+                                                              QDir::Files, QDir::Name))
+            fichiers << info.filePath();
+    }
+    if (fichiers.isEmpty())
+    {
+        std::cerr << "validermaquettes: aucune maquette dans "
+                  << qPrintable(parser.value(optionDossier)) << std::endl;
+        return 2;
+    }
+
+    ChargeurMaquette chargeur;
+    if (!chargeur.estValide())
+    {
+        std::cerr << "validermaquettes: impossible de lire "
+                  << qPrintable(chargeur.getFichierInfosVoies()) << std::endl;
+        return 2;
+    }
+
+    SimView simView(nullptr);
+    ValidateurMaquette validateur(parser.value(optionFermeture).toDouble(),
+                                  parser.value(optionJointure).toDouble(),
+                                  parser.value(optionAngle).toDouble(),
+                                  parser.value(optionContact).toDouble());
+    bool echec = false;
+
+    foreach (const QString &fichier, fichiers)
+    {
+        const QString nom = QFileInfo(fichier).fileName();
+
+        if (!chargeur.charger(fichier, &simView))
+        {
+            std::cout << qPrintable(nom) << ": impossible de charger la maquette" << std::endl;
+            echec = true;
+            continue;
+        }
+
+        const RapportGeometrie rapport = validateur.valider(&simView);
+
+        std::cout << qPrintable(nom) << ": " << rapport.nbVoies << " voies, "
+                  << rapport.nbContacts << " contacts, " << rapport.boucles.size()
+                  << " boucles, fermeture max "
+                  << qPrintable(QString::number(rapport.fermetureMax, 'f', 3)) << " mm : "
+                  << (rapport.estValide() ? "OK" : qPrintable(QString("%1 defaut(s)").arg(rapport.defauts.size())))
+                  << std::endl;
+
+        if (parser.isSet(optionDetails))
+        {
+            foreach (const FermetureBoucle &boucle, rapport.boucles)
+                std::cout << "  boucle " << boucle.idVoie << "-" << boucle.idVoisin << " : "
+                          << qPrintable(QString::number(boucle.erreur, 'f', 3)) << " mm" << std::endl;
+        }
+
+        foreach (const QString &defaut, rapport.defauts)
+            std::cout << "  - " << qPrintable(defaut) << std::endl;
+
+        echec = echec || !rapport.estValide();
+    }
+
+    simView.viderMaquette();
+
+    return echec ? 1 : 0;
+}
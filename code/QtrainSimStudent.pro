@@ -10,9 +10,17 @@ HEADERS +=  \
     src/launchable.h \
     src/locomotivebehavior.h \
     src/synchro.h \
-    src/synchrointerface.h
+    src/synchrointerface.h \
+    src/arbitrationpolicy.h \
+    src/stoptoken.h \
+    src/launchpool.h \
+    src/pausesupervisor.h \
+    src/collisionsupervisor.h
 
 SOURCES +=  \
     src/locomotive.cpp \
     src/cppmain.cpp \
-    src/locomotivebehavior.cpp
+    src/locomotivebehavior.cpp \
+    src/arbitrationpolicy.cpp \
+    src/pausesupervisor.cpp \
+    src/collisionsupervisor.cpp
@@ -0,0 +1,218 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#include "routeloader.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include "synchro.h"
+
+bool RouteLoader::load(const QString& path, QString& error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("cannot open %1").arg(path);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document =
+        QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (document.isNull()) {
+        error = QString("%1: %2").arg(path, parseError.errorString());
+        return false;
+    }
+
+    const QJsonObject root = document.object();
+    maquette = root.value("maquette").toString(MAQUETTE_A).toStdString();
+
+    for (const auto& value : root.value("junctions").toArray()) {
+        junctionList.push_back(parseJunction(value.toObject(), error));
+        if (!error.isEmpty()) {
+            return false;
+        }
+    }
+
+    const QJsonObject synchroConfig = root.value("synchros").toObject();
+    const QJsonArray  locos         = root.value("locos").toArray();
+    if (locos.isEmpty()) {
+        error = "the route defines no locomotive";
+        return false;
+    }
+
+    for (const auto& locoValue : locos) {
+        const QJsonObject loco    = locoValue.toObject();
+        const QJsonObject station = loco.value("station").toObject();
+        const int         number  = loco.value("number").toInt(-1);
+
+        if (number <= 0 || !station.contains("front") ||
+            !station.contains("back")) {
+            error = "each locomotive needs a number and a station";
+            return false;
+        }
+        if (number > MAX_LOCOS) {
+            error = QString("locomotive number %1 is above the simulator "
+                            "limit of %2")
+                        .arg(number)
+                        .arg(MAX_LOCOS);
+            return false;
+        }
+
+        std::vector<LocomotiveBehavior::SharedSection> sections;
+        std::vector<QString>                           names;
+        for (const auto& sectionValue : loco.value("sections").toArray()) {
+            const QJsonObject section = sectionValue.toObject();
+            const auto entry = parseJunction(section.value("entry").toObject(), error);
+            const auto exit  = parseJunction(section.value("exit").toObject(), error);
+            if (!error.isEmpty()) {
+                return false;
+            }
+
+            names.push_back(section.value("synchro").toString());
+            const auto shared = synchro(names.back(), synchroConfig, error);
+            if (shared == nullptr) {
+                return false;
+            }
+            shared->setSectionContacts(number,
+                                       section.value("contact_enter").toInt(),
+                                       section.value("contact_exit").toInt());
+            if (section.contains("approach_s")) {
+                shared->setApproachTime(number, section.value("approach_s").toDouble());
+            }
+
+            sections.push_back({shared,
+                                entry,
+                                exit,
+                                section.value("contact_warn").toInt(),
+                                section.value("contact_enter").toInt(),
+                                section.value("contact_exit").toInt()});
+        }
+
+        if (sections.empty()) {
+            error = QString("locomotive %1 has no shared section").arg(number);
+            return false;
+        }
+
+        std::vector<std::pair<int, int>> positions;
+        for (const auto& positionValue : loco.value("start_positions").toArray()) {
+            const QJsonArray position = positionValue.toArray();
+            if (position.size() != 2) {
+                error = "a start position is a [front, back] contact pair";
+                return false;
+            }
+            positions.emplace_back(position.at(0).toInt(), position.at(1).toInt());
+        }
+
+        synchroNames.push_back(names);
+        starts.push_back(positions);
+        locomotives.emplace_back(number, loco.value("speed").toInt(10));
+        params.push_back({locomotives.back(),
+                          {station.value("front").toInt(),
+                           station.value("back").toInt()},
+                          sections});
+    }
+
+    return true;
+}
+
+const std::string& RouteLoader::maquetteId() const {
+    return maquette;
+}
+
+const std::vector<LocomotiveBehavior::JunctionSetting>&
+RouteLoader::junctions() const {
+    return junctionList;
+}
+
+const std::vector<LocomotiveBehavior::Parameters>&
+RouteLoader::parameters() const {
+    return params;
+}
+
+const QString& RouteLoader::synchroName(std::size_t loco,
+                                        std::size_t section) const {
+    return synchroNames.at(loco).at(section);
+}
+
+const std::vector<std::pair<int, int>>& RouteLoader::startPositions(
+    std::size_t loco) const {
+    return starts.at(loco);
+}
+
+const std::map<QString, std::shared_ptr<Synchro>>& RouteLoader::synchrosByName() const {
+    return synchros;
+}
+
+bool RouteLoader::isMovingBlock(const QString& name) const {
+    return movingBlockSynchros.count(name) > 0;
+}
+
+LocomotiveBehavior::JunctionSetting RouteLoader::parseJunction(
+    const QJsonObject& object, QString& error) {
+    const QString direction = object.value("direction").toString();
+
+    if (!object.contains("id") ||
+        (direction != "DEVIE" && direction != "TOUT_DROIT")) {
+        error = "a junction needs an id and a DEVIE or TOUT_DROIT direction";
+        return {0, TOUT_DROIT};
+    }
+
+    return {object.value("id").toInt(),
+            direction == "DEVIE" ? DEVIE : TOUT_DROIT};
+}
+
+std::shared_ptr<Synchro> RouteLoader::synchro(const QString& name,
+                                              const QJsonObject& config,
+                                              QString& error) {
+    auto& synchro = synchros[name];
+    if (synchro != nullptr) {
+        return synchro;
+    }
+
+    const QJsonObject settings = config.value(name).toObject();
+    const QString     policyName = settings.value("policy").toString("fifo");
+
+    std::map<std::int32_t, double> priorities;
+    const QJsonObject              prioritiesObject = settings.value("priorities").toObject();
+    for (auto it = prioritiesObject.constBegin(); it != prioritiesObject.constEnd(); ++it) {
+        priorities[it.key().toInt()] = it.value().toDouble();
+    }
+
+    const auto policy = makeArbitrationPolicy(
+        policyName.toStdString(), priorities, settings.value("aging_per_s").toDouble(1.0));
+    if (policy == nullptr) {
+        error = QString("unknown policy \"%1\" for synchro %2").arg(policyName, name);
+        synchros.erase(name);
+        return nullptr;
+    }
+
+    synchro = std::make_shared<Synchro>(name, policy);
+    synchro->setPredictive(settings.value("predictive").toBool(false));
+    if (settings.value("moving_block").toBool(false)) {
+        synchro->setMovingBlock(true);
+        movingBlockSynchros.insert(name);
+    }
+
+    const QString pausePolicy = settings.value("pause_policy").toString("hold");
+    if (pausePolicy == "release") {
+        synchro->setPausePolicy(PausePolicy::Release);
+    } else if (pausePolicy == "release_after") {
+        synchro->setPausePolicy(
+            PausePolicy::ReleaseAfter,
+            std::chrono::milliseconds(
+                static_cast<long long>(settings.value("pause_release_s").toDouble(10.0) * 1000)));
+    } else if (pausePolicy != "hold") {
+        error = QString("unknown pause policy \"%1\" for synchro %2").arg(pausePolicy, name);
+        synchros.erase(name);
+        return nullptr;
+    }
+    return synchro;
+}
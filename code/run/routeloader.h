@@ -0,0 +1,133 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef ROUTELOADER_H
+#define ROUTELOADER_H
+
+#include <QJsonObject>
+#include <QString>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "locomotive.h"
+#include "locomotivebehavior.h"
+#include "synchro.h"
+#include "synchrointerface.h"
+
+/**
+ * @brief Loads a route definition from a JSON file.
+ *
+ * A route names the maquette, the junction settings applied before the start
+ * and, for each locomotive, its number, speed, station and shared sections.
+ * Sections referring to the same synchro name share a single Synchro object.
+ * The optional "synchros" object selects the arbitration policy of each
+ * synchro by name, and whether approaching locos are slowed down rather than
+ * stopped ("predictive") or follow each other in the section under moving-block
+ * signalling ("moving_block"). See code/routes/ for examples.
+ */
+class RouteLoader {
+    public:
+    /**
+     * @brief Reads and validates a route file.
+     *
+     * @param path The path of the JSON route file.
+     * @param error Set to a description of the problem if the file is invalid.
+     * @return true if the route was loaded.
+     */
+    bool load(const QString& path, QString& error);
+
+    /**
+     * @brief The id of the maquette the route runs on.
+     */
+    const std::string& maquetteId() const;
+
+    /**
+     * @brief The junction settings to apply before the locomotives start.
+     */
+    const std::vector<LocomotiveBehavior::JunctionSetting>& junctions() const;
+
+    /**
+     * @brief The behavior parameters of each locomotive, in file order.
+     */
+    const std::vector<LocomotiveBehavior::Parameters>& parameters() const;
+
+    /**
+     * @brief The synchro name of a shared section.
+     *
+     * @param loco The index of the locomotive in parameters().
+     * @param section The index of the section in its parameters.
+     * @return The name given to the synchro in the route file.
+     */
+    const QString& synchroName(std::size_t loco, std::size_t section) const;
+
+    /**
+     * @brief The alternative start positions of a locomotive, as (front, back)
+     * contact pairs. They must lie on the loop of the locomotive, between its
+     * station and its first warning contact.
+     *
+     * @param loco The index of the locomotive in parameters().
+     * @return The start positions, empty if only the station may be used.
+     */
+    const std::vector<std::pair<int, int>>& startPositions(std::size_t loco) const;
+
+    /**
+     * @brief The synchros of the route, by name.
+     */
+    const std::map<QString, std::shared_ptr<Synchro>>& synchrosByName() const;
+
+    /**
+     * @brief Whether a synchro runs under moving-block signalling, where
+     * several locos may be in the section at once.
+     *
+     * @param name The synchro name.
+     */
+    bool isMovingBlock(const QString& name) const;
+
+    private:
+    /**
+     * @brief Parses a junction setting object.
+     *
+     * @param object The JSON object, with "id" and "direction" keys.
+     * @param error Set if the object is invalid.
+     * @return The junction setting.
+     */
+    static LocomotiveBehavior::JunctionSetting parseJunction(
+        const QJsonObject& object, QString& error);
+
+    /**
+     * @brief Returns the synchro registered under a name, creating it with
+     * its configured policy if needed.
+     *
+     * @param name The synchro name.
+     * @param config The "synchros" object of the route.
+     * @param error Set if the policy of the synchro is invalid.
+     * @return The shared synchro, nullptr on error.
+     */
+    std::shared_ptr<Synchro> synchro(const QString& name, const QJsonObject& config,
+                                     QString& error);
+
+    std::string                                              maquette;
+    std::vector<LocomotiveBehavior::JunctionSetting>         junctionList;
+    std::vector<LocomotiveBehavior::Parameters>              params;
+    // A deque never moves its elements, the parameters keep references to them.
+    std::deque<Locomotive>                                   locomotives;
+    std::map<QString, std::shared_ptr<Synchro>>              synchros;
+    std::set<QString>                                        movingBlockSynchros;
+    std::vector<std::vector<QString>>                        synchroNames;
+    std::vector<std::vector<std::pair<int, int>>>            starts;
+};
+
+#endif  // ROUTELOADER_H
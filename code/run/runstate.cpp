@@ -0,0 +1,142 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#include "runstate.h"
+
+#include <QDataStream>
+#include <QVector>
+
+#include <map>
+
+/**
+ * @brief Converts a list of loco numbers for QDataStream.
+ */
+static QVector<int> toVector(const std::vector<int>& locos) {
+    QVector<int> result;
+    for (const int loco : locos) {
+        result.append(loco);
+    }
+    return result;
+}
+
+QByteArray RunState::save(const RouteLoader& route,
+                          const std::vector<std::unique_ptr<LocomotiveBehavior>>& behaviors) {
+    QByteArray  data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << MAGIC << VERSION << QString::fromStdString(route.maquetteId());
+
+    out << static_cast<qint32>(behaviors.size());
+    for (const auto& behavior : behaviors) {
+        const LocomotiveBehavior::Progress progress = behavior->progress();
+        out << static_cast<qint32>(behavior->locomotive().numero())
+            << static_cast<qint32>(progress.step) << progress.section << progress.priority;
+    }
+
+    const auto& synchros = route.synchrosByName();
+    out << static_cast<qint32>(synchros.size());
+    for (const auto& synchro : synchros) {
+        const Synchro::State state = synchro.second->saveState();
+        out << synchro.first << static_cast<qint32>(state.occupant)
+            << toVector(state.movingBlock) << toVector(state.evicted);
+    }
+
+    return data;
+}
+
+bool RunState::restore(const QByteArray& data, const RouteLoader& route,
+                       std::vector<std::unique_ptr<LocomotiveBehavior>>& behaviors,
+                       QString& error) {
+    QDataStream in(data);
+    quint32     magic;
+    qint32      version;
+    QString     maquette;
+    in >> magic >> version >> maquette;
+    if (in.status() != QDataStream::Ok || magic != MAGIC || version != VERSION) {
+        error = "not a run state";
+        return false;
+    }
+    if (maquette != QString::fromStdString(route.maquetteId())) {
+        error = QString("the state was saved on maquette %1").arg(maquette);
+        return false;
+    }
+
+    // Everything is read and checked before anything is restored.
+    qint32 count;
+    in >> count;
+    if (count != static_cast<qint32>(behaviors.size()) ||
+        behaviors.size() != route.parameters().size()) {
+        error = "the state doesn't have the locos of the route";
+        return false;
+    }
+    std::vector<LocomotiveBehavior::Progress> progress;
+    for (const auto& params : route.parameters()) {
+        qint32 loco, step, section, priority;
+        in >> loco >> step >> section >> priority;
+        if (loco != params.loco.numero() ||
+            step < LocomotiveBehavior::Progress::StationContact ||
+            step > LocomotiveBehavior::Progress::Exit || section < 0 ||
+            static_cast<std::size_t>(section) >= params.sections.size()) {
+            error = QString("invalid progress of loco %1").arg(loco);
+            return false;
+        }
+        progress.push_back({static_cast<LocomotiveBehavior::Progress::Step>(step), section,
+                            priority});
+    }
+
+    const auto& synchros = route.synchrosByName();
+    in >> count;
+    if (count != static_cast<qint32>(synchros.size())) {
+        error = "the state doesn't have the synchros of the route";
+        return false;
+    }
+    std::map<QString, Synchro::State> states;
+    for (qint32 i = 0; i < count; ++i) {
+        QString      name;
+        qint32       occupant;
+        QVector<int> movingBlock, evicted;
+        in >> name >> occupant >> movingBlock >> evicted;
+        if (synchros.count(name) == 0) {
+            error = QString("unknown synchro %1").arg(name);
+            return false;
+        }
+        states[name] = {occupant, movingBlock.toStdVector(), evicted.toStdVector()};
+    }
+    if (in.status() != QDataStream::Ok) {
+        error = "truncated run state";
+        return false;
+    }
+
+    // A loco counts as parked while it asks for a section, so it may have
+    // been handed the section before its thread woke up. It asks again when
+    // resumed and would then wait for itself: the section is freed instead.
+    for (std::size_t i = 0; i < progress.size(); ++i) {
+        const auto& p        = progress[i];
+        const bool  askAgain = p.step == LocomotiveBehavior::Progress::Station ||
+                              (p.step == LocomotiveBehavior::Progress::Access &&
+                               p.priority != 0);
+        auto&       state    = states.at(route.synchroName(i, p.section));
+        if (askAgain && state.occupant == route.parameters()[i].loco.numero()) {
+            state.occupant = -1;
+        }
+    }
+
+    std::vector<Locomotive*> locos;
+    for (const auto& params : route.parameters()) {
+        locos.push_back(&params.loco);
+    }
+    for (const auto& state : states) {
+        synchros.at(state.first)->restoreState(state.second, locos);
+    }
+    for (std::size_t i = 0; i < behaviors.size(); ++i) {
+        behaviors[i]->resumeFrom(progress[i]);
+    }
+
+    return true;
+}
@@ -0,0 +1,62 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef RUNSTATE_H
+#define RUNSTATE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <memory>
+#include <vector>
+
+#include "locomotivebehavior.h"
+#include "routeloader.h"
+
+/**
+ * @brief Saves and restores the client side of a run, stored in a snapshot
+ * along with the state of the simulation: where each behavior stands on its
+ * route and who holds each synchro.
+ *
+ * Contacts keep no state of their own, and the locos waiting for a section ask
+ * for it again when their thread restarts, so neither is saved. A loco stopped
+ * at the station waits again for its whole stop.
+ */
+class RunState {
+    public:
+    /**
+     * @brief Saves the state of a run whose simulation is suspended.
+     *
+     * @param route The route of the run.
+     * @param behaviors The behaviors of the locos of the route.
+     * @return QByteArray The saved state.
+     */
+    static QByteArray save(const RouteLoader& route,
+                           const std::vector<std::unique_ptr<LocomotiveBehavior>>& behaviors);
+
+    /**
+     * @brief Restores the state of a run before its threads are started.
+     *
+     * @param data The state returned by save().
+     * @param route The route of the run, the same as when the state was saved.
+     * @param behaviors The behaviors of the locos of the route.
+     * @param error Set if the state doesn't match the route.
+     * @return bool Whether the state was restored.
+     */
+    static bool restore(const QByteArray& data, const RouteLoader& route,
+                        std::vector<std::unique_ptr<LocomotiveBehavior>>& behaviors,
+                        QString& error);
+
+    private:
+    static constexpr quint32 MAGIC   = 0x54535253;
+    static constexpr qint32  VERSION = 1;
+};
+
+#endif  // RUNSTATE_H
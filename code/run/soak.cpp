@@ -0,0 +1,255 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#include "soak.h"
+
+#include <QLineF>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+
+#include "locostore.h"
+
+// Minimal distance between the centres of two locomotives in a moving-block
+// section. Measured as the crow flies, so shorter than along the track in
+// curves: only part of the margin the simulator keeps is required.
+static constexpr double MIN_SEPARATION = LONGUEUR_LOCO + MARGE_BLOC_MOBILE / 2;
+
+SoakMonitor::SoakMonitor(SimBatch* batch, const RouteLoader& route,
+                         const Options& options)
+    : batch(batch),
+      route(route),
+      options(options),
+      random(options.seed),
+      powerRestore(0.0),
+      powered(true),
+      emergencyStops(0),
+      speedChanges(0),
+      windowStart(0.0) {
+    nextSpeedChange = nextDelay(options.speedChangeMeanS * 1000.0);
+    nextStop        = nextDelay(options.stopMeanS * 1000.0);
+
+    for (std::size_t i = 0; i < route.parameters().size(); ++i) {
+        starts.push_back({route.parameters()[i].station.front,
+                          route.parameters()[i].station.back});
+    }
+
+    QObject::connect(batch, &SimBatch::pasEffectue, [this]() { onStep(); });
+    QObject::connect(batch->getSimView(), &SimView::passageContact,
+                     [this](int loco, int contact) { onContact(loco, contact); });
+}
+
+void SoakMonitor::randomiseStart() {
+    const auto& params = route.parameters();
+
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        const double factor =
+            options.minSpeedFactor +
+            random.generateDouble() * (options.maxSpeedFactor - options.minSpeedFactor);
+        params[i].loco.fixerVitesse(std::clamp(
+            qRound(params[i].loco.vitesse() * factor), VITESSE_MINIMUM, VITESSE_MAXIMUM));
+
+        const auto& positions = route.startPositions(i);
+        const auto  choice    = random.bounded(static_cast<quint32>(positions.size() + 1));
+        if (choice > 0) {
+            starts[i] = positions[choice - 1];
+        }
+    }
+}
+
+std::pair<int, int> SoakMonitor::startPosition(std::size_t loco) const {
+    return starts.at(loco);
+}
+
+bool SoakMonitor::violated() const {
+    return !violations.isEmpty();
+}
+
+QJsonObject SoakMonitor::report() const {
+    QJsonObject result{
+        {"seed", static_cast<qint64>(options.seed)},
+        {"emergency_stops", emergencyStops},
+        {"speed_changes", speedChanges},
+        {"violations", violations},
+        {"throughput", throughput},
+    };
+
+    // Mean laps per hour of the last quarter of the windows relative to the
+    // first quarter: well below 1 means the run slows down over time.
+    const std::size_t quarter = windowLapsPerHour.size() / 4;
+    if (quarter > 0) {
+        double first = 0.0;
+        double last  = 0.0;
+        for (std::size_t i = 0; i < quarter; ++i) {
+            first += windowLapsPerHour[i];
+            last += windowLapsPerHour[windowLapsPerHour.size() - 1 - i];
+        }
+        if (first > 0.0) {
+            result.insert("throughput_ratio", last / first);
+        }
+    }
+
+    return result;
+}
+
+void SoakMonitor::onStep() {
+    const StatistiquesSim& stats = batch->getSimView()->getStatistiques();
+    const double           now   = stats.getTempsSimule();
+    SimView*               view  = batch->getSimView();
+    const auto&            params = route.parameters();
+
+    // Emergency stops: the power of the whole layout is cut for a while.
+    if (!powered && now >= powerRestore) {
+        view->setAlimentation(true);
+        powered = true;
+    }
+    if (powered && now >= nextStop) {
+        view->setAlimentation(false);
+        powered      = false;
+        powerRestore = now + options.stopHoldS * 1000.0;
+        nextStop     = powerRestore + nextDelay(options.stopMeanS * 1000.0);
+        emergencyStops++;
+    }
+
+    // Physical speed perturbation of a random locomotive.
+    if (now >= nextSpeedChange) {
+        const auto   i      = random.bounded(static_cast<quint32>(params.size()));
+        const double factor = options.minSpeedFactor +
+                              random.generateDouble() *
+                                  (options.maxSpeedFactor - options.minSpeedFactor);
+        view->setFacteurVitesseLoco(params[i].loco.numero(), factor);
+        nextSpeedChange = now + nextDelay(options.speedChangeMeanS * 1000.0);
+        speedChanges++;
+    }
+
+    if (stats.getNbCollisions() > 0) {
+        violation("collision between two locomotives");
+        return;
+    }
+    if (stats.getNbDeraillements() > 0) {
+        violation("junction thrown under a locomotive");
+        return;
+    }
+    checkSeparation();
+    if (violated()) {
+        return;
+    }
+
+    // Starvation: time spent stopped while the layout is powered.
+    const LocoStore* store = LocoStore::getInstance();
+    for (const auto& p : params) {
+        const int number = p.loco.numero();
+        if (powered && store->vitesse[number] == 0) {
+            stoppedFor[number] += PAS_SIMULATION_MS;
+        } else {
+            stoppedFor[number] = 0.0;
+        }
+
+        if (stoppedFor[number] > options.starvationS * 1000.0) {
+            violation(QString("locomotive %1 stopped for more than %2 s")
+                          .arg(number)
+                          .arg(options.starvationS));
+            return;
+        }
+    }
+
+    // Throughput sampling.
+    if (now - windowStart >= options.windowS * 1000.0) {
+        QJsonObject laps;
+        int         total = 0;
+        for (const auto& p : params) {
+            const int number = p.loco.numero();
+            const int done   = batch->getNbTours(number) - lapsAtWindowStart[number];
+            laps.insert(QString::number(number), done);
+            lapsAtWindowStart[number] += done;
+            total += done;
+        }
+
+        const double lapsPerHour = total * 3600.0 / options.windowS;
+        windowLapsPerHour.push_back(lapsPerHour);
+        throughput.append(QJsonObject{
+            {"t_s", now / 1000.0},
+            {"laps", laps},
+            {"laps_per_hour", lapsPerHour},
+        });
+        windowStart = now;
+    }
+}
+
+void SoakMonitor::onContact(int loco, int contact) {
+    const auto& params = route.parameters();
+
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        if (params[i].loco.numero() != loco) {
+            continue;
+        }
+
+        for (std::size_t k = 0; k < params[i].sections.size(); ++k) {
+            const auto&    section = params[i].sections[k];
+            const QString& name    = route.synchroName(i, k);
+
+            if (contact == section.contactExit) {
+                occupants[name].erase(loco);
+            } else if (contact == section.contactEnter) {
+                auto& inside = occupants[name];
+                inside.insert(loco);
+                if (inside.size() > 1 && !route.isMovingBlock(name)) {
+                    QStringList numbers;
+                    for (int number : inside) {
+                        numbers << QString::number(number);
+                    }
+                    violation(QString("locomotives %1 together in section %2")
+                                  .arg(numbers.join(", "), name));
+                }
+            }
+        }
+    }
+}
+
+void SoakMonitor::checkSeparation() {
+    const LocoStore* store = LocoStore::getInstance();
+
+    for (const auto& [name, inside] : occupants) {
+        if (inside.size() < 2 || !route.isMovingBlock(name)) {
+            continue;
+        }
+
+        for (auto a = inside.begin(); a != inside.end(); ++a) {
+            for (auto b = std::next(a); b != inside.end(); ++b) {
+                const double distance =
+                    QLineF(store->getPosition(*a), store->getPosition(*b)).length();
+                if (distance < MIN_SEPARATION) {
+                    violation(QString("locomotives %1 and %2 %3 apart in section %4")
+                                  .arg(*a)
+                                  .arg(*b)
+                                  .arg(distance, 0, 'f', 0)
+                                  .arg(name));
+                    return;
+                }
+            }
+        }
+    }
+}
+
+void SoakMonitor::violation(const QString& message) {
+    const double now = batch->getSimView()->getStatistiques().getTempsSimule();
+    const QString text = QString("t=%1 s: %2").arg(now / 1000.0, 0, 'f', 1).arg(message);
+
+    violations.append(text);
+    std::cerr << "soak: " << qPrintable(text) << std::endl;
+    batch->arreter("invariant");
+}
+
+double SoakMonitor::nextDelay(double mean) {
+    return -mean * std::log(1.0 - random.generateDouble());
+}
@@ -0,0 +1,156 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QString>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "routeloader.h"
+#include "simbatch.h"
+
+/**
+ * @brief Perturbs a running scenario and checks its safety invariants at every
+ * simulation step.
+ *
+ * Perturbations, all drawn from a seeded generator so a failing run can be
+ * replayed:
+ * - random commanded speeds and start positions, chosen before the start,
+ * - random changes of the physical speed factor of a locomotive,
+ * - random emergency stops, cutting the power of the whole layout.
+ *
+ * Invariants:
+ * - at most one locomotive between the entry and exit contacts of a synchro,
+ *   or, for a moving-block synchro, no two locomotives in it closer than a
+ *   loco length plus half the moving-block margin, centre to centre,
+ * - no collision,
+ * - no junction thrown under a locomotive (reported as a derailment),
+ * - no locomotive stopped, with the power on, for longer than a bound.
+ *
+ * The first violation stops the run. Laps are sampled over fixed windows of
+ * simulated time to expose a throughput decay.
+ */
+class SoakMonitor {
+    public:
+    /**
+     * @brief Tuning of the perturbations and of the checks, in simulated seconds.
+     */
+    struct Options {
+        quint32 seed             = 1;
+        double  starvationS      = 120.0;
+        double  windowS          = 60.0;
+        double  speedChangeMeanS = 30.0;
+        double  minSpeedFactor   = 0.6;
+        double  maxSpeedFactor   = 1.4;
+        double  stopMeanS        = 180.0;
+        double  stopHoldS        = 5.0;
+    };
+
+    /**
+     * @brief Constructs the monitor and connects it to the batch.
+     *
+     * @param batch The simulation host.
+     * @param route The route being run.
+     * @param options The perturbation and check settings.
+     */
+    SoakMonitor(SimBatch* batch, const RouteLoader& route, const Options& options);
+
+    /**
+     * @brief Draws the commanded speed and the start position of each
+     * locomotive. To be called by cmain() before placing the locomotives.
+     */
+    void randomiseStart();
+
+    /**
+     * @brief The start position drawn for a locomotive.
+     *
+     * @param loco The index of the locomotive in the route parameters.
+     * @return The (front, back) contact pair.
+     */
+    std::pair<int, int> startPosition(std::size_t loco) const;
+
+    /**
+     * @brief Whether an invariant was violated.
+     */
+    bool violated() const;
+
+    /**
+     * @brief The soak part of the run summary.
+     */
+    QJsonObject report() const;
+
+    private:
+    /**
+     * @brief Applies the due perturbations and checks the invariants.
+     */
+    void onStep();
+
+    /**
+     * @brief Tracks the shared section occupancy on contact passages.
+     *
+     * @param loco The locomotive number.
+     * @param contact The contact number.
+     */
+    void onContact(int loco, int contact);
+
+    /**
+     * @brief Checks the separation of the locomotives inside the moving-block
+     * sections.
+     */
+    void checkSeparation();
+
+    /**
+     * @brief Records a violation and stops the run.
+     *
+     * @param message The description of the violation.
+     */
+    void violation(const QString& message);
+
+    /**
+     * @brief Draws an exponentially distributed delay.
+     *
+     * @param mean The mean delay, in milliseconds.
+     */
+    double nextDelay(double mean);
+
+    SimBatch*          batch;
+    const RouteLoader& route;
+    Options            options;
+    QRandomGenerator   random;
+
+    std::vector<std::pair<int, int>> starts;
+    // Synchro name -> locomotives currently between its entry and exit contacts.
+    std::map<QString, std::set<int>> occupants;
+    // Locomotive number -> simulated time it has been stopped with power on.
+    std::map<int, double>            stoppedFor;
+
+    double nextSpeedChange;
+    double nextStop;
+    double powerRestore;
+    bool   powered;
+    int    emergencyStops;
+    int    speedChanges;
+
+    double             windowStart;
+    std::map<int, int> lapsAtWindowStart;
+    QJsonArray         throughput;
+    std::vector<double> windowLapsPerHour;
+
+    QJsonArray violations;
+};
+
+#endif  // SOAK_H
@@ -0,0 +1,422 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ *
+ * Headless scenario runner: loads a route, runs the locomotive behaviors
+ * without any window at maximum simulation speed and writes a JSON summary.
+ * The exit code is 1 if a collision or a derailment occurred, 2 if the run
+ * could not be set up, 0 otherwise.
+ * A run can be saved to a snapshot file at a given simulated time, and a later
+ * run of the same route restarted from it.
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "commandetrain.h"
+#include "ctrain_handler.h"
+#include "metriques.h"
+#include "simbatch.h"
+#include "trainsimsettings.h"
+
+#include "launchable.h"
+#include "launchpool.h"
+#include "collisionsupervisor.h"
+#include "locomotivebehavior.h"
+#include "pausesupervisor.h"
+#include "routeloader.h"
+#include "runstate.h"
+#include "soak.h"
+#include "stoptoken.h"
+
+// Simulated duration used when neither a duration nor a lap count is given.
+static constexpr double DEFAULT_DURATION_S = 600.0;
+
+// Soak runs default to a few times real time: the behaviors sleep in wall-clock
+// time, and a faster simulation turns those sleeps into long simulated stops.
+static constexpr int SOAK_DEFAULT_RATE = 4 * FRAME_RATE;
+
+static RouteLoader route;
+static SimBatch*   batch = nullptr;
+static std::unique_ptr<SoakMonitor> soak;
+static LaunchPool  pool;
+static std::shared_ptr<StopToken> stopToken = std::make_shared<StopToken>();
+static PauseSupervisor pauseSupervisor;
+static CollisionSupervisor collisionSupervisor;
+static std::vector<std::unique_ptr<LocomotiveBehavior>> behaviors;
+
+// Wall-clock time the behaviors may take to reach their next wait once the
+// simulation is suspended for a snapshot.
+static constexpr std::chrono::milliseconds SNAPSHOT_SETTLE_TIMEOUT{5000};
+
+static QString           snapshotFile;
+static QString           restoreFile;
+static std::future<void> snapshotDone;
+static std::atomic<bool> restoreFailed{false};
+
+/**
+ * @brief Stops all locos.
+ */
+void emergency_stop() {
+    arret_urgence();
+    stopToken->requestStop();
+
+    afficher_message("\nSTOP!");
+}
+
+/**
+ * @brief Suspends the simulation and saves it to the snapshot file along with
+ * the state of the behaviors. Called from the simulation thread, the saving
+ * itself waits in a task of the pool until every behavior is blocked in a
+ * wait, where its progress can't change while the simulation is suspended.
+ */
+static void takeSnapshot() {
+    batch->getSimView()->setSuspendue(true);
+    snapshotDone = pool.submit([] {
+        bool settled = true;
+        for (const auto& behavior : behaviors) {
+            settled = behavior->waitUntilParked(SNAPSHOT_SETTLE_TIMEOUT) && settled;
+        }
+        if (!settled) {
+            std::cerr << "trainsim-run: the behaviors did not settle, no snapshot taken"
+                      << std::endl;
+        } else if (!CommandeTrain::getInstance()->sauvegarder_etat(
+                       snapshotFile, RunState::save(route, behaviors))) {
+            std::cerr << "trainsim-run: cannot write " << qPrintable(snapshotFile)
+                      << std::endl;
+        }
+        CommandeTrain::getInstance()->suspendre_simulation(false);
+    });
+}
+
+/**
+ * @brief Restores the simulation and the behaviors from the snapshot file.
+ *
+ * @return bool Whether the snapshot was restored.
+ */
+static bool restoreSnapshot() {
+    QByteArray state;
+    QString    error = "cannot restore the simulation";
+    if (!CommandeTrain::getInstance()->restaurer_etat(restoreFile, state) ||
+        !RunState::restore(state, route, behaviors, error)) {
+        std::cerr << "trainsim-run: " << qPrintable(restoreFile) << ": "
+                  << qPrintable(error) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Places the locomotives of the route and runs their behaviors.
+ *
+ * @return int The exit code of the user thread.
+ */
+int cmain() {
+    // The maquette was preloaded by main(): the behaviors are built while the
+    // simulation thread loads it.
+    for (const auto& params : route.parameters()) {
+        behaviors.push_back(std::make_unique<LocomotiveBehavior>(params));
+        behaviors.back()->setStopToken(stopToken);
+        pauseSupervisor.supervise(*behaviors.back());
+        collisionSupervisor.supervise(params.loco);
+    }
+    pauseSupervisor.setStopToken(stopToken);
+    collisionSupervisor.setStopToken(stopToken);
+    sur_arret_programme([](void*) { stopToken->requestStop(); }, nullptr);
+
+    selection_maquette(route.maquetteId().c_str());
+
+    for (const auto& junction : route.junctions()) {
+        diriger_aiguillage(junction.junctionId, junction.direction, 0);
+    }
+
+    if (soak != nullptr) {
+        soak->randomiseStart();
+    }
+
+    for (std::size_t i = 0; i < route.parameters().size(); ++i) {
+        const auto& params = route.parameters()[i];
+        const auto  start  = soak != nullptr
+                                 ? soak->startPosition(i)
+                                 : std::make_pair(params.station.front, params.station.back);
+        params.loco.fixerPosition(start.first, start.second);
+    }
+
+    if (!restoreFile.isEmpty() && !restoreSnapshot()) {
+        restoreFailed = true;
+        mettre_maquette_hors_service();
+        QMetaObject::invokeMethod(qApp, "quit", Qt::QueuedConnection);
+        return EXIT_FAILURE;
+    }
+
+    pauseSupervisor.startThread(&pool);
+    collisionSupervisor.startThread(&pool);
+    for (auto& behavior : behaviors) {
+        behavior->startThread(&pool);
+    }
+
+    // Queued after the placement of the locos, so the simulation starts with
+    // every loco on the track.
+    QMetaObject::invokeMethod(batch, "demarrer", Qt::QueuedConnection);
+
+    // The behaviors return once the run is over and the stop is requested.
+    for (auto& behavior : behaviors) {
+        behavior->join();
+    }
+    pauseSupervisor.join();
+    collisionSupervisor.join();
+
+    // The snapshot is taken in the simulation thread before the stop it may
+    // be followed by, so its task is known once the behaviors are over.
+    if (snapshotDone.valid()) {
+        snapshotDone.wait();
+    }
+
+    mettre_maquette_hors_service();
+    QMetaObject::invokeMethod(qApp, "quit", Qt::QueuedConnection);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Builds the JSON summary of the run.
+ *
+ * @param routePath The path of the route file.
+ * @return QJsonObject The summary.
+ */
+static QJsonObject summary(const QString& routePath) {
+    const StatistiquesSim& stats   = batch->getSimView()->getStatistiques();
+    const qreal            simTime = stats.getTempsSimule();
+
+    QJsonArray locos;
+    for (const auto& params : route.parameters()) {
+        const int number = params.loco.numero();
+
+        QJsonObject passages;
+        const auto  contacts = stats.getPassagesContacts().value(number);
+        for (auto it = contacts.constBegin(); it != contacts.constEnd(); ++it) {
+            passages.insert(QString::number(it.key()), it.value());
+        }
+
+        locos.append(QJsonObject{
+            {"number", number},
+            {"laps", batch->getNbTours(number)},
+            {"stopped_time_s", stats.getTempsArret().value(number) / 1000.0},
+            {"contact_passages", passages},
+        });
+    }
+
+    QJsonArray sections;
+    const auto& occupation = stats.getOccupationSegments();
+    for (auto it = occupation.constBegin(); it != occupation.constEnd(); ++it) {
+        sections.append(QJsonObject{
+            {"contacts", QJsonArray{it.key().first, it.key().second}},
+            {"occupied_time_s", it.value() / 1000.0},
+            {"utilisation", simTime > 0.0 ? it.value() / simTime : 0.0},
+        });
+    }
+
+    QJsonObject result{
+        {"route", routePath},
+        {"maquette", QString::fromStdString(route.maquetteId())},
+        {"termination", batch->getRaisonArret()},
+        {"sim_time_s", simTime / 1000.0},
+        {"steps", stats.getNbPas()},
+        {"collisions", stats.getNbCollisions()},
+        {"derailments", stats.getNbDeraillements()},
+        {"emergency_stops", stats.getNbArretsUrgence()},
+        {"emergency_stop_max_latency_ms", stats.getLatenceMaxArretUrgence() / 1000.0},
+        {"locos", locos},
+        {"section_utilisation", sections},
+    };
+
+    if (soak != nullptr) {
+        result.insert("soak", soak->report());
+    }
+
+    return result;
+}
+
+/**
+ * @brief Main function.
+ *
+ * @return int 0 if the run completed safely, 1 on collision, derailment or
+ * soak invariant violation, 2 on invalid arguments or an unreadable snapshot.
+ */
+int main(int argc, char* argv[]) {
+    // No display is needed, the simulation view is never shown.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("trainsim-run");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Runs a route without display at maximum simulation speed and writes a "
+        "JSON summary. Behaviors sleeping in wall-clock time see shortened "
+        "waits in simulated time, use --rate to slow the simulation down.");
+    parser.addHelpOption();
+
+    const QCommandLineOption routeOption(
+        {"r", "route"}, "JSON route definition.", "file");
+    const QCommandLineOption durationOption(
+        {"d", "duration"}, "Simulated duration, in seconds.", "seconds");
+    const QCommandLineOption lapsOption(
+        {"l", "laps"}, "Stop once every loco has done this many laps.", "laps");
+    const QCommandLineOption outputOption(
+        {"o", "output"}, "Summary file, standard output by default.", "file");
+    const QCommandLineOption rateOption(
+        "rate", "Simulation steps per second, 0 for maximum speed.", "steps", "0");
+    const QCommandLineOption threadsOption(
+        "threads", "Simulation threads, 0 for automatic.", "threads", "0");
+    const QCommandLineOption noInertiaOption(
+        "no-inertia", "Disable the inertia of the locos.");
+    const QCommandLineOption metricsOption(
+        "metrics-csv", "Append the operations metrics to a CSV file at the end.",
+        "file");
+    const QCommandLineOption soakOption(
+        "soak", "Perturb the run randomly and check the safety invariants.");
+    const QCommandLineOption seedOption(
+        "seed", "Seed of the soak perturbations.", "seed", "1");
+    const QCommandLineOption starvationOption(
+        "starvation", "Longest stop allowed during a soak, in seconds.",
+        "seconds", "120");
+    const QCommandLineOption windowOption(
+        "window", "Throughput sampling window of a soak, in seconds.",
+        "seconds", "60");
+    const QCommandLineOption snapshotOption(
+        "snapshot", "Save the run to a snapshot file, see --snapshot-at.", "file");
+    const QCommandLineOption snapshotAtOption(
+        "snapshot-at", "Simulated time of the snapshot, in seconds.", "seconds", "0");
+    const QCommandLineOption restoreOption(
+        "restore", "Restart the run from a snapshot file of the same route.", "file");
+    const QCommandLineOption verboseOption(
+        {"v", "verbose"}, "Print the simulation messages.");
+
+    parser.addOptions({routeOption, durationOption, lapsOption, outputOption,
+                       rateOption, threadsOption, noInertiaOption,
+                       metricsOption, soakOption,
+                       seedOption, starvationOption, windowOption,
+                       snapshotOption, snapshotAtOption, restoreOption,
+                       verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(routeOption)) {
+        std::cerr << "trainsim-run: --route is required" << std::endl;
+        return 2;
+    }
+
+    QString error;
+    if (!route.load(parser.value(routeOption), error)) {
+        std::cerr << "trainsim-run: " << qPrintable(error) << std::endl;
+        return 2;
+    }
+
+    double duration = parser.value(durationOption).toDouble();
+    const int laps  = parser.value(lapsOption).toInt();
+    if (duration <= 0.0 && laps <= 0) {
+        duration = DEFAULT_DURATION_S;
+    }
+
+    TrainSimSettings::getInstance()->setInertie(!parser.isSet(noInertiaOption));
+    TrainSimSettings::getInstance()->setNbThreadsSimulation(
+        parser.value(threadsOption).toInt());
+
+    batch = new SimBatch();
+    if (!batch->estValide()) {
+        std::cerr << "trainsim-run: cannot read the track descriptions" << std::endl;
+        return 2;
+    }
+
+    batch->setVerbeux(parser.isSet(verboseOption));
+    batch->setDureeMax(duration * 1000.0);
+    batch->setNbToursMax(laps);
+    batch->setPasParSeconde(parser.value(rateOption).toInt());
+    if (parser.isSet(soakOption)) {
+        SoakMonitor::Options options;
+        options.seed        = parser.value(seedOption).toUInt();
+        options.starvationS = parser.value(starvationOption).toDouble();
+        options.windowS     = qMax(1.0, parser.value(windowOption).toDouble());
+        soak = std::make_unique<SoakMonitor>(batch, route, options);
+
+        if (!parser.isSet(rateOption)) {
+            batch->setPasParSeconde(SOAK_DEFAULT_RATE);
+        }
+    }
+    for (const auto& params : route.parameters()) {
+        batch->setContactTour(params.loco.numero(), params.station.front);
+    }
+
+    restoreFile = parser.value(restoreOption);
+    if (parser.isSet(snapshotOption)) {
+        snapshotFile      = parser.value(snapshotOption);
+        const double atMs = parser.value(snapshotAtOption).toDouble() * 1000.0;
+        QObject::connect(batch, &SimBatch::pasEffectue, [atMs] {
+            static bool taken = false;
+            if (!taken && batch->getSimView()->getStatistiques().getTempsSimule() >= atMs) {
+                taken = true;
+                takeSnapshot();
+            }
+        });
+    }
+
+    // Stopping the behaviors ends cmain(), which quits the application.
+    QObject::connect(batch, &SimBatch::termine, [] { stopToken->requestStop(); });
+
+    CommandeTrain::getInstance()->init_batch(batch);
+    CommandeTrain::getInstance()->precharger_maquette(
+        QString::fromStdString(route.maquetteId()));
+    const int status = app.exec();
+
+    if (restoreFailed || status != 0) {
+        return 2;
+    }
+
+    const QByteArray json =
+        QJsonDocument(summary(parser.value(routeOption))).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            std::cerr << "trainsim-run: cannot write "
+                      << qPrintable(parser.value(outputOption)) << std::endl;
+            return 2;
+        }
+    } else {
+        std::cout << json.constData() << std::flush;
+    }
+
+    if (parser.isSet(metricsOption) &&
+        !Metriques::getInstance()->exporterCsv(parser.value(metricsOption))) {
+        std::cerr << "trainsim-run: cannot write "
+                  << qPrintable(parser.value(metricsOption)) << std::endl;
+    }
+
+    const QString reason = batch->getRaisonArret();
+    const int code = (reason == "collision" || reason == "derailment" ||
+                      (soak != nullptr && soak->violated()))
+                         ? 1
+                         : 0;
+
+    std::fflush(nullptr);
+    return code;
+}
@@ -0,0 +1,108 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#include "arbitrationpolicy.h"
+
+#include <utility>
+
+std::size_t FifoPolicy::choose(const std::vector<SectionRequest>& waiting,
+                               std::chrono::steady_clock::time_point) const {
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < waiting.size(); ++i) {
+        if (waiting[i].sequence < waiting[best].sequence) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+std::string FifoPolicy::name() const {
+    return "fifo";
+}
+
+StaticPriorityPolicy::StaticPriorityPolicy(std::map<std::int32_t, double> priorities)
+    : priorities(std::move(priorities)) {}
+
+double StaticPriorityPolicy::effectivePriority(
+    const SectionRequest& request, std::chrono::steady_clock::time_point) const {
+    const auto it = priorities.find(request.loco);
+    return it != priorities.end() ? it->second : 0.0;
+}
+
+std::size_t StaticPriorityPolicy::choose(
+    const std::vector<SectionRequest>&    waiting,
+    std::chrono::steady_clock::time_point now) const {
+    std::size_t best         = 0;
+    double      bestPriority = effectivePriority(waiting[0], now);
+
+    for (std::size_t i = 1; i < waiting.size(); ++i) {
+        const double priority = effectivePriority(waiting[i], now);
+        if (priority > bestPriority ||
+            (priority == bestPriority && waiting[i].sequence < waiting[best].sequence)) {
+            best         = i;
+            bestPriority = priority;
+        }
+    }
+    return best;
+}
+
+std::string StaticPriorityPolicy::name() const {
+    return "priority";
+}
+
+AgingPolicy::AgingPolicy(std::map<std::int32_t, double> priorities,
+                         double                         agingPerSecond)
+    : StaticPriorityPolicy(std::move(priorities)), agingPerSecond(agingPerSecond) {}
+
+double AgingPolicy::effectivePriority(const SectionRequest&                 request,
+                                      std::chrono::steady_clock::time_point now) const {
+    const std::chrono::duration<double> waited = now - request.since;
+    return StaticPriorityPolicy::effectivePriority(request, now) +
+           agingPerSecond * waited.count();
+}
+
+std::string AgingPolicy::name() const {
+    return "aging";
+}
+
+std::size_t ShortestEtaPolicy::choose(const std::vector<SectionRequest>& waiting,
+                                      std::chrono::steady_clock::time_point) const {
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < waiting.size(); ++i) {
+        if (waiting[i].eta < waiting[best].eta ||
+            (waiting[i].eta == waiting[best].eta &&
+             waiting[i].sequence < waiting[best].sequence)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+std::string ShortestEtaPolicy::name() const {
+    return "eta";
+}
+
+std::shared_ptr<ArbitrationPolicy> makeArbitrationPolicy(
+    const std::string& name, const std::map<std::int32_t, double>& priorities,
+    double agingPerSecond) {
+    if (name == "fifo") {
+        return std::make_shared<FifoPolicy>();
+    }
+    if (name == "priority") {
+        return std::make_shared<StaticPriorityPolicy>(priorities);
+    }
+    if (name == "aging") {
+        return std::make_shared<AgingPolicy>(priorities, agingPerSecond);
+    }
+    if (name == "eta") {
+        return std::make_shared<ShortestEtaPolicy>();
+    }
+    return nullptr;
+}
@@ -0,0 +1,144 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef ARBITRATIONPOLICY_H
+#define ARBITRATIONPOLICY_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A locomotive waiting for a shared section.
+ *
+ * @param loco The locomotive number.
+ * @param since When the locomotive started waiting.
+ * @param sequence The arrival order of the request, unique per section.
+ * @param eta The estimated time for the locomotive to reach the section entry
+ * once granted, in seconds.
+ */
+struct SectionRequest {
+    std::int32_t                          loco;
+    std::chrono::steady_clock::time_point since;
+    std::uint64_t                         sequence;
+    double                                eta;
+};
+
+/**
+ * @brief Chooses which waiting locomotive gets a shared section when it is
+ * released. Called with the section mutex held, so implementations only need
+ * to be reentrant, not thread-safe.
+ */
+class ArbitrationPolicy {
+    public:
+    virtual ~ArbitrationPolicy() = default;
+
+    /**
+     * @brief Chooses the next locomotive to enter the section.
+     *
+     * @param waiting The waiting locomotives, never empty.
+     * @param now The current time.
+     * @return The index of the chosen request in waiting.
+     */
+    virtual std::size_t choose(
+        const std::vector<SectionRequest>&    waiting,
+        std::chrono::steady_clock::time_point now) const = 0;
+
+    /**
+     * @brief The name of the policy, as used in route files.
+     */
+    virtual std::string name() const = 0;
+};
+
+/**
+ * @brief First come, first served.
+ */
+class FifoPolicy final : public ArbitrationPolicy {
+    public:
+    std::size_t choose(const std::vector<SectionRequest>&    waiting,
+                       std::chrono::steady_clock::time_point now) const override;
+    std::string name() const override;
+};
+
+/**
+ * @brief Highest static priority first, first come first served among equal
+ * priorities. Can starve low priority locomotives.
+ */
+class StaticPriorityPolicy : public ArbitrationPolicy {
+    public:
+    /**
+     * @param priorities The priority of each locomotive number, 0 by default.
+     */
+    explicit StaticPriorityPolicy(std::map<std::int32_t, double> priorities);
+
+    std::size_t choose(const std::vector<SectionRequest>&    waiting,
+                       std::chrono::steady_clock::time_point now) const override;
+    std::string name() const override;
+
+    protected:
+    /**
+     * @brief The priority of a request at a given time.
+     */
+    virtual double effectivePriority(
+        const SectionRequest& request, std::chrono::steady_clock::time_point now) const;
+
+    const std::map<std::int32_t, double> priorities;
+};
+
+/**
+ * @brief Static priority raised by the time spent waiting. Any waiting
+ * locomotive eventually outranks the others, so none can starve.
+ */
+class AgingPolicy final : public StaticPriorityPolicy {
+    public:
+    /**
+     * @param priorities The base priority of each locomotive number.
+     * @param agingPerSecond The priority gained per second of waiting.
+     */
+    AgingPolicy(std::map<std::int32_t, double> priorities, double agingPerSecond);
+
+    std::string name() const override;
+
+    protected:
+    double effectivePriority(const SectionRequest&                 request,
+                             std::chrono::steady_clock::time_point now) const override;
+
+    private:
+    const double agingPerSecond;
+};
+
+/**
+ * @brief The locomotive which will reach the section first once granted goes
+ * first, which minimises the time the section stays idle. Ties are first come,
+ * first served.
+ */
+class ShortestEtaPolicy final : public ArbitrationPolicy {
+    public:
+    std::size_t choose(const std::vector<SectionRequest>&    waiting,
+                       std::chrono::steady_clock::time_point now) const override;
+    std::string name() const override;
+};
+
+/**
+ * @brief Builds a policy from its name.
+ *
+ * @param name "fifo", "priority", "aging" or "eta".
+ * @param priorities The locomotive priorities, for "priority" and "aging".
+ * @param agingPerSecond The aging rate, for "aging".
+ * @return The policy, nullptr if the name is unknown.
+ */
+std::shared_ptr<ArbitrationPolicy> makeArbitrationPolicy(
+    const std::string& name, const std::map<std::int32_t, double>& priorities = {},
+    double agingPerSecond = 1.0);
+
+#endif  // ARBITRATIONPOLICY_H
@@ -0,0 +1,165 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#include "collisionsupervisor.h"
+#include "ctrain_handler.h"
+
+#include <algorithm>
+
+void CollisionSupervisor::supervise(Locomotive& loco)
+{
+    locos.push_back(&loco);
+}
+
+void CollisionSupervisor::setStopToken(std::shared_ptr<StopToken> token)
+{
+    token->onStop([this] {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        condition.notify_all();
+    });
+    stopToken = std::move(token);
+}
+
+void CollisionSupervisor::report(int loco, int other, int level, double timeToCollision, void* supervisor)
+{
+    auto* self = static_cast<CollisionSupervisor*>(supervisor);
+    {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->events.push_back({loco, {other, level, timeToCollision}});
+    }
+    self->condition.notify_all();
+}
+
+bool CollisionSupervisor::mustStop(int loco, const Warning& warning) const
+{
+    // Both locos of a pair stopping would only postpone the collision.
+    const auto other  = warnings.find(warning.other);
+    const bool mutual = other != warnings.end() && other->second.other == loco &&
+                        other->second.level >= ALERTE_DANGER;
+    return !mutual || loco > warning.other;
+}
+
+int CollisionSupervisor::speedLimit(const Locomotive& loco)
+{
+    const int  number  = loco.numero();
+    const auto own     = warnings.find(number);
+    const int  reduced = std::max(VITESSE_MINIMUM, loco.vitesse() / 2);
+    const auto now     = std::chrono::steady_clock::now();
+
+    if (own != warnings.end() && own->second.level >= ALERTE_DANGER && mustStop(number, own->second)) {
+        held[number] = {false, now};
+        return 0;
+    }
+
+    // A stopped loco isn't warned anymore: it waits until no moving loco is
+    // warned about it.
+    if (loco.limiteVitesse() == 0) {
+        for (const auto& warned : warnings) {
+            if (warned.second.other == number && warned.second.level >= ALERTE_ATTENTION) {
+                return 0;
+            }
+        }
+    }
+
+    if (own != warnings.end() && own->second.level >= ALERTE_ATTENTION) {
+        held[number] = {false, now};
+        return reduced;
+    }
+
+    const auto hold = held.find(number);
+    if (hold == held.end()) {
+        return VITESSE_MAXIMUM;
+    }
+
+    // The limit is kept until the time to collision is past TTC_INFORMATION,
+    // not only past TTC_ATTENTION.
+    if (own != warnings.end()) {
+        hold->second.clear = false;
+        return reduced;
+    }
+
+    // The simulator can't time a stopped loco, whose warning is always
+    // cleared: it restarts at the reduced speed, to be timed again.
+    if (!hold->second.clear || loco.limiteVitesse() == 0) {
+        hold->second = {true, now};
+        return reduced;
+    }
+    if (now - hold->second.since < RELEASE_DELAY) {
+        return reduced;
+    }
+
+    held.erase(hold);
+    return VITESSE_MAXIMUM;
+}
+
+void CollisionSupervisor::run()
+{
+    sur_alerte_collision(&CollisionSupervisor::report, this);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopRequested()) {
+        // Woken up periodically while a limit is held, to lift it once clear.
+        if (held.empty()) {
+            condition.wait(lock, [this] { return !events.empty() || stopRequested(); });
+        } else {
+            condition.wait_for(lock, RELEASE_CHECK,
+                               [this] { return !events.empty() || stopRequested(); });
+        }
+        if (stopRequested()) {
+            break;
+        }
+
+        std::deque<Event> pending;
+        pending.swap(events);
+        lock.unlock();
+
+        for (const auto& event : pending) {
+            if (event.warning.level == ALERTE_AUCUNE) {
+                warnings.erase(event.loco);
+            } else {
+                warnings[event.loco] = event.warning;
+            }
+        }
+
+        for (auto* loco : locos) {
+            const int limit = speedLimit(*loco);
+            if (limit == loco->limiteVitesse()) {
+                continue;
+            }
+            loco->limiterVitesse(limit);
+
+            const auto warning = warnings.find(loco->numero());
+            if (limit == VITESSE_MAXIMUM) {
+                loco->afficherMessage("Collision warning cleared.");
+            } else if (warning != warnings.end()) {
+                loco->afficherMessage(QString("Collision with loco %1 in %2 s: speed limited to %3.")
+                                          .arg(warning->second.other)
+                                          .arg(warning->second.timeToCollision, 0, 'f', 1)
+                                          .arg(limit));
+            } else if (limit == 0) {
+                loco->afficherMessage("Waiting for the way to clear.");
+            } else {
+                loco->afficherMessage(QString("Speed limited to %1 until the way is clear.").arg(limit));
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+void CollisionSupervisor::printStartMessage()
+{
+    qDebug() << "[START] Thread de supervision des collisions lancé";
+}
+
+void CollisionSupervisor::printCompletionMessage()
+{
+    qDebug() << "[STOP] Thread de supervision des collisions a terminé";
+}
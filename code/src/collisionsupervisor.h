@@ -0,0 +1,142 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef COLLISIONSUPERVISOR_H
+#define COLLISIONSUPERVISOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "launchable.h"
+#include "locomotive.h"
+
+/**
+ * @brief Slows the locomotives down on the collision warnings of the
+ * simulator, so that a predicted collision is avoided without stopping the
+ * whole scenario.
+ *
+ * The simulator predicts the time to collision of every pair of locomotives
+ * heading for the same tracks and reports each change of warning level. A
+ * locomotive warned with ALERTE_ATTENTION runs at half its speed; with
+ * ALERTE_DANGER it stops until no locomotive is warned about it anymore. When
+ * both locomotives of a pair are in danger, only the one with the larger
+ * number stops, the other one only slows down to clear the way.
+ *
+ * A limit is lifted with hysteresis, so that a follower doesn't oscillate
+ * behind a slower leader: a stopped locomotive restarts at half its speed,
+ * and the limit is only lifted once the locomotive has run without any
+ * warning, not even ALERTE_INFORMATION, for RELEASE_DELAY.
+ */
+class CollisionSupervisor : public Launchable {
+    public:
+    /**
+     * @brief Adds a locomotive to supervise. To be called before
+     * startThread().
+     *
+     * @param loco The locomotive, which must outlive the supervisor thread.
+     */
+    void supervise(Locomotive& loco);
+
+    /**
+     * @brief Shares the stop request of the behaviors. The supervisor doesn't
+     * drive a locomotive, so it isn't counted among the threads acknowledging
+     * the stop.
+     *
+     * @param token The stop request.
+     */
+    void setStopToken(std::shared_ptr<StopToken> token) override;
+
+    protected:
+    /**
+     * @brief Applies the warnings until a stop is requested. The warning
+     * reports are registered with the simulator at the start, so the
+     * supervisor must outlive the simulator.
+     */
+    void run() override;
+
+    void printStartMessage() override;
+    void printCompletionMessage() override;
+
+    private:
+    /**
+     * @brief The collision warning of a locomotive.
+     */
+    struct Warning {
+        int    other;
+        int    level;
+        double timeToCollision;
+    };
+
+    /**
+     * @brief A change of warning reported by the simulator.
+     */
+    struct Event {
+        int     loco;
+        Warning warning;
+    };
+
+    /**
+     * @brief Queues a change of warning, from the simulator thread.
+     */
+    static void report(int loco, int other, int level, double timeToCollision, void* supervisor);
+
+    /**
+     * @brief The speed limit of a supervised locomotive under the current
+     * warnings.
+     *
+     * @param loco The locomotive.
+     * @return The speed limit, VITESSE_MAXIMUM if the locomotive isn't warned
+     * nor held.
+     */
+    int speedLimit(const Locomotive& loco);
+
+    /**
+     * @brief Whether a locomotive is the one to stop on a danger warning.
+     */
+    bool mustStop(int loco, const Warning& warning) const;
+
+    /**
+     * @brief The limit of a locomotive kept after its warning went below
+     * ALERTE_ATTENTION.
+     */
+    struct Hold {
+        //! Whether the locomotive runs without any warning.
+        bool                                  clear;
+        //! When the locomotive was last limited or started running clear.
+        std::chrono::steady_clock::time_point since;
+    };
+
+    /**
+     * @brief How long a held locomotive must run without any warning before
+     * its limit is lifted, in wall-clock time.
+     */
+    static constexpr std::chrono::milliseconds RELEASE_DELAY{2000};
+
+    /**
+     * @brief How often the held limits are checked.
+     */
+    static constexpr std::chrono::milliseconds RELEASE_CHECK{200};
+
+    std::vector<Locomotive*> locos;
+    //! Current warning of each warned locomotive, only used by run().
+    std::map<int, Warning>   warnings;
+    //! Limits being held, per locomotive number, only used by run().
+    std::map<int, Hold>      held;
+    std::mutex               mutex;
+    std::condition_variable  condition;
+    std::deque<Event>        events;
+};
+
+#endif  // COLLISIONSUPERVISOR_H
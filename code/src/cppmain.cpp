@@ -13,10 +13,13 @@
 
 #include "ctrain_handler.h"
 
+#include "collisionsupervisor.h"
 #include "locomotive.h"
 #include "locomotivebehavior.h"
+#include "pausesupervisor.h"
 #include "synchrointerface.h"
 #include "synchro.h"
+#include "stoptoken.h"
 
 #include <string>
 #include <vector>
@@ -70,16 +73,26 @@ static Locomotive locoA(1 , 10);
 // Locomotive B
 static Locomotive locoB(2 , 12);
 
+// Stop request shared by the locomotive threads, set when the simulator closes
+// or on emergency stop.
+static std::shared_ptr<StopToken> stopToken = std::make_shared<StopToken>();
+
+// Relays the pauses of the locos to their threads, for as long as the simulator runs.
+static PauseSupervisor pauseSupervisor;
+
+// Slows the locos down on the collision warnings of the simulator.
+static CollisionSupervisor collisionSupervisor;
+
 /**
  * @brief Stops all locos.
+ *
+ * The simulator halts every loco at its next step, without inertia, so that no
+ * loco glides onto a contact and starts again. The stop request then releases
+ * the behaviors wherever they wait, and they return with their loco stopped.
  */
 void emergency_stop() {
-    // We need to call fixerVitesse, otherwise the locos might glide to a stop,
-    // hit a warning/station contact and start again because of inertia.
-    locoA.arreter();
-    locoB.arreter();
-    locoA.fixerVitesse(0);
-    locoB.fixerVitesse(0);
+    arret_urgence();
+    stopToken->requestStop();
 
     afficher_message("\nSTOP!");
 }
@@ -134,9 +147,26 @@ int cmain() {
      ********************/
 
     // Création du thread pour la loco 0
-    std::unique_ptr<Launchable> locoBehaveA = std::make_unique<LocomotiveBehavior>(route.paramsA);
+    std::unique_ptr<LocomotiveBehavior> locoBehaveA = std::make_unique<LocomotiveBehavior>(route.paramsA);
     // Création du thread pour la loco 1
-    std::unique_ptr<Launchable> locoBehaveB = std::make_unique<LocomotiveBehavior>(route.paramsB);
+    std::unique_ptr<LocomotiveBehavior> locoBehaveB = std::make_unique<LocomotiveBehavior>(route.paramsB);
+
+    // Let the threads end cleanly when the simulator is closed.
+    locoBehaveA->setStopToken(stopToken);
+    locoBehaveB->setStopToken(stopToken);
+    pauseSupervisor.setStopToken(stopToken);
+    collisionSupervisor.setStopToken(stopToken);
+    sur_arret_programme([](void*) { stopToken->requestStop(); }, nullptr);
+
+    // Suspend the thread of a loco paused from the simulator.
+    pauseSupervisor.supervise(*locoBehaveA);
+    pauseSupervisor.supervise(*locoBehaveB);
+    pauseSupervisor.startThread();
+
+    // Slow a loco down instead of letting it run into another one.
+    collisionSupervisor.supervise(locoA);
+    collisionSupervisor.supervise(locoB);
+    collisionSupervisor.startThread();
 
     // Lanchement des threads
     afficher_message(qPrintable(QString("Lancement thread loco A (numéro %1)").arg(locoA.numero())));
@@ -147,6 +177,8 @@ int cmain() {
     // Attente sur la fin des threads
     locoBehaveA->join();
     locoBehaveB->join();
+    pauseSupervisor.join();
+    collisionSupervisor.join();
 
     // Fin de la simulation
     mettre_maquette_hors_service();
@@ -161,7 +193,7 @@ int cmain() {
  * @return Route The route object.
  */
 Route routeFactory(RouteName route) {
-    std::shared_ptr<SynchroInterface> synchro1 = std::make_shared<Synchro>();
+    std::shared_ptr<SynchroInterface> synchro1 = std::make_shared<Synchro>("Section 1");
 
     switch (route) {
         default:
@@ -310,7 +342,7 @@ Route routeFactory(RouteName route) {
             });
 
             std::shared_ptr<SynchroInterface> synchro2 =
-                std::make_shared<Synchro>();
+                std::make_shared<Synchro>("Section 2");
 
             // Paramètres de la locomotive 1
             LocomotiveBehavior::Parameters paramsA = {
@@ -13,8 +13,15 @@
 
 #include <QDebug>
 
+#include <future>
+#include <memory>
+#include <utility>
+
 #include <pcosynchro/pcothread.h>
 
+#include "launchpool.h"
+#include "stoptoken.h"
+
 /*!
  * \brief La classe Launchable est une classe abstraite qui représente le fait d'avoir un thread
  * associé qui permet d'être lancé, thread qui exécute la fonction run() qui représente le
@@ -25,13 +32,20 @@ class Launchable
 public:
     Launchable() {}
 
+    virtual ~Launchable() {}
+
     /*!
      * \brief startThread Lance un thread avec la fonction run()
+     * \param pool Le pool fournissant le thread, ou nullptr pour un thread dédié
      */
-    void startThread() {
-        if (thread == nullptr) {
+    void startThread(LaunchPool* pool = nullptr) {
+        if (thread == nullptr && !pooled.valid()) {
             printStartMessage();
-            thread = std::make_unique<PcoThread>(&Launchable::run, this);
+            if (pool != nullptr) {
+                pooled = pool->submit([this] { run(); });
+            } else {
+                thread = std::make_unique<PcoThread>(&Launchable::run, this);
+            }
         }
     }
 
@@ -42,9 +56,30 @@ public:
         if (thread != nullptr) {
             thread->join();
             printCompletionMessage();
+        } else if (pooled.valid()) {
+            pooled.get();
+            printCompletionMessage();
         }
     };
 
+    /*!
+     * \brief setStopToken Partage une demande d'arrêt, par exemple entre tous les
+     * Launchables d'un scénario. A appeler avant startThread(), une seule fois :
+     * le Launchable compte parmi les threads qui doivent acquitter la demande.
+     * \param token La demande d'arrêt
+     */
+    virtual void setStopToken(std::shared_ptr<StopToken> token) {
+        token->enlist();
+        stopToken = std::move(token);
+    }
+
+    /*!
+     * \brief requestStop Demande à run() de se terminer dès que possible
+     */
+    void requestStop() {
+        stopToken->requestStop();
+    }
+
 protected:
 
     /*!
@@ -53,6 +88,14 @@ protected:
      */
     virtual void run() = 0;
 
+    /*!
+     * \brief stopRequested Indique si run() doit se terminer. A vérifier après
+     * chaque appel bloquant.
+     */
+    bool stopRequested() const {
+        return stopToken->stopRequested();
+    }
+
     /*!
      * \brief printStartMessage Message affiché au lancement du thread
      */
@@ -68,6 +111,16 @@ protected:
      */
     std::unique_ptr<PcoThread> thread = nullptr;
 
+    /*!
+     * \brief pooled La fin de run(), si elle est exécutée par un pool
+     */
+    std::future<void> pooled;
+
+    /*!
+     * \brief stopToken La demande d'arrêt
+     */
+    std::shared_ptr<StopToken> stopToken = std::make_shared<StopToken>();
+
 };
 
 #endif // LAUNCHABLE_H
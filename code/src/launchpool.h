@@ -0,0 +1,102 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef LAUNCHPOOL_H
+#define LAUNCHPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pcosynchro/pcothread.h>
+
+/**
+ * @brief A pool of reusable threads for Launchable objects.
+ *
+ * A behavior blocks its thread for its whole lifetime, so the pool never
+ * queues a task behind a busy thread: it starts a new thread whenever there
+ * are more tasks than idle threads. Threads are kept once their task ends,
+ * which makes launching the next scenario cheap.
+ */
+class LaunchPool {
+    public:
+    LaunchPool() = default;
+
+    LaunchPool(const LaunchPool&)            = delete;
+    LaunchPool& operator=(const LaunchPool&) = delete;
+
+    /**
+     * @brief Waits for the running tasks and stops the threads.
+     */
+    ~LaunchPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker->join();
+        }
+    }
+
+    /**
+     * @brief Runs a task on an idle thread of the pool, or on a new one.
+     *
+     * @param task The task to run.
+     * @return std::future<void> Ready once the task has returned.
+     */
+    std::future<void> submit(std::function<void()> task) {
+        std::packaged_task<void()> packaged(std::move(task));
+        std::future<void>          done = packaged.get_future();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(packaged));
+        if (tasks.size() > idle) {
+            workers.push_back(std::make_unique<PcoThread>(&LaunchPool::work, this));
+        }
+        available.notify_one();
+        return done;
+    }
+
+    private:
+    /**
+     * @brief Loop of a pool thread: runs tasks until the pool is destroyed.
+     */
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            ++idle;
+            available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            --idle;
+            if (tasks.empty()) {
+                return;
+            }
+
+            std::packaged_task<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex                              mutex;
+    std::condition_variable                 available;
+    std::deque<std::packaged_task<void()>>  tasks;
+    std::vector<std::unique_ptr<PcoThread>> workers;
+    std::size_t                             idle     = 0;
+    bool                                    stopping = false;
+};
+
+#endif  // LAUNCHPOOL_H
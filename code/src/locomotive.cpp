@@ -11,9 +11,13 @@
 #include "locomotive.h"
 #include "ctrain_handler.h"
 
+#include <algorithm>
+
 Locomotive::Locomotive() :
     _numero(-1),
     _vitesse(0),
+    _limite(VITESSE_MAXIMUM),
+    _reduction(VITESSE_MAXIMUM),
     _enFonction(false)
 {
 
@@ -22,6 +26,8 @@ Locomotive::Locomotive() :
 Locomotive::Locomotive(int numero, int vitesse) :
     _numero(numero),
     _vitesse(vitesse),
+    _limite(VITESSE_MAXIMUM),
+    _reduction(VITESSE_MAXIMUM),
     _enFonction(false)
 {
 
@@ -39,20 +45,51 @@ void Locomotive::fixerNumero(int numero)
 
 int Locomotive::vitesse() const
 {
+    std::lock_guard<std::mutex> verrou(_mutex);
     return _vitesse;
 }
 
 void Locomotive::fixerVitesse(int vitesse)
 {
+    std::lock_guard<std::mutex> verrou(_mutex);
     _vitesse = vitesse;
 
     if (_enFonction)
-        mettre_vitesse_progressive(_numero, vitesse);
+        mettre_vitesse_progressive(_numero, vitesseLimitee());
+}
+
+void Locomotive::limiterVitesse(int limite)
+{
+    std::lock_guard<std::mutex> verrou(_mutex);
+    _limite = limite;
+
+    if (_enFonction)
+        mettre_vitesse_progressive(_numero, vitesseLimitee());
+}
+
+int Locomotive::limiteVitesse() const
+{
+    std::lock_guard<std::mutex> verrou(_mutex);
+    return _limite;
+}
+
+void Locomotive::ralentir(int vitesse)
+{
+    std::lock_guard<std::mutex> verrou(_mutex);
+    _reduction = vitesse;
+
+    if (_enFonction)
+        mettre_vitesse_progressive(_numero, vitesseLimitee());
+}
+
+int Locomotive::vitesseLimitee() const
+{
+    return std::min({_vitesse, _limite, _reduction});
 }
 
 void Locomotive::fixerPosition(int contactAvant, int contactArriere)
 {
-    assigner_loco(contactAvant, contactArriere, _numero, _vitesse);
+    assigner_loco(contactAvant, contactArriere, _numero, vitesse());
 }
 
 void Locomotive::afficherMessage(const QString &message)
@@ -72,12 +109,16 @@ void Locomotive::eteindrePhares()
 
 void Locomotive::demarrer()
 {
-    mettre_vitesse_progressive(_numero, _vitesse);
+    std::lock_guard<std::mutex> verrou(_mutex);
+    _reduction = VITESSE_MAXIMUM;
+    mettre_vitesse_progressive(_numero, vitesseLimitee());
     _enFonction = true;
 }
 
 void Locomotive::arreter()
 {
+    std::lock_guard<std::mutex> verrou(_mutex);
+    _reduction = VITESSE_MAXIMUM;
     arreter_loco(_numero);
     _enFonction = false;
 }
@@ -13,6 +13,8 @@
 
 #include <QString>
 
+#include <mutex>
+
 class Locomotive
 {
 
@@ -53,6 +55,25 @@ public:
      */
     void fixerVitesse(int vitesse);
 
+    /** Limite la vitesse de la locomotive, sans changer la vitesse fixee.
+     * Si la locomotive est en fonction, sa vitesse devient la plus petite de
+     * la vitesse fixee et de la limite. Une locomotive arretee le reste.
+     * @param limite Vitesse maximale, VITESSE_MAXIMUM pour lever la limite.
+     */
+    void limiterVitesse(int limite);
+
+    /** Retourne la limite de vitesse de la locomotive.
+     * @return Vitesse maximale de la locomotive.
+     */
+    int limiteVitesse() const;
+
+    /** Reduit la vitesse de la locomotive en fonction jusqu'au prochain
+     * demarrage ou arret, sans changer la vitesse fixee. La vitesse reste
+     * soumise a la limite.
+     * @param vitesse Vitesse reduite.
+     */
+    void ralentir(int vitesse);
+
     /** Determine la position initiale de la locomotive.
      * @param contactAvant Contact vers lequel la locomotive va se diriger.
      * @param contactArrier Contact a l'arriere de la locomotive.
@@ -82,7 +103,15 @@ public:
 private:
     int _numero;
     int _vitesse;
+    int _limite;
+    //! Vitesse reduite par ralentir(), VITESSE_MAXIMUM sinon.
+    int _reduction;
     bool _enFonction;
+    //! Protege les vitesses et la limite, modifiees depuis plusieurs threads.
+    mutable std::mutex _mutex;
+
+    //! Vitesse donnee a la locomotive en fonction.
+    int vitesseLimitee() const;
 };
 
 #endif // LOCOMOTIVE_H
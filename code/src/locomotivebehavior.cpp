@@ -11,52 +11,225 @@
 #include "locomotivebehavior.h"
 #include "ctrain_handler.h"
 
+void LocomotiveBehavior::setStopToken(std::shared_ptr<StopToken> token)
+{
+    // A new request means the thread is about to be (re)launched: undo the
+    // cancellations of a previous stop.
+    if (!token->stopRequested()) {
+        for (const auto& section : sections) {
+            section.synchro->reset();
+        }
+        retablir_attentes();
+    }
+
+    for (const auto& section : sections) {
+        const auto synchro = section.synchro;
+        token->onStop([synchro] { synchro->cancel(); });
+    }
+    token->onStop([] { annuler_attentes(); });
+    token->onStop([this] {
+        { std::lock_guard<std::mutex> lock(pauseMutex); }
+        pauseCondition.notify_all();
+    });
+
+    Launchable::setStopToken(std::move(token));
+}
+
 void LocomotiveBehavior::run()
 {
-    // Locomotive initialization.
+    drive();
+
+    // Leave the locomotive stopped, whatever the state of the route.
+    loco.arreter();
+    park(true);
+
+    if (stopRequested()) {
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        const StopAcknowledgement ack = stopToken->acknowledge();
+        loco.afficherMessage(QString("Stopped %1 ms after the request.")
+                                 .arg(Milliseconds(ack.latency).count(), 0, 'f', 2));
+        if (ack.last) {
+            afficher_message(qPrintable(QString("All behaviors stopped, worst latency %1 ms.")
+                                            .arg(Milliseconds(ack.worst).count(), 0, 'f', 2)));
+        }
+    }
+}
+
+void LocomotiveBehavior::drive()
+{
+    // Locomotive initialization. A resumed locomotive already got its speed
+    // back with the simulation.
     loco.allumerPhares();
-    loco.demarrer();
-    loco.afficherMessage("Ready!");
+    if (!resumed) {
+        loco.demarrer();
+        loco.afficherMessage("Ready!");
+    } else {
+        loco.afficherMessage("Resumed!");
+    }
+
+    Progress start = resumed ? resumeAt : Progress{Progress::StationContact, 0, loco.priority};
 
     // Initial entry into the station.
-    attendre_contact(station);
+    if (start.step == Progress::StationContact) {
+        reach(Progress::StationContact, 0);
+        if (!waitContact(station)) {
+            return;
+        }
+        start.step = Progress::Station;
+    }
 
-    while (true) {
-        sections.front().synchro->stopAtStation(loco);
+    while (!stopRequested()) {
+        if (start.step == Progress::Station) {
+            reach(Progress::Station, 0);
+            if (!waitWhilePaused()) {
+                return;
+            }
+            park(true);
+            sections.front().synchro->stopAtStation(loco);
+            park(false);
+            start = {Progress::Warn, 0, loco.priority};
+        }
+
+        // Go through each section, from the one reached when resuming.
+        for (auto i = static_cast<std::size_t>(start.section); i < sections.size(); ++i) {
+            const auto& section = sections[i];
+            const auto  from    = i == static_cast<std::size_t>(start.section) ? start.step
+                                                                                : Progress::Warn;
 
-        // Go through each section
-        for (const auto& section : sections) {
             // Wait for the warning contact to be triggered, if any.
-            if (section.contactWarn != station) {
-                attendre_contact(section.contactWarn);
+            if (from <= Progress::Warn) {
+                reach(Progress::Warn, i);
+                if (section.contactWarn != station && !waitContact(section.contactWarn)) {
+                    return;
+                }
             }
 
             // The first departed locomotive gets priority in the first shared
             // section and then has its priority incremented to normal.
-            if (loco.priority == 0) {
-                loco.priority++;
-            } else {
-                section.synchro->access(loco);
+            if (from <= Progress::Access) {
+                reach(Progress::Access, i);
+                if (!waitWhilePaused()) {
+                    return;
+                }
+                if (loco.priority == 0) {
+                    loco.priority++;
+                } else {
+                    park(true);
+                    section.synchro->access(loco);
+                    park(false);
+                }
             }
 
             // Toggle the junctions once the section entry contact is hit.
-            attendre_contact(section.contactEnter);
-            diriger_aiguillage(section.junctionEntry.junctionId,
-                               section.junctionEntry.direction, 0);
-            diriger_aiguillage(section.junctionExit.junctionId,
-                               section.junctionExit.direction, 0);
+            if (from <= Progress::Enter) {
+                reach(Progress::Enter, i);
+                if (!waitContact(section.contactEnter)) {
+                    return;
+                }
+                diriger_aiguillage(section.junctionEntry.junctionId,
+                                   section.junctionEntry.direction, 0);
+                diriger_aiguillage(section.junctionExit.junctionId,
+                                   section.junctionExit.direction, 0);
+            }
 
             // Release the shared section after passing the exit contact.
-            attendre_contact(section.contactExit);
+            reach(Progress::Exit, i);
+            if (!waitContact(section.contactExit)) {
+                return;
+            }
             section.synchro->leave(loco);
         }
 
         // Wait for the station contact if it is different from the section
         // exit contact.
         if (station != sections.back().contactExit) {
-            attendre_contact(station);
+            reach(Progress::StationContact, 0);
+            if (!waitContact(station)) {
+                return;
+            }
         }
+        start = {Progress::Station, 0, loco.priority};
+    }
+}
+
+bool LocomotiveBehavior::waitContact(std::int32_t contact)
+{
+    if (stopRequested()) {
+        return false;
     }
+    park(true);
+    attendre_contact_loco(contact, loco.numero());
+    park(false);
+    return !stopRequested();
+}
+
+bool LocomotiveBehavior::waitWhilePaused()
+{
+    park(true);
+    {
+        std::unique_lock<std::mutex> lock(pauseMutex);
+        pauseCondition.wait(lock, [this] { return !paused || stopRequested(); });
+    }
+    park(false);
+    return !stopRequested();
+}
+
+void LocomotiveBehavior::pause(std::chrono::milliseconds pausedFor)
+{
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex);
+        paused = true;
+    }
+    for (const auto& section : sections) {
+        section.synchro->pause(loco, pausedFor);
+    }
+}
+
+void LocomotiveBehavior::resume()
+{
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex);
+        paused = false;
+    }
+    pauseCondition.notify_all();
+    for (const auto& section : sections) {
+        section.synchro->resume(loco);
+    }
+}
+
+void LocomotiveBehavior::reach(Progress::Step step, std::size_t section)
+{
+    std::lock_guard<std::mutex> lock(progressMutex);
+    current = {step, static_cast<std::int32_t>(section), loco.priority};
+}
+
+LocomotiveBehavior::Progress LocomotiveBehavior::progress() const
+{
+    std::lock_guard<std::mutex> lock(progressMutex);
+    return current;
+}
+
+void LocomotiveBehavior::park(bool isParked)
+{
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        parked = isParked;
+    }
+    parkedCondition.notify_all();
+}
+
+bool LocomotiveBehavior::waitUntilParked(std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock(progressMutex);
+    return parkedCondition.wait_for(lock, timeout, [this] { return parked; });
+}
+
+void LocomotiveBehavior::resumeFrom(const Progress& progress)
+{
+    resumed       = true;
+    resumeAt      = progress;
+    current       = progress;
+    loco.priority = progress.priority;
 }
 
 void LocomotiveBehavior::printStartMessage()
@@ -12,6 +12,10 @@
 #ifndef LOCOMOTIVEBEHAVIOR_H
 #define LOCOMOTIVEBEHAVIOR_H
 
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <utility>
 
 #include "launchable.h"
@@ -70,6 +74,25 @@ class LocomotiveBehavior : public Launchable {
         const std::int32_t                      contactExit;
     } SharedSection;
 
+    /**
+     * @brief Where the behavior stands on its route: the step it waits for, in
+     * the order they occur, and the section it is in.
+     */
+    struct Progress {
+        enum Step : std::int32_t {
+            StationContact,  ///< Waiting for the station contact.
+            Station,         ///< Stopping at the station.
+            Warn,            ///< Waiting for the warning contact of the section.
+            Access,          ///< Asking for the section.
+            Enter,           ///< Waiting for the entry contact of the section.
+            Exit,            ///< Waiting for the exit contact of the section.
+        };
+
+        Step         step;
+        std::int32_t section;
+        std::int32_t priority;
+    };
+
     /**
      * @brief Encapsulates the parameters of the locomotive behavior.
      *
@@ -95,6 +118,64 @@ class LocomotiveBehavior : public Launchable {
         this->loco.priority = 0;  // Not initialized by the Loco class itself.
     }
 
+    /**
+     * @brief Shares a stop request. Requesting the stop also cancels the
+     * contact waits and the shared sections of the locomotive, so that run()
+     * returns even if it is blocked. To be called before startThread(), and
+     * before restoring the shared sections: the shared sections are reset, so
+     * that the behavior can be relaunched with a new request after a stop.
+     *
+     * @param token The stop request.
+     */
+    void setStopToken(std::shared_ptr<StopToken> token) override;
+
+    /**
+     * @brief The locomotive whose behavior this is.
+     */
+    const Locomotive& locomotive() const { return loco; }
+
+    /**
+     * @brief Suspends the behavior of a paused locomotive: it doesn't start
+     * from the station nor ask for a section until resume(). Also applies the
+     * pause policy of the shared sections. Called at the pause, then
+     * periodically while it lasts, from another thread.
+     *
+     * @param pausedFor How long the locomotive has been paused.
+     */
+    void pause(std::chrono::milliseconds pausedFor);
+
+    /**
+     * @brief Resumes the behavior of a paused locomotive.
+     */
+    void resume();
+
+    /**
+     * @brief Where the behavior stands, to be saved with the simulation. Only
+     * consistent while the simulation is suspended and the thread is waiting,
+     * see waitUntilParked().
+     */
+    Progress progress() const;
+
+    /**
+     * @brief Waits until the thread is blocked in one of its waits, or has
+     * returned, so that progress() stays the same while the simulation is
+     * suspended. Called from another thread.
+     *
+     * @param timeout How long to wait at most.
+     * @return false if the thread still runs after the timeout.
+     */
+    bool waitUntilParked(std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief Makes run() start at a saved step instead of at the start of the
+     * route, for a simulation restored from a snapshot. To be called before
+     * startThread().
+     *
+     * @param progress The step returned by progress() when the snapshot was
+     * taken.
+     */
+    void resumeFrom(const Progress& progress);
+
     protected:
     /*!
      * \brief run Fonction lancée par le thread, représente le comportement de
@@ -118,6 +199,37 @@ class LocomotiveBehavior : public Launchable {
     Locomotive& loco;
 
     private:
+    /**
+     * @brief Drives the locomotive along its route until a stop is requested.
+     */
+    void drive();
+
+    /**
+     * @brief Waits for the locomotive to activate a contact.
+     *
+     * @param contact The contact number.
+     * @return false if a stop was requested during the wait.
+     */
+    bool waitContact(std::int32_t contact);
+
+    /**
+     * @brief Blocks while the locomotive is paused.
+     *
+     * @return false if a stop was requested.
+     */
+    bool waitWhilePaused();
+
+    /**
+     * @brief Records the step the behavior is about to wait for.
+     */
+    void reach(Progress::Step step, std::size_t section);
+
+    /**
+     * @brief Records that the thread enters or leaves a wait, for
+     * waitUntilParked().
+     */
+    void park(bool isParked);
+
     /**
      * @brief sections The shared sections the locomotive is passing through.
      */
@@ -127,6 +239,19 @@ class LocomotiveBehavior : public Launchable {
      * @brief station The station of the locomotive.
      */
     const std::int32_t station;
+
+    mutable std::mutex              progressMutex;
+    mutable std::condition_variable parkedCondition;
+    Progress                        current{Progress::StationContact, 0, 0};
+    //! Whether the thread is blocked in a wait or has returned.
+    bool                            parked = false;
+    //! Set by resumeFrom(): the step run() starts at.
+    bool               resumed = false;
+    Progress           resumeAt{Progress::StationContact, 0, 0};
+
+    std::mutex              pauseMutex;
+    std::condition_variable pauseCondition;
+    bool                    paused = false;
 };
 
 #endif  // LOCOMOTIVEBEHAVIOR_H
@@ -0,0 +1,99 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#include "pausesupervisor.h"
+#include "ctrain_handler.h"
+
+void PauseSupervisor::supervise(LocomotiveBehavior& behavior)
+{
+    behaviors.push_back(&behavior);
+}
+
+void PauseSupervisor::setStopToken(std::shared_ptr<StopToken> token)
+{
+    token->onStop([this] {
+        { std::lock_guard<std::mutex> lock(mutex); }
+        condition.notify_all();
+    });
+    stopToken = std::move(token);
+}
+
+void PauseSupervisor::report(int loco, int paused, void* supervisor)
+{
+    auto* self = static_cast<PauseSupervisor*>(supervisor);
+    {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->events.push_back({loco, paused != 0});
+    }
+    self->condition.notify_all();
+}
+
+void PauseSupervisor::run()
+{
+    sur_pause_loco(&PauseSupervisor::report, this);
+
+    // Locos may already be paused, e.g. in a simulation restored from a snapshot.
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto* behavior : behaviors) {
+        const int loco = behavior->locomotive().numero();
+        if (loco_en_pause(loco)) {
+            events.push_back({loco, true});
+        }
+    }
+    while (!stopRequested()) {
+        const auto ready = [this] { return !events.empty() || stopRequested(); };
+        if (pausedSince.empty()) {
+            condition.wait(lock, ready);
+        } else {
+            condition.wait_for(lock, CHECK_PERIOD, ready);
+        }
+        if (stopRequested()) {
+            break;
+        }
+
+        std::deque<Event> pending;
+        pending.swap(events);
+        lock.unlock();
+
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto& event : pending) {
+            for (auto* behavior : behaviors) {
+                if (behavior->locomotive().numero() != event.loco) {
+                    continue;
+                }
+                if (event.paused) {
+                    pausedSince.emplace(event.loco, now);
+                } else if (pausedSince.erase(event.loco) != 0) {
+                    behavior->resume();
+                }
+            }
+        }
+
+        for (auto* behavior : behaviors) {
+            const auto since = pausedSince.find(behavior->locomotive().numero());
+            if (since != pausedSince.end()) {
+                behavior->pause(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(now - since->second));
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+void PauseSupervisor::printStartMessage()
+{
+    qDebug() << "[START] Thread de supervision des pauses lancé";
+}
+
+void PauseSupervisor::printCompletionMessage()
+{
+    qDebug() << "[STOP] Thread de supervision des pauses a terminé";
+}
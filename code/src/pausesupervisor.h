@@ -0,0 +1,91 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef PAUSESUPERVISOR_H
+#define PAUSESUPERVISOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "launchable.h"
+#include "locomotivebehavior.h"
+
+/**
+ * @brief Relays the pauses of the locomotives, from the simulator or the
+ * program, to their behaviors.
+ *
+ * The simulator reports pauses from its own thread, which must not block:
+ * this thread applies them instead, and keeps telling the behaviors how long
+ * their locomotive has been paused so that the pause policies of the shared
+ * sections can time out.
+ */
+class PauseSupervisor : public Launchable {
+    public:
+    /**
+     * @brief Adds a behavior to supervise. To be called before startThread().
+     *
+     * @param behavior The behavior, which must outlive the supervisor thread.
+     */
+    void supervise(LocomotiveBehavior& behavior);
+
+    /**
+     * @brief Shares the stop request of the behaviors. The supervisor doesn't
+     * drive a locomotive, so it isn't counted among the threads acknowledging
+     * the stop.
+     *
+     * @param token The stop request.
+     */
+    void setStopToken(std::shared_ptr<StopToken> token) override;
+
+    protected:
+    /**
+     * @brief Applies the pauses until a stop is requested. The pause reports
+     * are registered with the simulator at the start, so the supervisor must
+     * outlive the simulator.
+     */
+    void run() override;
+
+    void printStartMessage() override;
+    void printCompletionMessage() override;
+
+    private:
+    /**
+     * @brief Interval at which the behaviors of paused locomotives are told
+     * how long the pause has lasted.
+     */
+    static constexpr std::chrono::milliseconds CHECK_PERIOD{100};
+
+    /**
+     * @brief A change of pause state reported by the simulator.
+     */
+    struct Event {
+        int  loco;
+        bool paused;
+    };
+
+    /**
+     * @brief Queues a change of pause state, from the simulator thread.
+     */
+    static void report(int loco, int paused, void* supervisor);
+
+    std::vector<LocomotiveBehavior*> behaviors;
+    //! Start of the pause of each paused locomotive, only used by run().
+    std::map<int, std::chrono::steady_clock::time_point> pausedSince;
+    std::mutex              mutex;
+    std::condition_variable condition;
+    std::deque<Event>       events;
+};
+
+#endif  // PAUSESUPERVISOR_H
@@ -0,0 +1,129 @@
+/*  _____   _____ ____    ___   ___ ___  ____
+ * |  __ \ / ____/ __ \  |__ \ / _ \__ \|___ \
+ * | |__) | |   | |  | |    ) | | | | ) | __) |
+ * |  ___/| |   | |  | |   / /| | | |/ / |__ <
+ * | |    | |___| |__| |  / /_| |_| / /_ ___) |
+ * |_|     \_____\____/  |____|\___/____|____/
+ * Authors: Timothée Van Hove and Aubry Mangold
+ * Date: 2023-11-27
+ */
+
+#ifndef STOPTOKEN_H
+#define STOPTOKEN_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief What a thread learns when it acknowledges a stop request.
+ */
+struct StopAcknowledgement {
+    /// Time between the request and this acknowledgement.
+    std::chrono::microseconds latency{0};
+    /// Worst latency among the acknowledgements so far, this one included.
+    std::chrono::microseconds worst{0};
+    /// Whether every enlisted thread has now acknowledged the request.
+    bool last{false};
+};
+
+/**
+ * @brief A cooperative stop request shared by the threads of a scenario.
+ *
+ * The threads check stopRequested() after each blocking call and return when
+ * it is set. The objects they may be blocked on register a callback with
+ * onStop() that releases them, so that a stop request reaches every thread
+ * in bounded time.
+ */
+class StopToken {
+    public:
+    /**
+     * @brief Requests the stop and runs the registered callbacks, once.
+     * Further requests have no effect.
+     */
+    void requestStop() {
+        std::vector<std::function<void()>> toRun;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped) {
+                return;
+            }
+            stopped     = true;
+            requestedAt = std::chrono::steady_clock::now();
+            toRun.swap(callbacks);
+        }
+
+        for (const auto& callback : toRun) {
+            callback();
+        }
+    }
+
+    /**
+     * @brief Whether the stop was requested. May be called from any thread.
+     */
+    bool stopRequested() const { return stopped; }
+
+    /**
+     * @brief Registers a callback run by requestStop(), in the thread that
+     * requested the stop. Runs it immediately if the stop was already
+     * requested. The callback must not block.
+     *
+     * @param callback The callback, usually releasing blocked threads.
+     */
+    void onStop(std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!stopped) {
+                callbacks.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    /**
+     * @brief Counts one more thread expected to acknowledge the stop request.
+     */
+    void enlist() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++participants;
+    }
+
+    /**
+     * @brief Records that the calling thread has honoured the stop request,
+     * i.e. returned from its work with its loco stopped. Has no effect if the
+     * stop was not requested.
+     *
+     * @return StopAcknowledgement The latency of this thread and of the slowest
+     * one so far.
+     */
+    StopAcknowledgement acknowledge() {
+        std::lock_guard<std::mutex> lock(mutex);
+        StopAcknowledgement result;
+        if (!stopped) {
+            return result;
+        }
+
+        result.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - requestedAt);
+        worst        = std::max(worst, result.latency);
+        result.worst = worst;
+        result.last  = ++acknowledged >= participants;
+        return result;
+    }
+
+    private:
+    std::mutex                            mutex;
+    std::atomic<bool>                     stopped{false};
+    std::vector<std::function<void()>>    callbacks;
+    std::chrono::steady_clock::time_point requestedAt;
+    std::chrono::microseconds             worst{0};
+    int                                   participants{0};
+    int                                   acknowledged{0};
+};
+
+#endif  // STOPTOKEN_H
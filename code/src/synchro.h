@@ -14,13 +14,39 @@
 
 #include <QDebug>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include <pcosynchro/pcosemaphore.h>
 
+#include "arbitrationpolicy.h"
 #include "locomotive.h"
 #include "ctrain_handler.h"
+#include "metriques.h"
 #include "synchrointerface.h"
 
 
+/**
+ * @brief What a section does when the loco holding it is paused.
+ */
+enum class PausePolicy {
+    /// The loco keeps the section until it resumes and leaves it.
+    Hold,
+    /// The section is released as soon as the loco is paused.
+    Release,
+    /// The section is released once the loco has been paused for a while.
+    ReleaseAfter,
+};
+
 /**
  * @brief La classe Synchro implémente l'interface SynchroInterface qui
  * propose les méthodes liées à la section partagée.
@@ -31,15 +57,197 @@ public:
     /**
      * @brief Synchro Constructeur de la classe qui représente la section partagée.
      * Initialisez vos éventuels attributs ici, sémaphores etc.
+     *
+     * @param name The name of the section in the metrics.
+     * @param policy Chooses the next loco among those waiting when the section
+     * is released, first come first served by default.
      */
-    Synchro() :
+    explicit Synchro(const QString& name = "Section",
+                     std::shared_ptr<ArbitrationPolicy> policy = std::make_shared<FifoPolicy>()) :
+      section(Metriques::getInstance()->enregistrerSection(name)),
+      occupiedSince(0),
+      policy(std::move(policy)),
+      nextSequence(0),
+      occupant(-1),
+      predictive(false),
+      movingBlock(false),
+      pausePolicy(PausePolicy::Hold),
+      pauseDelay(0),
+      pauseListener(&Synchro::printPauseNotice),
+      cancelled(false),
       mutexSection(1),
       mutexStation(1),
-      sectionSemaphore(0),
       stationSemaphore(0),
       isSectionFree(true),
-      otherIsWaiting(false),
-      isStationOccupied(false) {}
+      isStationOccupied(false),
+      stationWaiting(false) {}
+
+    /**
+     * @brief Sets the estimated time a loco needs, once granted the section
+     * while stopped at its warning contact, to reach the section entry. Used by
+     * the shortest-time-to-arrival policy.
+     *
+     * @param locoNumber The number of the loco.
+     * @param seconds The estimated time, in seconds.
+     */
+    void setApproachTime(int locoNumber, double seconds) {
+        mutexSection.acquire();
+        approachTimes[locoNumber] = seconds;
+        mutexSection.release();
+    }
+
+    /**
+     * @brief Sets the contacts a loco triggers when entering and leaving the
+     * section. Required for a loco to be slowed down in predictive mode.
+     *
+     * @param locoNumber The number of the loco.
+     * @param contactEnter The section entry contact of the loco.
+     * @param contactExit The section exit contact of the loco.
+     */
+    void setSectionContacts(int locoNumber, int contactEnter, int contactExit) {
+        mutexSection.acquire();
+        sectionContacts[locoNumber] = {contactEnter, contactExit};
+        mutexSection.release();
+    }
+
+    /**
+     * @brief Enables the predictive access mode. When the section is busy, an
+     * approaching loco is slowed down so that it reaches the entry contact
+     * when the occupant is predicted to leave, instead of being stopped at the
+     * warning contact. It is stopped just before the entry contact if the
+     * section is still busy by then.
+     *
+     * @param enabled True to enable the predictive mode.
+     */
+    void setPredictive(bool enabled) {
+        mutexSection.acquire();
+        predictive = enabled;
+        mutexSection.release();
+    }
+
+    /**
+     * @brief Enables the moving-block mode. Instead of holding the whole
+     * section, any number of locos may be in it: the simulator limits the
+     * speed of each one so that it can always stop behind the loco ahead.
+     * Only suitable for sections all locos run through in the same direction
+     * on the same track: junctions, where locos from another branch merge in,
+     * still need a fixed section.
+     *
+     * @param enabled True to enable the moving-block mode.
+     */
+    void setMovingBlock(bool enabled) {
+        mutexSection.acquire();
+        movingBlock = enabled;
+        mutexSection.release();
+    }
+
+    /**
+     * @brief Chooses what happens to the section when the loco holding it is
+     * paused. Only a loco that has not reached its entry contact yet can give
+     * the section up: it is then stopped just before the entry contact, and
+     * asks for the section again when it resumes. A loco paused inside the
+     * section physically blocks it and always keeps it. Under the releasing
+     * policies, a paused loco waiting for the section is also passed over.
+     * Requires the section contacts of the locos.
+     *
+     * @param policy The pause policy, Hold by default.
+     * @param delay How long the loco must have been paused before the
+     * section is released, for the ReleaseAfter policy.
+     */
+    void setPausePolicy(PausePolicy policy,
+                        std::chrono::milliseconds delay = std::chrono::milliseconds(0)) {
+        mutexSection.acquire();
+        pausePolicy = policy;
+        pauseDelay  = policy == PausePolicy::ReleaseAfter ? delay : std::chrono::milliseconds(0);
+        mutexSection.release();
+    }
+
+    /**
+     * @brief Called for each loco waiting for the section when the loco
+     * holding it is paused, then again if the paused loco gives the section
+     * up, so that the waiting locos can re-plan.
+     *
+     * @param waiting The number of the waiting loco.
+     * @param holder The number of the paused loco.
+     * @param released True if the paused loco gave the section up.
+     */
+    using PauseListener = std::function<void(int waiting, int holder, bool released)>;
+
+    /**
+     * @brief Sets who is told about the pauses of the loco holding the
+     * section. The listener is called outside of the section lock, from the
+     * thread applying the pause; it must not block. By default, the waiting
+     * locos are told in the console.
+     *
+     * @param listener The listener, replacing the previous one.
+     */
+    void setPauseListener(PauseListener listener) {
+        mutexSection.acquire();
+        pauseListener = std::move(listener);
+        mutexSection.release();
+    }
+
+    /**
+     * @brief Who holds the section, saved with the simulation so that a run can
+     * be restarted from a snapshot.
+     */
+    struct State {
+        //! The loco holding the section, -1 if it is free.
+        int              occupant;
+        //! The locos inside the section in moving-block mode.
+        std::vector<int> movingBlock;
+        //! The locos that gave the section up during a pause.
+        std::vector<int> evicted;
+    };
+
+    /**
+     * @brief Returns who holds the section. The locos waiting for it aren't
+     * part of the state: they ask for it again when their thread is restarted.
+     */
+    State saveState() {
+        State state;
+        mutexSection.acquire();
+        state.occupant = isSectionFree ? -1 : occupant;
+        for (const auto& entered : enteredAt) {
+            state.movingBlock.push_back(entered.first);
+        }
+        for (const auto& loco : evicted) {
+            state.evicted.push_back(loco.first);
+        }
+        mutexSection.release();
+        return state;
+    }
+
+    /**
+     * @brief Restores who holds the section, before the threads of the locos
+     * are started. Nobody waits for the section nor at the station.
+     *
+     * @param state The state returned by saveState().
+     * @param locos The locos of the route, to find the evicted ones.
+     */
+    void restoreState(const State& state, const std::vector<Locomotive*>& locos) {
+        mutexSection.acquire();
+        const qint64 now = Metriques::maintenant();
+        occupant         = state.occupant;
+        isSectionFree    = state.occupant < 0;
+        occupiedSince    = now;
+        enteredAt.clear();
+        for (const int loco : state.movingBlock) {
+            enteredAt[loco] = now;
+        }
+        evicted.clear();
+        for (Locomotive* loco : locos) {
+            if (std::find(state.evicted.begin(), state.evicted.end(), loco->numero()) !=
+                state.evicted.end()) {
+                evicted[loco->numero()] = loco;
+            }
+        }
+        waiting.clear();
+        pausedLocos.clear();
+        keptByPaused.clear();
+        isStationOccupied = false;
+        mutexSection.release();
+    }
 
     /**
      * @brief access Méthode à appeler pour accéder à la section partagée
@@ -49,23 +257,70 @@ public:
      * @param loco La locomotive qui essaie accéder à la section partagée
      */
     void access(Locomotive& loco) override {
+        const qint64 requested = Metriques::maintenant();
+        qint64       waited    = 0;
         mutexSection.acquire();
 
-        // If the section isn't free, stop the loco and wait to acquire it.
-        if (!isSectionFree) {
-            loco.arreter();
+        if (cancelled) {
+            mutexSection.release();
+            return;
+        }
+
+        // In moving-block mode the loco never waits, the simulator keeps it
+        // behind the loco ahead.
+        if (movingBlock) {
+            enteredAt[loco.numero()] = requested;
+            mutexSection.release();
+            mettre_bloc_mobile_loco(loco.numero(), 1);
+            Metriques::getInstance()->accesSection(section, loco.numero(), 0);
             afficher_message(qPrintable(
-                QString("Loco %1: S'arrête et attend").arg(loco.numero())));
+                QString("Loco %1: Accès à la section en bloc mobile").arg(loco.numero())));
+            return;
+        }
+
+        Prediction prediction{occupant, -1.0, -1.0};
+        if (!isSectionFree) {
+            prediction = predict(loco);
+            if (cancelled) {
+                mutexSection.release();
+                return;
+            }
+        }
+
+        // If the section isn't free, slow down or stop the loco and wait to
+        // acquire it. It may have been freed while the simulator was queried.
+        if (!isSectionFree) {
+            const int entryContact = slowDown(loco, prediction);
+            if (entryContact < 0) {
+                loco.arreter();
+                afficher_message(qPrintable(
+                    QString("Loco %1: S'arrête et attend").arg(loco.numero())));
+            }
 
-            // Set the other loco to wait.
-            otherIsWaiting = true;
+            // Register the request: the leaving loco hands the section over to
+            // the request chosen by the policy by releasing its semaphore.
+            PcoSemaphore granted(0);
+            const auto   approach = approachTimes.find(loco.numero());
+            waiting.push_back({{loco.numero(),
+                                std::chrono::steady_clock::now(),
+                                nextSequence++,
+                                approach != approachTimes.end() ? approach->second : 0.0},
+                               &granted,
+                               nullptr});
             mutexSection.release();
 
-            // Blockingly wait for the section to be free.
-            sectionSemaphore.acquire();
+            // Blockingly wait for the section to be handed over.
+            granted.acquire();
             mutexSection.acquire();
-            otherIsWaiting = false;
+            if (cancelled) {
+                mutexSection.release();
+                return;
+            }
+            waited = Metriques::maintenant() - requested;
 
+            if (entryContact >= 0) {
+                annuler_arret_loco(loco.numero());
+            }
             loco.demarrer();
             afficher_message(
                 qPrintable(QString("Loco %1: Redémarre").arg(loco.numero())));
@@ -73,7 +328,10 @@ public:
 
         // Set the section to occupied now that a loco has acquired it.
         isSectionFree = false;
+        occupant      = loco.numero();
+        occupiedSince = Metriques::maintenant();
         mutexSection.release();
+        Metriques::getInstance()->accesSection(section, loco.numero(), waited);
         afficher_message(
             qPrintable(QString("Loco %1: Accès à la section partagée")
                            .arg(loco.numero())));
@@ -88,13 +346,22 @@ public:
      */
     void leave(Locomotive& loco) override {
         mutexSection.acquire();
-        isSectionFree = true;
 
-        // Give access to the other loco if it is waiting.
-        if (otherIsWaiting) {
-            sectionSemaphore.release();
+        if (movingBlock) {
+            const qint64 entered = enteredAt[loco.numero()];
+            enteredAt.erase(loco.numero());
+            mutexSection.release();
+            mettre_bloc_mobile_loco(loco.numero(), 0);
+            Metriques::getInstance()->sortieSection(section, Metriques::maintenant() - entered);
+            afficher_message(
+                qPrintable(QString("Loco %1: Sortie de la section partagée")
+                               .arg(loco.numero())));
+            return;
         }
+        Metriques::getInstance()->sortieSection(
+            section, Metriques::maintenant() - occupiedSince);
 
+        handOver();
         mutexSection.release();
 
         afficher_message(
@@ -111,6 +378,11 @@ public:
      * @param loco La locomotive qui doit attendre à la gare
      */
     void stopAtStation(Locomotive& loco) override {
+        if (cancelled) {
+            return;
+        }
+
+        const qint64 arrival = Metriques::maintenant();
         afficher_message(
             qPrintable(QString("Loco %1: Arrivée en gare").arg(loco.numero())));
 
@@ -119,11 +391,15 @@ public:
         mutexStation.acquire();
         if (!isStationOccupied) {
             isStationOccupied = true;
+            stationWaiting    = true;
             mutexStation.release();
             loco.arreter();
 
             // Wait to be released by the last arrived loco.
             stationSemaphore.acquire();
+            if (cancelled) {
+                return;
+            }
 
             // Set the priority (1 being lower priority than 0) and restart the
             // loco.
@@ -136,19 +412,33 @@ public:
             isStationOccupied = false;
             loco.arreter();
 
-            // Wait for the 5 seconds.
+            // Wait for the 5 seconds, or less if a stop is requested: cancel()
+            // wakes the wait up at once.
             afficher_message(qPrintable(
                 QString("Loco %1: Attente de 5 secondes").arg(loco.numero())));
-            PcoThread::usleep(5e6);
+            {
+                std::unique_lock<std::mutex> lock(cancelMutex);
+                cancelCondition.wait_for(lock, std::chrono::microseconds(STATION_WAIT_US),
+                                         [this] { return cancelled.load(); });
+            }
+            if (cancelled) {
+                mutexStation.release();
+                return;
+            }
 
             // Give access to the shared section before releasing other locos so
             // that we're sure it can't be acquired by another loco.
             access(loco);
+            if (cancelled) {
+                mutexStation.release();
+                return;
+            }
             afficher_message(
                 qPrintable(QString("Loco %1: Prioritaire").arg(loco.numero())));
 
             // Release the semaphore to signal the first loco that it may
             // continue.
+            stationWaiting = false;
             stationSemaphore.release();
 
             // Set the loco to the highest priority and restart it.
@@ -160,18 +450,429 @@ public:
             mutexStation.release();
         }
 
+        Metriques::getInstance()->sejourGare(loco.numero(),
+                                             Metriques::maintenant() - arrival);
         afficher_message(qPrintable(
             QString("Loco %1: Départ de la gare").arg(loco.numero())));
     }
 
+    /**
+     * @brief cancel Méthode appelée lors d'une demande d'arrêt
+     *
+     * Releases every loco waiting for the section or at the station. From now
+     * on, access() and stopAtStation() return immediately, until reset().
+     */
+    void cancel() override {
+        {
+            std::lock_guard<std::mutex> lock(cancelMutex);
+            cancelled = true;
+        }
+        cancelCondition.notify_all();
+
+        mutexSection.acquire();
+        for (const auto& waiter : waiting) {
+            if (waiter.granted != nullptr) {
+                waiter.granted->release();
+            }
+        }
+        waiting.clear();
+        evicted.clear();
+        mutexSection.release();
+
+        // At most one loco waits at the station. The loco releasing it, if
+        // any, has returned from its wait once cancelled is set.
+        mutexStation.acquire();
+        if (stationWaiting) {
+            stationWaiting = false;
+            stationSemaphore.release();
+        }
+        mutexStation.release();
+    }
+
+    /**
+     * @brief reset Méthode appelée avant de relancer les threads après un arrêt
+     *
+     * Frees the section and the station and lifts the cancellation, keeping
+     * the configuration of the section. No thread may use the section during
+     * the call.
+     */
+    void reset() override {
+        mutexSection.acquire();
+        {
+            std::lock_guard<std::mutex> lock(cancelMutex);
+            cancelled = false;
+        }
+        waiting.clear();
+        evicted.clear();
+        pausedLocos.clear();
+        keptByPaused.clear();
+        enteredAt.clear();
+        isSectionFree = true;
+        occupant      = -1;
+        mutexSection.release();
+
+        mutexStation.acquire();
+        isStationOccupied = false;
+        stationWaiting    = false;
+        mutexStation.release();
+    }
+
+    /**
+     * @brief pause Méthode appelée tant qu'une locomotive est en pause
+     *
+     * Tells the locos waiting for the section that its holder is paused,
+     * through the pause listener, and releases the section under the pause
+     * policy.
+     *
+     * @param loco La locomotive en pause
+     * @param pausedFor La durée de la pause jusqu'ici
+     */
+    void pause(Locomotive& loco, std::chrono::milliseconds pausedFor) override {
+        const int number = loco.numero();
+        mutexSection.acquire();
+        const bool justPaused = pausedLocos.insert(number).second;
+
+        if (!holdsReleasable(number)) {
+            mutexSection.release();
+            return;
+        }
+
+        const PauseListener listener = pauseListener;
+        if (justPaused) {
+            notifyWaiting(listener, number, false);
+            if (!holdsReleasable(number)) {
+                mutexSection.release();
+                return;
+            }
+        }
+
+        const auto contacts = sectionContacts.find(number);
+        if (pausePolicy == PausePolicy::Hold || pausedFor < pauseDelay ||
+            contacts == sectionContacts.end()) {
+            mutexSection.release();
+            return;
+        }
+
+        // The loco is frozen: its position tells whether it has entered the
+        // section, in which case it keeps it. The simulator is queried without
+        // mutexSection, see predict().
+        const std::pair<int, int> entryExit = contacts->second;
+        mutexSection.release();
+        const double toEnter = distance_jusqu_au_contact(number, entryExit.first);
+        const double toExit  = distance_jusqu_au_contact(number, entryExit.second);
+        mutexSection.acquire();
+
+        // The loco may have resumed, or the section been handed over, meanwhile.
+        if (!holdsReleasable(number)) {
+            mutexSection.release();
+            return;
+        }
+
+        if (toEnter < 0 || (toExit >= 0 && toExit < toEnter)) {
+            keptByPaused.insert(number);
+            mutexSection.release();
+            afficher_message(qPrintable(
+                QString("Loco %1: En pause dans la section, la garde").arg(number)));
+            return;
+        }
+
+        programmer_arret_loco(number, entryExit.first);
+        evicted[number] = &loco;
+        Metriques::getInstance()->sortieSection(
+            section, Metriques::maintenant() - occupiedSince);
+        // Tell every loco that was waiting, including the one now granted the
+        // section.
+        std::vector<int> released;
+        for (const auto& waiter : waiting) {
+            released.push_back(waiter.request.loco);
+        }
+        handOver();
+        mutexSection.release();
+
+        afficher_message(qPrintable(
+            QString("Loco %1: En pause, libère la section").arg(number)));
+        if (listener) {
+            for (const int waiter : released) {
+                listener(waiter, number, true);
+            }
+        }
+    }
+
+    /**
+     * @brief resume Méthode appelée à la reprise d'une locomotive mise en pause
+     *
+     * A loco that gave the section up asks for it again, a loco that was
+     * passed over while waiting may now be granted it.
+     *
+     * @param loco La locomotive qui reprend
+     */
+    void resume(Locomotive& loco) override {
+        const int number = loco.numero();
+        mutexSection.acquire();
+        pausedLocos.erase(number);
+        keptByPaused.erase(number);
+
+        if (!cancelled) {
+            if (evicted.count(number) != 0) {
+                waiting.push_back({{number, std::chrono::steady_clock::now(), nextSequence++, 0.0},
+                                   nullptr,
+                                   &loco});
+                afficher_message(qPrintable(
+                    QString("Loco %1: Reprend et redemande la section").arg(number)));
+            }
+            if (isSectionFree && !waiting.empty()) {
+                isSectionFree = false;
+                handOver();
+            }
+        }
+
+        mutexSection.release();
+    }
+
     private:
+    /**
+     * @brief Whether a loco is still paused, holds the section and may still
+     * give it up under the pause policy. Must be called with mutexSection
+     * held.
+     *
+     * @param number The number of the paused loco.
+     */
+    bool holdsReleasable(int number) const {
+        return !cancelled && !movingBlock && !isSectionFree && occupant == number &&
+               pausedLocos.count(number) != 0 && evicted.count(number) == 0 &&
+               keptByPaused.count(number) == 0;
+    }
+
+    /**
+     * @brief Tells the locos waiting for the section about the paused holder.
+     * Must be called with mutexSection held, which is released while the
+     * listener runs so that it can't block the section: the section may have
+     * changed on return.
+     *
+     * @param listener The listener to call.
+     * @param holder The number of the paused loco.
+     * @param released True if the paused loco gave the section up.
+     */
+    void notifyWaiting(const PauseListener& listener, int holder, bool released) {
+        std::vector<int> waiters;
+        for (const auto& waiter : waiting) {
+            waiters.push_back(waiter.request.loco);
+        }
+        if (!listener || waiters.empty()) {
+            return;
+        }
+
+        mutexSection.release();
+        for (const int waiter : waiters) {
+            listener(waiter, holder, released);
+        }
+        mutexSection.acquire();
+    }
+
+    /**
+     * @brief The default pause listener, which tells the waiting loco in the
+     * console.
+     */
+    static void printPauseNotice(int waiting, int holder, bool released) {
+        afficher_message_loco(waiting,
+                              qPrintable(released
+                                             ? QString("La loco %1, en pause, a libéré la section").arg(holder)
+                                             : QString("La loco %1, qui tient la section, est en pause").arg(holder)));
+    }
+
+    /**
+     * @brief Hands the section over to the waiting loco chosen by the policy,
+     * or frees it if no loco can take it. The section stays occupied during
+     * the hand-over so that no other loco can take it in between. Must be
+     * called with mutexSection held.
+     */
+    void handOver() {
+        // A paused loco would hold the section without moving: unless the
+        // section is held through pauses, it is passed over.
+        std::vector<std::size_t>    candidates;
+        std::vector<SectionRequest> requests;
+        for (std::size_t i = 0; i < waiting.size(); ++i) {
+            if (pausePolicy == PausePolicy::Hold ||
+                pausedLocos.count(waiting[i].request.loco) == 0) {
+                candidates.push_back(i);
+                requests.push_back(waiting[i].request);
+            }
+        }
+
+        if (candidates.empty()) {
+            isSectionFree = true;
+            occupant      = -1;
+            return;
+        }
+
+        const auto   now    = std::chrono::steady_clock::now();
+        const auto   chosen = waiting.begin() + static_cast<std::ptrdiff_t>(
+                                                  candidates[policy->choose(requests, now)]);
+        const Waiter waiter = *chosen;
+        waiting.erase(chosen);
+        occupant = waiter.request.loco;
+
+        if (waiter.granted != nullptr) {
+            waiter.granted->release();
+            return;
+        }
+
+        // A loco that gave the section up during a pause waits in front of its
+        // entry contact, not in access(): restart it from here.
+        evicted.erase(occupant);
+        occupiedSince = Metriques::maintenant();
+        annuler_arret_loco(occupant);
+        waiter.evicted->demarrer();
+        Metriques::getInstance()->accesSection(
+            section, occupant,
+            std::chrono::duration_cast<std::chrono::microseconds>(now - waiter.request.since)
+                .count());
+        afficher_message(qPrintable(
+            QString("Loco %1: Accès à la section partagée").arg(occupant)));
+    }
+
+    /**
+     * @brief Margin added to the predicted clearing time of the section, in
+     * seconds, so that the approaching loco doesn't reach the entry contact
+     * before the occupant has actually left.
+     */
+    static constexpr double PREDICTION_MARGIN_S = 1.0;
+
+    /**
+     * @brief Duration of the station stop, in microseconds.
+     */
+    static constexpr unsigned STATION_WAIT_US = 5000000;
+
+    /**
+     * @brief When the occupant of the section and an approaching loco are
+     * predicted to reach their contacts.
+     */
+    struct Prediction {
+        //! The occupant the prediction was made against.
+        int    occupant;
+        //! Time until the occupant reaches its exit contact, in seconds, negative if unknown.
+        double toClear;
+        //! Time until the loco reaches its entry contact, in seconds, negative if unknown.
+        double toArrive;
+    };
+
+    /**
+     * @brief Predicts when the occupant clears the section and when the loco
+     * reaches its entry contact, in predictive mode. The simulator answers
+     * from the GUI thread, which takes mutexSection in cancel(): mutexSection
+     * is released during the queries, so the section may have changed on
+     * return. Must be called with mutexSection held.
+     *
+     * @param loco The loco approaching the busy section.
+     * @return The prediction, with negative times if the loco can't be timed.
+     */
+    Prediction predict(const Locomotive& loco) {
+        Prediction prediction{occupant, -1.0, -1.0};
+
+        // Only the first waiting loco can be timed against the occupant.
+        if (!predictive || !waiting.empty()) {
+            return prediction;
+        }
+
+        const auto approaching = sectionContacts.find(loco.numero());
+        const auto occupying   = sectionContacts.find(occupant);
+        if (approaching == sectionContacts.end() || occupying == sectionContacts.end()) {
+            return prediction;
+        }
+
+        const int entryContact = approaching->second.first;
+        const int exitContact  = occupying->second.second;
+        mutexSection.release();
+        prediction.toClear  = temps_jusqu_au_contact(prediction.occupant, exitContact);
+        prediction.toArrive = temps_jusqu_au_contact(loco.numero(), entryContact);
+        mutexSection.acquire();
+        return prediction;
+    }
+
+    /**
+     * @brief Gives the loco a reduced speed so that it reaches its entry
+     * contact when the occupant is predicted to reach its exit contact, and
+     * programs a stop just before the entry contact in case it is still busy.
+     * Must be called with mutexSection held.
+     *
+     * @param loco The loco approaching the busy section.
+     * @param prediction The prediction made by predict().
+     * @return The entry contact of the loco, or -1 if the loco wasn't slowed
+     * down and must be stopped.
+     */
+    int slowDown(Locomotive& loco, const Prediction& prediction) {
+        // The prediction is stale if another loco got the section or started
+        // waiting for it in the meantime.
+        if (!predictive || !waiting.empty() || prediction.occupant != occupant ||
+            prediction.toClear < 0 || prediction.toArrive < 0) {
+            return -1;
+        }
+
+        const auto approaching = sectionContacts.find(loco.numero());
+        if (approaching == sectionContacts.end()) {
+            return -1;
+        }
+
+        const double toClear  = prediction.toClear;
+        const double toArrive = prediction.toArrive;
+
+        // Keep the speed if the section clears in time, never go under the
+        // minimum speed: the programmed stop is the last resort.
+        const int speed = std::max(VITESSE_MINIMUM, std::min(loco.vitesse(),
+            static_cast<int>(loco.vitesse() * toArrive / (toClear + PREDICTION_MARGIN_S))));
+        programmer_arret_loco(loco.numero(), approaching->second.first);
+        loco.ralentir(speed);
+        afficher_message(qPrintable(QString("Loco %1: Ralentit à %2 et attend")
+                                        .arg(loco.numero())
+                                        .arg(speed)));
+        return approaching->second.first;
+    }
+
+    /**
+     * @brief A loco waiting for the section, with the semaphore it blocks on,
+     * or, for a loco that gave the section up during a pause, the loco to
+     * restart once it is granted the section again.
+     */
+    struct Waiter {
+        SectionRequest request;
+        PcoSemaphore*  granted;
+        Locomotive*    evicted;
+    };
+
+    const int                                section;
+    qint64                                   occupiedSince;
+    const std::shared_ptr<ArbitrationPolicy> policy;
+    std::vector<Waiter>                      waiting;
+    std::map<int, double>                    approachTimes;
+    std::uint64_t                            nextSequence;
+    //! Entry and exit contacts of the section, per loco number.
+    std::map<int, std::pair<int, int>>       sectionContacts;
+    int                                      occupant;
+    bool                                     predictive;
+    bool                                     movingBlock;
+    PausePolicy                              pausePolicy;
+    std::chrono::milliseconds                pauseDelay;
+    PauseListener                            pauseListener;
+    //! Numbers of the paused locos.
+    std::set<int>                            pausedLocos;
+    //! Paused locos inside the section, which keep it whatever the policy.
+    std::set<int>                            keptByPaused;
+    //! Locos that gave the section up during a pause, stopped before their entry contact.
+    std::map<int, Locomotive*>               evicted;
+    //! Set once a stop was requested, read without the mutexes.
+    std::atomic<bool>                        cancelled;
+    //! Wakes the station wait up when a stop is requested.
+    std::mutex                               cancelMutex;
+    std::condition_variable                  cancelCondition;
+    //! Time each loco entered the section, in moving-block mode.
+    std::map<int, qint64>                    enteredAt;
     PcoSemaphore mutexSection;
     PcoSemaphore mutexStation;
-    PcoSemaphore sectionSemaphore;
     PcoSemaphore stationSemaphore;
     bool         isSectionFree;
-    bool         otherIsWaiting;
     bool         isStationOccupied;
+    //! Whether a loco waits on stationSemaphore, protected by mutexStation.
+    bool         stationWaiting;
 };
 
 #endif // SYNCHRO_H
@@ -11,6 +11,8 @@
 #ifndef SYNCHROINTERFACE_H
 #define SYNCHROINTERFACE_H
 
+#include <chrono>
+
 #include "locomotive.h"
 
 /**
@@ -50,6 +52,43 @@ public:
      * @param loco La locomotive qui doit attendre à la gare
      */
     virtual void stopAtStation(Locomotive& loco) = 0;
+
+    /**
+     * @brief cancel Méthode appelée lors d'une demande d'arrêt
+     *
+     * Libère les threads bloqués dans access et stopAtStation. Ensuite, ces méthodes
+     * retournent sans attendre, jusqu'à l'appel de reset.
+     */
+    virtual void cancel() {}
+
+    /**
+     * @brief reset Méthode appelée avant de relancer les threads après un arrêt
+     *
+     * Remet la section partagée et la gare dans leur état initial, libres, et annule
+     * l'effet de cancel. Appelée alors qu'aucun thread n'utilise la synchronisation.
+     */
+    virtual void reset() {}
+
+    /**
+     * @brief pause Méthode appelée tant qu'une locomotive est en pause
+     *
+     * Appelée à la mise en pause puis régulièrement jusqu'à la reprise, depuis un autre
+     * thread que celui de la locomotive. Permet de libérer la section partagée tenue par
+     * une locomotive en pause.
+     *
+     * @param loco La locomotive en pause
+     * @param pausedFor La durée de la pause jusqu'ici
+     */
+    virtual void pause(Locomotive& /*loco*/, std::chrono::milliseconds /*pausedFor*/) {}
+
+    /**
+     * @brief resume Méthode appelée à la reprise d'une locomotive mise en pause
+     *
+     * @param loco La locomotive qui reprend
+     */
+    virtual void resume(Locomotive& /*loco*/) {}
+
+    virtual ~SynchroInterface() {}
 };
 
 #endif // SYNCHROINTERFACE_H